@@ -0,0 +1,69 @@
+/**
+   Copyright 2021 Chris Cartland. All Rights Reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "BootStats.h"
+
+#if USE_ADAFRUIT_HUZZAH32_ESP32_FEATHER
+#include <Preferences.h>
+#include <esp_system.h>
+
+#define BOOT_STATS_NAMESPACE "boot_stats"
+
+static Preferences preferences;
+#endif
+
+static unsigned long rebootCount = 0;
+static unsigned long carriedOutageMillis = 0;
+
+void bootStatsBegin() {
+#if USE_ADAFRUIT_HUZZAH32_ESP32_FEATHER
+  preferences.begin(BOOT_STATS_NAMESPACE, false);
+  rebootCount = preferences.getULong("reboots", 0);
+  carriedOutageMillis = preferences.getULong("outage", 0);
+  // Waking from deep sleep also runs setup(), but it is not a reboot
+  if (esp_reset_reason() != ESP_RST_DEEPSLEEP) {
+    rebootCount++;
+    preferences.putULong("reboots", rebootCount);
+  }
+#else
+  rebootCount = 1;
+#endif
+}
+
+unsigned long bootStatsRebootCount() {
+  return rebootCount;
+}
+
+void bootStatsSaveOutage(unsigned long outageMillis) {
+  carriedOutageMillis = outageMillis;
+#if USE_ADAFRUIT_HUZZAH32_ESP32_FEATHER
+  preferences.putULong("outage", outageMillis);
+#endif
+}
+
+unsigned long bootStatsCarriedOutage() {
+  return carriedOutageMillis;
+}
+
+void bootStatsClearOutage() {
+  if (carriedOutageMillis == 0) {
+    return;
+  }
+  carriedOutageMillis = 0;
+#if USE_ADAFRUIT_HUZZAH32_ESP32_FEATHER
+  preferences.putULong("outage", 0);
+#endif
+}
@@ -20,11 +20,18 @@
 
 #include <Arduino.h>
 
-#include "WiFiGetMulti.h"
-#include "WiFiGetNina.h"
+/**
+   Counters that survive a reset. On the HUZZAH32 they are kept in NVS, because the
+   reset wire clears RTC memory. Other boards keep them in RAM, so they start over.
+*/
+void bootStatsBegin();
+
+unsigned long bootStatsRebootCount();
 
-#define WIFI_CONNECT_RETRY_MAX 0
+// Save how long the server had been unreachable, right before resetting
+void bootStatsSaveOutage(unsigned long outageMillis);
 
-bool wifiSetup(String wifiSSID, String wifiPassword);
+// Outage carried over from before the last reset. Cleared by bootStatsClearOutage().
+unsigned long bootStatsCarriedOutage();
 
-bool wget(String &url, int port, char *buff);
+void bootStatsClearOutage();
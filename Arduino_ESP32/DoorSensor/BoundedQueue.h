@@ -0,0 +1,89 @@
+/**
+   Copyright 2021 Chris Cartland. All Rights Reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+/**
+   Fixed-capacity FIFO. When full, push() drops the oldest item so the newest
+   state is never lost, and counts the drop. While the front is held, for example
+   by a request in flight that pops it on success, the second-oldest item is
+   dropped instead, so pop() never removes an item that was not sent.
+*/
+template <typename T, size_t N>
+class BoundedQueue {
+  private:
+    T _items[N];
+    size_t _head = 0;
+    size_t _count = 0;
+    unsigned long _dropped = 0;
+    bool _frontHeld = false;
+
+    // Remove the item at position index from the front, keeping the order of the rest
+    void removeAt(size_t index) {
+      for (size_t i = index; i + 1 < _count; i++) {
+        _items[(_head + i) % N] = _items[(_head + i + 1) % N];
+      }
+      _count--;
+    }
+
+  public:
+    void push(const T &item) {
+      if (_count == N) {
+        _dropped++;
+        if (!_frontHeld) {
+          _head = (_head + 1) % N;
+          _count--;
+        } else if (N > 1) {
+          removeAt(1);
+        } else {
+          return; // The only slot is in flight, drop the new item
+        }
+      }
+      _items[(_head + _count) % N] = item;
+      _count++;
+    }
+    // Keep front() in place until pop() or releaseFront()
+    void holdFront() {
+      _frontHeld = _count > 0;
+    }
+    void releaseFront() {
+      _frontHeld = false;
+    }
+    T &front() {
+      return _items[_head];
+    }
+    void pop() {
+      _frontHeld = false;
+      if (_count > 0) {
+        _head = (_head + 1) % N;
+        _count--;
+      }
+    }
+    bool empty() {
+      return _count == 0;
+    }
+    size_t size() {
+      return _count;
+    }
+    // Items dropped since the last call
+    unsigned long takeDropped() {
+      unsigned long dropped = _dropped;
+      _dropped = 0;
+      return dropped;
+    }
+};
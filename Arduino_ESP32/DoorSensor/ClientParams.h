@@ -0,0 +1,83 @@
+/**
+   Copyright 2026 Chris Cartland. All Rights Reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <stdio.h>
+
+#include <GarageCore.h>
+
+// A number set to this is left out of the request
+#define CLIENT_PARAM_NONE -1L
+
+/**
+   The query parameters of a sensor request. Numbers are written straight into the URL
+   and the strings point at buffers the sketch owns, so a request allocates nothing.
+*/
+typedef struct ClientParams {
+  const char *session = "";
+  float batteryVoltage = CLIENT_PARAM_NONE;
+  long sensorA = CLIENT_PARAM_NONE;
+  long sensorB = CLIENT_PARAM_NONE;
+  long eventAgeMillis = CLIENT_PARAM_NONE;
+  long awakeMillis = CLIENT_PARAM_NONE;
+  long rebootCount = CLIENT_PARAM_NONE;
+  long outageMillis = CLIENT_PARAM_NONE;
+  long droppedReports = CLIENT_PARAM_NONE;
+  const char *error = "";
+} ClientParams;
+
+inline void appendClientParam(garage_core::UrlWriter &url, const char *key, long value) {
+  if (value != CLIENT_PARAM_NONE) {
+    url.param(key, value);
+  }
+}
+
+inline void appendClientParam(garage_core::UrlWriter &url, const char *key, const char *value) {
+  if (value[0] != '\0') {
+    url.param(key, value);
+  }
+}
+
+/**
+   Volts with two decimals, like String(float). Written by hand because printf on
+   some Arduino cores has no %f.
+*/
+inline void appendClientParam(garage_core::UrlWriter &url, const char *key, float volts) {
+  if (volts < 0) {
+    return;
+  }
+  long centivolts = (long)(volts * 100 + 0.5f);
+  char value[24];
+  snprintf(value, sizeof(value), "%ld.%02ld", centivolts / 100, centivolts % 100);
+  url.param(key, value);
+}
+
+/**
+   Append every parameter that is set, in the order the server has always seen them.
+*/
+inline void appendClientParams(garage_core::UrlWriter &url, const ClientParams &params) {
+  appendClientParam(url, "session", params.session);
+  appendClientParam(url, "batteryVoltage", params.batteryVoltage);
+  appendClientParam(url, "sensorA", params.sensorA);
+  appendClientParam(url, "sensorB", params.sensorB);
+  appendClientParam(url, "eventAgeMillis", params.eventAgeMillis);
+  appendClientParam(url, "awakeMillis", params.awakeMillis);
+  appendClientParam(url, "rebootCount", params.rebootCount);
+  appendClientParam(url, "outageMillis", params.outageMillis);
+  appendClientParam(url, "droppedReports", params.droppedReports);
+  appendClientParam(url, "error", params.error);
+}
@@ -16,35 +16,113 @@
 #pragma once
 
 #include "Arduino.h"
+#include <GarageCore.h>
 
-#define DEBOUNCER_MAX_PIN_COUNT 32
 #define DEBOUNCER_INVALID -1
 
+/**
+   Debounces a set of pins fixed at compile time. State is packed one bit per pin, in the
+   order the pins are listed, and the compiler unrolls the update over the pins.
+   Nothing is printed. The caller decides what to log from the returned mask.
+
+  Debouncer<SENSOR_PIN_A, SENSOR_PIN_B> debouncer(DEBOUNCE_MILLIS);
+  uint32_t changed = debouncer.debounceUpdate(millis());
+  if (changed & debouncer.pinMask(SENSOR_PIN_A)) {
+    Serial.println(debouncer.debounceGet(SENSOR_PIN_A));
+  }
+*/
+template <int... Pins>
 class Debouncer {
+  public:
+    static const size_t PIN_COUNT = sizeof...(Pins);
+    static_assert(PIN_COUNT > 0 && PIN_COUNT <= 32, "Debouncer packs pins into a uint32_t");
+
+    explicit Debouncer(unsigned long duration) : debounceDuration(duration) {}
+
+    // Read every pin. Returns the pinMask() bits of the pins whose debounced value changed.
+    uint32_t debounceUpdate(unsigned long currentTime) {
+      return updatePins(currentTime, typename garage_core::MakeIndexSequence<PIN_COUNT>::type());
+    }
+
+    int debounceGet(int pin) const {
+      uint32_t mask = pinMask(pin);
+      if ((valid & mask) == 0) {
+        return DEBOUNCER_INVALID;
+      }
+      return (state & mask) ? HIGH : LOW;
+    }
+
+    // Seed a pin with a value that was debounced before a deep sleep
+    void debounceRestore(int pin, int value, unsigned long currentTime) {
+      int index = pinIndex(pin);
+      if (index < 0) {
+        return;
+      }
+      uint32_t mask = (uint32_t)1 << index;
+      uint32_t bits = value == HIGH ? mask : 0;
+      if (value == DEBOUNCER_INVALID) {
+        valid &= ~mask;
+        seen &= ~mask;
+      } else {
+        valid |= mask;
+        seen |= mask;
+      }
+      state = (state & ~mask) | bits;
+      lastRead = (lastRead & ~mask) | bits;
+      debounceTime[index] = currentTime;
+    }
+
+    // Bit for pin in the mask returned by debounceUpdate(), or 0 if the pin is not debounced
+    static constexpr uint32_t pinMask(int pin) {
+      return pinIndex(pin) < 0 ? 0 : (uint32_t)1 << pinIndex(pin);
+    }
+
   private:
-    Stream *Serial;
-    String _error;
+    static constexpr int PINS[PIN_COUNT] = {Pins...};
+    static constexpr uint32_t ALL_PINS = PIN_COUNT == 32 ? 0xFFFFFFFFu : ((uint32_t)1 << PIN_COUNT) - 1;
+
     unsigned long debounceDuration;
-    int state[DEBOUNCER_MAX_PIN_COUNT];
-    int lastRead[DEBOUNCER_MAX_PIN_COUNT];
-    unsigned long debounceTime[DEBOUNCER_MAX_PIN_COUNT];
+    uint32_t state = 0;    // Debounced levels
+    uint32_t valid = 0;    // Pins with a debounced level
+    uint32_t lastRead = 0; // Raw levels from the last update
+    uint32_t seen = 0;     // Pins read at least once
+    unsigned long debounceTime[PIN_COUNT] = {};
 
-  public:
-    Debouncer(Stream *serial, unsigned long duration) {
-      Serial = serial;
-      debounceDuration = duration;
-      for (int i = 0; i < DEBOUNCER_MAX_PIN_COUNT; i++) {
-        state[i] = DEBOUNCER_INVALID;
-        lastRead[i] = DEBOUNCER_INVALID;
-        debounceTime[i] = 0;
-      }
-    };
-    bool debounceUpdate(int SENSOR_PIN, unsigned long currentTime);
-    int debounceGet(int SENSOR_PIN);
-    void setError(String error) {
-      _error = error;
+    static constexpr int pinIndex(int pin, size_t i = 0) {
+      return i >= PIN_COUNT ? -1 : (PINS[i] == pin ? (int)i : pinIndex(pin, i + 1));
+    }
+
+    /**
+       Reads every pin before touching the packed state, then updates all pins at once with
+       mask operations. Interleaving digitalRead() calls with per-pin read-modify-writes made
+       the compiler store and reload the state around every call.
+    */
+    template <size_t... I>
+    uint32_t updatePins(unsigned long currentTime, garage_core::IndexSequence<I...>) {
+      uint32_t reads = 0;
+      int unrolledReads[] = {(reads |= (digitalRead(Pins) == HIGH ? (uint32_t)1 << I : 0), 0)...};
+      (void)unrolledReads;
+      // A pin read for the first time, or whose raw level moved, starts its wait over
+      uint32_t moved = (reads ^ lastRead) | ~seen;
+      uint32_t settled = 0;
+      int unrolledTimes[] = {(settled |= settle(I, (moved >> I) & 1, currentTime), 0)...};
+      (void)unrolledTimes;
+      seen = ALL_PINS;
+      lastRead = reads;
+      uint32_t changed = settled & (~valid | (reads ^ state));
+      valid |= settled;
+      state = (state & ~settled) | (reads & settled);
+      return changed;
     }
-    String getError() {
-      return _error;
+
+    // The pin's bit if its raw level has held for longer than the debounce duration
+    uint32_t settle(size_t index, uint32_t moved, unsigned long currentTime) {
+      if (moved) {
+        debounceTime[index] = currentTime;
+      }
+      return currentTime - debounceTime[index] > debounceDuration ? (uint32_t)1 << index : 0;
     }
 };
+
+template <int... Pins>
+constexpr int Debouncer<Pins...>::PINS[Debouncer<Pins...>::PIN_COUNT];
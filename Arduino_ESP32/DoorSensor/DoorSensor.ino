@@ -15,16 +15,42 @@
 */
 
 #include "secrets.h"
-#include "BlinkMorseCode.h"
 #include "Debouncer.h"
-#include "WiFiGet.h"
 #include "ServerApi.h"
+#include "Scheduler.h"
+#include "BoundedQueue.h"
+#include "BootStats.h"
+#include <GarageCore.h>
+#include <garage_core/arduino_wifi.h>
 
 #define SIGNAL_HIGH 1
 #define SIGNAL_LOW 0
 #define SWITCH_OPEN SIGNAL_HIGH
 #define SWITCH_CLOSED SIGNAL_LOW
 #define DEBOUNCE_MILLIS 50
+#define SAMPLE_INTERVAL_MILLIS 5
+
+#define REPORT_QUEUE_SIZE 8
+#define ERROR_BUFFER_SIZE 96
+#define RETRY_BACKOFF_MIN_MILLIS 1000
+#define RETRY_BACKOFF_MAX_MILLIS (60UL * 1000)
+// Reset only after the server has been unreachable this long. Override in secrets.h.
+#ifndef SUSTAINED_FAILURE_RESET_MILLIS
+#define SUSTAINED_FAILURE_RESET_MILLIS (30UL * 60 * 1000) // 30 minutes.
+#endif
+
+// Deep sleep between events. Define USE_DEEP_SLEEP true in secrets.h to enable.
+#ifndef USE_DEEP_SLEEP
+#define USE_DEEP_SLEEP false
+#endif
+#if USE_DEEP_SLEEP && !USE_ADAFRUIT_HUZZAH32_ESP32_FEATHER
+#error "USE_DEEP_SLEEP is only supported on USE_ADAFRUIT_HUZZAH32_ESP32_FEATHER"
+#endif
+#if USE_DEEP_SLEEP
+#include <esp_sleep.h>
+// Stay awake at least this long after waking, so the debouncer can see the change
+#define SLEEP_SETTLE_MILLIS (DEBOUNCE_MILLIS * 2)
+#endif
 
 // Analog input to measure battery voltage.
 //
@@ -56,16 +82,51 @@
 #define WIFI_PORT 443
 #endif
 
-Debouncer debouncer(&Serial, DEBOUNCE_MILLIS);
+Debouncer<SENSOR_PIN_A, SENSOR_PIN_B> debouncer(DEBOUNCE_MILLIS);
 
 ServerApi serverApi(&Serial);
-ClientParams params;
 ServerResponse serverdata;
-String session = "";
+char session[SESSION_BUFFER_SIZE] = "";
 unsigned long HEARTBEAT_INTERVAL = 1000 * 60 * 10; // 10 minutes.
 unsigned long lastNetworkRequestTime = 0;
 float batteryVoltage = 0.0;
 
+// Latest debounced readings, updated by sampleSensors()
+int debouncedA = DEBOUNCER_INVALID;
+int debouncedB = DEBOUNCER_INVALID;
+// A reading waiting to be sent. DEBOUNCER_INVALID leaves a sensor out of the report.
+typedef struct SensorReport {
+  int sensorA;
+  int sensorB;
+  bool heartbeat;
+  unsigned long capturedMillis; // Sent as an age, so the server can date the event
+} SensorReport;
+// Reports waiting for the server, oldest first. Kept across failed requests.
+BoundedQueue<SensorReport, REPORT_QUEUE_SIZE> reportQueue;
+bool pendingHeartbeat = true; // Report once after booting
+char pendingError[ERROR_BUFFER_SIZE] = "";
+garage_core::WiFiRequest serverRequest;
+// Whether the request in flight carries the report at the front of the queue. A request
+// can carry only pendingError, and then its success must not pop anything.
+bool sentReport = false;
+
+// An outage starts at the first failed request and ends at the next success.
+garage_core::RetryPolicy<garage_core::ArduinoPlatform> retryPolicy(RETRY_BACKOFF_MIN_MILLIS, RETRY_BACKOFF_MAX_MILLIS);
+bool rebootReported = false;
+
+#if USE_DEEP_SLEEP
+// State that survives deep sleep. Everything else starts over on each wakeup.
+RTC_DATA_ATTR bool rtcValid = false;
+RTC_DATA_ATTR int rtcDebouncedA = DEBOUNCER_INVALID;
+RTC_DATA_ATTR int rtcDebouncedB = DEBOUNCER_INVALID;
+RTC_DATA_ATTR char rtcSession[SESSION_BUFFER_SIZE];
+RTC_DATA_ATTR unsigned long rtcLastAwakeMillis = 0; // Reported with the next request
+#endif
+
+bool resetScheduled = false;
+unsigned long resetAtMillis = 0;
+garage_core::OkBlinker<garage_core::ArduinoPlatform> okBlinker;
+
 const unsigned long BLINK_PERIOD_MS = 1000 * 10; // 10 seconds.
 const unsigned long BLINK_DURATION_MS = 500; // 500 ms.
 
@@ -75,31 +136,30 @@ void resetDevice() {
   digitalWrite(RST_PIN, LOW);
 }
 
-void fail(String msg, int delaySeconds) {
+/**
+   Report the error with the next server request and reset after delaySeconds.
+   Returns right away; checkReset() performs the reset, so sampling continues meanwhile.
+*/
+void fail(const char *msg, int delaySeconds) {
   Serial.print("Failure: ");
   Serial.println(msg);
-
-  Serial.println("Attempting to notify server of the error...");
-  ClientParams params;
-  params.session = session;
-  params.error = msg;
-  bool networkSuccess = updateServerSensorData(params);
-  if (networkSuccess) {
-    Serial.println("Successfully notified server.");
-  } else {
-    Serial.println("Failed to notify server.");
+  if (resetScheduled) {
+    return;
   }
-
+  Serial.println("Attempting to notify server of the error...");
+  snprintf(pendingError, sizeof(pendingError), "%s", msg);
+  resetScheduled = true;
+  resetAtMillis = millis() + delaySeconds * 1000UL;
   Serial.print("Restarting device after ");
   Serial.print(delaySeconds);
   Serial.println(" seconds...");
-  for (int i = 0; i < delaySeconds; i++) {
-    delay(1000);
-    Serial.print('.');
+}
+
+void checkReset(unsigned long now) {
+  if (resetScheduled && (long)(now - resetAtMillis) >= 0) {
+    Serial.println("Resetting now!");
+    resetDevice();
   }
-  Serial.println();
-  Serial.println("Resetting now!");
-  resetDevice();
 }
 
 float readBatteryVoltage() {
@@ -112,68 +172,109 @@ float readBatteryVoltage() {
   return (analogRead(VOLTAGE_INPUT_PIN) / MAX_ANALOG_READ_VOLTAGE_INPUT) * MAX_VOLTAGE * ADC_REFERENCE_VOLTAGE * ADAFRUIT_MULTIPLIER;
 }
 
-bool updateServerSensorData(ClientParams params) {
+bool parseServerResponse(garage_core::WiFiResponseReader &response, void *context) {
+  return serverApi.parseData(*(ServerResponse *)context, response);
+}
+
+/**
+   Start a server request with everything that is pending. The response is handled
+   by finishServerSensorData() once runNetwork() sees it complete.
+*/
+bool startServerSensorData(const ClientParams &params) {
   digitalWrite(LED_BUILTIN, HIGH); // Blink a little while contacting the server.
-  String url = serverApi.buildUrl(params);
+  char url[SERVER_URL_BUFFER_SIZE];
+  if (!serverApi.buildUrl(params, url, sizeof(url))) {
+    digitalWrite(LED_BUILTIN, LOW);
+    return false;
+  }
   Serial.print("Request URL: ");
   Serial.println(url);
   const uint16_t port = WIFI_PORT;
-  char buf[4000];
-  wget(url, port, buf);
-  String json = buf;
-  Serial.println(json);
-  bool success = serverApi.parseData(serverdata, json);
-  if (!success) {
+  if (!serverRequest.begin(url, port)) {
+    garage_core::print_wget_result(Serial, serverRequest);
     digitalWrite(LED_BUILTIN, LOW);
     return false;
   }
-  session = serverdata.session;
-  if (session.length() <= 0) {
-    Serial.println("No session ID.");
-  } else {
-    Serial.print("Session ID: ");
-    Serial.println(serverdata.session);
-  }
-  digitalWrite(LED_BUILTIN, LOW);
   return true;
 }
 
-void setup() {
-  // https://www.instructables.com/two-ways-to-reset-arduino-in-software/
-  // Write PIN high immediately in order to avoid resetting the device.
-  digitalWrite(RST_PIN, HIGH);
-  delay(200);
-  pinMode(RST_PIN, OUTPUT);
+// How long the server has been unreachable, including time before the last reset
+unsigned long outageMillis(unsigned long now) {
+  return bootStatsCarriedOutage() + retryPolicy.outage_duration();
+}
 
-  Serial.begin(115200);
-  delay(100);
-  Serial.println(""); // First line is usually lost. Print empty line.
-  pinMode(SENSOR_PIN_A, INPUT);
-  pinMode(SENSOR_PIN_B, INPUT);
-  pinMode(LED_PIN_A, OUTPUT);
-  pinMode(LED_PIN_B, OUTPUT);
-  pinMode(LED_BUILTIN, OUTPUT);
-  blinkOK(LED_BUILTIN);
-  Serial.println("==========");
-  Serial.println(String(__TIMESTAMP__));
-  bool success = wifiSetup(WIFI_SSID, WIFI_PASSWORD);
-  if (success) {
-    Serial.println("Successfully connected to WiFi.");
-  } else {
-    fail("Failed to connect to WiFi.", 5);
+/**
+   Back off and keep the report for the next attempt. Only a sustained outage resets
+   the device, since a reset means a Wi-Fi and TLS cold start.
+*/
+void handleServerFailure(unsigned long now) {
+  retryPolicy.on_failure();
+  Serial.print("Server update failed, ");
+  Serial.print(reportQueue.size());
+  Serial.print(" reports queued. Retrying in ");
+  Serial.print(retryPolicy.backoff());
+  Serial.println(" ms.");
+  // Measure the window from this boot, so a long outage resets at most once per window
+  if (retryPolicy.outage_duration() >= SUSTAINED_FAILURE_RESET_MILLIS && !resetScheduled) {
+    unsigned long outage = outageMillis(now);
+    bootStatsSaveOutage(outage);
+    char message[ERROR_BUFFER_SIZE];
+    snprintf(message, sizeof(message), "Server unreachable for %lu seconds", outage / 1000);
+    fail(message, 5);
   }
 }
 
-void loop() {
-  unsigned long currentTime = millis();
+void finishServerSensorData(bool success) {
+  unsigned long now = millis();
+  digitalWrite(LED_BUILTIN, LOW);
+  bool reportDelivered = success && sentReport;
+  if (sentReport) {
+    // Delivered, or it stays at the front for the retry but may be dropped like any other now
+    reportQueue.releaseFront();
+    sentReport = false;
+  }
+  if (!success) {
+    handleServerFailure(now);
+    return;
+  }
+  unsigned long outage = outageMillis(now);
+  if (outage > 0) {
+    Serial.print("Recovered after ");
+    Serial.print(outage);
+    Serial.println(" ms.");
+  }
+  retryPolicy.on_success();
+  bootStatsClearOutage();
+  rebootReported = true;
+  pendingError[0] = '\0';
+  if (reportDelivered) {
+    reportQueue.pop();
+  }
+  lastNetworkRequestTime = now;
+  snprintf(session, sizeof(session), "%s", serverdata.session);
+  if (session[0] == '\0') {
+    Serial.println("No session ID.");
+  } else {
+    Serial.print("Session ID: ");
+    Serial.println(session);
+  }
+  Serial.println();
+}
 
-  bool changedA = debouncer.debounceUpdate(SENSOR_PIN_A, currentTime);
-  int debouncedA = debouncer.debounceGet(SENSOR_PIN_A);
-  String debouncedAString = String(debouncedA);
+/**
+   Debounce both sensors and mirror them on the LEDs. Changes are only marked as
+   pending here; runNetwork() sends them when the network is free.
+*/
+void sampleSensors(unsigned long now) {
+  uint32_t changed = debouncer.debounceUpdate(now);
+  debouncedA = debouncer.debounceGet(SENSOR_PIN_A);
+  debouncedB = debouncer.debounceGet(SENSOR_PIN_B);
 #if USE_SENSOR_A
-#else
-  changedA = false;
-  debouncedAString = "";
+  if (changed & debouncer.pinMask(SENSOR_PIN_A)) {
+    Serial.print("Sensor A Changed: ");
+    Serial.println(debouncedA);
+    reportQueue.push({debouncedA, DEBOUNCER_INVALID, false, now});
+  }
 #endif
   if (debouncedA == SWITCH_CLOSED) {
     digitalWrite(LED_PIN_A, HIGH);
@@ -181,82 +282,244 @@ void loop() {
     digitalWrite(LED_PIN_A, LOW);
   }
 
-  bool changedB = debouncer.debounceUpdate(SENSOR_PIN_B, currentTime);
-  int debouncedB = debouncer.debounceGet(SENSOR_PIN_B);
-  String debouncedBString = String(debouncedB);
 #if USE_SENSOR_B
-#else
-  changedB = false;
-  debouncedBString = "";
+  if (changed & debouncer.pinMask(SENSOR_PIN_B)) {
+    Serial.print("Sensor B Changed: ");
+    Serial.println(debouncedB);
+    reportQueue.push({DEBOUNCER_INVALID, debouncedB, false, now});
+  }
 #endif
   if (debouncedB == SWITCH_CLOSED) {
     digitalWrite(LED_PIN_B, HIGH);
   } else {
     digitalWrite(LED_PIN_B, LOW);
   }
+}
 
-  batteryVoltage = readBatteryVoltage();
-  bool networkSuccess = false;
-  if (changedA) {
-    Serial.print("Sensor A Changed: ");
-    Serial.print(debouncedAString);
-    Serial.print(" - Battery voltage: ");
-    Serial.println(batteryVoltage);
-    ClientParams params;
-    params.session = session;
-    params.batteryVoltage = String(batteryVoltage);
-    params.sensorA = debouncedAString;
-    params.sensorB = "";
-    networkSuccess = updateServerSensorData(params);
-    if (!networkSuccess) {
-      fail("Server update failed", 60);
+/**
+   Step the server request. Sends the oldest queued report once the previous request
+   has finished and any retry backoff has passed. Sampling continues throughout, so a
+   sensor that changes during a request or an outage is queued and sent in order.
+*/
+void runNetwork(unsigned long now) {
+  if (serverRequest.in_progress()) {
+    garage_core::WgetState state = serverRequest.poll(parseServerResponse, &serverdata);
+    if (state != garage_core::WGET_WAITING) {
+      garage_core::print_wget_result(Serial, serverRequest);
+      finishServerSensorData(state == garage_core::WGET_SUCCEEDED);
     }
-    lastNetworkRequestTime = currentTime;
-    Serial.println();
+    return;
   }
-  if (changedB) {
-    Serial.print("Sensor B Changed: ");
-    Serial.print(debouncedBString);
-    Serial.print(" - Battery voltage: ");
-    Serial.println(batteryVoltage);
-    ClientParams params;
-    params.session = session;
-    params.batteryVoltage = String(batteryVoltage);
-    params.sensorA = "";
-    params.sensorB = debouncedBString;
-    networkSuccess = updateServerSensorData(params);
-    if (!networkSuccess) {
-      fail("Server update failed", 60);
+  if (!retryPolicy.ready()) {
+    return;
+  }
+  if (now - lastNetworkRequestTime > HEARTBEAT_INTERVAL) {
+    pendingHeartbeat = true;
+  }
+  if (pendingHeartbeat) {
+    // Any queued report already tells the server the device is alive
+    if (reportQueue.empty()) {
+      reportQueue.push({debouncedA, debouncedB, true, now});
     }
-    lastNetworkRequestTime = currentTime;
-    Serial.println();
+    pendingHeartbeat = false;
   }
-  if (currentTime - lastNetworkRequestTime > HEARTBEAT_INTERVAL || lastNetworkRequestTime == 0) {
-    Serial.print("Heartbeat - Battery voltage: ");
-    Serial.println(batteryVoltage);
-    digitalWrite(LED_BUILTIN, HIGH);
-    ClientParams params;
-    params.session = session;
-    params.batteryVoltage = String(batteryVoltage);
-    if (debouncedA != DEBOUNCER_INVALID) {
-      params.sensorA = debouncedAString;
+  if (reportQueue.empty() && pendingError[0] == '\0') {
+    return;
+  }
+  batteryVoltage = readBatteryVoltage();
+  // Only numbers and pointers to the buffers above, so a request allocates nothing
+  ClientParams params;
+  params.session = session;
+  params.batteryVoltage = batteryVoltage;
+  params.error = pendingError;
+  if (!reportQueue.empty()) {
+    SensorReport &report = reportQueue.front();
+#if USE_SENSOR_A
+    if (report.sensorA != DEBOUNCER_INVALID) {
+      params.sensorA = report.sensorA;
     }
-    if (debouncedB != DEBOUNCER_INVALID) {
-      params.sensorB = debouncedBString;
+#endif
+#if USE_SENSOR_B
+    if (report.sensorB != DEBOUNCER_INVALID) {
+      params.sensorB = report.sensorB;
     }
-    networkSuccess = updateServerSensorData(params);
-    if (!networkSuccess) {
-      fail("Server update failed", 60);
+#endif
+    // Queued reports can wait through an outage. The age lets the server subtract it.
+    params.eventAgeMillis = (long)(now - report.capturedMillis);
+    // Sampling keeps pushing during the request. Do not let it evict the report being
+    // sent, or the pop() on success would remove one that never was.
+    reportQueue.holdFront();
+    sentReport = true;
+    if (report.heartbeat) {
+      Serial.print("Heartbeat");
+    } else {
+      Serial.print("Sensor update");
     }
-    lastNetworkRequestTime = currentTime;
-    digitalWrite(LED_BUILTIN, LOW);
-    Serial.println();
   }
+  unsigned long dropped = reportQueue.takeDropped();
+  if (dropped > 0) {
+    params.droppedReports = (long)dropped;
+  }
+  if (!rebootReported) {
+    params.rebootCount = (long)bootStatsRebootCount();
+  }
+  unsigned long outage = outageMillis(now);
+  if (outage > 0) {
+    params.outageMillis = (long)outage;
+  }
+#if USE_DEEP_SLEEP
+  if (rtcLastAwakeMillis > 0) {
+    params.awakeMillis = (long)rtcLastAwakeMillis;
+    rtcLastAwakeMillis = 0;
+  }
+#endif
+  Serial.print(" - Battery voltage: ");
+  Serial.println(batteryVoltage);
+  if (!startServerSensorData(params)) {
+    finishServerSensorData(false);
+  }
+}
 
-  unsigned long blinkTime = currentTime % BLINK_PERIOD_MS;
+void updateStatusLed(unsigned long now) {
+  if (okBlinker.update(now)) {
+    return;
+  }
+  if (serverRequest.in_progress()) {
+    digitalWrite(LED_BUILTIN, HIGH);
+    return;
+  }
+  unsigned long blinkTime = now % BLINK_PERIOD_MS;
   if (blinkTime < BLINK_DURATION_MS) {
     digitalWrite(LED_BUILTIN, HIGH);
   } else {
     digitalWrite(LED_BUILTIN, LOW);
   }
 }
+
+#if USE_DEEP_SLEEP
+/**
+   Restore the debounced readings and session after a deep sleep wakeup.
+   Returns false on a cold boot.
+*/
+bool restoreFromDeepSleep() {
+  esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+  if (!rtcValid) {
+    return false;
+  }
+  unsigned long now = millis();
+  debouncer.debounceRestore(SENSOR_PIN_A, rtcDebouncedA, now);
+  debouncer.debounceRestore(SENSOR_PIN_B, rtcDebouncedB, now);
+  debouncedA = rtcDebouncedA;
+  debouncedB = rtcDebouncedB;
+  snprintf(session, sizeof(session), "%s", rtcSession);
+  Serial.print("Woke up from deep sleep, cause: ");
+  Serial.println((int)cause);
+  // A sensor wakeup reports the change. Only the timer wakeup is a heartbeat.
+  pendingHeartbeat = cause != ESP_SLEEP_WAKEUP_EXT0 && cause != ESP_SLEEP_WAKEUP_EXT1;
+  return true;
+}
+
+void goToDeepSleep() {
+  rtcValid = true;
+  rtcDebouncedA = debouncedA;
+  rtcDebouncedB = debouncedB;
+  snprintf(rtcSession, sizeof(rtcSession), "%s", session);
+  rtcLastAwakeMillis = millis();
+  Serial.print("Awake for ");
+  Serial.print(rtcLastAwakeMillis);
+  Serial.println(" ms. Going to deep sleep.");
+  // Wake when either sensor leaves its current level, or for the next heartbeat
+  esp_sleep_enable_ext0_wakeup((gpio_num_t)SENSOR_PIN_A, debouncedA == SIGNAL_HIGH ? SIGNAL_LOW : SIGNAL_HIGH);
+  esp_sleep_enable_ext1_wakeup(1ULL << SENSOR_PIN_B, debouncedB == SIGNAL_HIGH ? ESP_EXT1_WAKEUP_ALL_LOW : ESP_EXT1_WAKEUP_ANY_HIGH);
+  esp_sleep_enable_timer_wakeup((uint64_t)HEARTBEAT_INTERVAL * 1000);
+  Serial.flush();
+  esp_deep_sleep_start();
+}
+
+/**
+   Sleep once everything is reported and both sensors are steady.
+*/
+void sleepWhenIdle(unsigned long now) {
+  if (now < SLEEP_SETTLE_MILLIS || resetScheduled || okBlinker.running() || serverRequest.in_progress()) {
+    return;
+  }
+  if (!reportQueue.empty() || pendingHeartbeat || pendingError[0] != '\0') {
+    return;
+  }
+  // A raw reading that differs from the debounced one is a change in progress
+  if (digitalRead(SENSOR_PIN_A) != debouncedA || digitalRead(SENSOR_PIN_B) != debouncedB) {
+    return;
+  }
+  goToDeepSleep();
+}
+#endif
+
+ScheduledTask tasks[] = {
+  {"sample", sampleSensors, SAMPLE_INTERVAL_MILLIS},
+  {"network", runNetwork, 0},
+  {"led", updateStatusLed, 10},
+  {"reset", checkReset, 100},
+#if USE_DEEP_SLEEP
+  {"sleep", sleepWhenIdle, 10},
+#endif
+};
+const size_t TASK_COUNT = sizeof(tasks) / sizeof(tasks[0]);
+Scheduler scheduler(tasks, TASK_COUNT);
+
+/**
+   Runs while a response is being read. Every task except the network keeps its cadence.
+*/
+void runWhileWaiting() {
+  unsigned long now = millis();
+  for (size_t i = 0; i < TASK_COUNT; i++) {
+    if (tasks[i].callback != runNetwork) {
+      Scheduler::runIfDue(tasks[i], now);
+    }
+  }
+}
+
+void setup() {
+  // https://www.instructables.com/two-ways-to-reset-arduino-in-software/
+  // Write PIN high immediately in order to avoid resetting the device.
+  digitalWrite(RST_PIN, HIGH);
+  delay(200);
+  pinMode(RST_PIN, OUTPUT);
+
+  Serial.begin(115200);
+  delay(100);
+  Serial.println(""); // First line is usually lost. Print empty line.
+  pinMode(SENSOR_PIN_A, INPUT);
+  pinMode(SENSOR_PIN_B, INPUT);
+  pinMode(LED_PIN_A, OUTPUT);
+  pinMode(LED_PIN_B, OUTPUT);
+  pinMode(LED_BUILTIN, OUTPUT);
+  Serial.println("==========");
+  Serial.println(__TIMESTAMP__);
+  bootStatsBegin();
+  Serial.print("Reboot count: ");
+  Serial.println(bootStatsRebootCount());
+  if (bootStatsCarriedOutage() > 0) {
+    // Reset during an outage. It lasts until the first successful request.
+    retryPolicy.begin_outage();
+  }
+#if USE_DEEP_SLEEP
+  bool wokeFromSleep = restoreFromDeepSleep();
+  bool success = garage_core::wifi_fast_reconnect(WIFI_SSID, WIFI_PASSWORD);
+#else
+  bool wokeFromSleep = false;
+  bool success = garage_core::wifi_setup(WIFI_SSID, WIFI_PASSWORD);
+#endif
+  if (success) {
+    Serial.println("Successfully connected to WiFi.");
+  } else {
+    fail("Failed to connect to WiFi.", 5);
+  }
+  serverRequest.set_idle_callback(runWhileWaiting);
+  if (!wokeFromSleep) {
+    okBlinker.start(LED_BUILTIN, millis());
+  }
+}
+
+void loop() {
+  scheduler.run(millis());
+}
@@ -0,0 +1,75 @@
+/**
+   Copyright 2021 Chris Cartland. All Rights Reserved.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+/**
+   Cooperative scheduler. Each task is a short, non-blocking function that runs when its
+   interval has elapsed. Long work (like a network request) must be split into steps that
+   return quickly, so every other task keeps its cadence.
+
+   Usage:
+
+  ScheduledTask tasks[] = {
+    {"sample", sampleSensors, 5},
+    {"network", runNetwork, 0},
+  };
+  Scheduler scheduler(tasks, 2);
+
+  void loop() {
+    scheduler.run(millis());
+  }
+*/
+typedef void (*TaskCallback)(unsigned long now);
+
+typedef struct ScheduledTask {
+  const char *name;
+  TaskCallback callback;
+  unsigned long intervalMillis; // 0 runs the task on every pass
+  unsigned long lastRunMillis;
+  bool hasRun;
+} ScheduledTask;
+
+class Scheduler {
+  private:
+    ScheduledTask *_tasks;
+    size_t _count;
+
+  public:
+    Scheduler(ScheduledTask *tasks, size_t count) {
+      _tasks = tasks;
+      _count = count;
+    }
+
+    // Run every task that is due once
+    void run(unsigned long now) {
+      for (size_t i = 0; i < _count; i++) {
+        runIfDue(_tasks[i], now);
+      }
+    }
+
+    static bool runIfDue(ScheduledTask &task, unsigned long now) {
+      if (task.hasRun && now - task.lastRunMillis < task.intervalMillis) {
+        return false;
+      }
+      task.lastRunMillis = now;
+      task.hasRun = true;
+      task.callback(now);
+      return true;
+    }
+};
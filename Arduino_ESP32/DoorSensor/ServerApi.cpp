@@ -16,44 +16,45 @@
 
 #include "ServerApi.h"
 
-String ServerApi::buildUrl(ClientParams params) {
-  String buildTimestamp = __TIMESTAMP__;
-  // Convert "Wed Mar  3 00:28:41 2021" to "Wed%20Mar%20%203%2000%3A28%3A41%202021"
-  buildTimestamp.replace(" ", "%20");
-  long deviceTimestamp = millis();
-  String url = URL + String("?buildTimestamp=") + buildTimestamp + String("&deviceTimestamp=") + String(deviceTimestamp);
-  if (params.session.length() > 0) {
-    url = url + String("&session=") + params.session;
-  }
-  if (params.batteryVoltage.length() > 0) {
-    url = url + String("&batteryVoltage=") + params.batteryVoltage;
-  }
-  if (params.sensorA.length() > 0) {
-    url = url + String("&sensorA=") + params.sensorA;
-  }
-  if (params.sensorB.length() > 0) {
-    url = url + String("&sensorB=") + params.sensorB;
-  }
-  if (params.error.length() > 0) {
-    params.error.replace(" ", "%20");
-    url = url + String("&error=") + params.error;
+// "Wed Mar  3 00:28:41 2021" -> "Wed%20Mar%20%203%2000%3A28%3A41%202021", encoded by the compiler
+GARAGE_CORE_URL_ENCODED_CONSTANT(BUILD_TIMESTAMP_URL_ENCODED, __TIMESTAMP__);
+
+/**
+   Write the request URL into buff. Every parameter is percent-encoded and nothing
+   is allocated. Returns false if the URL does not fit.
+*/
+bool ServerApi::buildUrl(const ClientParams &params, char *buff, size_t buffSize) {
+  garage_core::UrlWriter url(buff, buffSize);
+  url.append(URL);
+  url.encoded_param("buildTimestamp", BUILD_TIMESTAMP_URL_ENCODED.value);
+  url.param("deviceTimestamp", (long) millis());
+  appendClientParams(url, params);
+  if (url.overflowed()) {
+    Serial->print("URL does not fit in ");
+    Serial->print(buffSize);
+    Serial->println(" bytes.");
+    return false;
   }
-  return url;
+  return true;
 }
 
-bool ServerApi::parseData(ServerResponse &data, String json) {
+/**
+   Deserialize straight from the response body. The filter keeps only the fields
+   ServerResponse needs, so the rest of the response is skipped without being stored.
+*/
+bool ServerApi::parseData(ServerResponse &data, garage_core::WiFiResponseReader &json) {
   Serial->println("ServerApi::parseData");
-  DynamicJsonDocument doc(4000);
-  Serial->println(json);
-  DeserializationError error = deserializeJson(doc, json);
+  StaticJsonDocument<64> filter;
+  filter["version"] = true;
+  filter["session"] = true;
+  StaticJsonDocument<SERVER_RESPONSE_JSON_CAPACITY> doc;
+  DeserializationError error = deserializeJson(doc, json, DeserializationOption::Filter(filter));
   if (error) {
-    Serial->println(String("deserializeJson() failed: ") + (const char *)error.c_str());
-    Serial->println(json);
-    setError(String("deserializeJson() failed: ") + error.c_str());
+    Serial->print("deserializeJson() failed: ");
+    Serial->println(error.c_str());
     return false;
   }
-  data.version = (const char*) doc["version"];
   data.code = (int) doc["version"];
-  data.session = (const char*) doc["session"];
+  snprintf(data.session, sizeof(data.session), "%s", (const char *) (doc["session"] | ""));
   return true;
 }
@@ -20,35 +20,29 @@
 #define ARDUINOJSON_USE_LONG_LONG 1
 #include <ArduinoJson.h>          //https://github.com/bblanchon/ArduinoJson
 
-typedef struct ClientParams {
-  String session;
-  String batteryVoltage;
-  String sensorA;
-  String sensorB;
-  String error;
-} ClientParams;
+#include "ClientParams.h"
+#include <GarageCore.h>
+#include <garage_core/arduino_wifi.h>
+
+#define SERVER_URL_BUFFER_SIZE 512
+#define SESSION_BUFFER_SIZE 64
+
+// Only the filtered fields are stored, so this does not grow with the response size
+#define SERVER_RESPONSE_JSON_CAPACITY 512
 
 typedef struct ServerResponse {
-  String version;
   int code;
-  String session;
+  char session[SESSION_BUFFER_SIZE]; // Empty when the server sent none
 } ServerResponse;
 
 class ServerApi {
   private:
     Stream *Serial;
-    String _error;
 
   public:
     ServerApi(Stream *serial) {
       Serial = serial;
     };
-    String buildUrl(ClientParams params);
-    bool parseData(ServerResponse &data, String json);
-    void setError(String error) {
-      _error = error;
-    }
-    String getError() {
-      return _error;
-    }
+    bool buildUrl(const ClientParams &params, char *buff, size_t buffSize);
+    bool parseData(ServerResponse &data, garage_core::WiFiResponseReader &json);
 };
@@ -1,31 +0,0 @@
-/**
-   Copyright 2021 Chris Cartland. All Rights Reserved.
-
-   Licensed under the Apache License, Version 2.0 (the "License");
-   you may not use this file except in compliance with the License.
-   You may obtain a copy of the License at
-
-       http://www.apache.org/licenses/LICENSE-2.0
-
-   Unless required by applicable law or agreed to in writing, software
-   distributed under the License is distributed on an "AS IS" BASIS,
-   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-   See the License for the specific language governing permissions and
-   limitations under the License.
-*/
-
-#pragma once
-
-#include "WiFiGet.h"
-
-// Tested with Assembled Feather HUZZAH w/ ESP8266 WiFi With Stacking Headers
-// https://www.adafruit.com/product/3213
-// https://github.com/espressif/arduino-esp32/blob/master/docs/arduino-ide/boards_manager.md
-#if USE_MULTI_WIFI
-#include <WiFiMulti.h>
-
-bool wifiMultiSetup(String wifiSSID, String wifiPassword);
-
-bool wgetWifiMulti(String &host, String &path, int port, char *buff);
-
-#endif
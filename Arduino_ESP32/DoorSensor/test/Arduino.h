@@ -0,0 +1,76 @@
+// Just enough of Arduino.h for the sketch headers under test on the host
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+   Like the Arduino String, every value it holds is a heap allocation, made here with
+   new[] so the allocation tests count it.
+*/
+class String {
+  public:
+    String(const char *value = "") {
+      assign(value);
+    }
+    String(long value) {
+      char digits[21];
+      snprintf(digits, sizeof(digits), "%ld", value);
+      assign(digits);
+    }
+    String(const String &other) {
+      assign(other._buffer);
+    }
+    String &operator=(const String &other) {
+      if (this != &other) {
+        delete[] _buffer;
+        assign(other._buffer);
+      }
+      return *this;
+    }
+    ~String() {
+      delete[] _buffer;
+    }
+    const char *c_str() const {
+      return _buffer;
+    }
+    size_t length() const {
+      return strlen(_buffer);
+    }
+
+  private:
+    char *_buffer;
+
+    void assign(const char *value) {
+      _buffer = new char[strlen(value) + 1];
+      strcpy(_buffer, value);
+    }
+};
+
+#define HIGH 1
+#define LOW 0
+
+// Pin levels digitalRead() returns, set by the tests
+inline int *fakePinLevels() {
+  static int levels[40];
+  return levels;
+}
+
+inline int digitalRead(int pin) {
+  return fakePinLevels()[pin];
+}
+
+// Drops everything, like a Serial nobody reads
+class Stream {
+  public:
+    template <class T>
+    size_t print(const T &) {
+      return 0;
+    }
+    template <class T>
+    size_t println(const T &) {
+      return 0;
+    }
+};
@@ -0,0 +1,81 @@
+#include <assert.h>
+#include <stdio.h>
+
+#include "BoundedQueue.h"
+
+static void testDropsOldestWhenFull() {
+  BoundedQueue<int, 3> queue;
+  for (int i = 1; i <= 4; i++) {
+    queue.push(i);
+  }
+  assert(queue.size() == 3);
+  assert(queue.front() == 2);
+  assert(queue.takeDropped() == 1);
+  assert(queue.takeDropped() == 0);
+}
+
+// A report in flight stays at the front while sampling overflows the queue,
+// so the pop() when the request succeeds removes the report that was sent.
+static void testOverflowWhileInFlight() {
+  BoundedQueue<int, 3> queue;
+  queue.push(1);
+  queue.push(2);
+  queue.push(3);
+  queue.holdFront(); // Request for 1 starts
+  queue.push(4);
+  queue.push(5);
+  assert(queue.size() == 3);
+  assert(queue.front() == 1);
+  assert(queue.takeDropped() == 2);
+  queue.pop(); // Request for 1 succeeded
+  assert(queue.front() == 4);
+  queue.pop();
+  assert(queue.front() == 5);
+  queue.pop();
+  assert(queue.empty());
+}
+
+static void testReleaseAfterFailure() {
+  BoundedQueue<int, 2> queue;
+  queue.push(1);
+  queue.push(2);
+  queue.holdFront();
+  queue.releaseFront(); // Request for 1 failed, it waits for the retry like the others
+  queue.push(3);
+  assert(queue.front() == 2);
+  queue.holdFront();
+  queue.pop();
+  queue.push(4);
+  queue.push(5); // Nothing held anymore, the oldest goes
+  assert(queue.front() == 4);
+}
+
+static void testSingleSlotInFlight() {
+  BoundedQueue<int, 1> queue;
+  queue.push(1);
+  queue.holdFront();
+  queue.push(2);
+  assert(queue.front() == 1);
+  assert(queue.takeDropped() == 1);
+  queue.pop();
+  assert(queue.empty());
+}
+
+static void testHoldOnEmptyQueue() {
+  BoundedQueue<int, 2> queue;
+  queue.holdFront();
+  queue.push(1);
+  queue.push(2);
+  queue.push(3);
+  assert(queue.front() == 2);
+}
+
+int main() {
+  testDropsOldestWhenFull();
+  testOverflowWhileInFlight();
+  testReleaseAfterFailure();
+  testSingleSlotInFlight();
+  testHoldOnEmptyQueue();
+  printf("BoundedQueue tests passed\n");
+  return 0;
+}
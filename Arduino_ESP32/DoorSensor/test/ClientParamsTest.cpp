@@ -0,0 +1,97 @@
+#include <assert.h>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Arduino.h"
+#include "ClientParams.h"
+
+// Every operator new, which the String stub and any container go through
+static size_t allocations = 0;
+
+void *operator new(size_t size) {
+  allocations++;
+  void *p = malloc(size);
+  if (p == NULL) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept {
+  free(p);
+}
+
+static const char *BASE_URL = "https://example.com/echo?buildTimestamp=b";
+
+static void buildUrl(const ClientParams &params, char *url, size_t urlSize) {
+  garage_core::UrlWriter writer(url, urlSize);
+  writer.append(BASE_URL);
+  appendClientParams(writer, params);
+  assert(!writer.overflowed());
+}
+
+// The largest request runNetwork() sends: a sensor report with everything pending
+static void testFullRequestDoesNotAllocate() {
+  char session[64] = "5a6f3c1e-3b1c-4b5e-9d1a-2f7c9e8b4a10";
+  char pendingError[96] = "Server unreachable for 1800 seconds";
+  char url[512];
+  size_t before = allocations;
+
+  ClientParams params;
+  params.session = session;
+  params.batteryVoltage = 4.126f;
+  params.error = pendingError;
+  params.sensorA = 1;
+  params.sensorB = 0;
+  params.eventAgeMillis = 1234567L;
+  params.droppedReports = 3;
+  params.rebootCount = 12;
+  params.outageMillis = 1800000L;
+  params.awakeMillis = 250;
+  buildUrl(params, url, sizeof(url));
+
+  assert(allocations == before);
+  assert(strcmp(url, "https://example.com/echo?buildTimestamp=b"
+                     "&session=5a6f3c1e-3b1c-4b5e-9d1a-2f7c9e8b4a10&batteryVoltage=4.13&sensorA=1&sensorB=0"
+                     "&eventAgeMillis=1234567&awakeMillis=250&rebootCount=12&outageMillis=1800000"
+                     "&droppedReports=3&error=Server%20unreachable%20for%201800%20seconds") == 0);
+}
+
+static void testUnsetParamsAreLeftOut() {
+  char url[512];
+  ClientParams params;
+  params.sensorB = 1;
+  buildUrl(params, url, sizeof(url));
+  assert(strcmp(url, "https://example.com/echo?buildTimestamp=b&sensorB=1") == 0);
+}
+
+// The same two decimals String(float) printed
+static void testBatteryVoltageFormat() {
+  char url[512];
+  ClientParams params;
+  params.batteryVoltage = 0.0f;
+  buildUrl(params, url, sizeof(url));
+  assert(strcmp(url, "https://example.com/echo?buildTimestamp=b&batteryVoltage=0.00") == 0);
+  params.batteryVoltage = 3.999f;
+  buildUrl(params, url, sizeof(url));
+  assert(strcmp(url, "https://example.com/echo?buildTimestamp=b&batteryVoltage=4.00") == 0);
+}
+
+// The counter sees the String params the request used to build
+static void testCountsStringAllocations() {
+  size_t before = allocations;
+  String batteryVoltage("4.13");
+  String sensorA(1L);
+  assert(allocations == before + 2);
+}
+
+int main() {
+  testFullRequestDoesNotAllocate();
+  testUnsetParamsAreLeftOut();
+  testBatteryVoltageFormat();
+  testCountsStringAllocations();
+  printf("ClientParams tests passed\n");
+  return 0;
+}
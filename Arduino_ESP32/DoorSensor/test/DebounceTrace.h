@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Arduino.h"
+
+#define TRACE_PIN_A 14
+#define TRACE_PIN_B 32
+#define TRACE_DEBOUNCE_MILLIS 50
+
+/**
+   Both door sensors sampled once a millisecond. Each sensor changes level every few
+   seconds, bounces for up to 40 ms around the change, and sometimes glitches for a
+   sample or two in between. The same seed gives the same trace.
+*/
+class DebounceTrace {
+  public:
+    explicit DebounceTrace(uint32_t seed) : random(seed), now(0), levelA(HIGH), levelB(LOW), bounceA(0), bounceB(0) {}
+
+    // Set the pins for the next sample and return its time
+    unsigned long next() {
+      now++;
+      fakePinLevels()[TRACE_PIN_A] = step(levelA, bounceA);
+      fakePinLevels()[TRACE_PIN_B] = step(levelB, bounceB);
+      return now;
+    }
+
+  private:
+    uint32_t random;
+    unsigned long now;
+    int levelA;
+    int levelB;
+    int bounceA;
+    int bounceB;
+
+    uint32_t nextRandom() {
+      random = random * 1664525u + 1013904223u;
+      return random >> 8;
+    }
+
+    int step(int &level, int &bounce) {
+      uint32_t roll = nextRandom() % 4000;
+      if (roll == 0) {
+        level = level == HIGH ? LOW : HIGH;
+        bounce = 1 + nextRandom() % 40;
+      } else if (roll < 3 && bounce == 0) {
+        bounce = 1 + roll; // A glitch
+      }
+      if (bounce > 0) {
+        bounce--;
+        return (nextRandom() & 1) ? HIGH : LOW;
+      }
+      return level;
+    }
+};
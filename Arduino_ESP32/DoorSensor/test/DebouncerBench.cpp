@@ -0,0 +1,68 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <vector>
+
+#include "Arduino.h"
+#include "DebounceTrace.h"
+#include "Debouncer.h"
+#include "LegacyDebouncer.h"
+
+// Keeps results alive so the optimizer can't drop the loops
+static volatile uint32_t sink;
+
+static Stream discard;
+
+typedef struct Sample {
+  uint8_t levelA;
+  uint8_t levelB;
+} Sample;
+
+/**
+   Times one update of both pins over a recorded trace. The legacy class logs each change
+   to a Stream that drops it, so its numbers leave out the cost of printing.
+*/
+template <class Update>
+static uint32_t bench(const char *name, const std::vector<Sample> &samples, Update update) {
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  uint32_t changes = 0;
+  for (size_t i = 0; i < samples.size(); i++) {
+    fakePinLevels()[TRACE_PIN_A] = samples[i].levelA;
+    fakePinLevels()[TRACE_PIN_B] = samples[i].levelB;
+    changes += update((unsigned long)i + 1);
+  }
+  double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  sink = changes;
+  printf("%-28s %8.2f ns/update\n", name, elapsed / samples.size());
+  return changes;
+}
+
+int main(int argc, char **argv) {
+  long samples = argc > 1 ? atol(argv[1]) : 10000000;
+  DebounceTrace trace(1);
+  std::vector<Sample> recorded((size_t)samples);
+  for (long i = 0; i < samples; i++) {
+    trace.next();
+    recorded[i].levelA = (uint8_t)fakePinLevels()[TRACE_PIN_A];
+    recorded[i].levelB = (uint8_t)fakePinLevels()[TRACE_PIN_B];
+  }
+
+  Debouncer<TRACE_PIN_A, TRACE_PIN_B> debouncer(TRACE_DEBOUNCE_MILLIS);
+  uint32_t changes = bench("Debouncer<Pins...>", recorded, [&](unsigned long now) {
+    uint32_t changed = debouncer.debounceUpdate(now);
+    return (uint32_t)((changed & 1) + (changed >> 1));
+  });
+  LegacyDebouncer legacy(&discard, TRACE_DEBOUNCE_MILLIS);
+  uint32_t legacyChanges = bench("LegacyDebouncer", recorded, [&](unsigned long now) {
+    uint32_t a = legacy.debounceUpdate(TRACE_PIN_A, now);
+    uint32_t b = legacy.debounceUpdate(TRACE_PIN_B, now);
+    return a + b;
+  });
+  // Same trace, same changes
+  assert(changes == legacyChanges);
+  printf("%-28s %8u\n", "Changes", (unsigned)changes);
+  return 0;
+}
@@ -0,0 +1,84 @@
+#include <assert.h>
+#include <stdio.h>
+
+#include "Arduino.h"
+#include "DebounceTrace.h"
+#include "Debouncer.h"
+#include "LegacyDebouncer.h"
+
+typedef Debouncer<TRACE_PIN_A, TRACE_PIN_B> PinDebouncer;
+
+static Stream discard;
+
+// The old class returned one flag per pin. Packed the way debounceUpdate() packs them.
+static uint32_t legacyChangedMask(LegacyDebouncer &legacy, unsigned long now) {
+  uint32_t changed = 0;
+  if (legacy.debounceUpdate(TRACE_PIN_A, now)) {
+    changed |= PinDebouncer::pinMask(TRACE_PIN_A);
+  }
+  if (legacy.debounceUpdate(TRACE_PIN_B, now)) {
+    changed |= PinDebouncer::pinMask(TRACE_PIN_B);
+  }
+  return changed;
+}
+
+// Runs both over the same trace. Returns how many changes they reported.
+static int compareOnTrace(PinDebouncer &debouncer, LegacyDebouncer &legacy, uint32_t seed, int samples) {
+  DebounceTrace trace(seed);
+  int changes = 0;
+  for (int i = 0; i < samples; i++) {
+    unsigned long now = trace.next();
+    uint32_t changed = debouncer.debounceUpdate(now);
+    assert(changed == legacyChangedMask(legacy, now));
+    assert(debouncer.debounceGet(TRACE_PIN_A) == legacy.debounceGet(TRACE_PIN_A));
+    assert(debouncer.debounceGet(TRACE_PIN_B) == legacy.debounceGet(TRACE_PIN_B));
+    if (changed & PinDebouncer::pinMask(TRACE_PIN_A)) {
+      changes++;
+    }
+    if (changed & PinDebouncer::pinMask(TRACE_PIN_B)) {
+      changes++;
+    }
+  }
+  return changes;
+}
+
+static void testSameChangedMaskAsLegacy() {
+  for (uint32_t seed = 1; seed <= 5; seed++) {
+    PinDebouncer debouncer(TRACE_DEBOUNCE_MILLIS);
+    LegacyDebouncer legacy(&discard, TRACE_DEBOUNCE_MILLIS);
+    // Changes every few seconds, so a long trace sees plenty of them
+    assert(compareOnTrace(debouncer, legacy, seed, 600000) > 100);
+  }
+}
+
+// Waking from deep sleep seeds the debouncer, with a level or with DEBOUNCER_INVALID
+static void testRestoreMatchesLegacy() {
+  const int restored[][2] = {{HIGH, LOW}, {LOW, HIGH}, {DEBOUNCER_INVALID, HIGH}, {DEBOUNCER_INVALID, DEBOUNCER_INVALID}};
+  for (size_t i = 0; i < sizeof(restored) / sizeof(restored[0]); i++) {
+    PinDebouncer debouncer(TRACE_DEBOUNCE_MILLIS);
+    LegacyDebouncer legacy(&discard, TRACE_DEBOUNCE_MILLIS);
+    debouncer.debounceRestore(TRACE_PIN_A, restored[i][0], 0);
+    debouncer.debounceRestore(TRACE_PIN_B, restored[i][1], 0);
+    legacy.debounceRestore(TRACE_PIN_A, restored[i][0], 0);
+    legacy.debounceRestore(TRACE_PIN_B, restored[i][1], 0);
+    assert(debouncer.debounceGet(TRACE_PIN_A) == legacy.debounceGet(TRACE_PIN_A));
+    assert(debouncer.debounceGet(TRACE_PIN_B) == legacy.debounceGet(TRACE_PIN_B));
+    compareOnTrace(debouncer, legacy, 100 + i, 60000);
+  }
+}
+
+static void testUnknownPin() {
+  PinDebouncer debouncer(TRACE_DEBOUNCE_MILLIS);
+  assert(PinDebouncer::pinMask(7) == 0);
+  assert(debouncer.debounceGet(7) == DEBOUNCER_INVALID);
+  debouncer.debounceRestore(7, HIGH, 0);
+  assert(debouncer.debounceGet(TRACE_PIN_A) == DEBOUNCER_INVALID);
+}
+
+int main() {
+  testSameChangedMaskAsLegacy();
+  testRestoreMatchesLegacy();
+  testUnknownPin();
+  printf("Debouncer tests passed\n");
+  return 0;
+}
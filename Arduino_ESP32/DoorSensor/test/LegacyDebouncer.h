@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Arduino.h"
+
+/**
+   The Debouncer the sketch used before Debouncer<Pins...>, kept to check the new one
+   against and to time both. Unchanged except for the name, the inlined methods, and
+   room for pin 32: the original arrays had 32 entries, so SENSOR_PIN_B wrote past them.
+*/
+#define LEGACY_DEBOUNCER_MAX_PIN_COUNT 40
+#define LEGACY_DEBOUNCER_INVALID -1
+
+class LegacyDebouncer {
+  private:
+    Stream *Serial;
+    String _error;
+    unsigned long debounceDuration;
+    int state[LEGACY_DEBOUNCER_MAX_PIN_COUNT];
+    int lastRead[LEGACY_DEBOUNCER_MAX_PIN_COUNT];
+    unsigned long debounceTime[LEGACY_DEBOUNCER_MAX_PIN_COUNT];
+
+  public:
+    LegacyDebouncer(Stream *serial, unsigned long duration) {
+      Serial = serial;
+      debounceDuration = duration;
+      for (int i = 0; i < LEGACY_DEBOUNCER_MAX_PIN_COUNT; i++) {
+        state[i] = LEGACY_DEBOUNCER_INVALID;
+        lastRead[i] = LEGACY_DEBOUNCER_INVALID;
+        debounceTime[i] = 0;
+      }
+    };
+
+    bool debounceUpdate(int pin, unsigned long currentTime) {
+      bool changed = false;
+      int newRead = digitalRead(pin);
+      if (newRead != lastRead[pin]) {
+        debounceTime[pin] = currentTime;
+      }
+      if (currentTime - debounceTime[pin] > debounceDuration) {
+        if (state[pin] != newRead) {
+          Serial->print(currentTime);
+          Serial->print(": ");
+          Serial->print("Debounced pin: ");
+          Serial->print(pin);
+          Serial->print(", value: ");
+          Serial->println(newRead);
+          changed = true;
+        }
+        state[pin] = newRead;
+      }
+      lastRead[pin] = newRead;
+      return changed;
+    }
+
+    int debounceGet(int pin) {
+      return state[pin];
+    }
+
+    void debounceRestore(int pin, int value, unsigned long currentTime) {
+      state[pin] = value;
+      lastRead[pin] = value;
+      debounceTime[pin] = currentTime;
+    }
+};
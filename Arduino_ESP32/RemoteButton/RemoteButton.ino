@@ -15,9 +15,9 @@
 */
 
 #include "secrets.h"
-#include "BlinkMorseCode.h"
-#include "WiFiGet.h"
 #include "ServerApi.h"
+#include <GarageCore.h>
+#include <garage_core/arduino_wifi.h>
 
 #if USE_ADAFRUIT_HUZZAH32_ESP32_FEATHER
 // Use A13 on Adafruit HUZZAH32 - ESP32 Feather.
@@ -29,28 +29,62 @@
 
 ServerApi serverApi(&Serial);
 ServerResponse serverdata;
+garage_core::WiFiRequest serverRequest;
 String session = "";
 String buttonAckToken = "NO_BUTTON_ACK_TOKEN";
 unsigned long HEARTBEAT_INTERVAL = 1000 * 5; // 5 seconds.
-unsigned long PUSH_REMOTE_BUTTON_DURATION_MILLIS = 500;
+unsigned long PUSH_REMOTE_BUTTON_DURATION_MICROS = 500000; // 500 ms.
+unsigned long lastPingTime = 0;
 
-void pushRemoteButton(unsigned long durationMillis) {
+bool remoteButtonPressed = false;
+unsigned long remoteButtonPressMicros = 0;
+unsigned long remoteButtonDurationMicros = 0;
+
+// Press the remote button without waiting. updateRemoteButton() releases it.
+bool pushRemoteButton(unsigned long durationMicros) {
+  if (remoteButtonPressed) {
+    Serial.println("Remote button is already pressed.");
+    return false;
+  }
+  remoteButtonPressed = true;
+  remoteButtonDurationMicros = durationMicros;
+  remoteButtonPressMicros = micros();
   digitalWrite(REMOTE_BUTTON_PIN, HIGH);
-  delay(durationMillis);
+  return true;
+}
+
+// Release the remote button once the pulse is over. Call on every loop().
+void updateRemoteButton() {
+  if (!remoteButtonPressed) {
+    return;
+  }
+  unsigned long elapsedMicros = micros() - remoteButtonPressMicros;
+  if (elapsedMicros < remoteButtonDurationMicros) {
+    return;
+  }
   digitalWrite(REMOTE_BUTTON_PIN, LOW);
+  remoteButtonPressed = false;
+  Serial.print("Released remote button after ");
+  Serial.print(elapsedMicros);
+  Serial.println(" us.");
+}
+
+bool parseServerResponse(garage_core::WiFiResponseReader &response, void *context) {
+  return serverApi.parseData(*(ServerResponse *)context, response);
 }
 
 bool pingServer(ClientParams params) {
   digitalWrite(LED_BUILTIN, HIGH); // Blink a little while contacting the server.
-  String url = serverApi.buildUrl(params);
+  char url[SERVER_URL_BUFFER_SIZE];
+  if (!serverApi.buildUrl(params, url, sizeof(url))) {
+    digitalWrite(LED_BUILTIN, LOW);
+    return false;
+  }
   Serial.print("Request URL: ");
   Serial.println(url);
   const uint16_t port = WIFI_PORT;
-  char buf[4000];
-  wget(url, port, buf);
-  String json = buf;
-  Serial.println(json);
-  bool success = serverApi.parseData(serverdata, json);
+  bool success = serverRequest.get(url, port, parseServerResponse, &serverdata);
+  garage_core::print_wget_result(Serial, serverRequest);
   if (!success) {
     digitalWrite(LED_BUILTIN, LOW);
     return false;
@@ -72,9 +106,9 @@ bool pingServer(ClientParams params) {
     Serial.print("Received buttonAckToken: ");
     Serial.println(newButtonAckToken);
   }
-  if (newButtonAckToken.length() > 0 && newButtonAckToken != buttonAckToken) {
+  if (garage_core::is_button_press_requested(buttonAckToken.c_str(), newButtonAckToken.c_str())) {
     Serial.println("PUSHING BUTTON");
-    pushRemoteButton(PUSH_REMOTE_BUTTON_DURATION_MILLIS);
+    pushRemoteButton(PUSH_REMOTE_BUTTON_DURATION_MICROS);
   }
   buttonAckToken = newButtonAckToken;
   digitalWrite(LED_BUILTIN, LOW);
@@ -87,10 +121,10 @@ void setup() {
   Serial.println(""); // First line is usually lost. Print empty line.
   pinMode(REMOTE_BUTTON_PIN, OUTPUT);
   pinMode(LED_BUILTIN, OUTPUT);
-  blinkOK(LED_BUILTIN);
+  garage_core::blink_ok<garage_core::ArduinoPlatform>(LED_BUILTIN);
   Serial.println("==========");
   Serial.println(String(__TIMESTAMP__));
-  bool success = wifiSetup(WIFI_SSID, WIFI_PASSWORD);
+  bool success = garage_core::wifi_setup(WIFI_SSID, WIFI_PASSWORD);
   if (success) {
     Serial.println("Successfully connected to WiFi.");
   } else {
@@ -99,12 +133,15 @@ void setup() {
 }
 
 void loop() {
-  unsigned long currentTime = millis();
+  updateRemoteButton();
 
-  // Press remote button for 500 ms every 10 seconds.
-  ClientParams params;
-  params.session = session;
-  params.buttonAckToken = buttonAckToken;
-  pingServer(params);
-  delay(HEARTBEAT_INTERVAL);
+  // Ping the server HEARTBEAT_INTERVAL after the previous ping finished.
+  unsigned long currentTime = millis();
+  if (currentTime - lastPingTime >= HEARTBEAT_INTERVAL || lastPingTime == 0) {
+    ClientParams params;
+    params.session = session;
+    params.buttonAckToken = buttonAckToken;
+    pingServer(params);
+    lastPingTime = millis();
+  }
 }
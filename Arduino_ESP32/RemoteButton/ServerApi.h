@@ -20,6 +20,14 @@
 #define ARDUINOJSON_USE_LONG_LONG 1
 #include <ArduinoJson.h>          //https://github.com/bblanchon/ArduinoJson
 
+#include <GarageCore.h>
+#include <garage_core/arduino_wifi.h>
+
+#define SERVER_URL_BUFFER_SIZE 512
+
+// Only the filtered fields are stored, so this does not grow with the response size
+#define SERVER_RESPONSE_JSON_CAPACITY 512
+
 typedef struct ClientParams {
   String session;
   String buttonAckToken;
@@ -42,8 +50,8 @@ class ServerApi {
     ServerApi(Stream *serial) {
       Serial = serial;
     };
-    String buildUrl(ClientParams params);
-    bool parseData(ServerResponse &data, String json);
+    bool buildUrl(ClientParams &params, char *buff, size_t buffSize);
+    bool parseData(ServerResponse &data, garage_core::WiFiResponseReader &json);
     void setError(String error) {
       _error = error;
     }
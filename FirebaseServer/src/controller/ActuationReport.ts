@@ -0,0 +1,51 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * Whether the door moved after the ESP32 pushed the button. Pure: reads the
+ * fields the firmware adds to a button poll body.
+ *
+ * After each press from a closed or open door, the firmware watches its
+ * debounced sensors and polls right away with the result: the door started
+ * moving `latencyMillis` after the press, or did not move within
+ * `latencyMillis`. `attempts` is 2 when the firmware pressed once more after a
+ * miss. Presses from a door stopped between the sensors are not reported.
+ */
+
+export type ActuationResult = 'MOTION' | 'NO_MOTION';
+
+export interface ActuationReport {
+  result: ActuationResult;
+  latencyMillis: number;
+  attempts: number;
+}
+
+/** actuation_result_t in the firmware's garage_http_client.h. */
+const RESULT_CODES: { [code: number]: ActuationResult } = {
+  1: 'MOTION',
+  2: 'NO_MOTION',
+};
+
+/**
+ * The report in a button poll body, or null when the poll carries none.
+ * Malformed fields are treated as no report, never as a failed poll.
+ */
+export function parseActuationReport(body: any): ActuationReport | null {
+  const code = body?.actuation_result;
+  const result = typeof code === 'number' ? RESULT_CODES[code] : undefined;
+  const latencyMillis = body?.actuation_latency_ms;
+  const attempts = body?.actuation_attempts;
+  if (!result
+    || !Number.isSafeInteger(latencyMillis) || latencyMillis < 0
+    || !Number.isSafeInteger(attempts) || attempts < 1) {
+    return null;
+  }
+  return { result, latencyMillis, attempts };
+}
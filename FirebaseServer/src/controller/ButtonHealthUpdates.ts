@@ -40,7 +40,8 @@ export async function handleButtonHealthFromPollWrite(buildTimestamp: string): P
     console.warn('handleButtonHealthFromPollWrite: missing buildTimestamp; no-op');
     return;
   }
-  const config = await ServerConfigDatabase.get();
+  // Runs after every saved device poll, like the poll itself
+  const config = await ServerConfigDatabase.getCached();
   if (!isRemoteButtonEnabled(config)) {
     console.log('handleButtonHealthFromPollWrite: button feature disabled; no-op');
     return;
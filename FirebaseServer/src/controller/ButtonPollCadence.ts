@@ -0,0 +1,58 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * How often the ESP32 should poll for button commands. Pure: the caller reads
+ * the activity times.
+ *
+ * A fixed 5 s poll is too slow while someone is about to press the button and
+ * wasted the rest of the day. Activity is the app opening (a button health
+ * fetch) or a command being sent or cleared. Right after activity the device
+ * polls every second, then at the old 5 s period for a while, then idles.
+ */
+
+export const ACTIVE_POLL_SECONDS = 1;
+export const RECENT_POLL_SECONDS = 5;
+/**
+ * Button health reads the last saved poll, and the poll log saves an idle
+ * poll only once POLL_LOG_MIN_PERIOD_SECONDS have passed. Every idle poll
+ * clears that period even when it arrives a few seconds early, so saves are
+ * one idle period apart, and two after a lost poll. That still fits in
+ * ButtonHealthInterpreter's ONLINE_THRESHOLD_SEC with time to spare, so one
+ * lost poll does not flap an idle device to OFFLINE.
+ */
+export const IDLE_POLL_SECONDS = 20;
+
+/** How long after activity the device polls every ACTIVE_POLL_SECONDS. */
+export const ACTIVE_WINDOW_SECONDS = 5 * 60;
+/** How long after activity the device polls every RECENT_POLL_SECONDS. */
+export const RECENT_WINDOW_SECONDS = 30 * 60;
+
+/**
+ * Seconds until the next poll, from the latest of the activity times.
+ * Missing times are ignored. With none at all the device idles.
+ */
+export function nextPollSeconds(
+  nowSeconds: number,
+  activitySeconds: Array<number | null | undefined>,
+): number {
+  const known = activitySeconds.filter((seconds): seconds is number => typeof seconds === 'number');
+  if (known.length === 0) {
+    return IDLE_POLL_SECONDS;
+  }
+  const sinceActivity = nowSeconds - Math.max(...known);
+  if (sinceActivity < ACTIVE_WINDOW_SECONDS) {
+    return ACTIVE_POLL_SECONDS;
+  }
+  if (sinceActivity < RECENT_WINDOW_SECONDS) {
+    return RECENT_POLL_SECONDS;
+  }
+  return IDLE_POLL_SECONDS;
+}
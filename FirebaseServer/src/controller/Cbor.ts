@@ -0,0 +1,205 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * The subset of CBOR (RFC 8949) that devices speak: integers, strings, byte
+ * strings, booleans, null, arrays and maps, all with definite lengths. Pure,
+ * no Firestore.
+ *
+ * Maps decode to a `Map`, because device maps use integer keys. Anything
+ * outside the subset (floats, tags, indefinite lengths, integers past 2^53,
+ * trailing bytes) throws a CborError instead of guessing.
+ */
+
+export type CborValue = number | string | boolean | null | Uint8Array | CborValue[] | Map<CborValue, CborValue>;
+
+export class CborError extends Error {}
+
+/** Nesting limit. Device messages are one flat map. */
+export const MAX_CBOR_DEPTH = 8;
+
+const MAJOR_UNSIGNED = 0;
+const MAJOR_NEGATIVE = 1;
+const MAJOR_BYTES = 2;
+const MAJOR_TEXT = 3;
+const MAJOR_ARRAY = 4;
+const MAJOR_MAP = 5;
+const MAJOR_SIMPLE = 7;
+
+const SIMPLE_FALSE = 20;
+const SIMPLE_TRUE = 21;
+const SIMPLE_NULL = 22;
+
+/** Bytes that follow the initial byte, by its additional info. */
+const ARGUMENT_SIZES: { [info: number]: number } = { 24: 1, 25: 2, 26: 4, 27: 8 };
+
+export function encodeCbor(value: CborValue): Buffer {
+  const chunks: Buffer[] = [];
+  encodeValue(value, chunks, 0);
+  return Buffer.concat(chunks);
+}
+
+export function decodeCbor(bytes: Uint8Array): CborValue {
+  const reader = { bytes: bytes, offset: 0 };
+  const value = decodeValue(reader, 0);
+  if (reader.offset !== bytes.length) {
+    throw new CborError(`${bytes.length - reader.offset} trailing bytes`);
+  }
+  return value;
+}
+
+/** The shortest head for the argument, as the preferred serialization requires. */
+function encodeHead(major: number, argument: number, chunks: Buffer[]) {
+  if (!Number.isSafeInteger(argument) || argument < 0) {
+    throw new CborError(`Cannot encode ${argument}`);
+  }
+  const type = major << 5;
+  let head: Buffer;
+  if (argument < 24) {
+    head = Buffer.from([type | argument]);
+  } else if (argument <= 0xff) {
+    head = Buffer.from([type | 24, argument]);
+  } else if (argument <= 0xffff) {
+    head = Buffer.alloc(3);
+    head[0] = type | 25;
+    head.writeUInt16BE(argument, 1);
+  } else if (argument <= 0xffffffff) {
+    head = Buffer.alloc(5);
+    head[0] = type | 26;
+    head.writeUInt32BE(argument, 1);
+  } else {
+    head = Buffer.alloc(9);
+    head[0] = type | 27;
+    head.writeBigUInt64BE(BigInt(argument), 1);
+  }
+  chunks.push(head);
+}
+
+function encodeValue(value: CborValue, chunks: Buffer[], depth: number) {
+  if (depth > MAX_CBOR_DEPTH) {
+    throw new CborError('Nested too deep');
+  }
+  if (value === null) {
+    chunks.push(Buffer.from([(MAJOR_SIMPLE << 5) | SIMPLE_NULL]));
+  } else if (typeof value === 'boolean') {
+    chunks.push(Buffer.from([(MAJOR_SIMPLE << 5) | (value ? SIMPLE_TRUE : SIMPLE_FALSE)]));
+  } else if (typeof value === 'number') {
+    if (value >= 0) {
+      encodeHead(MAJOR_UNSIGNED, value, chunks);
+    } else {
+      encodeHead(MAJOR_NEGATIVE, -1 - value, chunks);
+    }
+  } else if (typeof value === 'string') {
+    const text = Buffer.from(value, 'utf8');
+    encodeHead(MAJOR_TEXT, text.length, chunks);
+    chunks.push(text);
+  } else if (value instanceof Uint8Array) {
+    encodeHead(MAJOR_BYTES, value.length, chunks);
+    chunks.push(Buffer.from(value));
+  } else if (Array.isArray(value)) {
+    encodeHead(MAJOR_ARRAY, value.length, chunks);
+    for (const item of value) {
+      encodeValue(item, chunks, depth + 1);
+    }
+  } else if (value instanceof Map) {
+    encodeHead(MAJOR_MAP, value.size, chunks);
+    for (const [key, item] of value) {
+      encodeValue(key, chunks, depth + 1);
+      encodeValue(item, chunks, depth + 1);
+    }
+  } else {
+    throw new CborError(`Cannot encode ${typeof value}`);
+  }
+}
+
+interface Reader {
+  bytes: Uint8Array;
+  offset: number;
+}
+
+function take(reader: Reader, length: number): Uint8Array {
+  if (length > reader.bytes.length - reader.offset) {
+    throw new CborError('Truncated');
+  }
+  const slice = reader.bytes.subarray(reader.offset, reader.offset + length);
+  reader.offset += length;
+  return slice;
+}
+
+function readArgument(reader: Reader, info: number): number {
+  if (info < 24) {
+    return info;
+  }
+  const size = ARGUMENT_SIZES[info];
+  if (size === undefined) {
+    // 28-30 are reserved, 31 is an indefinite length
+    throw new CborError(`Unsupported additional info ${info}`);
+  }
+  const view = Buffer.from(take(reader, size));
+  if (size === 8) {
+    const argument = view.readBigUInt64BE(0);
+    if (argument > BigInt(Number.MAX_SAFE_INTEGER)) {
+      throw new CborError('Integer too large');
+    }
+    return Number(argument);
+  }
+  return view.readUIntBE(0, size);
+}
+
+function decodeValue(reader: Reader, depth: number): CborValue {
+  if (depth > MAX_CBOR_DEPTH) {
+    throw new CborError('Nested too deep');
+  }
+  const initial = take(reader, 1)[0];
+  const major = initial >> 5;
+  const info = initial & 0x1f;
+  if (major === MAJOR_SIMPLE) {
+    switch (info) {
+      case SIMPLE_FALSE: return false;
+      case SIMPLE_TRUE: return true;
+      case SIMPLE_NULL: return null;
+      default: throw new CborError(`Unsupported simple value ${info}`);
+    }
+  }
+  const argument = readArgument(reader, info);
+  switch (major) {
+    case MAJOR_UNSIGNED:
+      return argument;
+    case MAJOR_NEGATIVE:
+      return -1 - argument;
+    case MAJOR_BYTES:
+      return Uint8Array.from(take(reader, argument));
+    case MAJOR_TEXT:
+      return Buffer.from(take(reader, argument)).toString('utf8');
+    case MAJOR_ARRAY: {
+      const items: CborValue[] = [];
+      for (let i = 0; i < argument; i++) {
+        items.push(decodeValue(reader, depth + 1));
+      }
+      return items;
+    }
+    case MAJOR_MAP: {
+      const map = new Map<CborValue, CborValue>();
+      for (let i = 0; i < argument; i++) {
+        const key = decodeValue(reader, depth + 1);
+        map.set(key, decodeValue(reader, depth + 1));
+      }
+      return map;
+    }
+    default:
+      throw new CborError(`Unsupported major type ${major}`);
+  }
+}
@@ -0,0 +1,73 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * When a sensor event happened, as told by the device. Pure: the arrival time
+ * is a parameter, so the bounds are unit-testable.
+ *
+ * The server used to date every event by when its upload arrived, which folds
+ * network latency and the device's retry queue into the event time. A door
+ * that closed during an outage would read as closing whenever the device got
+ * back online. Devices now send one or both of:
+ *
+ *  - `eventTimestampMillis`  Unix time of the capture, from an SNTP-synced
+ *                            clock (ESP-IDF firmware)
+ *  - `eventAgeMillis`        time between the capture and the upload, from a
+ *                            monotonic clock (every device, synced or not)
+ *
+ * The wall clock wins when it is plausible. The age is the fallback, because
+ * it needs no clock sync but still carries the network latency. Anything out of
+ * bounds is ignored and the caller keeps the arrival time.
+ */
+
+export const EVENT_TIMESTAMP_MILLIS_PARAM_KEY = 'eventTimestampMillis';
+export const EVENT_AGE_MILLIS_PARAM_KEY = 'eventAgeMillis';
+
+/** Older events are not believed. Longer than any retry queue holds a report. */
+export const MAX_EVENT_AGE_SECONDS = 24 * 60 * 60;
+/** How far a device clock may run ahead before its timestamp is ignored. */
+export const MAX_CLOCK_AHEAD_SECONDS = 60;
+
+/** A non-negative integer query parameter, or null. Query values arrive as strings. */
+function parseMillis(raw: unknown): number | null {
+  if (typeof raw === 'string') {
+    if (!/^\d+$/.test(raw)) return null;
+  } else if (typeof raw !== 'number') {
+    return null;
+  }
+  const value = Number(raw);
+  return Number.isSafeInteger(value) && value >= 0 ? value : null;
+}
+
+/**
+ * Returns the event time in seconds, never later than `arrivalSeconds`, or
+ * null if the device did not send a usable time.
+ */
+export function deviceEventTimestampSeconds(queryParams: any, arrivalSeconds: number): number | null {
+  if (!queryParams) return null;
+  const epochMillis = parseMillis(queryParams[EVENT_TIMESTAMP_MILLIS_PARAM_KEY]);
+  if (epochMillis !== null) {
+    const seconds = Math.floor(epochMillis / 1000);
+    if (seconds >= arrivalSeconds - MAX_EVENT_AGE_SECONDS && seconds <= arrivalSeconds + MAX_CLOCK_AHEAD_SECONDS) {
+      return Math.min(seconds, arrivalSeconds);
+    }
+  }
+  const ageMillis = parseMillis(queryParams[EVENT_AGE_MILLIS_PARAM_KEY]);
+  if (ageMillis !== null && ageMillis <= MAX_EVENT_AGE_SECONDS * 1000) {
+    return arrivalSeconds - Math.floor(ageMillis / 1000);
+  }
+  return null;
+}
@@ -0,0 +1,160 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import { CborError, CborValue, decodeCbor, encodeCbor } from './Cbor';
+
+/**
+ * CBOR messages between the ESP32 firmware and httpEcho / httpRemoteButton,
+ * sent with Content-Type application/cbor. Pure: maps bytes to the same
+ * `query` / `body` the JSON requests produce, so the handler cores and every
+ * Firestore document stay the same whichever format the device picked.
+ *
+ * Keys are small integers, shared with the firmware's
+ * components/garage_http_client/include/garage_http_client_cbor.h and pinned
+ * by the cbor_* fixtures in wire-contracts/echo and wire-contracts/remoteButton.
+ * Never renumber a key; add new ones at the end.
+ */
+
+export const WIRE_CBOR_CONTENT_TYPE = 'application/cbor';
+
+export const WIRE_KEY_BUILD_TIMESTAMP = 1;
+export const WIRE_KEY_SENSOR_A = 2;
+export const WIRE_KEY_SENSOR_B = 3;
+export const WIRE_KEY_EVENT_AGE_MILLIS = 4;
+export const WIRE_KEY_EVENT_TIMESTAMP_MILLIS = 5;
+export const WIRE_KEY_BUTTON_ACK_TOKEN = 6;
+export const WIRE_KEY_CONDITIONAL = 7;
+export const WIRE_KEY_LOCAL_PRESS_COUNT = 8;
+export const WIRE_KEY_ACTUATION_RESULT = 9;
+export const WIRE_KEY_ACTUATION_LATENCY_MILLIS = 10;
+export const WIRE_KEY_ACTUATION_ATTEMPTS = 11;
+export const WIRE_KEY_TRAVEL_OPEN = 12;
+export const WIRE_KEY_TRAVEL_CLOSE = 13;
+export const WIRE_KEY_PRESS_DELAY = 14;
+export const WIRE_KEY_TRAVEL_MEDIAN_MILLIS = 15;
+export const WIRE_KEY_TRAVEL_DRIFT = 16;
+export const WIRE_KEY_METRICS_COUNTERS = 17;
+export const WIRE_KEY_METRICS_GAUGES = 18;
+export const WIRE_KEY_METRICS_HISTOGRAMS = 19;
+
+/** Keys carried as query params. Values become strings, as in a URL. */
+const QUERY_KEYS: { [key: number]: { name: string, type: 'string' | 'number' | 'boolean' } } = {
+  [WIRE_KEY_BUILD_TIMESTAMP]: { name: 'buildTimestamp', type: 'string' },
+  [WIRE_KEY_SENSOR_A]: { name: 'sensorA', type: 'number' },
+  [WIRE_KEY_SENSOR_B]: { name: 'sensorB', type: 'number' },
+  [WIRE_KEY_EVENT_AGE_MILLIS]: { name: 'eventAgeMillis', type: 'number' },
+  [WIRE_KEY_EVENT_TIMESTAMP_MILLIS]: { name: 'eventTimestampMillis', type: 'number' },
+  [WIRE_KEY_BUTTON_ACK_TOKEN]: { name: 'buttonAckToken', type: 'string' },
+  [WIRE_KEY_CONDITIONAL]: { name: 'conditional', type: 'boolean' },
+};
+
+/**
+ * Keys carried in the JSON body, which the server only stores. Values are
+ * numbers, or arrays of numbers for the door travel histograms and the
+ * metrics a heartbeat carries. The metrics are in the order of the firmware's
+ * components/metrics/include/metrics.def.
+ */
+const BODY_KEYS: { [key: number]: string } = {
+  [WIRE_KEY_LOCAL_PRESS_COUNT]: 'local_press_count',
+  [WIRE_KEY_ACTUATION_RESULT]: 'actuation_result',
+  [WIRE_KEY_ACTUATION_LATENCY_MILLIS]: 'actuation_latency_ms',
+  [WIRE_KEY_ACTUATION_ATTEMPTS]: 'actuation_attempts',
+  [WIRE_KEY_TRAVEL_OPEN]: 'travel_open',
+  [WIRE_KEY_TRAVEL_CLOSE]: 'travel_close',
+  [WIRE_KEY_PRESS_DELAY]: 'press_delay',
+  [WIRE_KEY_TRAVEL_MEDIAN_MILLIS]: 'travel_median_ms',
+  [WIRE_KEY_TRAVEL_DRIFT]: 'travel_drift',
+  [WIRE_KEY_METRICS_COUNTERS]: 'metrics_counters',
+  [WIRE_KEY_METRICS_GAUGES]: 'metrics_gauges',
+  [WIRE_KEY_METRICS_HISTOGRAMS]: 'metrics_histograms',
+};
+
+export interface DeviceRequest {
+  query: { [name: string]: string };
+  body: { [name: string]: number | number[] };
+}
+
+/**
+ * Decodes a sensor upload or a button poll. Unknown keys are skipped so newer
+ * firmware can add fields. Throws CborError when the message is malformed.
+ */
+export function decodeDeviceRequest(bytes: Uint8Array): DeviceRequest {
+  const message = decodeCbor(bytes);
+  if (!(message instanceof Map)) {
+    throw new CborError('Device message is not a map');
+  }
+  const request: DeviceRequest = { query: {}, body: {} };
+  for (const [key, value] of message) {
+    if (typeof key !== 'number') {
+      continue;
+    }
+    const queryKey = QUERY_KEYS[key];
+    if (queryKey) {
+      if (typeof value !== queryKey.type) {
+        throw new CborError(`${queryKey.name} must be a ${queryKey.type}`);
+      }
+      request.query[queryKey.name] = String(value);
+    } else if (BODY_KEYS[key]) {
+      if (typeof value === 'number') {
+        request.body[BODY_KEYS[key]] = value;
+      } else if (Array.isArray(value) && value.every((item): item is number => typeof item === 'number')) {
+        request.body[BODY_KEYS[key]] = value;
+      } else {
+        throw new CborError(`${BODY_KEYS[key]} must be a number or an array of numbers`);
+      }
+    }
+  }
+  return request;
+}
+
+/** A query param as an integer, or undefined when it is missing or not one. */
+function integerParam(value: any): number | undefined {
+  const number = Number(value);
+  return typeof value === 'string' && value !== '' && Number.isSafeInteger(number) ? number : undefined;
+}
+
+/**
+ * The echo response the firmware reads: the device ID and sensor values the
+ * server stored, from the document handleEchoRequest returns.
+ */
+export function encodeSensorResponse(stored: any): Buffer {
+  const response = new Map<CborValue, CborValue>();
+  const params = stored?.queryParams ?? {};
+  if (typeof params.buildTimestamp === 'string') {
+    response.set(WIRE_KEY_BUILD_TIMESTAMP, params.buildTimestamp);
+  }
+  const sensorA = integerParam(params.sensorA);
+  if (sensorA !== undefined) {
+    response.set(WIRE_KEY_SENSOR_A, sensorA);
+  }
+  const sensorB = integerParam(params.sensorB);
+  if (sensorB !== undefined) {
+    response.set(WIRE_KEY_SENSOR_B, sensorB);
+  }
+  return encodeCbor(response);
+}
+
+/**
+ * The button poll response: the command's ack token, or an empty map when
+ * there is no command. The firmware presses the button when the token changes.
+ */
+export function encodeButtonResponse(command: any): Buffer {
+  const response = new Map<CborValue, CborValue>();
+  if (typeof command?.buttonAckToken === 'string') {
+    response.set(WIRE_KEY_BUTTON_ACK_TOKEN, command.buttonAckToken);
+  }
+  return encodeCbor(response);
+}
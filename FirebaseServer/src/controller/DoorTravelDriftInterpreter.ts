@@ -0,0 +1,55 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/**
+ * Reads the door travel drift flags a heartbeat carries.
+ *
+ * The firmware (GarageFirmware_ESP32/components/door_travel) keeps a
+ * histogram of each kind of travel and raises a kind's bit in
+ * `travel_drift` when the median of its last few travels moves more than
+ * CONFIG_GARAGE_TRAVEL_DRIFT_PERCENT from the histogram's median: the
+ * opener or the springs are changing. `travel_median_ms` holds each
+ * kind's histogram median, in the same order as the bits.
+ */
+
+export type DoorTravelKind = 'OPEN' | 'CLOSE' | 'PRESS_DELAY';
+
+// Bit order of door_travel_kind_t in door_travel.h
+export const DOOR_TRAVEL_KINDS: DoorTravelKind[] = ['OPEN', 'CLOSE', 'PRESS_DELAY'];
+
+export interface TravelDrift {
+  driftFlags: number;
+  medianMillis: Array<number | null>;   // Per kind, null when the heartbeat left it out
+}
+
+/**
+ * Pure function. Returns null when the body has no usable `travel_drift`,
+ * which is every heartbeat from firmware without door travel.
+ */
+export function parseTravelDrift(body: any): TravelDrift | null {
+  const flags = body?.travel_drift;
+  if (typeof flags !== 'number' || !Number.isInteger(flags) || flags < 0) {
+    return null;
+  }
+  const medians = Array.isArray(body.travel_median_ms) ? body.travel_median_ms : [];
+  return {
+    driftFlags: flags,
+    medianMillis: DOOR_TRAVEL_KINDS.map((_, i) => typeof medians[i] === 'number' ? medians[i] : null),
+  };
+}
+
+/**
+ * Pure function. The kinds whose bit is set in `flags` and was clear in
+ * `priorFlags`. A bit that stays set is not new, so a door that keeps
+ * drifting is reported once; a bit that clears and rises again is.
+ */
+export function newlyDriftedKinds(priorFlags: number, flags: number): DoorTravelKind[] {
+  return DOOR_TRAVEL_KINDS.filter((_, i) => (flags & (1 << i)) !== 0 && (priorFlags & (1 << i)) === 0);
+}
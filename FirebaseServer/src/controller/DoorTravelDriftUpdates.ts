@@ -0,0 +1,50 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+import { DATABASE as DOOR_TRAVEL_DRIFT_DATABASE } from '../database/DoorTravelDriftDatabase';
+import { newlyDriftedKinds, parseTravelDrift } from './DoorTravelDriftInterpreter';
+import { SERVICE as DoorTravelDriftFCMService } from './fcm/DoorTravelDriftFCM';
+
+/**
+ * Called with every heartbeat. Alerts when the heartbeat raises a
+ * `travel_drift` bit that the previous one from the same device did not.
+ *
+ * The flags are kept per device in DoorTravelDriftDatabase, and written
+ * only when they change, so a steady heartbeat costs one read. The
+ * firmware's histograms start over after a reboot, so a door that is
+ * still drifting afterwards is reported again once the firmware has
+ * enough travels to raise the flag.
+ */
+export async function handleTravelDriftFromHeartbeat(
+  buildTimestamp: string | undefined,
+  body: any,
+  nowSeconds: number,
+): Promise<void> {
+  const drift = parseTravelDrift(body);
+  if (!buildTimestamp || drift === null) {
+    return;
+  }
+  const prior = await DOOR_TRAVEL_DRIFT_DATABASE.getCurrent(buildTimestamp);
+  const priorFlags = prior?.driftFlags ?? 0;
+  if (priorFlags === drift.driftFlags) {
+    return;
+  }
+  await DOOR_TRAVEL_DRIFT_DATABASE.save(buildTimestamp, {
+    driftFlags: drift.driftFlags,
+    changedAtSeconds: nowSeconds,
+  });
+  const kinds = newlyDriftedKinds(priorFlags, drift.driftFlags);
+  if (kinds.length === 0) {
+    console.log('Door travel drift cleared', { buildTimestamp, driftFlags: drift.driftFlags });
+    return;
+  }
+  console.warn('Door travel drift', { buildTimestamp, kinds, medianMillis: drift.medianMillis });
+  await DoorTravelDriftFCMService.sendForDrift(buildTimestamp, kinds, drift.medianMillis);
+}
@@ -21,6 +21,7 @@ import { DATABASE as SensorEventDatabase } from '../database/SensorEventDatabase
 import { SensorSnapshot } from '../model/SensorSnapshot';
 
 import { getNewEventOrNull } from './EventInterpreter';
+import { deviceEventTimestampSeconds } from './DeviceEventTime';
 import { SensorEvent, SensorEventType } from '../model/SensorEvent';
 import { SERVICE as EventFCMService } from '../controller/fcm/EventFCM';
 import { SERVICE as ResolvedNotificationFCMService } from '../controller/fcm/ResolvedNotificationFCM';
@@ -53,8 +54,8 @@ export async function updateEvent(data, scheduledJob: boolean) {
       console.warn('Missing timestamp key:', DATABASE_TIMESTAMP_SECONDS_KEY, 'data:', data);
     }
   }
-  if (QUERY_PARAMS_KEY in data) {
-    const queryParams = data[QUERY_PARAMS_KEY];
+  const queryParams = QUERY_PARAMS_KEY in data ? data[QUERY_PARAMS_KEY] : null;
+  if (queryParams) {
     if (SENSOR_A_KEY in queryParams) {
       sensorSnapshot.sensorA = queryParams[SENSOR_A_KEY];
     }
@@ -64,16 +65,27 @@ export async function updateEvent(data, scheduledJob: boolean) {
   }
   const now = firebase.firestore.Timestamp.now();
   const timestampSeconds = now.seconds;
-  await updateWithParams(buildTimestamp, sensorSnapshot, timestampSeconds, scheduledJob);
+  // Date a device upload by when the device captured it. A scheduled check
+  // re-reads an old upload to look for timeouts, so it must use the clock.
+  let eventTimestampSeconds = timestampSeconds;
+  if (!scheduledJob) {
+    const arrivalSeconds = sensorSnapshot.timestampSeconds ?? timestampSeconds;
+    eventTimestampSeconds = deviceEventTimestampSeconds(queryParams, arrivalSeconds) ?? timestampSeconds;
+  }
+  await updateWithParams(buildTimestamp, sensorSnapshot, eventTimestampSeconds, timestampSeconds, scheduledJob);
 }
 
-async function updateWithParams(buildTimestamp, sensorSnapshot, timestampSeconds, scheduledJob: boolean) {
+async function updateWithParams(buildTimestamp, sensorSnapshot, eventTimestampSeconds, timestampSeconds, scheduledJob: boolean) {
   const oldData = await SensorEventDatabase.getCurrent(buildTimestamp);
   let oldEvent: SensorEvent = null;
   if (CURRENT_EVENT_KEY in oldData) {
     oldEvent = oldData[CURRENT_EVENT_KEY];
   }
-  const newEvent = getNewEventOrNull(oldEvent, sensorSnapshot, timestampSeconds);
+  // Keep events in order even if a device clock is slightly behind the last event
+  if (oldEvent && eventTimestampSeconds < oldEvent.timestampSeconds) {
+    eventTimestampSeconds = oldEvent.timestampSeconds;
+  }
+  const newEvent = getNewEventOrNull(oldEvent, sensorSnapshot, eventTimestampSeconds);
   if (newEvent !== null) {
     const data = {};
     data[BUILD_TIMESTAMP_PARAM_KEY] = buildTimestamp;
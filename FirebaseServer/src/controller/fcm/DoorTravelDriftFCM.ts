@@ -0,0 +1,108 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+import * as firebase from 'firebase-admin';
+
+import { DoorTravelKind, DOOR_TRAVEL_KINDS } from '../DoorTravelDriftInterpreter';
+import {
+  AndroidConfig,
+  AndroidMessagePriority,
+  AndroidNotification,
+  Notification,
+  NotificationPriority,
+  TopicMessage,
+} from '../../model/FCM';
+import { buildTimestampToFcmTopic } from '../../model/FcmTopic';
+
+/**
+ * Side-effecting FCM dispatch for door travel drift.
+ *
+ * Shape matches src/controller/fcm/ButtonHealthFCM.ts (interface +
+ * default impl + swappable singleton + setImpl/resetImpl).
+ *
+ * A user-visible notification on the legacy door topic, like the
+ * door-not-closed warning in OldDataFCM.ts: a drifting door is worth
+ * a look at the opener, not an app state change.
+ */
+export interface DoorTravelDriftFCMService {
+  sendForDrift(
+    buildTimestamp: string,
+    kinds: DoorTravelKind[],
+    medianMillis: Array<number | null>,
+  ): Promise<TopicMessage>;
+}
+
+class DefaultDoorTravelDriftFCMService implements DoorTravelDriftFCMService {
+  async sendForDrift(
+    buildTimestamp: string,
+    kinds: DoorTravelKind[],
+    medianMillis: Array<number | null>,
+  ): Promise<TopicMessage> {
+    const message = buildDriftMessage(buildTimestamp, kinds, medianMillis);
+    console.log('Sending door travel drift FCM', JSON.stringify(message));
+    await firebase.messaging().send(message)
+      .then((response) => {
+        console.log('Successfully sent door travel drift FCM:', JSON.stringify(response));
+      })
+      .catch((error) => {
+        console.log('Error sending door travel drift FCM:', JSON.stringify(error));
+      });
+    return message;
+  }
+}
+
+let _instance: DoorTravelDriftFCMService = new DefaultDoorTravelDriftFCMService();
+
+export const SERVICE: DoorTravelDriftFCMService = {
+  sendForDrift: (t, k, m) => _instance.sendForDrift(t, k, m),
+};
+
+/** TEST-ONLY: swap in a fake implementation. */
+export function setImpl(impl: DoorTravelDriftFCMService): void { _instance = impl; }
+
+/** TEST-ONLY: restore the default (Firebase-dispatching) implementation. */
+export function resetImpl(): void { _instance = new DefaultDoorTravelDriftFCMService(); }
+
+const KIND_NAMES: { [kind in DoorTravelKind]: string } = {
+  OPEN: 'Opening',
+  CLOSE: 'Closing',
+  PRESS_DELAY: 'The delay after a button press',
+};
+
+function formatSeconds(millis: number): string {
+  return (millis / 1000).toFixed(1) + ' s';
+}
+
+/**
+ * Pure helper — builds the notification for the kinds that started
+ * drifting. The medians are the firmware's long-run ones, which is what
+ * the recent travels moved away from.
+ */
+export function buildDriftMessage(
+  buildTimestamp: string,
+  kinds: DoorTravelKind[],
+  medianMillis: Array<number | null>,
+): TopicMessage {
+  const message = <TopicMessage>{};
+  message.notification = <Notification>{};
+  message.android = <AndroidConfig>{};
+  message.android.notification = <AndroidNotification>{};
+  message.topic = buildTimestampToFcmTopic(buildTimestamp);
+  message.android.collapse_key = 'door_travel_drift';
+  message.android.priority = AndroidMessagePriority.HIGH;
+  message.android.notification.notification_priority = NotificationPriority.PRIORITY_DEFAULT;
+  message.notification.title = 'Door travel time changed';
+  message.notification.body = kinds.map((kind) => {
+    const median = medianMillis[DOOR_TRAVEL_KINDS.indexOf(kind)];
+    const usual = median ? ' (usually ' + formatSeconds(median) + ')' : '';
+    return KIND_NAMES[kind] + ' is taking a different time than usual' + usual + '.';
+  }).join(' ') + ' The opener or springs may need a look.';
+  return message;
+}
@@ -0,0 +1,67 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+import * as firebase from 'firebase-admin';
+
+import { ActuationResult } from '../controller/ActuationReport';
+
+// Canonical collection string. Pinned by
+// test/database/ButtonActuationDatabaseTest.ts. Changing it requires a
+// Firestore data migration in production — see
+// docs/FIREBASE_DATABASE_REFACTOR.md.
+//
+// Only the latest report per device is kept. Every report is also in the
+// button poll's body in remoteButtonRequestAll.
+export const COLLECTION_CURRENT = 'buttonActuationCurrent';
+
+/** Whether the door moved after the device's latest button press. */
+export interface ButtonActuationRecord {
+  result: ActuationResult;
+  latencyMillis: number;
+  attempts: number;
+  /** The ack token the device sent with the report: the command it pressed for. */
+  buttonAckToken: string | null;
+  reportedAtSeconds: number;
+}
+
+export interface ButtonActuationDatabase {
+  save(buildTimestamp: string, record: ButtonActuationRecord): Promise<void>;
+  getCurrent(buildTimestamp: string): Promise<ButtonActuationRecord | null>;
+}
+
+class FirestoreButtonActuationDatabase implements ButtonActuationDatabase {
+  async save(buildTimestamp: string, record: ButtonActuationRecord): Promise<void> {
+    await firebase.app().firestore()
+      .collection(COLLECTION_CURRENT)
+      .doc(buildTimestamp)
+      .set(record);
+  }
+
+  async getCurrent(buildTimestamp: string): Promise<ButtonActuationRecord | null> {
+    const ref = await firebase.app().firestore()
+      .collection(COLLECTION_CURRENT)
+      .doc(buildTimestamp)
+      .get();
+    return (ref.data() as ButtonActuationRecord) ?? null;
+  }
+}
+
+let _instance: ButtonActuationDatabase = new FirestoreButtonActuationDatabase();
+
+export const DATABASE: ButtonActuationDatabase = {
+  save: (t, r) => _instance.save(t, r),
+  getCurrent: (t) => _instance.getCurrent(t),
+};
+
+/** TEST-ONLY: swap in a fake implementation. */
+export function setImpl(impl: ButtonActuationDatabase): void { _instance = impl; }
+
+/** TEST-ONLY: restore the Firestore implementation. */
+export function resetImpl(): void { _instance = new FirestoreButtonActuationDatabase(); }
@@ -0,0 +1,90 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+import * as firebase from 'firebase-admin';
+
+import { CurrentDocumentCache } from './CurrentDocumentCache';
+
+// Canonical collection string. Pinned by
+// test/database/ButtonAttentionDatabaseTest.ts. Changing it requires a
+// Firestore data migration in production — see
+// docs/FIREBASE_DATABASE_REFACTOR.md.
+export const COLLECTION_CURRENT = 'buttonAttentionCurrent';
+
+// Safety net for ATTENTION_CACHE. The snapshot listener normally refreshes it sooner.
+const ATTENTION_CACHE_MAX_AGE_SECONDS = 60;
+
+/** When an allowlisted user last opened the app for a device. */
+export interface ButtonAttentionRecord {
+  seenAtSeconds: number;
+}
+
+export interface ButtonAttentionDatabase {
+  save(buildTimestamp: string, record: ButtonAttentionRecord): Promise<void>;
+  getCurrent(buildTimestamp: string): Promise<ButtonAttentionRecord | null>;
+  watchCurrent(
+    buildTimestamp: string,
+    onChange: (record: ButtonAttentionRecord | null) => void,
+    onError: (error: Error) => void,
+  ): () => void;
+}
+
+class FirestoreButtonAttentionDatabase implements ButtonAttentionDatabase {
+  async save(buildTimestamp: string, record: ButtonAttentionRecord): Promise<void> {
+    await firebase.app().firestore()
+      .collection(COLLECTION_CURRENT)
+      .doc(buildTimestamp)
+      .set(record);
+  }
+
+  async getCurrent(buildTimestamp: string): Promise<ButtonAttentionRecord | null> {
+    const ref = await firebase.app().firestore()
+      .collection(COLLECTION_CURRENT)
+      .doc(buildTimestamp)
+      .get();
+    return toRecord(ref.data());
+  }
+
+  watchCurrent(
+    buildTimestamp: string,
+    onChange: (record: ButtonAttentionRecord | null) => void,
+    onError: (error: Error) => void,
+  ): () => void {
+    return firebase.app().firestore()
+      .collection(COLLECTION_CURRENT)
+      .doc(buildTimestamp)
+      .onSnapshot((snapshot) => onChange(toRecord(snapshot.data())), onError);
+  }
+}
+
+function toRecord(data: any): ButtonAttentionRecord | null {
+  if (!data) return null;
+  return { seenAtSeconds: data.seenAtSeconds };
+}
+
+let _instance: ButtonAttentionDatabase = new FirestoreButtonAttentionDatabase();
+
+export const DATABASE: ButtonAttentionDatabase = {
+  save: (t, r) => _instance.save(t, r),
+  getCurrent: (t) => _instance.getCurrent(t),
+  watchCurrent: (t, c, e) => _instance.watchCurrent(t, c, e),
+};
+
+/**
+ * Attention per buildTimestamp, kept fresh by a snapshot listener.
+ * Every button poll reads it to pick the next poll period.
+ */
+export const ATTENTION_CACHE = new CurrentDocumentCache(COLLECTION_CURRENT, DATABASE, ATTENTION_CACHE_MAX_AGE_SECONDS);
+
+/** TEST-ONLY: swap in a fake implementation. */
+export function setImpl(impl: ButtonAttentionDatabase): void { ATTENTION_CACHE.clear(); _instance = impl; }
+
+/** TEST-ONLY: restore the Firestore implementation. */
+export function resetImpl(): void { ATTENTION_CACHE.clear(); _instance = new FirestoreButtonAttentionDatabase(); }
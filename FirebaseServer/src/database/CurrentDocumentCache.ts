@@ -0,0 +1,138 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+import * as firebase from 'firebase-admin';
+
+/** A database with one "current" document per key, like TimeSeriesDatabase. */
+export interface CurrentDocumentSource {
+  getCurrent(key: string): Promise<any>;
+  watchCurrent(key: string, onChange: (data: any) => void, onError: (error: Error) => void): () => void;
+}
+
+export interface CacheStats {
+  hits: number;
+  misses: number;
+}
+
+// Log hit rate once per this many lookups
+const STATS_LOG_INTERVAL = 1000;
+
+interface CacheEntry {
+  data: any;
+  fetchedSeconds: number;
+  unsubscribe: () => void;
+}
+
+/**
+ * In-process cache of "current" documents.
+ *
+ * The first read of a key starts a snapshot listener, so writes from any
+ * function instance reach the cache within about a second. maxAgeSeconds bounds
+ * how long an entry is trusted if the listener goes quiet without an error.
+ * A listener error drops the entry and the next read goes to the database.
+ * The hit rate is logged every STATS_LOG_INTERVAL lookups.
+ */
+export class CurrentDocumentCache {
+  private readonly entries = new Map<string, CacheEntry>();
+  private hits = 0;
+  private misses = 0;
+
+  constructor(
+    private readonly name: string,
+    private readonly source: CurrentDocumentSource,
+    private readonly maxAgeSeconds: number,
+  ) { }
+
+  async get(key: string): Promise<any> {
+    const entry = this.entries.get(key);
+    const hit = entry !== undefined && nowSeconds() - entry.fetchedSeconds < this.maxAgeSeconds;
+    this.recordLookup(hit);
+    if (hit) {
+      return entry.data;
+    }
+    const data = await this.source.getCurrent(key);
+    this.set(key, data);
+    return data;
+  }
+
+  /** Store data for key, e.g. right after this instance saved it. */
+  set(key: string, data: any): void {
+    const entry = this.entries.get(key);
+    if (entry) {
+      entry.data = data;
+      entry.fetchedSeconds = nowSeconds();
+      return;
+    }
+    const newEntry: CacheEntry = { data: data, fetchedSeconds: nowSeconds(), unsubscribe: () => { } };
+    this.entries.set(key, newEntry);
+    newEntry.unsubscribe = this.source.watchCurrent(
+      key,
+      (changed) => {
+        if (this.entries.get(key) === newEntry) {
+          newEntry.data = changed;
+          newEntry.fetchedSeconds = nowSeconds();
+        }
+      },
+      (error) => {
+        console.warn('CurrentDocumentCache: listener failed for', this.name, key, error);
+        this.remove(key, newEntry);
+      },
+    );
+  }
+
+  /** Forget key, so the next get() reads it. */
+  invalidate(key: string): void {
+    const entry = this.entries.get(key);
+    if (entry) {
+      this.remove(key, entry);
+    }
+  }
+
+  stats(): CacheStats {
+    return { hits: this.hits, misses: this.misses };
+  }
+
+  /** Drop every entry and stop every listener. */
+  clear(): void {
+    for (const [key, entry] of Array.from(this.entries)) {
+      this.remove(key, entry);
+    }
+    this.hits = 0;
+    this.misses = 0;
+  }
+
+  private recordLookup(hit: boolean): void {
+    if (hit) {
+      this.hits++;
+    } else {
+      this.misses++;
+    }
+    const lookups = this.hits + this.misses;
+    if (lookups % STATS_LOG_INTERVAL === 0) {
+      console.log('CurrentDocumentCache stats:', {
+        name: this.name,
+        hits: this.hits,
+        misses: this.misses,
+        hitRate: this.hits / lookups,
+      });
+    }
+  }
+
+  private remove(key: string, entry: CacheEntry): void {
+    if (this.entries.get(key) === entry) {
+      this.entries.delete(key);
+    }
+    entry.unsubscribe();
+  }
+}
+
+function nowSeconds(): number {
+  return firebase.firestore.Timestamp.now().seconds;
+}
@@ -0,0 +1,62 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+import * as firebase from 'firebase-admin';
+
+// Canonical collection string. Pinned by
+// test/database/DoorTravelDriftDatabaseTest.ts. Changing it requires a
+// Firestore data migration in production — see
+// docs/FIREBASE_DATABASE_REFACTOR.md.
+export const COLLECTION_CURRENT = 'doorTravelDriftCurrent';
+
+export interface DoorTravelDriftRecord {
+  driftFlags: number;              // travel_drift from the last heartbeat that changed it
+  changedAtSeconds: number;
+}
+
+export interface DoorTravelDriftDatabase {
+  save(buildTimestamp: string, record: DoorTravelDriftRecord): Promise<void>;
+  getCurrent(buildTimestamp: string): Promise<DoorTravelDriftRecord | null>;
+}
+
+class FirestoreDoorTravelDriftDatabase implements DoorTravelDriftDatabase {
+  async save(buildTimestamp: string, record: DoorTravelDriftRecord): Promise<void> {
+    await firebase.app().firestore()
+      .collection(COLLECTION_CURRENT)
+      .doc(buildTimestamp)
+      .set(record);
+  }
+
+  async getCurrent(buildTimestamp: string): Promise<DoorTravelDriftRecord | null> {
+    const ref = await firebase.app().firestore()
+      .collection(COLLECTION_CURRENT)
+      .doc(buildTimestamp)
+      .get();
+    const data = ref.data();
+    if (!data) return null;
+    return {
+      driftFlags: data.driftFlags,
+      changedAtSeconds: data.changedAtSeconds,
+    };
+  }
+}
+
+let _instance: DoorTravelDriftDatabase = new FirestoreDoorTravelDriftDatabase();
+
+export const DATABASE: DoorTravelDriftDatabase = {
+  save: (t, r) => _instance.save(t, r),
+  getCurrent: (t) => _instance.getCurrent(t),
+};
+
+/** TEST-ONLY: swap in a fake implementation. */
+export function setImpl(impl: DoorTravelDriftDatabase): void { _instance = impl; }
+
+/** TEST-ONLY: restore the Firestore implementation. */
+export function resetImpl(): void { _instance = new FirestoreDoorTravelDriftDatabase(); }
@@ -0,0 +1,93 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+/** Polls folded into one saved row. */
+export interface PollStats {
+  polls: number;
+  conditionalPolls: number;
+  firstPollSeconds: number;
+  lastPollSeconds: number;
+}
+
+interface PollLogState {
+  signature: string;
+  lastSaveSeconds: number;
+  stats: PollStats | null;
+}
+
+/**
+ * Decides which device polls are worth a Firestore write.
+ *
+ * A poll is saved when its query or body differs from the last saved poll, or
+ * when the last save is minPeriodSeconds old. Otherwise it is only counted,
+ * and the next saved row carries the counts as `pollStats`. A row only counts
+ * as saved once the caller reports the write with saved(), so a failed write
+ * leaves the next poll to be saved instead. Counts still pending when an
+ * instance shuts down are lost, which is fine for a log.
+ *
+ * State is per function instance. More instances means a few more writes.
+ */
+export class PollLogCoalescer {
+  private readonly states = new Map<string, PollLogState>();
+
+  constructor(private readonly minPeriodSeconds: number) { }
+
+  /**
+   * Returns the row to save for this poll, or null if it was folded into the next one.
+   * Call saved() with the row once the write succeeds.
+   */
+  record(key: string, data: any, conditional: boolean, nowSeconds: number): any | null {
+    let state = this.states.get(key);
+    if (!state) {
+      state = { signature: '', lastSaveSeconds: Number.NEGATIVE_INFINITY, stats: null };
+      this.states.set(key, state);
+    }
+    const stats = state.stats ?? { polls: 0, conditionalPolls: 0, firstPollSeconds: nowSeconds, lastPollSeconds: nowSeconds };
+    stats.polls++;
+    stats.conditionalPolls += conditional ? 1 : 0;
+    stats.lastPollSeconds = nowSeconds;
+    state.stats = stats;
+    if (pollSignature(data) === state.signature && nowSeconds - state.lastSaveSeconds < this.minPeriodSeconds) {
+      return null;
+    }
+    return { ...data, pollStats: { ...stats } };
+  }
+
+  /** Marks a row from record() as written, so later polls are measured from it. */
+  saved(key: string, row: any): void {
+    const state = this.states.get(key);
+    if (!state) {
+      return;
+    }
+    const savedStats: PollStats = row.pollStats;
+    state.signature = pollSignature(row);
+    state.lastSaveSeconds = savedStats.lastPollSeconds;
+    const stats = state.stats;
+    if (!stats || stats.polls <= savedStats.polls) {
+      state.stats = null;
+      return;
+    }
+    // Polls that arrived while the write was in flight stay for the next row
+    state.stats = {
+      polls: stats.polls - savedStats.polls,
+      conditionalPolls: stats.conditionalPolls - savedStats.conditionalPolls,
+      firstPollSeconds: savedStats.lastPollSeconds,
+      lastPollSeconds: stats.lastPollSeconds,
+    };
+  }
+
+  clear(): void {
+    this.states.clear();
+  }
+}
+
+function pollSignature(data: any): string {
+  return JSON.stringify([data.queryParams ?? null, data.body ?? null]);
+}
@@ -9,6 +9,7 @@
  */
 
 import { TimeSeriesDatabase } from './TimeSeriesDatabase';
+import { CurrentDocumentCache } from './CurrentDocumentCache';
 
 // Canonical collection strings for this database. Pinned by
 // test/database/RemoteButtonCommandDatabaseTest.ts. Changing them
@@ -17,9 +18,13 @@ import { TimeSeriesDatabase } from './TimeSeriesDatabase';
 export const COLLECTION_CURRENT = 'remoteButtonCommandCurrent';
 export const COLLECTION_ALL = 'remoteButtonCommandAll';
 
+// Safety net for CURRENT_CACHE. The snapshot listener normally refreshes it sooner.
+const CURRENT_CACHE_MAX_AGE_SECONDS = 60;
+
 export interface RemoteButtonCommandDatabase {
   save(buildTimestamp: string, data: any): Promise<void>;
   getCurrent(buildTimestamp: string): Promise<any>;
+  watchCurrent(buildTimestamp: string, onChange: (data: any) => void, onError: (error: Error) => void): () => void;
   deleteAllBefore(cutoffTimestampSeconds: number, dryRun: boolean): Promise<number>;
 }
 
@@ -27,6 +32,7 @@ class FirestoreRemoteButtonCommandDatabase implements RemoteButtonCommandDatabas
   private readonly db = new TimeSeriesDatabase(COLLECTION_CURRENT, COLLECTION_ALL);
   save(t: string, d: any) { return this.db.save(t, d); }
   getCurrent(t: string) { return this.db.getCurrent(t); }
+  watchCurrent(t: string, c: (data: any) => void, e: (error: Error) => void) { return this.db.watchCurrent(t, c, e); }
   deleteAllBefore(c: number, dry: boolean) { return this.db.deleteAllBefore(c, dry); }
 }
 
@@ -35,11 +41,18 @@ let _instance: RemoteButtonCommandDatabase = new FirestoreRemoteButtonCommandDat
 export const DATABASE: RemoteButtonCommandDatabase = {
   save: (t, d) => _instance.save(t, d),
   getCurrent: (t) => _instance.getCurrent(t),
+  watchCurrent: (t, c, e) => _instance.watchCurrent(t, c, e),
   deleteAllBefore: (c, dry) => _instance.deleteAllBefore(c, dry),
 };
 
+/**
+ * Current command per buildTimestamp, kept fresh by a snapshot listener.
+ * Conditional button polls read from here instead of Firestore.
+ */
+export const CURRENT_CACHE = new CurrentDocumentCache(COLLECTION_CURRENT, DATABASE, CURRENT_CACHE_MAX_AGE_SECONDS);
+
 /** TEST-ONLY: swap in a fake implementation. */
-export function setImpl(impl: RemoteButtonCommandDatabase): void { _instance = impl; }
+export function setImpl(impl: RemoteButtonCommandDatabase): void { CURRENT_CACHE.clear(); _instance = impl; }
 
 /** TEST-ONLY: restore the Firestore implementation. */
-export function resetImpl(): void { _instance = new FirestoreRemoteButtonCommandDatabase(); }
+export function resetImpl(): void { CURRENT_CACHE.clear(); _instance = new FirestoreRemoteButtonCommandDatabase(); }
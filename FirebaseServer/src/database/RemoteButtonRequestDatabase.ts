@@ -9,6 +9,7 @@
  */
 
 import { TimeSeriesDatabase } from './TimeSeriesDatabase';
+import { PollLogCoalescer } from './PollLogCoalescer';
 
 // Canonical collection strings for this database. Pinned by
 // test/database/RemoteButtonRequestDatabaseTest.ts. Changing them
@@ -17,6 +18,12 @@ import { TimeSeriesDatabase } from './TimeSeriesDatabase';
 export const COLLECTION_CURRENT = 'remoteButtonRequestCurrent';
 export const COLLECTION_ALL = 'remoteButtonRequestAll';
 
+// ButtonHealthInterpreter.ONLINE_THRESHOLD_SEC reads the current doc's
+// timestamp as the time of the last poll. Shorter than the idle poll period
+// (ButtonPollCadence.IDLE_POLL_SECONDS) by more than the arrival jitter, so
+// every idle poll is saved; otherwise saves would be two idle periods apart.
+export const POLL_LOG_MIN_PERIOD_SECONDS = 15;
+
 export interface RemoteButtonRequestDatabase {
   save(buildTimestamp: string, data: any): Promise<void>;
   getCurrent(buildTimestamp: string): Promise<any>;
@@ -38,8 +45,11 @@ export const DATABASE: RemoteButtonRequestDatabase = {
   deleteAllBefore: (c, dry) => _instance.deleteAllBefore(c, dry),
 };
 
+/** Decides which device polls reach save(). See handleRemoteButtonPoll. */
+export const POLL_LOG = new PollLogCoalescer(POLL_LOG_MIN_PERIOD_SECONDS);
+
 /** TEST-ONLY: swap in a fake implementation. */
-export function setImpl(impl: RemoteButtonRequestDatabase): void { _instance = impl; }
+export function setImpl(impl: RemoteButtonRequestDatabase): void { POLL_LOG.clear(); _instance = impl; }
 
 /** TEST-ONLY: restore the Firestore implementation. */
-export function resetImpl(): void { _instance = new FirestoreRemoteButtonRequestDatabase(); }
+export function resetImpl(): void { POLL_LOG.clear(); _instance = new FirestoreRemoteButtonRequestDatabase(); }
@@ -15,6 +15,7 @@
  */
 
 import { TimeSeriesDatabase } from './TimeSeriesDatabase';
+import { CacheStats, CurrentDocumentCache } from './CurrentDocumentCache';
 
 // Canonical collection strings + document key for this database.
 // Pinned by test/database/ServerConfigDatabaseTest.ts. Changing them
@@ -24,26 +25,51 @@ export const COLLECTION_CURRENT = 'configCurrent';
 export const COLLECTION_ALL = 'configAll';
 export const CURRENT_KEY = 'current';
 
+// Safety net for getCached(). The snapshot listener normally refreshes it within a second,
+// which is what SetConfigFlag and scripts/set-config-flag.sh rely on.
+const CONFIG_CACHE_MAX_AGE_SECONDS = 10;
+
 export interface ServerConfigDatabase {
   get(): Promise<any>;
   set(data: any): Promise<void>;
+  watch(onChange: (data: any) => void, onError: (error: Error) => void): () => void;
 }
 
 class FirestoreServerConfigDatabase implements ServerConfigDatabase {
   private readonly db = new TimeSeriesDatabase(COLLECTION_CURRENT, COLLECTION_ALL);
   get() { return this.db.getCurrent(CURRENT_KEY); }
   set(d: any) { return this.db.save(CURRENT_KEY, d); }
+  watch(c: (data: any) => void, e: (error: Error) => void) { return this.db.watchCurrent(CURRENT_KEY, c, e); }
 }
 
 let _instance: ServerConfigDatabase = new FirestoreServerConfigDatabase();
 
-export const DATABASE: ServerConfigDatabase = {
+const CONFIG_CACHE = new CurrentDocumentCache(COLLECTION_CURRENT, {
+  getCurrent: (_key) => _instance.get(),
+  watchCurrent: (_key, c, e) => _instance.watch(c, e),
+}, CONFIG_CACHE_MAX_AGE_SECONDS);
+
+export const DATABASE: ServerConfigDatabase & {
+  /**
+   * Config from an in-process cache kept fresh by a snapshot listener, for
+   * endpoints hit on every device poll. Everything else should use get().
+   */
+  getCached(): Promise<any>;
+  cacheStats(): CacheStats;
+} = {
   get: () => _instance.get(),
-  set: (d) => _instance.set(d),
+  set: async (d) => {
+    await _instance.set(d);
+    // Read-your-writes in this instance without waiting for the listener
+    CONFIG_CACHE.invalidate(CURRENT_KEY);
+  },
+  watch: (c, e) => _instance.watch(c, e),
+  getCached: () => CONFIG_CACHE.get(CURRENT_KEY),
+  cacheStats: () => CONFIG_CACHE.stats(),
 };
 
 /** TEST-ONLY: swap in a fake implementation. */
-export function setImpl(impl: ServerConfigDatabase): void { _instance = impl; }
+export function setImpl(impl: ServerConfigDatabase): void { CONFIG_CACHE.clear(); _instance = impl; }
 
 /** TEST-ONLY: restore the Firestore implementation. */
-export function resetImpl(): void { _instance = new FirestoreServerConfigDatabase(); }
+export function resetImpl(): void { CONFIG_CACHE.clear(); _instance = new FirestoreServerConfigDatabase(); }
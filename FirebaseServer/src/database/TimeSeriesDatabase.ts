@@ -81,6 +81,18 @@ export class TimeSeriesDatabase {
     return TimeSeriesDatabase.convertFromFirestore(currentRef.data());
   }
 
+  /**
+   * Call onChange with the current data now and whenever it changes, until the
+   * returned function is called. onError ends the listener.
+   */
+  watchCurrent(session: string, onChange: (data: any) => void, onError: (error: Error) => void): () => void {
+    return firebase.app().firestore().collection(this.collectionCurrent).doc(session)
+      .onSnapshot(
+        (snapshot) => onChange(TimeSeriesDatabase.convertFromFirestore(snapshot.data())),
+        onError,
+      );
+  }
+
   async getLatestN(n: number): Promise<any[]> {
     const allRef = firebase.app().firestore().collection(this.collectionAll);
 
@@ -34,6 +34,14 @@ export type HandlerResult<T> =
   | { kind: 'ok'; data: T }
   | { kind: 'error'; status: number; body: unknown };
 
+/**
+ * HandlerResult for endpoints that support conditional requests. The wrapper
+ * also maps { kind: 'notModified' } → response.status(304).end().
+ */
+export type ConditionalHandlerResult<T> =
+  | HandlerResult<T>
+  | { kind: 'notModified' };
+
 export function ok<T>(data: T): HandlerResult<T> {
   return { kind: 'ok', data };
 }
@@ -41,3 +49,8 @@ export function ok<T>(data: T): HandlerResult<T> {
 export function err(status: number, body: unknown): HandlerResult<never> {
   return { kind: 'error', status, body };
 }
+
+/** The client already has the current data. Only for clients that asked for it. */
+export function notModified(): ConditionalHandlerResult<never> {
+  return { kind: 'notModified' };
+}
@@ -8,11 +8,16 @@
  *     http://www.apache.org/licenses/LICENSE-2.0
  */
 
+import * as firebase from 'firebase-admin';
 import * as functions from 'firebase-functions/v1';
 
 import { DATABASE as ServerConfigDatabase } from '../../database/ServerConfigDatabase';
 import { DATABASE as BUTTON_HEALTH_DATABASE } from '../../database/ButtonHealthDatabase';
 import { DATABASE as REMOTE_BUTTON_REQUEST_DATABASE } from '../../database/RemoteButtonRequestDatabase';
+import {
+  DATABASE as BUTTON_ATTENTION_DATABASE,
+  ATTENTION_CACHE as BUTTON_ATTENTION_CACHE,
+} from '../../database/ButtonAttentionDatabase';
 import {
   isRemoteButtonEnabled,
   getRemoteButtonPushKey,
@@ -26,6 +31,9 @@ import { HTTP_RUNTIME_OPTS } from '../HttpRuntime';
 const BUILD_TIMESTAMP_PARAM_KEY = 'buildTimestamp';
 const DATABASE_TIMESTAMP_SECONDS_KEY = 'FIRESTORE_databaseTimestampSeconds';
 
+// Refreshes closer together than this are not saved. Well inside ACTIVE_WINDOW_SECONDS.
+const ATTENTION_SAVE_PERIOD_SECONDS = 60;
+
 /**
  * Cold-start endpoint for mobile clients. Returns the current health
  * snapshot for the button device's buildTimestamp, or
@@ -41,6 +49,11 @@ const DATABASE_TIMESTAMP_SECONDS_KEY = 'FIRESTORE_databaseTimestampSeconds';
  * outer catch and yield 500 (not 401). Consistency with the existing
  * button auth handler is more important than the asymmetry with
  * Snooze (which wraps and returns 401).
+ *
+ * An authorized fetch means someone has the app open and may be about to
+ * press the button, so it is saved as attention for the device (at most once
+ * per ATTENTION_SAVE_PERIOD_SECONDS). The button poll reads it to ask the
+ * device for fast polls — see controller/ButtonPollCadence.ts.
  */
 export async function handleButtonHealth(input: {
   query: any;
@@ -81,6 +94,14 @@ export async function handleButtonHealth(input: {
     return err(400, { error: 'Missing required parameter: ' + BUILD_TIMESTAMP_PARAM_KEY });
   }
 
+  const nowSeconds = firebase.firestore.Timestamp.now().seconds;
+  const attention = await BUTTON_ATTENTION_CACHE.get(buildTimestamp);
+  if (!attention || nowSeconds - attention.seenAtSeconds >= ATTENTION_SAVE_PERIOD_SECONDS) {
+    const seen = { seenAtSeconds: nowSeconds };
+    await BUTTON_ATTENTION_DATABASE.save(buildTimestamp, seen);
+    BUTTON_ATTENTION_CACHE.set(buildTimestamp, seen);
+  }
+
   const record = await BUTTON_HEALTH_DATABASE.getCurrent(buildTimestamp);
   // `lastPollAtSeconds` is computed fresh from the polling history rather
   // than persisted in `buttonHealthCurrent` — this avoids ~17K Firestore
@@ -19,6 +19,12 @@ import { v4 as uuidv4 } from 'uuid';
 import * as functions from 'firebase-functions/v1';
 
 import { DATABASE as UpdateDatabase } from '../../database/UpdateDatabase';
+import { handleTravelDriftFromHeartbeat } from '../../controller/DoorTravelDriftUpdates';
+import {
+  decodeDeviceRequest,
+  encodeSensorResponse,
+  WIRE_CBOR_CONTENT_TYPE,
+} from '../../controller/DeviceWire';
 import { HTTP_RUNTIME_OPTS } from '../HttpRuntime';
 
 const SESSION_PARAM_KEY = "session";
@@ -28,12 +34,19 @@ const BUILD_TIMESTAMP_PARAM_KEY = "buildTimestamp";
  * Pure core — testable with plain object args. Handler-body extraction
  * per docs/archive/FIREBASE_HANDLER_TESTING_PLAN.md (Phase H1 pilot).
  *
- * Behavior is byte-identical to the pre-extraction inline code:
+ * Behavior follows the pre-extraction inline code:
  * - Builds the echo `data` payload from query + body.
  * - Uses the provided `session` query param, or generates a v4 UUID.
  * - Passes `buildTimestamp` through if present in the query.
  * - Saves to UpdateDatabase keyed by session, then returns the stored
- *   document read back from `getCurrent(session)`.
+ *   document read back from `getCurrent(session)`, without its body.
+ * - Alerts on newly raised door travel drift flags in the body, keyed by
+ *   `buildTimestamp` (see controller/DoorTravelDriftUpdates.ts). A failed
+ *   alert is logged and does not fail the heartbeat.
+ *
+ * The body is left out because the device only reads back the query params,
+ * and a heartbeat body carries its metrics and door travel histograms, which
+ * would overflow the firmware's receive buffer (HTTP_RECEIVE_BUFFER_SIZE).
  */
 export async function handleEchoRequest(input: {
   query: any;
@@ -61,19 +74,39 @@ export async function handleEchoRequest(input: {
   }
 
   await UpdateDatabase.save(session, data);
-  return UpdateDatabase.getCurrent(session);
+  try {
+    await handleTravelDriftFromHeartbeat(data[BUILD_TIMESTAMP_PARAM_KEY], input.body, Math.floor(Date.now() / 1000));
+  } catch (error) {
+    console.error('Door travel drift check failed', error);
+  }
+  const stored = { ...await UpdateDatabase.getCurrent(session) };
+  delete stored.body;
+  return stored;
 }
 
 /**
  * HTTP endpoint captures request parameters, stores them in the database, and returns the data.
+ *
+ * A CBOR body (Content-Type application/cbor, see controller/DeviceWire.ts)
+ * stands in for the query params and JSON body, and gets a CBOR response.
  */
 export const httpEcho = functions.runWith(HTTP_RUNTIME_OPTS).https.onRequest(async (request, response) => {
+  const cbor = !!request.is(WIRE_CBOR_CONTENT_TYPE);
+  let input: { query: any, body: any };
+  try {
+    input = cbor ? decodeDeviceRequest(request.rawBody) : { query: request.query, body: request.body };
+  } catch (error) {
+    console.error(error);
+    response.status(400).send({ error: 'Bad Request' });
+    return;
+  }
   try {
-    const result = await handleEchoRequest({
-      query: request.query,
-      body: request.body,
-    });
-    response.status(200).send(result);
+    const result = await handleEchoRequest(input);
+    if (cbor) {
+      response.status(200).type(WIRE_CBOR_CONTENT_TYPE).send(encodeSensorResponse(result));
+    } else {
+      response.status(200).send(result);
+    }
   }
   catch (error) {
     console.error(error);
@@ -21,13 +21,28 @@ import * as functions from 'firebase-functions/v1';
 
 import { DATABASE as ServerConfigDatabase } from '../../database/ServerConfigDatabase';
 import { isRemoteButtonEnabled, getRemoteButtonPushKey, getRemoteButtonAuthorizedEmails } from '../../controller/config/ConfigAccessors';
-import { DATABASE as REMOTE_BUTTON_COMMAND_DATABASE } from '../../database/RemoteButtonCommandDatabase';
-import { DATABASE as REMOTE_BUTTON_REQUEST_DATABASE } from '../../database/RemoteButtonRequestDatabase';
+import {
+  DATABASE as REMOTE_BUTTON_COMMAND_DATABASE,
+  CURRENT_CACHE as REMOTE_BUTTON_COMMAND_CACHE,
+} from '../../database/RemoteButtonCommandDatabase';
+import {
+  DATABASE as REMOTE_BUTTON_REQUEST_DATABASE,
+  POLL_LOG as REMOTE_BUTTON_POLL_LOG,
+} from '../../database/RemoteButtonRequestDatabase';
+import { ATTENTION_CACHE as BUTTON_ATTENTION_CACHE } from '../../database/ButtonAttentionDatabase';
+import { DATABASE as BUTTON_ACTUATION_DATABASE } from '../../database/ButtonActuationDatabase';
 import { isEmailInAllowlist } from '../../controller/Auth';
 import { SERVICE as AuthService } from '../../controller/AuthService';
+import {
+  decodeDeviceRequest,
+  encodeButtonResponse,
+  WIRE_CBOR_CONTENT_TYPE,
+} from '../../controller/DeviceWire';
+import { nextPollSeconds } from '../../controller/ButtonPollCadence';
+import { parseActuationReport } from '../../controller/ActuationReport';
 
 import { RemoteButtonCommand } from '../../model/RemoteButtonCommand';
-import { HandlerResult, ok, err } from '../HandlerResult';
+import { HandlerResult, ConditionalHandlerResult, ok, err, notModified } from '../HandlerResult';
 import { HTTP_RUNTIME_OPTS } from '../HttpRuntime';
 
 const DATABASE_TIMESTAMP_SECONDS_KEY = 'FIRESTORE_databaseTimestampSeconds';
@@ -35,6 +50,9 @@ const SESSION_PARAM_KEY = "session";
 const BUTTON_ACK_TOKEN_PARAM_KEY = "buttonAckToken";
 const BUILD_TIMESTAMP_PARAM_KEY = "buildTimestamp";
 const EMAIL_PARAM_KEY = "email";
+const CONDITIONAL_PARAM_KEY = "conditional";
+
+export const NEXT_POLL_HEADER = 'X-Next-Poll-Seconds';
 
 const REMOTE_BUTTON_MIN_PERIOD_SECONDS = 10;
 const REMOTE_BUTTON_COMMAND_TIMEOUT_SECONDS = 60;
@@ -49,23 +67,36 @@ const REMOTE_BUTTON_COMMAND_TIMEOUT_SECONDS = 60;
  *    as `undefined` (the empty `// Skip.` else branch is preserved so
  *    downstream `getCurrent(undefined)` calls produce the same logs
  *    as before).
- *  - Request is ALWAYS saved for logging, regardless of what branch
- *    the command state machine takes.
+ *  - Request is logged through REMOTE_BUTTON_POLL_LOG regardless of
+ *    what branch the command state machine takes. Identical polls are
+ *    saved at most every POLL_LOG_MIN_PERIOD_SECONDS, and the saved row
+ *    counts the skipped ones in `pollStats`. The save runs alongside the
+ *    command read; it is still awaited, because a v1 function may be
+ *    frozen as soon as the response is sent.
  *  - Ack-token state machine: saves a noop-command + returns the
  *    freshly re-read version (Firestore timestamps populated) when
  *    `shouldStopSendingRemoteButtonCommand && oldAckToken !== ''`;
  *    otherwise returns `oldCommand` directly (no save, no re-read).
  *    This asymmetry — return fresh on save-path, return pre-save
  *    on else-path — is intentional. Tests pin it.
+ *  - A poll body with an actuation report (see controller/ActuationReport.ts)
+ *    also saves it to BUTTON_ACTUATION_DATABASE, alongside the log save.
  *  - Any throw during the save/read sequence                → 500.
  *
+ * Conditional polls (`conditional=true`, sent by the ESP32 firmware): the
+ * command is read from REMOTE_BUTTON_COMMAND_CACHE instead of Firestore, and
+ * when nothing would change — no noop save and the command's ack token equals
+ * the client's `buttonAckToken` — the result is notModified (304, empty body).
+ * That is almost every poll. Polls without the flag behave as before.
+ *
  * No auth: the ESP32 polls this endpoint and has no credentials.
  */
 export async function handleRemoteButtonPoll(input: {
   query: any;
   body: any;
-}): Promise<HandlerResult<any>> {
-  const config = await ServerConfigDatabase.get();
+}): Promise<ConditionalHandlerResult<any>> {
+  // Every device poll starts here, so skip the Firestore read when the cache is fresh
+  const config = await ServerConfigDatabase.getCached();
   if (!isRemoteButtonEnabled(config)) {
     return err(400, { error: 'Disabled' });
   }
@@ -94,9 +125,28 @@ export async function handleRemoteButtonPoll(input: {
     // prior behavior.
   }
   const buildTimestamp = data[BUILD_TIMESTAMP_PARAM_KEY];
-  // Save the request. This is mostly for logging purposes.
-  await REMOTE_BUTTON_REQUEST_DATABASE.save(buildTimestamp, data);
-  const oldCommand = await REMOTE_BUTTON_COMMAND_DATABASE.getCurrent(buildTimestamp);
+  const conditional = input.query?.[CONDITIONAL_PARAM_KEY] === 'true' && typeof buildTimestamp === 'string';
+  // Save the request, mostly for logging and button health. Most polls are only counted.
+  const nowSeconds = firebase.firestore.Timestamp.now().seconds;
+  const pollLogRow = REMOTE_BUTTON_POLL_LOG.record(buildTimestamp, data, conditional, nowSeconds);
+  // The device polls right after a press to say whether the door moved
+  const actuation = typeof buildTimestamp === 'string' ? parseActuationReport(input.body) : null;
+  const [, oldCommand] = await Promise.all([
+    pollLogRow
+      ? REMOTE_BUTTON_REQUEST_DATABASE.save(buildTimestamp, pollLogRow)
+        .then(() => REMOTE_BUTTON_POLL_LOG.saved(buildTimestamp, pollLogRow))
+      : Promise.resolve(),
+    conditional
+      ? REMOTE_BUTTON_COMMAND_CACHE.get(buildTimestamp)
+      : REMOTE_BUTTON_COMMAND_DATABASE.getCurrent(buildTimestamp),
+    actuation
+      ? BUTTON_ACTUATION_DATABASE.save(buildTimestamp, {
+        ...actuation,
+        buttonAckToken: typeof buttonAckToken === 'string' ? buttonAckToken : null,
+        reportedAtSeconds: nowSeconds,
+      })
+      : Promise.resolve(),
+  ]);
   const oldAckToken = oldCommand?.[BUTTON_ACK_TOKEN_PARAM_KEY] ?? '';
   const timeSinceLastRemoteButtonCommandSeconds = oldCommand?.[DATABASE_TIMESTAMP_SECONDS_KEY]
     ? firebase.firestore.Timestamp.now().seconds - oldCommand[DATABASE_TIMESTAMP_SECONDS_KEY]
@@ -133,22 +183,74 @@ export async function handleRemoteButtonPoll(input: {
     // fields (FIRESTORE_databaseTimestampSeconds). The else branch below
     // returns `oldCommand` without a second read — preserve that split.
     const updatedCommand = await REMOTE_BUTTON_COMMAND_DATABASE.getCurrent(buildTimestamp);
+    REMOTE_BUTTON_COMMAND_CACHE.set(buildTimestamp, updatedCommand);
     return ok(updatedCommand);
   }
+  if (conditional && buttonAckToken === oldAckToken) {
+    return notModified();
+  }
   return ok(oldCommand);
 }
 
+/**
+ * When the device should poll again, for the NEXT_POLL_HEADER response header.
+ * Null without a buildTimestamp, or if a read fails: the device then keeps its
+ * default period, so the hint never fails a poll.
+ *
+ * Activity is the current command's timestamp (a command sent, acknowledged or
+ * timed out) and the last time the app was opened. Both come from snapshot-fed
+ * caches, so this adds no Firestore reads per poll.
+ */
+export async function remoteButtonNextPollSeconds(query: any): Promise<number | null> {
+  const buildTimestamp = query?.[BUILD_TIMESTAMP_PARAM_KEY];
+  if (typeof buildTimestamp !== 'string') {
+    return null;
+  }
+  try {
+    const [command, attention] = await Promise.all([
+      REMOTE_BUTTON_COMMAND_CACHE.get(buildTimestamp),
+      BUTTON_ATTENTION_CACHE.get(buildTimestamp),
+    ]);
+    return nextPollSeconds(firebase.firestore.Timestamp.now().seconds, [
+      command?.[DATABASE_TIMESTAMP_SECONDS_KEY],
+      attention?.seenAtSeconds,
+    ]);
+  } catch (error) {
+    console.warn('Failed to pick the next poll period:', error);
+    return null;
+  }
+}
+
 /**
  * curl -H "Content-Type: application/json" http://localhost:5000/PROJECT-ID/us-central1/remoteButton?buildTimestamp=buildTimestamp&buttonAckToken=buttonAckToken
+ *
+ * A CBOR body (Content-Type application/cbor, see controller/DeviceWire.ts)
+ * stands in for the query params and JSON body, and a command gets a CBOR response.
  */
 export const httpRemoteButton = functions.runWith(HTTP_RUNTIME_OPTS).https.onRequest(async (request, response) => {
+  const cbor = !!request.is(WIRE_CBOR_CONTENT_TYPE);
+  let input: { query: any, body: any };
   try {
-    const result = await handleRemoteButtonPoll({
-      query: request.query,
-      body: request.body,
-    });
+    input = cbor ? decodeDeviceRequest(request.rawBody) : { query: request.query, body: request.body };
+  } catch (error) {
+    console.error(error);
+    response.status(400).send({ error: 'Bad Request' });
+    return;
+  }
+  try {
+    const result = await handleRemoteButtonPoll(input);
+    if (result.kind !== 'error') {
+      const nextPoll = await remoteButtonNextPollSeconds(input.query);
+      if (nextPoll !== null) {
+        response.set(NEXT_POLL_HEADER, String(nextPoll));
+      }
+    }
     if (result.kind === 'error') {
       response.status(result.status).send(result.body);
+    } else if (result.kind === 'notModified') {
+      response.status(304).end();
+    } else if (cbor) {
+      response.status(200).type(WIRE_CBOR_CONTENT_TYPE).send(encodeButtonResponse(result.data));
     } else {
       response.status(200).send(result.data);
     }
@@ -277,6 +379,8 @@ export async function handleAddRemoteButtonCommand(input: {
   // pre-extraction `save(undefined, data)` side effect.
   await REMOTE_BUTTON_COMMAND_DATABASE.save(buildTimestamp, data);
   const updatedCommand = await REMOTE_BUTTON_COMMAND_DATABASE.getCurrent(buildTimestamp);
+  // The snapshot listener would catch up too, but this instance can answer the next poll now.
+  REMOTE_BUTTON_COMMAND_CACHE.set(buildTimestamp, updatedCommand);
   return pendingErrorResponse ?? ok(updatedCommand);
 }
 
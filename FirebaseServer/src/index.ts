@@ -89,7 +89,8 @@ if (!process.env.FUNCTION_NAME || process.env.FUNCTION_NAME === 'updateEvents')
  *
  * Trigger Type: Firestore (onWrite on remoteButtonRequestAll/{docId})
  *
- * Fires after every device poll. Computes the new health state from
+ * Fires after every saved device poll: on any change, and at least every
+ * POLL_LOG_MIN_PERIOD_SECONDS while the device polls. Computes the new health state from
  * the latest poll timestamp and persists + sends a data-only FCM only
  * on transitions. Provably cannot affect the device path — runs
  * asynchronously after the device's HTTP response is on the wire.
@@ -0,0 +1,42 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+import { expect } from 'chai';
+
+import { parseActuationReport } from '../../src/controller/ActuationReport';
+
+describe('parseActuationReport', () => {
+  it('reads motion', () => {
+    const body = { actuation_result: 1, actuation_latency_ms: 740, actuation_attempts: 1 };
+    expect(parseActuationReport(body)).to.deep.equal({ result: 'MOTION', latencyMillis: 740, attempts: 1 });
+  });
+
+  it('reads no motion after a retry', () => {
+    const body = { actuation_result: 2, actuation_latency_ms: 5000, actuation_attempts: 2 };
+    expect(parseActuationReport(body)).to.deep.equal({ result: 'NO_MOTION', latencyMillis: 5000, attempts: 2 });
+  });
+
+  it('is null for a poll without a report', () => {
+    expect(parseActuationReport({})).to.be.null;
+    expect(parseActuationReport({ local_press_count: 1 })).to.be.null;
+    expect(parseActuationReport(undefined)).to.be.null;
+  });
+
+  it('is null for malformed fields', () => {
+    const valid = { actuation_result: 1, actuation_latency_ms: 740, actuation_attempts: 1 };
+    expect(parseActuationReport({ ...valid, actuation_result: 0 })).to.be.null;
+    expect(parseActuationReport({ ...valid, actuation_result: 3 })).to.be.null;
+    expect(parseActuationReport({ ...valid, actuation_result: '1' })).to.be.null;
+    expect(parseActuationReport({ ...valid, actuation_latency_ms: -1 })).to.be.null;
+    expect(parseActuationReport({ ...valid, actuation_latency_ms: 1.5 })).to.be.null;
+    expect(parseActuationReport({ ...valid, actuation_attempts: 0 })).to.be.null;
+    expect(parseActuationReport({ ...valid, actuation_attempts: undefined })).to.be.null;
+  });
+});
@@ -0,0 +1,84 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+import { expect } from 'chai';
+
+import {
+  ACTIVE_POLL_SECONDS,
+  ACTIVE_WINDOW_SECONDS,
+  IDLE_POLL_SECONDS,
+  nextPollSeconds,
+  RECENT_POLL_SECONDS,
+  RECENT_WINDOW_SECONDS,
+} from '../../src/controller/ButtonPollCadence';
+import { ONLINE_THRESHOLD_SEC } from '../../src/controller/ButtonHealthInterpreter';
+import { PollLogCoalescer } from '../../src/database/PollLogCoalescer';
+import { POLL_LOG_MIN_PERIOD_SECONDS } from '../../src/database/RemoteButtonRequestDatabase';
+
+const NOW = 1_800_000_000;
+
+describe('nextPollSeconds', () => {
+  it('idles without any activity', () => {
+    expect(nextPollSeconds(NOW, [])).to.equal(IDLE_POLL_SECONDS);
+    expect(nextPollSeconds(NOW, [null, undefined])).to.equal(IDLE_POLL_SECONDS);
+  });
+
+  it('polls fast right after activity', () => {
+    expect(nextPollSeconds(NOW, [NOW])).to.equal(ACTIVE_POLL_SECONDS);
+    expect(nextPollSeconds(NOW, [NOW - ACTIVE_WINDOW_SECONDS + 1])).to.equal(ACTIVE_POLL_SECONDS);
+  });
+
+  it('steps down to the recent period, then idles', () => {
+    expect(nextPollSeconds(NOW, [NOW - ACTIVE_WINDOW_SECONDS])).to.equal(RECENT_POLL_SECONDS);
+    expect(nextPollSeconds(NOW, [NOW - RECENT_WINDOW_SECONDS + 1])).to.equal(RECENT_POLL_SECONDS);
+    expect(nextPollSeconds(NOW, [NOW - RECENT_WINDOW_SECONDS])).to.equal(IDLE_POLL_SECONDS);
+  });
+
+  it('uses the latest activity', () => {
+    expect(nextPollSeconds(NOW, [NOW - RECENT_WINDOW_SECONDS, null, NOW - 10])).to.equal(ACTIVE_POLL_SECONDS);
+  });
+
+  it('idles fast enough to keep button health ONLINE after a lost poll', () => {
+    expect(IDLE_POLL_SECONDS * 2).to.be.at.most(ONLINE_THRESHOLD_SEC);
+  });
+
+  it('keeps the saved poll fresh enough for button health with the poll log and one lost poll', () => {
+    // Idle polls through the real poll log. Network delays move each poll up to
+    // JITTER_SECONDS either way, and one poll never arrives.
+    const JITTER_SECONDS = 2;
+    const LOST_POLL = 5;
+    const log = new PollLogCoalescer(POLL_LOG_MIN_PERIOD_SECONDS);
+    const data = { queryParams: { buildTimestamp: 'b', buttonAckToken: '' }, body: {} };
+    let lastSaveSeconds = NOW;
+    let worstAgeSeconds = 0;
+    log.saved('b', log.record('b', data, true, NOW));
+    for (let i = 1; i <= 20; i++) {
+      if (i === LOST_POLL) {
+        continue;
+      }
+      // Alternating early and late, and worst around the lost poll: early before, late after
+      const late = i === LOST_POLL + 1 || (i !== LOST_POLL - 1 && i % 2 === 0);
+      const jitter = late ? JITTER_SECONDS : -JITTER_SECONDS;
+      const pollSeconds = NOW + i * IDLE_POLL_SECONDS + jitter;
+      const row = log.record('b', data, true, pollSeconds);
+      if (row !== null) {
+        log.saved('b', row);
+        worstAgeSeconds = Math.max(worstAgeSeconds, pollSeconds - lastSaveSeconds);
+        lastSaveSeconds = pollSeconds;
+      }
+    }
+
+    // Every idle poll clears the poll log period, so only the lost poll widens a gap
+    expect(POLL_LOG_MIN_PERIOD_SECONDS).to.be.at.most(IDLE_POLL_SECONDS - 2 * JITTER_SECONDS);
+    expect(worstAgeSeconds).to.equal(2 * IDLE_POLL_SECONDS + 2 * JITTER_SECONDS);
+    // The saved poll is at most this old just before the next save
+    expect(worstAgeSeconds).to.be.at.most(ONLINE_THRESHOLD_SEC);
+  });
+});
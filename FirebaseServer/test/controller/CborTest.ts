@@ -0,0 +1,97 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import { expect } from 'chai';
+
+import { CborError, decodeCbor, encodeCbor, MAX_CBOR_DEPTH } from '../../src/controller/Cbor';
+
+function hex(bytes: Uint8Array): string {
+  return Buffer.from(bytes).toString('hex');
+}
+
+function bytes(hexString: string): Buffer {
+  return Buffer.from(hexString, 'hex');
+}
+
+describe('Cbor', () => {
+  // RFC 8949 Appendix A
+  const VECTORS: [any, string][] = [
+    [0, '00'],
+    [23, '17'],
+    [24, '1818'],
+    [1000, '1903e8'],
+    [1000000, '1a000f4240'],
+    [1000000000000, '1b000000e8d4a51000'],
+    [-1, '20'],
+    [-1000, '3903e7'],
+    ['', '60'],
+    ['IETF', '6449455446'],
+    ['ü', '62c3bc'],
+    [false, 'f4'],
+    [true, 'f5'],
+    [null, 'f6'],
+    [[1, [2, 3], [4, 5]], '8301820203820405'],
+  ];
+
+  it('encodes and decodes the RFC 8949 examples', () => {
+    for (const [value, expected] of VECTORS) {
+      expect(hex(encodeCbor(value))).to.equal(expected);
+      expect(decodeCbor(bytes(expected))).to.deep.equal(value);
+    }
+  });
+
+  it('decodes maps with integer keys', () => {
+    const map = decodeCbor(bytes('a201020304'));
+    expect(map).to.be.instanceOf(Map);
+    expect(Array.from((map as Map<any, any>).entries())).to.deep.equal([[1, 2], [3, 4]]);
+    expect(hex(encodeCbor(new Map([[1, 'a']])))).to.equal('a1016161');
+  });
+
+  it('round-trips byte strings', () => {
+    expect(decodeCbor(bytes('4401020304'))).to.deep.equal(Uint8Array.from([1, 2, 3, 4]));
+    expect(hex(encodeCbor(Uint8Array.from([1, 2])))).to.equal('420102');
+  });
+
+  it('rejects what devices never send', () => {
+    const rejected = [
+      'bf', // indefinite map
+      '9f', // indefinite array
+      'f93c00', // half float
+      'c074', // tag
+      '1c', // reserved additional info
+      '1b0020000000000000', // past 2^53
+    ];
+    for (const message of rejected) {
+      expect(() => decodeCbor(bytes(message)), message).to.throw(CborError);
+    }
+  });
+
+  it('rejects truncated and trailing bytes', () => {
+    expect(() => decodeCbor(bytes('61'))).to.throw(CborError);
+    expect(() => decodeCbor(bytes('a1'))).to.throw(CborError);
+    expect(() => decodeCbor(bytes('7801'))).to.throw(CborError);
+    expect(() => decodeCbor(bytes('00ff'))).to.throw(CborError);
+  });
+
+  it('limits nesting', () => {
+    expect(() => decodeCbor(bytes('81'.repeat(MAX_CBOR_DEPTH + 1) + '00'))).to.throw(CborError);
+    expect(decodeCbor(bytes('81'.repeat(MAX_CBOR_DEPTH) + '00'))).to.be.an('array');
+  });
+
+  it('only encodes integers', () => {
+    expect(() => encodeCbor(1.5)).to.throw(CborError);
+  });
+});
@@ -0,0 +1,67 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import { expect } from 'chai';
+
+import {
+  deviceEventTimestampSeconds,
+  MAX_CLOCK_AHEAD_SECONDS,
+  MAX_EVENT_AGE_SECONDS,
+} from '../../src/controller/DeviceEventTime';
+
+const ARRIVAL = 1_700_000_000;
+
+describe('deviceEventTimestampSeconds', () => {
+  it('returns null without params', () => {
+    expect(deviceEventTimestampSeconds(undefined, ARRIVAL)).to.be.null;
+    expect(deviceEventTimestampSeconds({}, ARRIVAL)).to.be.null;
+  });
+
+  it('uses the device wall clock', () => {
+    const params = { eventTimestampMillis: String((ARRIVAL - 30) * 1000 + 999) };
+    expect(deviceEventTimestampSeconds(params, ARRIVAL)).to.equal(ARRIVAL - 30);
+  });
+
+  it('prefers the wall clock over the age', () => {
+    const params = { eventTimestampMillis: String((ARRIVAL - 30) * 1000), eventAgeMillis: '5000' };
+    expect(deviceEventTimestampSeconds(params, ARRIVAL)).to.equal(ARRIVAL - 30);
+  });
+
+  it('subtracts the age from the arrival time', () => {
+    expect(deviceEventTimestampSeconds({ eventAgeMillis: '90500' }, ARRIVAL)).to.equal(ARRIVAL - 90);
+    expect(deviceEventTimestampSeconds({ eventAgeMillis: 0 }, ARRIVAL)).to.equal(ARRIVAL);
+  });
+
+  it('never returns a time after arrival', () => {
+    const params = { eventTimestampMillis: String((ARRIVAL + MAX_CLOCK_AHEAD_SECONDS) * 1000) };
+    expect(deviceEventTimestampSeconds(params, ARRIVAL)).to.equal(ARRIVAL);
+  });
+
+  it('falls back to the age when the wall clock is out of bounds', () => {
+    const ahead = { eventTimestampMillis: String((ARRIVAL + MAX_CLOCK_AHEAD_SECONDS + 1) * 1000), eventAgeMillis: '2000' };
+    expect(deviceEventTimestampSeconds(ahead, ARRIVAL)).to.equal(ARRIVAL - 2);
+    const unsynced = { eventTimestampMillis: '12000', eventAgeMillis: '2000' };
+    expect(deviceEventTimestampSeconds(unsynced, ARRIVAL)).to.equal(ARRIVAL - 2);
+  });
+
+  it('ignores values that are too old or malformed', () => {
+    expect(deviceEventTimestampSeconds({ eventAgeMillis: String((MAX_EVENT_AGE_SECONDS + 1) * 1000) }, ARRIVAL)).to.be.null;
+    expect(deviceEventTimestampSeconds({ eventAgeMillis: '-5' }, ARRIVAL)).to.be.null;
+    expect(deviceEventTimestampSeconds({ eventAgeMillis: '1e3' }, ARRIVAL)).to.be.null;
+    expect(deviceEventTimestampSeconds({ eventTimestampMillis: 'soon' }, ARRIVAL)).to.be.null;
+    expect(deviceEventTimestampSeconds({ eventAgeMillis: ['1000'] }, ARRIVAL)).to.be.null;
+  });
+});
@@ -0,0 +1,92 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import { expect } from 'chai';
+import * as fs from 'fs';
+import * as path from 'path';
+
+import { CborError } from '../../src/controller/Cbor';
+import {
+  decodeDeviceRequest,
+  encodeButtonResponse,
+  encodeSensorResponse,
+} from '../../src/controller/DeviceWire';
+
+// The request fixtures hold bytes encoded by the ESP32 firmware's wire_cbor component
+const FIXTURE_ROOT = path.join(__dirname, '..', '..', '..', 'wire-contracts');
+
+function fixture(endpoint: string, name: string): any {
+  return JSON.parse(fs.readFileSync(path.join(FIXTURE_ROOT, endpoint, name), 'utf8'));
+}
+
+function bytes(hexString: string): Buffer {
+  return Buffer.from(hexString, 'hex');
+}
+
+describe('DeviceWire', () => {
+  const REQUESTS: [string, string][] = [
+    ['echo', 'cbor_request_sensor.json'],
+    ['echo', 'cbor_request_sensor_unsynced.json'],
+    ['echo', 'cbor_request_sensor_heartbeat.json'],
+    ['remoteButton', 'cbor_request_poll.json'],
+    ['remoteButton', 'cbor_request_poll_local_press.json'],
+    ['remoteButton', 'cbor_request_poll_actuation.json'],
+  ];
+
+  it('decodes device requests into the JSON query and body', () => {
+    for (const [endpoint, name] of REQUESTS) {
+      const { cborHex, query, body } = fixture(endpoint, name);
+      expect(decodeDeviceRequest(bytes(cborHex)), name).to.deep.equal({ query, body });
+    }
+  });
+
+  it('encodes the sensor response', () => {
+    const { stored, cborHex } = fixture('echo', 'cbor_response_sensor.json');
+    expect(encodeSensorResponse(stored).toString('hex')).to.equal(cborHex);
+  });
+
+  it('encodes the button response', () => {
+    for (const name of ['cbor_response_command.json', 'cbor_response_no_command.json']) {
+      const { command, cborHex } = fixture('remoteButton', name);
+      expect(encodeButtonResponse(command).toString('hex'), name).to.equal(cborHex);
+    }
+  });
+
+  it('skips unknown keys', () => {
+    // {1: "id", 99: [1], "x": 2}
+    const request = decodeDeviceRequest(bytes('a30162696418638101617802'));
+    expect(request).to.deep.equal({ query: { buildTimestamp: 'id' }, body: {} });
+  });
+
+  it('rejects a value of the wrong type', () => {
+    // {1: 1}
+    expect(() => decodeDeviceRequest(bytes('a10101'))).to.throw(CborError);
+    // {2: "0"}
+    expect(() => decodeDeviceRequest(bytes('a1026130'))).to.throw(CborError);
+    // {12: ["x"]}
+    expect(() => decodeDeviceRequest(bytes('a10c816178'))).to.throw(CborError);
+  });
+
+  it('rejects a message that is not a map', () => {
+    expect(() => decodeDeviceRequest(bytes('80'))).to.throw(CborError);
+  });
+
+  it('leaves out sensor values that are not integers', () => {
+    const response = encodeSensorResponse({ queryParams: { buildTimestamp: 'id', sensorA: 'x' } });
+    // {1: "id"}
+    expect(response.toString('hex')).to.equal('a101626964');
+  });
+});
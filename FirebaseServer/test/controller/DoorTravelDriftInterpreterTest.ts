@@ -0,0 +1,51 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+import { expect } from 'chai';
+
+import { newlyDriftedKinds, parseTravelDrift } from '../../src/controller/DoorTravelDriftInterpreter';
+
+describe('parseTravelDrift', () => {
+  it('reads the flags and the medians in door_travel_kind_t order', () => {
+    const drift = parseTravelDrift({ travel_drift: 5, travel_median_ms: [12000, 11500, 400] });
+    expect(drift).to.deep.equal({ driftFlags: 5, medianMillis: [12000, 11500, 400] });
+  });
+
+  it('returns null for a heartbeat without travel_drift', () => {
+    expect(parseTravelDrift({ metrics_counters: [1, 2] })).to.equal(null);
+    expect(parseTravelDrift(undefined)).to.equal(null);
+  });
+
+  it('returns null for flags that are not a non-negative integer', () => {
+    expect(parseTravelDrift({ travel_drift: '1' })).to.equal(null);
+    expect(parseTravelDrift({ travel_drift: 1.5 })).to.equal(null);
+    expect(parseTravelDrift({ travel_drift: -1 })).to.equal(null);
+  });
+
+  it('leaves out medians the heartbeat did not carry', () => {
+    const drift = parseTravelDrift({ travel_drift: 1, travel_median_ms: [12000] });
+    expect(drift?.medianMillis).to.deep.equal([12000, null, null]);
+  });
+});
+
+describe('newlyDriftedKinds', () => {
+  it('maps bits 0, 1 and 2 to OPEN, CLOSE and PRESS_DELAY', () => {
+    expect(newlyDriftedKinds(0, 7)).to.deep.equal(['OPEN', 'CLOSE', 'PRESS_DELAY']);
+  });
+
+  it('ignores bits that were already set', () => {
+    expect(newlyDriftedKinds(1, 3)).to.deep.equal(['CLOSE']);
+    expect(newlyDriftedKinds(3, 3)).to.deep.equal([]);
+  });
+
+  it('reports nothing when a flag clears', () => {
+    expect(newlyDriftedKinds(2, 0)).to.deep.equal([]);
+  });
+});
@@ -0,0 +1,100 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+import { expect } from 'chai';
+
+import { handleTravelDriftFromHeartbeat } from '../../src/controller/DoorTravelDriftUpdates';
+import {
+  setImpl as setDoorTravelDriftDBImpl,
+  resetImpl as resetDoorTravelDriftDBImpl,
+} from '../../src/database/DoorTravelDriftDatabase';
+import {
+  setImpl as setDoorTravelDriftFCMImpl,
+  resetImpl as resetDoorTravelDriftFCMImpl,
+} from '../../src/controller/fcm/DoorTravelDriftFCM';
+import { FakeDoorTravelDriftDatabase } from '../fakes/FakeDoorTravelDriftDatabase';
+import { FakeDoorTravelDriftFCMService } from '../fakes/FakeDoorTravelDriftFCMService';
+
+const BUILD_TIMESTAMP = 'Sat Apr 10 23:57:32 2021';
+const NOW_SECONDS = 1_730_000_000;
+
+describe('handleTravelDriftFromHeartbeat', () => {
+  let driftDB: FakeDoorTravelDriftDatabase;
+  let fcm: FakeDoorTravelDriftFCMService;
+
+  beforeEach(() => {
+    driftDB = new FakeDoorTravelDriftDatabase();
+    fcm = new FakeDoorTravelDriftFCMService();
+    setDoorTravelDriftDBImpl(driftDB);
+    setDoorTravelDriftFCMImpl(fcm);
+  });
+
+  afterEach(() => {
+    resetDoorTravelDriftDBImpl();
+    resetDoorTravelDriftFCMImpl();
+  });
+
+  it('notifies and saves the flags when a kind starts drifting', async () => {
+    const body = { travel_drift: 2, travel_median_ms: [12000, 11500, 400] };
+
+    await handleTravelDriftFromHeartbeat(BUILD_TIMESTAMP, body, NOW_SECONDS);
+
+    expect(driftDB.saved).to.deep.equal([
+      [BUILD_TIMESTAMP, { driftFlags: 2, changedAtSeconds: NOW_SECONDS }],
+    ]);
+    expect(fcm.sends).to.deep.equal([
+      { buildTimestamp: BUILD_TIMESTAMP, kinds: ['CLOSE'], medianMillis: [12000, 11500, 400] },
+    ]);
+  });
+
+  it('does not notify again while the flag stays set', async () => {
+    driftDB.seed(BUILD_TIMESTAMP, { driftFlags: 2, changedAtSeconds: NOW_SECONDS - 600 });
+
+    await handleTravelDriftFromHeartbeat(BUILD_TIMESTAMP, { travel_drift: 2 }, NOW_SECONDS);
+
+    expect(driftDB.saved).to.have.lengthOf(0);
+    expect(fcm.sends).to.have.lengthOf(0);
+  });
+
+  it('notifies only for the newly raised kind', async () => {
+    driftDB.seed(BUILD_TIMESTAMP, { driftFlags: 2, changedAtSeconds: NOW_SECONDS - 600 });
+
+    await handleTravelDriftFromHeartbeat(BUILD_TIMESTAMP, { travel_drift: 3 }, NOW_SECONDS);
+
+    expect(fcm.sends.map((send) => send.kinds)).to.deep.equal([['OPEN']]);
+    expect(driftDB.saved[0][1].driftFlags).to.equal(3);
+  });
+
+  it('saves a cleared flag without notifying, so the next rise notifies', async () => {
+    driftDB.seed(BUILD_TIMESTAMP, { driftFlags: 1, changedAtSeconds: NOW_SECONDS - 600 });
+
+    await handleTravelDriftFromHeartbeat(BUILD_TIMESTAMP, { travel_drift: 0 }, NOW_SECONDS);
+    expect(fcm.sends).to.have.lengthOf(0);
+    expect(driftDB.saved[0][1].driftFlags).to.equal(0);
+
+    await handleTravelDriftFromHeartbeat(BUILD_TIMESTAMP, { travel_drift: 1 }, NOW_SECONDS + 60);
+    expect(fcm.sends.map((send) => send.kinds)).to.deep.equal([['OPEN']]);
+  });
+
+  it('writes nothing for a device that has never drifted', async () => {
+    await handleTravelDriftFromHeartbeat(BUILD_TIMESTAMP, { travel_drift: 0 }, NOW_SECONDS);
+
+    expect(driftDB.saved).to.have.lengthOf(0);
+    expect(fcm.sends).to.have.lengthOf(0);
+  });
+
+  it('ignores heartbeats without travel_drift or without a buildTimestamp', async () => {
+    await handleTravelDriftFromHeartbeat(BUILD_TIMESTAMP, { sensorA: 1 }, NOW_SECONDS);
+    await handleTravelDriftFromHeartbeat(undefined, { travel_drift: 1 }, NOW_SECONDS);
+
+    expect(driftDB.saved).to.have.lengthOf(0);
+    expect(fcm.sends).to.have.lengthOf(0);
+  });
+});
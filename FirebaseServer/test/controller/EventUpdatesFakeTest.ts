@@ -136,6 +136,56 @@ describe('EventUpdates (via fakes)', () => {
     expect(fakeFCM.sends[0]).to.deep.equal({ buildTimestamp: 'test', event: newEvent });
   });
 
+  describe('event time', () => {
+    const ARRIVAL = 1_700_000_000;
+
+    it('dates a new event by the device capture time', async () => {
+      const newEvent: SensorEvent = {
+        type: SensorEventType.Closed, timestampSeconds: ARRIVAL - 45, message: '', checkInTimestampSeconds: 0,
+      };
+      const stub = sinon.stub(EventInterpreter, 'getNewEventOrNull').returns(newEvent);
+
+      await updateEvent({
+        buildTimestamp: 'test',
+        FIRESTORE_databaseTimestampSeconds: ARRIVAL,
+        queryParams: { sensorA: '0', sensorB: '1', eventAgeMillis: '45000' },
+      }, false);
+
+      expect(stub.calledOnce).to.be.true;
+      expect(stub.firstCall.args[2]).to.equal(ARRIVAL - 45);
+    });
+
+    it('keeps events in order when the device time is before the current event', async () => {
+      const oldEvent: SensorEvent = {
+        type: SensorEventType.Closed, timestampSeconds: ARRIVAL - 10, message: '', checkInTimestampSeconds: 0,
+      };
+      fakeDB.seed('test', { currentEvent: oldEvent });
+      const stub = sinon.stub(EventInterpreter, 'getNewEventOrNull').returns(null);
+
+      await updateEvent({
+        buildTimestamp: 'test',
+        FIRESTORE_databaseTimestampSeconds: ARRIVAL,
+        queryParams: { eventAgeMillis: '60000' },
+      }, false);
+
+      expect(stub.firstCall.args[2]).to.equal(ARRIVAL - 10);
+      // The check-in is when the server heard from the device, not the capture time.
+      expect(oldEvent.checkInTimestampSeconds).to.be.greaterThan(ARRIVAL);
+    });
+
+    it('uses the clock for scheduled checks', async () => {
+      const stub = sinon.stub(EventInterpreter, 'getNewEventOrNull').returns(null);
+
+      await updateEvent({
+        buildTimestamp: 'test',
+        FIRESTORE_databaseTimestampSeconds: ARRIVAL,
+        queryParams: { eventAgeMillis: '45000' },
+      }, true);
+
+      expect(stub.firstCall.args[2]).to.be.greaterThan(ARRIVAL);
+    });
+  });
+
   // --- Failure-mode tests: updateEvent has no try/catch, so any step that
   //     throws propagates immediately. These tests document and pin that
   //     contract: errors are NOT silently swallowed, and later steps are
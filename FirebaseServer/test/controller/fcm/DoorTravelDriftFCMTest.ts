@@ -0,0 +1,40 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+import { expect } from 'chai';
+
+import { buildDriftMessage } from '../../../src/controller/fcm/DoorTravelDriftFCM';
+import { AndroidMessagePriority } from '../../../src/model/FCM';
+
+describe('buildDriftMessage', () => {
+  const buildTimestamp = 'Sat Apr 10 23:57:32 2021';
+
+  it('sends a user-visible notification on the legacy door topic', () => {
+    const message = buildDriftMessage(buildTimestamp, ['OPEN'], [12000, 11500, 400]);
+    expect(message.topic).to.equal('door_open-Sat.Apr.10.23.57.32.2021');
+    expect(message.notification.title).to.equal('Door travel time changed');
+    expect(message.android.collapse_key).to.equal('door_travel_drift');
+    expect(message.android.priority).to.equal(AndroidMessagePriority.HIGH);
+  });
+
+  it('names each drifting kind with its usual time', () => {
+    const message = buildDriftMessage(buildTimestamp, ['CLOSE', 'PRESS_DELAY'], [12000, 11500, 400]);
+    expect(message.notification.body).to.equal(
+      'Closing is taking a different time than usual (usually 11.5 s).'
+      + ' The delay after a button press is taking a different time than usual (usually 0.4 s).'
+      + ' The opener or springs may need a look.');
+  });
+
+  it('leaves out a median the heartbeat did not carry', () => {
+    const message = buildDriftMessage(buildTimestamp, ['OPEN'], [null, null, null]);
+    expect(message.notification.body).to.equal(
+      'Opening is taking a different time than usual. The opener or springs may need a look.');
+  });
+});
@@ -0,0 +1,26 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+import { expect } from 'chai';
+import { COLLECTION_CURRENT } from '../../src/database/ButtonActuationDatabase';
+
+describe('ButtonActuationDatabase: collection-name contract', () => {
+  // This string MUST match what httpRemoteButton writes and the apps read.
+  // A mismatch means presses stop being confirmed.
+  //
+  // Intentional change requires a full data migration:
+  //   1. Copy documents from old collection to new in production.
+  //   2. Update this test.
+  //   3. Deploy atomically.
+
+  it('current collection is pinned', () => {
+    expect(COLLECTION_CURRENT).to.equal('buttonActuationCurrent');
+  });
+});
@@ -0,0 +1,27 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+import { expect } from 'chai';
+import { COLLECTION_CURRENT } from '../../src/database/ButtonAttentionDatabase';
+
+describe('ButtonAttentionDatabase: collection-name contract', () => {
+  // This string MUST match what httpButtonHealth writes and httpRemoteButton
+  // reads. A mismatch means the device never hears that the app is open and
+  // keeps polling at the idle period.
+  //
+  // Intentional change requires a full data migration:
+  //   1. Copy documents from old collection to new in production.
+  //   2. Update this test.
+  //   3. Deploy atomically.
+
+  it('current collection is pinned', () => {
+    expect(COLLECTION_CURRENT).to.equal('buttonAttentionCurrent');
+  });
+});
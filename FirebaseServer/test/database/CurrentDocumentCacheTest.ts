@@ -0,0 +1,128 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+import { expect } from 'chai';
+import * as sinon from 'sinon';
+import * as firebase from 'firebase-admin';
+
+import { CurrentDocumentCache, CurrentDocumentSource } from '../../src/database/CurrentDocumentCache';
+
+const MAX_AGE_SECONDS = 60;
+
+/** Source with one document per key, a read counter and controllable listeners. */
+class FakeSource implements CurrentDocumentSource {
+  readonly docs = new Map<string, any>();
+  reads = 0;
+  readonly listeners: Array<{ key: string, onChange: (data: any) => void, onError: (error: Error) => void, active: boolean }> = [];
+
+  async getCurrent(key: string): Promise<any> {
+    this.reads++;
+    return this.docs.get(key) ?? null;
+  }
+
+  watchCurrent(key: string, onChange: (data: any) => void, onError: (error: Error) => void): () => void {
+    const listener = { key, onChange, onError, active: true };
+    this.listeners.push(listener);
+    return () => { listener.active = false; };
+  }
+
+  write(key: string, data: any): void {
+    this.docs.set(key, data);
+    this.listeners.filter((l) => l.active && l.key === key).forEach((l) => l.onChange(data));
+  }
+
+  activeListeners(): number {
+    return this.listeners.filter((l) => l.active).length;
+  }
+}
+
+describe('CurrentDocumentCache', () => {
+  let nowSeconds: number;
+  let source: FakeSource;
+  let cache: CurrentDocumentCache;
+
+  beforeEach(() => {
+    nowSeconds = 1_800_000_000;
+    sinon.stub(firebase.firestore.Timestamp, 'now').callsFake(
+      () => new firebase.firestore.Timestamp(nowSeconds, 0),
+    );
+    source = new FakeSource();
+    source.docs.set('a', { value: 1 });
+    cache = new CurrentDocumentCache('test', source, MAX_AGE_SECONDS);
+  });
+
+  afterEach(() => {
+    cache.clear();
+    sinon.restore();
+  });
+
+  it('reads once and listens for changes', async () => {
+    expect(await cache.get('a')).to.deep.equal({ value: 1 });
+    expect(await cache.get('a')).to.deep.equal({ value: 1 });
+
+    expect(source.reads).to.equal(1);
+    expect(source.activeListeners()).to.equal(1);
+    expect(cache.stats()).to.deep.equal({ hits: 1, misses: 1 });
+  });
+
+  it('picks up writes from the listener without reading', async () => {
+    await cache.get('a');
+    source.write('a', { value: 2 });
+
+    expect(await cache.get('a')).to.deep.equal({ value: 2 });
+    expect(source.reads).to.equal(1);
+  });
+
+  it('reads again after maxAgeSeconds without a change, keeping one listener', async () => {
+    await cache.get('a');
+    nowSeconds += MAX_AGE_SECONDS;
+    source.docs.set('a', { value: 3 }); // Missed by the listener
+
+    expect(await cache.get('a')).to.deep.equal({ value: 3 });
+    expect(source.reads).to.equal(2);
+    expect(source.activeListeners()).to.equal(1);
+  });
+
+  it('drops the entry when the listener fails', async () => {
+    await cache.get('a');
+    source.listeners[0].onError(new Error('stream closed'));
+
+    await cache.get('a');
+    expect(source.reads).to.equal(2);
+    expect(source.listeners[0].active).to.equal(false);
+    expect(source.activeListeners()).to.equal(1);
+  });
+
+  it('set() stores a local write and starts a listener for a new key', async () => {
+    cache.set('b', { value: 'saved' });
+
+    expect(await cache.get('b')).to.deep.equal({ value: 'saved' });
+    expect(source.reads).to.equal(0);
+    expect(source.activeListeners()).to.equal(1);
+  });
+
+  it('invalidate() makes the next get() read and listen again', async () => {
+    await cache.get('a');
+    cache.invalidate('a');
+    await cache.get('a');
+
+    expect(source.reads).to.equal(2);
+    expect(source.activeListeners()).to.equal(1);
+  });
+
+  it('clear() stops the listeners and resets the stats', async () => {
+    await cache.get('a');
+    await cache.get('a');
+    cache.clear();
+
+    expect(source.activeListeners()).to.equal(0);
+    expect(cache.stats()).to.deep.equal({ hits: 0, misses: 0 });
+  });
+});
@@ -0,0 +1,21 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+import { expect } from 'chai';
+import { COLLECTION_CURRENT } from '../../src/database/DoorTravelDriftDatabase';
+
+describe('DoorTravelDriftDatabase: collection-name contract', () => {
+  // Holds the last drift flags seen per device, so a heartbeat only
+  // notifies when a flag is newly raised. Renaming it loses that state
+  // and re-sends the notification for every door that is still drifting.
+  it('current collection is pinned', () => {
+    expect(COLLECTION_CURRENT).to.equal('doorTravelDriftCurrent');
+  });
+});
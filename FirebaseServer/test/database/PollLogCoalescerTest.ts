@@ -0,0 +1,107 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+import { expect } from 'chai';
+
+import { PollLogCoalescer } from '../../src/database/PollLogCoalescer';
+
+const MIN_PERIOD_SECONDS = 30;
+const T0 = 1_800_000_000;
+
+describe('PollLogCoalescer', () => {
+  const poll = (token: string) => ({ queryParams: { buildTimestamp: 'b', buttonAckToken: token }, body: {} });
+  const recordAndSave = (log: PollLogCoalescer, key: string, data: any, conditional: boolean, nowSeconds: number) => {
+    const row = log.record(key, data, conditional, nowSeconds);
+    if (row !== null) {
+      log.saved(key, row);
+    }
+    return row;
+  };
+
+  it('saves the first poll with stats for just that poll', () => {
+    const log = new PollLogCoalescer(MIN_PERIOD_SECONDS);
+
+    const row = log.record('b', poll('t'), true, T0);
+
+    expect(row.queryParams.buttonAckToken).to.equal('t');
+    expect(row.pollStats).to.deep.equal({ polls: 1, conditionalPolls: 1, firstPollSeconds: T0, lastPollSeconds: T0 });
+  });
+
+  it('folds identical polls until the period passes', () => {
+    const log = new PollLogCoalescer(MIN_PERIOD_SECONDS);
+    recordAndSave(log, 'b', poll('t'), false, T0);
+
+    expect(recordAndSave(log, 'b', poll('t'), true, T0 + 5)).to.equal(null);
+    expect(recordAndSave(log, 'b', poll('t'), false, T0 + 29)).to.equal(null);
+    const row = recordAndSave(log, 'b', poll('t'), true, T0 + 30);
+
+    expect(row.pollStats).to.deep.equal({ polls: 3, conditionalPolls: 2, firstPollSeconds: T0 + 5, lastPollSeconds: T0 + 30 });
+  });
+
+  it('saves a changed poll at once, with the folded polls before it', () => {
+    const log = new PollLogCoalescer(MIN_PERIOD_SECONDS);
+    recordAndSave(log, 'b', poll('t1'), false, T0);
+    recordAndSave(log, 'b', poll('t1'), false, T0 + 5);
+
+    const row = recordAndSave(log, 'b', { queryParams: poll('t1').queryParams, body: { local_press_count: 1 } }, false, T0 + 6);
+
+    expect(row.body).to.deep.equal({ local_press_count: 1 });
+    expect(row.pollStats.polls).to.equal(2);
+  });
+
+  it('keeps keys apart and does not modify the input', () => {
+    const log = new PollLogCoalescer(MIN_PERIOD_SECONDS);
+    const data = poll('t');
+    recordAndSave(log, 'a', data, false, T0);
+
+    expect(recordAndSave(log, 'b', data, false, T0)).to.not.equal(null);
+    expect(data).to.not.have.property('pollStats');
+  });
+
+  it('clear() forgets every key', () => {
+    const log = new PollLogCoalescer(MIN_PERIOD_SECONDS);
+    recordAndSave(log, 'b', poll('t'), false, T0);
+    log.clear();
+
+    expect(recordAndSave(log, 'b', poll('t'), false, T0 + 1)).to.not.equal(null);
+  });
+
+  it('saves the next poll again when a write fails', () => {
+    const log = new PollLogCoalescer(MIN_PERIOD_SECONDS);
+    recordAndSave(log, 'b', poll('t'), false, T0);
+    log.record('b', poll('t'), false, T0 + 30);
+
+    const row = recordAndSave(log, 'b', poll('t'), true, T0 + 35);
+
+    expect(row).to.not.equal(null);
+    expect(row.pollStats).to.deep.equal({ polls: 2, conditionalPolls: 1, firstPollSeconds: T0 + 30, lastPollSeconds: T0 + 35 });
+    expect(recordAndSave(log, 'b', poll('t'), false, T0 + 40)).to.equal(null);
+  });
+
+  it('saves a changed poll again when its write fails', () => {
+    const log = new PollLogCoalescer(MIN_PERIOD_SECONDS);
+    recordAndSave(log, 'b', poll('t1'), false, T0);
+    log.record('b', poll('t2'), false, T0 + 1);
+
+    expect(recordAndSave(log, 'b', poll('t2'), false, T0 + 2)).to.not.equal(null);
+    expect(recordAndSave(log, 'b', poll('t2'), false, T0 + 3)).to.equal(null);
+  });
+
+  it('keeps polls that arrive while a write is in flight for the next row', () => {
+    const log = new PollLogCoalescer(MIN_PERIOD_SECONDS);
+    const inFlight = log.record('b', poll('t'), false, T0);
+    log.record('b', poll('t'), true, T0 + 1);
+    log.saved('b', inFlight);
+
+    const row = recordAndSave(log, 'b', poll('t'), false, T0 + 30);
+
+    expect(row.pollStats).to.deep.equal({ polls: 2, conditionalPolls: 1, firstPollSeconds: T0, lastPollSeconds: T0 + 30 });
+  });
+});
@@ -0,0 +1,33 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+import { ButtonActuationDatabase, ButtonActuationRecord } from '../../src/database/ButtonActuationDatabase';
+
+export class FakeButtonActuationDatabase implements ButtonActuationDatabase {
+  private readonly store = new Map<string, ButtonActuationRecord>();
+
+  /** Audit log of all save() calls. */
+  readonly saved: Array<[string, ButtonActuationRecord]> = [];
+
+  async save(buildTimestamp: string, record: ButtonActuationRecord): Promise<void> {
+    this.store.set(buildTimestamp, record);
+    this.saved.push([buildTimestamp, record]);
+  }
+
+  async getCurrent(buildTimestamp: string): Promise<ButtonActuationRecord | null> {
+    return this.store.get(buildTimestamp) ?? null;
+  }
+
+  /** Test-only helper: wipe storage and audit logs. */
+  clear(): void {
+    this.store.clear();
+    this.saved.length = 0;
+  }
+}
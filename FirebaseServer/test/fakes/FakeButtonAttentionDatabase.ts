@@ -0,0 +1,59 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+import { ButtonAttentionDatabase, ButtonAttentionRecord } from '../../src/database/ButtonAttentionDatabase';
+
+export class FakeButtonAttentionDatabase implements ButtonAttentionDatabase {
+  private readonly store = new Map<string, ButtonAttentionRecord>();
+  private readonly watchers = new Map<string, Set<(record: ButtonAttentionRecord | null) => void>>();
+
+  /** Audit log of all save() calls. */
+  readonly saved: Array<[string, ButtonAttentionRecord]> = [];
+
+  async save(buildTimestamp: string, record: ButtonAttentionRecord): Promise<void> {
+    this.store.set(buildTimestamp, record);
+    this.saved.push([buildTimestamp, record]);
+    this.notify(buildTimestamp);
+  }
+
+  async getCurrent(buildTimestamp: string): Promise<ButtonAttentionRecord | null> {
+    return this.store.get(buildTimestamp) ?? null;
+  }
+
+  /** Like Firestore, but synchronous: listeners run inside save() and seed(). */
+  watchCurrent(
+    buildTimestamp: string,
+    onChange: (record: ButtonAttentionRecord | null) => void,
+    _onError: (error: Error) => void,
+  ): () => void {
+    if (!this.watchers.has(buildTimestamp)) {
+      this.watchers.set(buildTimestamp, new Set());
+    }
+    this.watchers.get(buildTimestamp).add(onChange);
+    return () => this.watchers.get(buildTimestamp).delete(onChange);
+  }
+
+  /** Test-only helper: pre-populate storage without recording in saved[]. */
+  seed(buildTimestamp: string, record: ButtonAttentionRecord): void {
+    this.store.set(buildTimestamp, record);
+    this.notify(buildTimestamp);
+  }
+
+  /** Test-only helper: wipe storage and audit logs. */
+  clear(): void {
+    this.store.clear();
+    this.saved.length = 0;
+  }
+
+  private notify(buildTimestamp: string): void {
+    const record = this.store.get(buildTimestamp) ?? null;
+    this.watchers.get(buildTimestamp)?.forEach((onChange) => onChange(record));
+  }
+}
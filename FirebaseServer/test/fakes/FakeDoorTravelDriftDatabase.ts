@@ -0,0 +1,38 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+import { DoorTravelDriftDatabase, DoorTravelDriftRecord } from '../../src/database/DoorTravelDriftDatabase';
+
+export class FakeDoorTravelDriftDatabase implements DoorTravelDriftDatabase {
+  private readonly store = new Map<string, DoorTravelDriftRecord>();
+
+  /** Audit log of all save() calls. */
+  readonly saved: Array<[string, DoorTravelDriftRecord]> = [];
+
+  async save(buildTimestamp: string, record: DoorTravelDriftRecord): Promise<void> {
+    this.store.set(buildTimestamp, record);
+    this.saved.push([buildTimestamp, record]);
+  }
+
+  async getCurrent(buildTimestamp: string): Promise<DoorTravelDriftRecord | null> {
+    return this.store.get(buildTimestamp) ?? null;
+  }
+
+  /** Test-only helper: pre-populate storage without recording in saved[]. */
+  seed(buildTimestamp: string, record: DoorTravelDriftRecord): void {
+    this.store.set(buildTimestamp, record);
+  }
+
+  /** Test-only helper: wipe storage and audit logs. */
+  clear(): void {
+    this.store.clear();
+    this.saved.length = 0;
+  }
+}
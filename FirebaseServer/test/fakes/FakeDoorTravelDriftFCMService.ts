@@ -0,0 +1,36 @@
+/**
+ * Copyright 2026 Chris Cartland. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ */
+
+import { DoorTravelDriftFCMService, buildDriftMessage } from '../../src/controller/fcm/DoorTravelDriftFCM';
+import { DoorTravelKind } from '../../src/controller/DoorTravelDriftInterpreter';
+import { TopicMessage } from '../../src/model/FCM';
+
+export class FakeDoorTravelDriftFCMService implements DoorTravelDriftFCMService {
+  /** Audit log of all sendForDrift() calls. */
+  readonly sends: Array<{
+    buildTimestamp: string;
+    kinds: DoorTravelKind[];
+    medianMillis: Array<number | null>;
+  }> = [];
+
+  async sendForDrift(
+    buildTimestamp: string,
+    kinds: DoorTravelKind[],
+    medianMillis: Array<number | null>,
+  ): Promise<TopicMessage> {
+    this.sends.push({ buildTimestamp, kinds, medianMillis });
+    return buildDriftMessage(buildTimestamp, kinds, medianMillis);
+  }
+
+  /** Test-only helper: wipe audit logs. */
+  clear(): void {
+    this.sends.length = 0;
+  }
+}
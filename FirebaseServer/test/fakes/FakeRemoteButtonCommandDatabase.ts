@@ -12,6 +12,7 @@ import { RemoteButtonCommandDatabase } from '../../src/database/RemoteButtonComm
 
 export class FakeRemoteButtonCommandDatabase implements RemoteButtonCommandDatabase {
   private readonly store = new Map<string, any>();
+  private readonly watchers = new Map<string, Set<(data: any) => void>>();
 
   /** Audit log of all save() calls. */
   readonly saved: Array<[string, any]> = [];
@@ -22,12 +23,27 @@ export class FakeRemoteButtonCommandDatabase implements RemoteButtonCommandDatab
   async save(buildTimestamp: string, data: any): Promise<void> {
     this.store.set(buildTimestamp, data);
     this.saved.push([buildTimestamp, data]);
+    this.notify(buildTimestamp);
   }
 
   async getCurrent(buildTimestamp: string): Promise<any> {
     return this.store.get(buildTimestamp) ?? null;
   }
 
+  /** Like Firestore, but synchronous: listeners run inside save() and seed(). */
+  watchCurrent(buildTimestamp: string, onChange: (data: any) => void, _onError: (error: Error) => void): () => void {
+    if (!this.watchers.has(buildTimestamp)) {
+      this.watchers.set(buildTimestamp, new Set());
+    }
+    this.watchers.get(buildTimestamp).add(onChange);
+    return () => this.watchers.get(buildTimestamp).delete(onChange);
+  }
+
+  /** Number of active watchCurrent() listeners for buildTimestamp. */
+  watcherCount(buildTimestamp: string): number {
+    return this.watchers.get(buildTimestamp)?.size ?? 0;
+  }
+
   async deleteAllBefore(cutoffTimestampSeconds: number, dryRun: boolean): Promise<number> {
     this.deleteCalls.push({ cutoff: cutoffTimestampSeconds, dryRun });
     return 0;
@@ -36,6 +52,7 @@ export class FakeRemoteButtonCommandDatabase implements RemoteButtonCommandDatab
   /** Test-only helper: pre-populate storage without recording in saved[]. */
   seed(buildTimestamp: string, data: any): void {
     this.store.set(buildTimestamp, data);
+    this.notify(buildTimestamp);
   }
 
   /** Test-only helper: wipe storage and audit logs. */
@@ -44,4 +61,9 @@ export class FakeRemoteButtonCommandDatabase implements RemoteButtonCommandDatab
     this.saved.length = 0;
     this.deleteCalls.length = 0;
   }
+
+  private notify(buildTimestamp: string): void {
+    const data = this.store.get(buildTimestamp) ?? null;
+    this.watchers.get(buildTimestamp)?.forEach((onChange) => onChange(data));
+  }
 }
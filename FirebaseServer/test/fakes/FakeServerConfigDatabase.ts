@@ -12,6 +12,7 @@ import { ServerConfigDatabase } from '../../src/database/ServerConfigDatabase';
 
 export class FakeServerConfigDatabase implements ServerConfigDatabase {
   private current: any = null;
+  private readonly watchers = new Set<(data: any) => void>();
 
   /** Audit log of all set() calls. */
   readonly saved: any[] = [];
@@ -27,6 +28,7 @@ export class FakeServerConfigDatabase implements ServerConfigDatabase {
       throw err;
     }
     this.current = data;
+    this.notify();
   }
 
   async get(): Promise<any> {
@@ -40,9 +42,16 @@ export class FakeServerConfigDatabase implements ServerConfigDatabase {
     return this.current ?? {};
   }
 
+  /** Like Firestore, but synchronous: listeners run inside set(), seed() and clear(). */
+  watch(onChange: (data: any) => void, _onError: (error: Error) => void): () => void {
+    this.watchers.add(onChange);
+    return () => this.watchers.delete(onChange);
+  }
+
   /** Test-only helper: pre-populate without recording in saved[]. */
   seed(data: any): void {
     this.current = data;
+    this.notify();
   }
 
   /** Test-only helper: wipe state and audit logs. */
@@ -51,6 +60,7 @@ export class FakeServerConfigDatabase implements ServerConfigDatabase {
     this.saved.length = 0;
     this._nextSetError = null;
     this._nextGetError = null;
+    this.notify();
   }
 
   /** Make the next set() reject with the given error. */
@@ -58,4 +68,9 @@ export class FakeServerConfigDatabase implements ServerConfigDatabase {
 
   /** Make the next get() reject with the given error. */
   failNextGet(error: Error): void { this._nextGetError = error; }
+
+  private notify(): void {
+    const data = this.current ?? {};
+    this.watchers.forEach((onChange) => onChange(data));
+  }
 }
@@ -29,7 +29,12 @@ import {
   setImpl as setAuthServiceImpl,
   resetImpl as resetAuthServiceImpl,
 } from '../../../src/controller/AuthService';
+import {
+  setImpl as setButtonAttentionDBImpl,
+  resetImpl as resetButtonAttentionDBImpl,
+} from '../../../src/database/ButtonAttentionDatabase';
 import { FakeServerConfigDatabase } from '../../fakes/FakeServerConfigDatabase';
+import { FakeButtonAttentionDatabase } from '../../fakes/FakeButtonAttentionDatabase';
 import { FakeButtonHealthDatabase } from '../../fakes/FakeButtonHealthDatabase';
 import { FakeRemoteButtonRequestDatabase } from '../../fakes/FakeRemoteButtonRequestDatabase';
 import { FakeAuthService } from '../../fakes/FakeAuthService';
@@ -68,6 +73,7 @@ describe('handleButtonHealth (pure handler core)', () => {
   let fakeAuth: FakeAuthService;
   let fakeHealthDB: FakeButtonHealthDatabase;
   let fakeRequestDB: FakeRemoteButtonRequestDatabase;
+  let fakeAttentionDB: FakeButtonAttentionDatabase;
 
   beforeEach(() => {
     fakeConfig = new FakeServerConfigDatabase();
@@ -78,6 +84,8 @@ describe('handleButtonHealth (pure handler core)', () => {
     setAuthServiceImpl(fakeAuth);
     setButtonHealthDBImpl(fakeHealthDB);
     setRemoteButtonRequestDBImpl(fakeRequestDB);
+    fakeAttentionDB = new FakeButtonAttentionDatabase();
+    setButtonAttentionDBImpl(fakeAttentionDB);
     fakeConfig.seed({
       body: {
         remoteButtonEnabled: true,
@@ -93,6 +101,7 @@ describe('handleButtonHealth (pure handler core)', () => {
     resetAuthServiceImpl();
     resetButtonHealthDBImpl();
     resetRemoteButtonRequestDBImpl();
+    resetButtonAttentionDBImpl();
   });
 
   const happyInput = (overrides: any = {}) => ({
@@ -234,4 +243,28 @@ describe('handleButtonHealth (pure handler core)', () => {
     if (result.kind !== 'ok') return;
     expect(result.data.lastPollAtSeconds).to.equal(null);
   });
+
+  // ---- Attention (drives the device's poll period) ----
+
+  it('saves attention for the device on an authorized fetch', async () => {
+    const before = Math.floor(Date.now() / 1000);
+    await handleButtonHealth(happyInput());
+    expect(fakeAttentionDB.saved).to.have.lengthOf(1);
+    const [savedBt, record] = fakeAttentionDB.saved[0];
+    expect(savedBt).to.equal(BUILD_TIMESTAMP);
+    expect(record.seenAtSeconds).to.be.at.least(before);
+  });
+
+  it('does not save attention again within a minute', async () => {
+    await handleButtonHealth(happyInput());
+    await handleButtonHealth(happyInput());
+    expect(fakeAttentionDB.saved).to.have.lengthOf(1);
+  });
+
+  it('does not save attention for a rejected fetch', async () => {
+    await handleButtonHealth(happyInput({ pushKeyHeader: 'wrong-key' }));
+    fakeAuth.seedDecoded({ email: DENIED_EMAIL });
+    await handleButtonHealth(happyInput());
+    expect(fakeAttentionDB.saved).to.be.empty;
+  });
 });
@@ -31,21 +31,45 @@ import {
   setImpl as setUpdateDBImpl,
   resetImpl as resetUpdateDBImpl,
 } from '../../../src/database/UpdateDatabase';
+import {
+  setImpl as setDoorTravelDriftDBImpl,
+  resetImpl as resetDoorTravelDriftDBImpl,
+} from '../../../src/database/DoorTravelDriftDatabase';
+import {
+  setImpl as setDoorTravelDriftFCMImpl,
+  resetImpl as resetDoorTravelDriftFCMImpl,
+} from '../../../src/controller/fcm/DoorTravelDriftFCM';
+import { TimeSeriesDatabase } from '../../../src/database/TimeSeriesDatabase';
 import { FakeUpdateDatabase } from '../../fakes/FakeUpdateDatabase';
+import { FakeDoorTravelDriftDatabase } from '../../fakes/FakeDoorTravelDriftDatabase';
+import { FakeDoorTravelDriftFCMService } from '../../fakes/FakeDoorTravelDriftFCMService';
 
 // Pattern for matching a UUID v4 session identifier.
 const UUID_V4_RE = /^[0-9a-f]{8}-[0-9a-f]{4}-4[0-9a-f]{3}-[89ab][0-9a-f]{3}-[0-9a-f]{12}$/i;
 
+// HTTP_RECEIVE_BUFFER_SIZE in GarageFirmware_ESP32/main/main.c
+const FIRMWARE_RECEIVE_BUFFER_BYTES = 1024;
+// MAX_DEVICE_ID_LENGTH in GarageFirmware_ESP32/components/garage_config/garage_config.h
+const FIRMWARE_MAX_DEVICE_ID_LENGTH = 256;
+
 describe('handleEchoRequest (pure handler core)', () => {
   let fakeDB: FakeUpdateDatabase;
+  let driftDB: FakeDoorTravelDriftDatabase;
+  let driftFCM: FakeDoorTravelDriftFCMService;
 
   beforeEach(() => {
     fakeDB = new FakeUpdateDatabase();
+    driftDB = new FakeDoorTravelDriftDatabase();
+    driftFCM = new FakeDoorTravelDriftFCMService();
     setUpdateDBImpl(fakeDB);
+    setDoorTravelDriftDBImpl(driftDB);
+    setDoorTravelDriftFCMImpl(driftFCM);
   });
 
   afterEach(() => {
     resetUpdateDBImpl();
+    resetDoorTravelDriftDBImpl();
+    resetDoorTravelDriftFCMImpl();
   });
 
   it('saves to UpdateDatabase using the session id from the query', async () => {
@@ -82,11 +106,12 @@ describe('handleEchoRequest (pure handler core)', () => {
 
     const result = await handleEchoRequest({ query, body });
 
-    // The returned value is what getCurrent(session) holds after save —
-    // byte-identical to the stored document in the fake.
+    // The returned value is what getCurrent(session) holds after save,
+    // minus the body, which only the stored document keeps.
     expect(result.session).to.equal('roundtrip');
     expect(result.queryParams).to.deep.equal(query);
-    expect(result.body).to.deep.equal(body);
+    expect(result).to.not.have.property('body');
+    expect(fakeDB.saved[0][1].body).to.deep.equal(body);
     expect(result.buildTimestamp).to.equal('Sat Mar 13 14:45:00 2021');
   });
 
@@ -112,4 +137,58 @@ describe('handleEchoRequest (pure handler core)', () => {
     const stored = fakeDB.saved[0][1];
     expect(stored).to.not.have.property('buildTimestamp');
   });
+
+  it('fits the echo of a fully populated heartbeat in the firmware receive buffer', async () => {
+    // Stamp the document the way Firestore stores it
+    fakeDB.save = async (session: string, data: any) => {
+      fakeDB.seed(session, TimeSeriesDatabase.convertToFirestore(data));
+    };
+    const UINT32_MAX = 4294967295;
+    const full = (length: number) => new Array(length).fill(UINT32_MAX);
+    const query = {
+      session: '3f2504e0-4f89-41d3-9a0c-0305e82c3301',
+      buildTimestamp: 'x'.repeat(FIRMWARE_MAX_DEVICE_ID_LENGTH),
+      sensorA: '1',
+      sensorB: '1',
+      eventAgeMillis: '-9223372036854775808',
+      eventTimestampMillis: '9223372036854775807',
+    };
+    const body = {
+      travel_open: full(12),
+      travel_close: full(12),
+      press_delay: full(12),
+      travel_median_ms: full(3),
+      travel_drift: 7,
+      metrics_counters: full(64),
+      metrics_gauges: full(16),
+      metrics_histograms: full(128),
+    };
+
+    const result = await handleEchoRequest({ query, body });
+
+    expect(result.queryParams).to.deep.equal(query);
+    expect(Buffer.byteLength(JSON.stringify(result))).to.be.at.most(FIRMWARE_RECEIVE_BUFFER_BYTES);
+  });
+
+  it('alerts on a newly raised travel_drift flag keyed by buildTimestamp', async () => {
+    const query = { buildTimestamp: 'Sat Apr 10 23:57:32 2021', sensorA: '0', sensorB: '1' };
+    const body = { travel_drift: 1, travel_median_ms: [12000, 11500, 400] };
+
+    await handleEchoRequest({ query, body });
+    await handleEchoRequest({ query, body });
+
+    expect(driftDB.saved.map(([buildTimestamp, record]) => [buildTimestamp, record.driftFlags]))
+      .to.deep.equal([['Sat Apr 10 23:57:32 2021', 1]]);
+    expect(driftFCM.sends.map((send) => send.kinds)).to.deep.equal([['OPEN']]);
+  });
+
+  it('still answers the heartbeat when the drift check fails', async () => {
+    driftDB.getCurrent = async () => { throw new Error('Firestore unavailable'); };
+    const query = { session: 's', buildTimestamp: 'Sat Apr 10 23:57:32 2021' };
+
+    const result = await handleEchoRequest({ query, body: { travel_drift: 1 } });
+
+    expect(result.session).to.equal('s');
+    expect(driftFCM.sends).to.have.lengthOf(0);
+  });
 });
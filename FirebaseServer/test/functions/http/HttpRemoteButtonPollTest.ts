@@ -29,20 +29,38 @@ import { expect } from 'chai';
 import * as sinon from 'sinon';
 import * as firebase from 'firebase-admin';
 
-import { handleRemoteButtonPoll } from '../../../src/functions/http/RemoteButton';
+import { handleRemoteButtonPoll, remoteButtonNextPollSeconds } from '../../../src/functions/http/RemoteButton';
 import {
+  DATABASE as ServerConfigDatabase,
   setImpl as setServerConfigDBImpl,
   resetImpl as resetServerConfigDBImpl,
 } from '../../../src/database/ServerConfigDatabase';
 import {
   setImpl as setRemoteButtonRequestDBImpl,
   resetImpl as resetRemoteButtonRequestDBImpl,
+  POLL_LOG_MIN_PERIOD_SECONDS,
 } from '../../../src/database/RemoteButtonRequestDatabase';
 import {
   setImpl as setRemoteButtonCommandDBImpl,
   resetImpl as resetRemoteButtonCommandDBImpl,
+  CURRENT_CACHE as REMOTE_BUTTON_COMMAND_CACHE,
 } from '../../../src/database/RemoteButtonCommandDatabase';
+import {
+  setImpl as setButtonAttentionDBImpl,
+  resetImpl as resetButtonAttentionDBImpl,
+} from '../../../src/database/ButtonAttentionDatabase';
+import {
+  setImpl as setButtonActuationDBImpl,
+  resetImpl as resetButtonActuationDBImpl,
+} from '../../../src/database/ButtonActuationDatabase';
+import {
+  ACTIVE_POLL_SECONDS,
+  IDLE_POLL_SECONDS,
+  RECENT_POLL_SECONDS,
+} from '../../../src/controller/ButtonPollCadence';
 import { FakeServerConfigDatabase } from '../../fakes/FakeServerConfigDatabase';
+import { FakeButtonAttentionDatabase } from '../../fakes/FakeButtonAttentionDatabase';
+import { FakeButtonActuationDatabase } from '../../fakes/FakeButtonActuationDatabase';
 import { FakeRemoteButtonRequestDatabase } from '../../fakes/FakeRemoteButtonRequestDatabase';
 import { FakeRemoteButtonCommandDatabase } from '../../fakes/FakeRemoteButtonCommandDatabase';
 
@@ -55,14 +73,20 @@ describe('handleRemoteButtonPoll (pure handler core)', () => {
   let fakeConfig: FakeServerConfigDatabase;
   let fakeRequestDB: FakeRemoteButtonRequestDatabase;
   let fakeCommandDB: FakeRemoteButtonCommandDatabase;
+  let fakeAttentionDB: FakeButtonAttentionDatabase;
+  let fakeActuationDB: FakeButtonActuationDatabase;
 
   beforeEach(() => {
     fakeConfig = new FakeServerConfigDatabase();
     fakeRequestDB = new FakeRemoteButtonRequestDatabase();
     fakeCommandDB = new FakeRemoteButtonCommandDatabase();
+    fakeAttentionDB = new FakeButtonAttentionDatabase();
+    fakeActuationDB = new FakeButtonActuationDatabase();
     setServerConfigDBImpl(fakeConfig);
     setRemoteButtonRequestDBImpl(fakeRequestDB);
     setRemoteButtonCommandDBImpl(fakeCommandDB);
+    setButtonAttentionDBImpl(fakeAttentionDB);
+    setButtonActuationDBImpl(fakeActuationDB);
     sinon.stub(firebase.firestore.Timestamp, 'now').returns(
       new firebase.firestore.Timestamp(NOW_SECONDS, 0),
     );
@@ -73,6 +97,8 @@ describe('handleRemoteButtonPoll (pure handler core)', () => {
     resetServerConfigDBImpl();
     resetRemoteButtonRequestDBImpl();
     resetRemoteButtonCommandDBImpl();
+    resetButtonAttentionDBImpl();
+    resetButtonActuationDBImpl();
     sinon.restore();
   });
 
@@ -227,4 +253,241 @@ describe('handleRemoteButtonPoll (pure handler core)', () => {
     expect(fakeCommandDB.saved).to.be.empty;
     expect(result).to.deep.equal({ kind: 'ok', data: null });
   });
+
+  describe('cached server config', () => {
+    it('reads the config once for repeated polls', async () => {
+      await handleRemoteButtonPoll({ query: { buildTimestamp: BUILD_TIMESTAMP }, body: {} });
+      await handleRemoteButtonPoll({ query: { buildTimestamp: BUILD_TIMESTAMP }, body: {} });
+
+      expect(ServerConfigDatabase.cacheStats()).to.deep.equal({ hits: 1, misses: 1 });
+    });
+
+    it('sees a config change on the next poll', async () => {
+      await handleRemoteButtonPoll({ query: { buildTimestamp: BUILD_TIMESTAMP }, body: {} });
+      fakeConfig.seed({ body: { remoteButtonEnabled: false } });
+
+      const result = await handleRemoteButtonPoll({ query: { buildTimestamp: BUILD_TIMESTAMP }, body: {} });
+
+      expect(result).to.deep.equal({ kind: 'error', status: 400, body: { error: 'Disabled' } });
+    });
+
+    it('sees a config saved through set() in this instance', async () => {
+      await handleRemoteButtonPoll({ query: { buildTimestamp: BUILD_TIMESTAMP }, body: {} });
+      await ServerConfigDatabase.set({ body: { remoteButtonEnabled: false } });
+
+      const result = await handleRemoteButtonPoll({ query: { buildTimestamp: BUILD_TIMESTAMP }, body: {} });
+
+      expect(result.kind).to.equal('error');
+    });
+  });
+
+  describe('coalesced poll log', () => {
+    const poll = (buttonAckToken: string) => handleRemoteButtonPoll({
+      query: { buildTimestamp: BUILD_TIMESTAMP, buttonAckToken: buttonAckToken },
+      body: {},
+    });
+    const setNow = (seconds: number) => {
+      (firebase.firestore.Timestamp.now as sinon.SinonStub).returns(new firebase.firestore.Timestamp(seconds, 0));
+    };
+
+    it('saves identical polls at most every POLL_LOG_MIN_PERIOD_SECONDS and counts the rest', async () => {
+      await poll('t');
+      setNow(NOW_SECONDS + 5);
+      await poll('t');
+      setNow(NOW_SECONDS + 10);
+      await poll('t');
+      expect(fakeRequestDB.saved).to.have.lengthOf(1);
+
+      setNow(NOW_SECONDS + POLL_LOG_MIN_PERIOD_SECONDS);
+      await poll('t');
+
+      expect(fakeRequestDB.saved).to.have.lengthOf(2);
+      expect(fakeRequestDB.saved[1][1].pollStats).to.deep.equal({
+        polls: 3,
+        conditionalPolls: 0,
+        firstPollSeconds: NOW_SECONDS + 5,
+        lastPollSeconds: NOW_SECONDS + POLL_LOG_MIN_PERIOD_SECONDS,
+      });
+    });
+
+    it('saves a poll right away when its token changes', async () => {
+      await poll('t1');
+      await poll('t2');
+
+      expect(fakeRequestDB.saved).to.have.lengthOf(2);
+      expect(fakeRequestDB.saved[1][1].buttonAckToken).to.equal('t2');
+    });
+
+    it('saves the next poll when the previous save failed', async () => {
+      const save = sinon.stub(fakeRequestDB, 'save').rejects(new Error('unavailable'));
+      const failed = await poll('t').then(() => null, (e) => e);
+      save.restore();
+      expect(failed).to.not.equal(null);
+
+      setNow(NOW_SECONDS + 5);
+      await poll('t');
+
+      expect(fakeRequestDB.saved).to.have.lengthOf(1);
+      expect(fakeRequestDB.saved[0][1].pollStats.polls).to.equal(2);
+    });
+
+    it('still answers every poll while skipping the save', async () => {
+      const command = { buttonAckToken: 'pending', FIRESTORE_databaseTimestampSeconds: NOW_SECONDS };
+      fakeCommandDB.seed(BUILD_TIMESTAMP, command);
+
+      await poll('t');
+      const result = await poll('t');
+
+      expect(fakeRequestDB.saved).to.have.lengthOf(1);
+      expect(result).to.deep.equal({ kind: 'ok', data: command });
+    });
+  });
+
+  describe('actuation reports', () => {
+    it('saves the report with the token the device pressed for', async () => {
+      await handleRemoteButtonPoll({
+        query: { buildTimestamp: BUILD_TIMESTAMP, buttonAckToken: 'token-1' },
+        body: { actuation_result: 1, actuation_latency_ms: 740, actuation_attempts: 1 },
+      });
+
+      expect(fakeActuationDB.saved).to.deep.equal([[BUILD_TIMESTAMP, {
+        result: 'MOTION',
+        latencyMillis: 740,
+        attempts: 1,
+        buttonAckToken: 'token-1',
+        reportedAtSeconds: NOW_SECONDS,
+      }]]);
+      expect(fakeRequestDB.saved[0][1].body).to.deep.equal({
+        actuation_result: 1, actuation_latency_ms: 740, actuation_attempts: 1,
+      });
+    });
+
+    it('saves nothing for a poll without a report', async () => {
+      await handleRemoteButtonPoll({ query: { buildTimestamp: BUILD_TIMESTAMP }, body: {} });
+      await handleRemoteButtonPoll({ query: { buildTimestamp: BUILD_TIMESTAMP }, body: { actuation_result: 9 } });
+
+      expect(fakeActuationDB.saved).to.deep.equal([]);
+    });
+
+    it('saves nothing without a buildTimestamp', async () => {
+      await handleRemoteButtonPoll({
+        query: {},
+        body: { actuation_result: 2, actuation_latency_ms: 5000, actuation_attempts: 2 },
+      });
+
+      expect(fakeActuationDB.saved).to.deep.equal([]);
+    });
+  });
+
+  describe('conditional polls (conditional=true)', () => {
+    const conditionalQuery = (buttonAckToken: string) => ({
+      buildTimestamp: BUILD_TIMESTAMP,
+      buttonAckToken: buttonAckToken,
+      conditional: 'true',
+    });
+
+    it('returns notModified when the client already has the empty token, and still saves the request', async () => {
+      fakeCommandDB.seed(BUILD_TIMESTAMP, { buttonAckToken: '', FIRESTORE_databaseTimestampSeconds: NOW_SECONDS - 100 });
+
+      const result = await handleRemoteButtonPoll({ query: conditionalQuery(''), body: {} });
+
+      expect(result).to.deep.equal({ kind: 'notModified' });
+      expect(fakeRequestDB.saved).to.have.lengthOf(1);
+      expect(fakeCommandDB.saved).to.be.empty;
+    });
+
+    it('serves repeat polls from the cache', async () => {
+      fakeCommandDB.seed(BUILD_TIMESTAMP, { buttonAckToken: '' });
+
+      await handleRemoteButtonPoll({ query: conditionalQuery(''), body: {} });
+      await handleRemoteButtonPoll({ query: conditionalQuery(''), body: {} });
+      await handleRemoteButtonPoll({ query: conditionalQuery(''), body: {} });
+
+      expect(REMOTE_BUTTON_COMMAND_CACHE.stats()).to.deep.equal({ hits: 2, misses: 1 });
+      expect(fakeCommandDB.watcherCount(BUILD_TIMESTAMP)).to.equal(1);
+    });
+
+    it('returns a command written by another instance as soon as the listener sees it', async () => {
+      fakeCommandDB.seed(BUILD_TIMESTAMP, { buttonAckToken: '' });
+      await handleRemoteButtonPoll({ query: conditionalQuery(''), body: {} });
+
+      // Another function instance adds a command: only the snapshot listener sees it.
+      const pendingCommand = { buttonAckToken: 'new-token', FIRESTORE_databaseTimestampSeconds: NOW_SECONDS };
+      fakeCommandDB.seed(BUILD_TIMESTAMP, pendingCommand);
+      const result = await handleRemoteButtonPoll({ query: conditionalQuery(''), body: {} });
+
+      expect(result).to.deep.equal({ kind: 'ok', data: pendingCommand });
+    });
+
+    it('acknowledges like a normal poll, then answers notModified from the saved noop', async () => {
+      fakeCommandDB.seed(BUILD_TIMESTAMP, { buttonAckToken: 'new-token', FIRESTORE_databaseTimestampSeconds: NOW_SECONDS - 5 });
+
+      const ack = await handleRemoteButtonPoll({ query: conditionalQuery('new-token'), body: {} });
+      const next = await handleRemoteButtonPoll({ query: conditionalQuery(''), body: {} });
+
+      expect(fakeCommandDB.saved).to.have.lengthOf(1);
+      expect(ack.kind).to.equal('ok');
+      if (ack.kind === 'ok') {
+        expect(ack.data.buttonAckToken).to.equal('');
+      }
+      expect(next).to.deep.equal({ kind: 'notModified' });
+    });
+
+    it('returns the full command when the client token differs', async () => {
+      const command = { buttonAckToken: '' };
+      fakeCommandDB.seed(BUILD_TIMESTAMP, command);
+
+      const result = await handleRemoteButtonPoll({ query: conditionalQuery('NO_BUTTON_TOKEN'), body: {} });
+
+      expect(result).to.deep.equal({ kind: 'ok', data: command });
+    });
+
+    it('leaves polls without the flag unchanged', async () => {
+      const command = { buttonAckToken: '' };
+      fakeCommandDB.seed(BUILD_TIMESTAMP, command);
+
+      const result = await handleRemoteButtonPoll({
+        query: { buildTimestamp: BUILD_TIMESTAMP, buttonAckToken: '' },
+        body: {},
+      });
+
+      expect(result).to.deep.equal({ kind: 'ok', data: command });
+      expect(REMOTE_BUTTON_COMMAND_CACHE.stats()).to.deep.equal({ hits: 0, misses: 0 });
+    });
+  });
+
+  describe('next poll hint', () => {
+    it('idles without activity', async () => {
+      expect(await remoteButtonNextPollSeconds({ buildTimestamp: BUILD_TIMESTAMP })).to.equal(IDLE_POLL_SECONDS);
+    });
+
+    it('polls fast after the app is opened', async () => {
+      fakeAttentionDB.seed(BUILD_TIMESTAMP, { seenAtSeconds: NOW_SECONDS - 20 });
+      expect(await remoteButtonNextPollSeconds({ buildTimestamp: BUILD_TIMESTAMP })).to.equal(ACTIVE_POLL_SECONDS);
+    });
+
+    it('polls fast after a command, then steps down', async () => {
+      fakeCommandDB.seed(BUILD_TIMESTAMP, {
+        buttonAckToken: 'token-1',
+        FIRESTORE_databaseTimestampSeconds: NOW_SECONDS - 5,
+      });
+      expect(await remoteButtonNextPollSeconds({ buildTimestamp: BUILD_TIMESTAMP })).to.equal(ACTIVE_POLL_SECONDS);
+      fakeCommandDB.seed(BUILD_TIMESTAMP, {
+        buttonAckToken: '',
+        FIRESTORE_databaseTimestampSeconds: NOW_SECONDS - 600,
+      });
+      expect(await remoteButtonNextPollSeconds({ buildTimestamp: BUILD_TIMESTAMP })).to.equal(RECENT_POLL_SECONDS);
+    });
+
+    it('gives no hint without a buildTimestamp', async () => {
+      expect(await remoteButtonNextPollSeconds({})).to.be.null;
+      expect(await remoteButtonNextPollSeconds(undefined)).to.be.null;
+    });
+
+    it('gives no hint when a read fails', async () => {
+      sinon.stub(fakeAttentionDB, 'getCurrent').rejects(new Error('unavailable'));
+      sinon.stub(console, 'warn');
+      expect(await remoteButtonNextPollSeconds({ buildTimestamp: BUILD_TIMESTAMP })).to.be.null;
+    });
+  });
 });
@@ -0,0 +1,58 @@
+#ifndef BINARY_LOG_H
+#define BINARY_LOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Deferred binary logging for hot paths.
+ *
+ * A call site stores a message ID and up to BINARY_LOG_MAX_ARGS integers into a lock-free
+ * ring buffer, which takes a few microseconds and never blocks on the UART. binary_log_drain
+ * runs as a low-priority task and prints each record as one hex line:
+ *
+ *   BLOG:<timestamp_us int64><id uint16><arg count uint8><args int32...>   (little endian)
+ *
+ * Format strings live only in binary_log_ids.def. Decode a monitor log on the host with:
+ *
+ *   idf.py monitor | python components/binary_log/tools/binary_log_decode.py
+ *
+ * Any task or ISR can write. When the ring is full, new records are dropped and counted.
+ */
+
+#define BINARY_LOG_MAX_ARGS 4
+#define BINARY_LOG_RING_SIZE 64 // Must be a power of 2
+
+#define BINARY_LOG_ID(name, format) BLOG_##name,
+typedef enum {
+#include "binary_log_ids.def"
+    BLOG_ID_COUNT,
+} binary_log_id_t;
+#undef BINARY_LOG_ID
+
+typedef struct {
+    int64_t timestamp_us;
+    uint16_t id;
+    uint8_t arg_count;
+    int32_t args[BINARY_LOG_MAX_ARGS];
+} binary_log_record_t;
+
+// Prepare the ring buffer. Call once before any other binary_log function.
+void binary_log_init(void);
+
+// Store a record. Safe from any task or ISR. Returns false if the ring was full.
+bool binary_log_write(binary_log_id_t id, uint8_t arg_count, int32_t a0, int32_t a1, int32_t a2, int32_t a3);
+
+// Take the oldest record. Only one reader (binary_log_drain) may call this.
+bool binary_log_read(binary_log_record_t *record);
+
+// Task that prints records as BLOG lines. Run it at a low priority.
+void binary_log_drain(void *pvParameters);
+
+#define BLOG0(id) binary_log_write(BLOG_##id, 0, 0, 0, 0, 0)
+#define BLOG1(id, a0) binary_log_write(BLOG_##id, 1, (a0), 0, 0, 0)
+#define BLOG2(id, a0, a1) binary_log_write(BLOG_##id, 2, (a0), (a1), 0, 0)
+#define BLOG3(id, a0, a1, a2) binary_log_write(BLOG_##id, 3, (a0), (a1), (a2), 0)
+#define BLOG4(id, a0, a1, a2, a3) binary_log_write(BLOG_##id, 4, (a0), (a1), (a2), (a3))
+
+#endif // BINARY_LOG_H
@@ -0,0 +1,105 @@
+#include "binary_log.h"
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdatomic.h>
+#include <stdio.h>
+
+#define RING_MASK (BINARY_LOG_RING_SIZE - 1)
+#define DRAIN_PERIOD_MS 100
+
+// Bounded multi-producer, single-consumer ring.
+// Each slot's sequence tells whose turn it is:
+//   sequence == position      -> free for the producer that reserved position
+//   sequence == position + 1  -> holds a record for the consumer at position
+typedef struct {
+    atomic_uint sequence;
+    binary_log_record_t record;
+} binary_log_slot_t;
+
+static binary_log_slot_t ring[BINARY_LOG_RING_SIZE];
+static atomic_uint write_position;
+static unsigned read_position;
+static atomic_uint dropped_count;
+
+void binary_log_init(void) {
+    for (unsigned i = 0; i < BINARY_LOG_RING_SIZE; i++) {
+        atomic_store_explicit(&ring[i].sequence, i, memory_order_relaxed);
+    }
+    atomic_store_explicit(&write_position, 0, memory_order_relaxed);
+    atomic_store_explicit(&dropped_count, 0, memory_order_relaxed);
+    read_position = 0;
+}
+
+bool binary_log_write(binary_log_id_t id, uint8_t arg_count, int32_t a0, int32_t a1, int32_t a2, int32_t a3) {
+    unsigned position = atomic_load_explicit(&write_position, memory_order_relaxed);
+    binary_log_slot_t *slot;
+    while (1) {
+        slot = &ring[position & RING_MASK];
+        unsigned sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        int diff = (int)(sequence - position);
+        if (diff == 0) {
+            // Slot is free: try to reserve it
+            if (atomic_compare_exchange_weak_explicit(&write_position, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // The reader has not freed this slot yet: the ring is full
+            atomic_fetch_add_explicit(&dropped_count, 1, memory_order_relaxed);
+            return false;
+        } else {
+            // Another producer took this position
+            position = atomic_load_explicit(&write_position, memory_order_relaxed);
+        }
+    }
+    slot->record.timestamp_us = esp_timer_get_time();
+    slot->record.id = (uint16_t)id;
+    slot->record.arg_count = arg_count > BINARY_LOG_MAX_ARGS ? BINARY_LOG_MAX_ARGS : arg_count;
+    slot->record.args[0] = a0;
+    slot->record.args[1] = a1;
+    slot->record.args[2] = a2;
+    slot->record.args[3] = a3;
+    atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+    return true;
+}
+
+bool binary_log_read(binary_log_record_t *record) {
+    binary_log_slot_t *slot = &ring[read_position & RING_MASK];
+    unsigned sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    if (sequence != read_position + 1) {
+        return false; // Empty, or the producer is still writing
+    }
+    *record = slot->record;
+    atomic_store_explicit(&slot->sequence, read_position + BINARY_LOG_RING_SIZE, memory_order_release);
+    read_position++;
+    return true;
+}
+
+static void print_hex_le(uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        printf("%02x", (unsigned)((value >> (8 * i)) & 0xff));
+    }
+}
+
+void binary_log_drain(void *pvParameters) {
+    static binary_log_record_t record;
+    while (1) {
+        while (binary_log_read(&record)) {
+            printf("BLOG:");
+            print_hex_le((uint64_t)record.timestamp_us, 8);
+            print_hex_le(record.id, 2);
+            print_hex_le(record.arg_count, 1);
+            for (int i = 0; i < record.arg_count; i++) {
+                print_hex_le((uint32_t)record.args[i], 4);
+            }
+            printf("\n");
+        }
+        unsigned dropped = atomic_exchange_explicit(&dropped_count, 0, memory_order_relaxed);
+        if (dropped > 0) {
+            printf("BLOG dropped %u records\n", dropped);
+        }
+        vTaskDelay(pdMS_TO_TICKS(DRAIN_PERIOD_MS));
+    }
+}
@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+"""Decode BLOG lines from the firmware's binary log into readable messages.
+
+Usage:
+    idf.py monitor | python components/binary_log/tools/binary_log_decode.py
+    python components/binary_log/tools/binary_log_decode.py monitor.log
+
+Lines that are not BLOG records are passed through unchanged. Message formats
+come from include/binary_log_ids.def, so the firmware never carries them.
+"""
+
+import os
+import re
+import struct
+import sys
+
+IDS_FILE = os.path.join(os.path.dirname(__file__), "..", "include", "binary_log_ids.def")
+ENTRY = re.compile(r'^\s*BINARY_LOG_ID\(\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+RECORD = re.compile(r"BLOG:([0-9a-fA-F]+)")
+HEADER = struct.Struct("<qHB")
+
+
+def load_formats(path=IDS_FILE):
+    """Return [(name, format)] in ID order."""
+    formats = []
+    with open(path, encoding="utf-8") as ids:
+        for line in ids:
+            match = ENTRY.match(line)
+            if match:
+                formats.append((match.group(1), match.group(2)))
+    return formats
+
+
+def decode(hex_record, formats):
+    data = bytes.fromhex(hex_record)
+    timestamp_us, message_id, arg_count = HEADER.unpack_from(data)
+    args = struct.unpack_from("<%di" % arg_count, data, HEADER.size)
+    if message_id >= len(formats):
+        return "%12.6f BLOG unknown id %d args %s" % (timestamp_us / 1e6, message_id, list(args))
+    name, fmt = formats[message_id]
+    try:
+        message = fmt % args
+    except (TypeError, ValueError):
+        message = "%s %s" % (fmt, list(args))
+    return "%12.6f %s: %s" % (timestamp_us / 1e6, name, message)
+
+
+def main():
+    formats = load_formats()
+    stream = open(sys.argv[1], encoding="utf-8", errors="replace") if len(sys.argv) > 1 else sys.stdin
+    for line in stream:
+        match = RECORD.search(line)
+        if match:
+            print(decode(match.group(1), formats))
+        else:
+            print(line, end="")
+
+
+if __name__ == "__main__":
+    main()
@@ -6,6 +6,10 @@
 
 #include "garage_config.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /**
  * The purpose of the button token is to ensure that the button is pressed only when the client observes a "push button" request from the server.
  * To simplify the memory and timing requirements, we introduce the concept of a button token, which is changed every time the server wants the client to push a button.
@@ -29,4 +33,8 @@ typedef struct {
 
 extern button_token_manager_t token_manager;
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif // DOOR_BUTTON_H
@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "esp_log.h"
+#include "garage_core/button_token.h"
 
 static const char *TAG = "button_token";
 
@@ -14,20 +15,16 @@ static void button_init(button_token_t *token) {
 }
 
 static bool is_button_press_requested(button_token_t *token, const char *new_token) {
-    if (strcmp(*token, new_token) == 0) {
-        ESP_LOGD(TAG, "Button token is not changed");
+    if (!garage_core::is_button_press_requested(*token, new_token)) {
+        ESP_LOGD(TAG, "Button press not requested because button token is empty or not changed");
         return false;
-    } else if (strlen(new_token) == 0) {
-        ESP_LOGD(TAG, "Button press not requested because button token is empty");
-        return false;
-    } else {
-        // Button token is sensitive — anyone with a UART connection (USB cable
-        // to the dev board) can read INFO-level logs. Log at DEBUG so the
-        // token only appears in builds that explicitly raise the log level
-        // above the default INFO threshold. Security audit reference: C2.
-        ESP_LOGD(TAG, "Push the button for %s", new_token);
-        return true;
     }
+    // Button token is sensitive — anyone with a UART connection (USB cable
+    // to the dev board) can read INFO-level logs. Log at DEBUG so the
+    // token only appears in builds that explicitly raise the log level
+    // above the default INFO threshold. Security audit reference: C2.
+    ESP_LOGD(TAG, "Push the button for %s", new_token);
+    return true;
 }
 
 static void consume_button_token(button_token_t *token, const char *new_token) {
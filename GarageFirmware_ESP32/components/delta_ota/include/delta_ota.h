@@ -0,0 +1,39 @@
+#ifndef DELTA_OTA_H
+#define DELTA_OTA_H
+
+#include "esp_err.h"
+
+/**
+ * Over-the-air updates from delta patches, into the ota_0/ota_1 partitions.
+ * Enable with GARAGE_OTA in idf.py menuconfig.
+ *
+ * The device asks for CONFIG_GARAGE_OTA_BASE_URL/<name>.gdp, where <name> is the first
+ * 16 hex digits of the running image's ELF SHA-256. 404 means there is no update.
+ * Make a patch on the host against the image the devices run:
+ *
+ *   python components/delta_ota/tools/delta_patch.py diff old.bin build/<project>.bin <dir>
+ *
+ * The patch is inflated and applied as it downloads, reading the old image from the running
+ * partition. RAM is bounded by the 32 KB inflate window, not the image size. The running image
+ * must match the patch's old SHA-256 before anything is written, and the new image must match
+ * its SHA-256 and pass esp_ota_end() before the boot partition changes.
+ */
+
+/**
+ * @brief Download and apply the patch for the running image. Blocks until done.
+ *
+ * @return ESP_OK if a new image is ready and set to boot (call esp_restart()),
+ *         ESP_ERR_NOT_FOUND if there is no patch for this image,
+ *         ESP_ERR_NOT_SUPPORTED if GARAGE_OTA is disabled, or another error.
+ */
+esp_err_t delta_ota_update(void);
+
+/**
+ * @brief Keep the running image after an update. Call once the server has been reached.
+ *
+ * With rollback enabled, an updated image that resets before this is called is replaced by
+ * the previous one on the next boot.
+ */
+void delta_ota_confirm_running_image(void);
+
+#endif // DELTA_OTA_H
@@ -0,0 +1,92 @@
+#ifndef DELTA_PATCH_H
+#define DELTA_PATCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Streaming applier for delta patches made by tools/delta_patch.py. Plain C with no
+ * ESP-IDF dependencies, so it also builds on the host.
+ *
+ * Patch layout, little endian:
+ *
+ *   header: "GDP1" <old_size u32> <new_size u32> <old_sha256 [32]> <new_sha256 [32]>
+ *   block:  <diff_len u32> <extra_len u32> <seek i32>
+ *           <diff_len bytes added (mod 256) to the old image at the old position>
+ *           <extra_len bytes copied to the new image as they are>
+ *
+ * Blocks repeat until new_size bytes are written. After each block the old position moves
+ * by diff_len + seek. This is the bsdiff control/diff/extra scheme with the three streams
+ * interleaved, so one pass over the patch produces the new image in order. The diff bytes
+ * are mostly zero for recompiled code, which is what makes the compressed patch small.
+ *
+ * Feed the patch in chunks of any size. RAM use is the delta_patch_t, whatever the patch
+ * or image size.
+ */
+
+#define DELTA_PATCH_MAGIC "GDP1"
+#define DELTA_PATCH_MAGIC_LENGTH 4
+#define DELTA_PATCH_SHA256_LENGTH 32
+#define DELTA_PATCH_HEADER_SIZE (DELTA_PATCH_MAGIC_LENGTH + 8 + 2 * DELTA_PATCH_SHA256_LENGTH)
+#define DELTA_PATCH_BLOCK_HEADER_SIZE 12
+#define DELTA_PATCH_CHUNK_SIZE 256
+
+typedef enum {
+    DELTA_PATCH_MORE = 0,          // Waiting for more patch data
+    DELTA_PATCH_DONE = 1,          // The new image is complete
+    DELTA_PATCH_ERR_MAGIC = -1,    // Not a delta patch
+    DELTA_PATCH_ERR_CORRUPT = -2,  // A block reaches outside the old or new image
+    DELTA_PATCH_ERR_TRAILING = -3, // Data after the new image was complete
+    DELTA_PATCH_ERR_CALLBACK = -4, // A callback failed
+} delta_patch_result_t;
+
+typedef struct {
+    uint32_t old_size;
+    uint32_t new_size;
+    uint8_t old_sha256[DELTA_PATCH_SHA256_LENGTH];
+    uint8_t new_sha256[DELTA_PATCH_SHA256_LENGTH];
+} delta_patch_header_t;
+
+/**
+ * Callbacks return true on success. on_header runs once, before anything is written,
+ * so the caller can check the old image and prepare the destination.
+ */
+typedef struct {
+    bool (*on_header)(const delta_patch_header_t *header, void *ctx);
+    bool (*read_old)(uint32_t offset, uint8_t *buffer, size_t length, void *ctx);
+    bool (*write_new)(const uint8_t *data, size_t length, void *ctx);
+    void *ctx;
+} delta_patch_callbacks_t;
+
+typedef struct {
+    delta_patch_callbacks_t callbacks;
+    delta_patch_header_t header;
+    int state;
+    delta_patch_result_t result;
+    // Header or block header being collected
+    uint8_t field[DELTA_PATCH_HEADER_SIZE];
+    size_t field_length;
+    // Current block
+    uint32_t diff_remaining;
+    uint32_t extra_remaining;
+    int32_t seek;
+    uint32_t old_position;
+    uint32_t new_position;
+    // Bounded buffers for old image reads and new image writes
+    uint8_t old_chunk[DELTA_PATCH_CHUNK_SIZE];
+    uint8_t out_chunk[DELTA_PATCH_CHUNK_SIZE];
+    size_t out_length;
+} delta_patch_t;
+
+void delta_patch_init(delta_patch_t *patch, const delta_patch_callbacks_t *callbacks);
+
+/**
+ * @brief Apply the next part of the patch.
+ *
+ * @return DELTA_PATCH_MORE until the new image is complete, then DELTA_PATCH_DONE.
+ *         Errors are negative and sticky.
+ */
+delta_patch_result_t delta_patch_feed(delta_patch_t *patch, const uint8_t *data, size_t length);
+
+#endif // DELTA_PATCH_H
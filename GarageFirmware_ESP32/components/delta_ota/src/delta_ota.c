@@ -0,0 +1,263 @@
+#include "delta_ota.h"
+
+#ifdef CONFIG_GARAGE_OTA
+
+#include "delta_patch.h"
+#include "esp_app_desc.h"
+#include "esp_http_client.h"
+#include "esp_log.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "esp_timer.h"
+#include "mbedtls/sha256.h"
+#include "rom/miniz.h"
+#include "root_ca.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Set the update server with: idf.py menuconfig
+#define OTA_BASE_URL CONFIG_GARAGE_OTA_BASE_URL
+
+#define OTA_NAME_HEX_DIGITS 16
+#define OTA_URL_SIZE 256
+#define OTA_HTTP_CHUNK_SIZE 1024
+#define OTA_HASH_CHUNK_SIZE 1024
+#define OTA_HTTP_TIMEOUT_MS 30000
+
+static const char *TAG = "delta_ota";
+
+// Everything one update needs. About 45 KB, so it is allocated for the update only
+// instead of holding the inflate window in static RAM forever.
+typedef struct {
+    const esp_partition_t *running;
+    const esp_partition_t *update;
+    esp_ota_handle_t handle;
+    bool ota_started;
+    mbedtls_sha256_context new_sha;
+    delta_patch_t patch;
+    tinfl_decompressor inflator;
+    uint8_t window[TINFL_LZ_DICT_SIZE]; // Inflate output doubles as the LZ77 window
+    size_t window_offset;
+    uint8_t buffer[OTA_HASH_CHUNK_SIZE > OTA_HTTP_CHUNK_SIZE ? OTA_HASH_CHUNK_SIZE : OTA_HTTP_CHUNK_SIZE];
+} ota_session_t;
+
+// The patch only applies to the exact image it was made from
+static bool running_image_matches(ota_session_t *session, const delta_patch_header_t *header) {
+    if (header->old_size > session->running->size) {
+        return false;
+    }
+    mbedtls_sha256_context sha;
+    uint8_t digest[DELTA_PATCH_SHA256_LENGTH];
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0);
+    bool ok = true;
+    for (uint32_t offset = 0; offset < header->old_size && ok; offset += OTA_HASH_CHUNK_SIZE) {
+        size_t length = header->old_size - offset < OTA_HASH_CHUNK_SIZE ? header->old_size - offset : OTA_HASH_CHUNK_SIZE;
+        ok = esp_partition_read(session->running, offset, session->buffer, length) == ESP_OK;
+        mbedtls_sha256_update(&sha, session->buffer, length);
+    }
+    mbedtls_sha256_finish(&sha, digest);
+    mbedtls_sha256_free(&sha);
+    return ok && memcmp(digest, header->old_sha256, sizeof(digest)) == 0;
+}
+
+static bool on_patch_header(const delta_patch_header_t *header, void *ctx) {
+    ota_session_t *session = ctx;
+    if (!running_image_matches(session, header)) {
+        ESP_LOGE(TAG, "Patch was made for a different image");
+        return false;
+    }
+    if (header->new_size > session->update->size) {
+        ESP_LOGE(TAG, "New image of %" PRIu32 " bytes does not fit in %s", header->new_size, session->update->label);
+        return false;
+    }
+    esp_err_t err = esp_ota_begin(session->update, header->new_size, &session->handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "esp_ota_begin failed: %s", esp_err_to_name(err));
+        return false;
+    }
+    session->ota_started = true;
+    ESP_LOGI(TAG, "Patching %" PRIu32 " byte image into %s", header->new_size, session->update->label);
+    return true;
+}
+
+static bool read_old_image(uint32_t offset, uint8_t *buffer, size_t length, void *ctx) {
+    ota_session_t *session = ctx;
+    return esp_partition_read(session->running, offset, buffer, length) == ESP_OK;
+}
+
+static bool write_new_image(const uint8_t *data, size_t length, void *ctx) {
+    ota_session_t *session = ctx;
+    mbedtls_sha256_update(&session->new_sha, data, length);
+    return esp_ota_write(session->handle, data, length) == ESP_OK;
+}
+
+/**
+ * Inflate one downloaded chunk and feed the output to the patch.
+ * Returns the patch result, or DELTA_PATCH_ERR_CORRUPT if the zlib stream is bad.
+ */
+static delta_patch_result_t inflate_and_apply(ota_session_t *session, const uint8_t *in, size_t in_length, bool more_input, bool *inflate_done) {
+    delta_patch_result_t result = DELTA_PATCH_MORE;
+    while (true) {
+        size_t in_bytes = in_length;
+        size_t out_bytes = TINFL_LZ_DICT_SIZE - session->window_offset;
+        tinfl_status status = tinfl_decompress(&session->inflator, in, &in_bytes,
+                                               session->window, session->window + session->window_offset, &out_bytes,
+                                               TINFL_FLAG_PARSE_ZLIB_HEADER | (more_input ? TINFL_FLAG_HAS_MORE_INPUT : 0));
+        in += in_bytes;
+        in_length -= in_bytes;
+        result = delta_patch_feed(&session->patch, session->window + session->window_offset, out_bytes);
+        session->window_offset = (session->window_offset + out_bytes) & (TINFL_LZ_DICT_SIZE - 1);
+        if (result < 0) {
+            return result;
+        }
+        if (status == TINFL_STATUS_DONE) {
+            *inflate_done = true;
+            return result;
+        }
+        if (status < 0) {
+            ESP_LOGE(TAG, "Patch is not a valid zlib stream: %d", status);
+            return DELTA_PATCH_ERR_CORRUPT;
+        }
+        if (status == TINFL_STATUS_NEEDS_MORE_INPUT) {
+            return result;
+        }
+        // TINFL_STATUS_HAS_MORE_OUTPUT: the window filled up, keep going
+    }
+}
+
+static esp_err_t download_and_apply(ota_session_t *session, esp_http_client_handle_t client, size_t *patch_bytes) {
+    const delta_patch_callbacks_t callbacks = {
+        .on_header = on_patch_header,
+        .read_old = read_old_image,
+        .write_new = write_new_image,
+        .ctx = session,
+    };
+    delta_patch_init(&session->patch, &callbacks);
+    tinfl_init(&session->inflator);
+    mbedtls_sha256_init(&session->new_sha);
+    mbedtls_sha256_starts(&session->new_sha, 0);
+
+    bool inflate_done = false;
+    delta_patch_result_t result = DELTA_PATCH_MORE;
+    while (!inflate_done) {
+        int read = esp_http_client_read(client, (char *)session->buffer, OTA_HTTP_CHUNK_SIZE);
+        if (read < 0) {
+            ESP_LOGE(TAG, "Download failed after %u bytes", (unsigned)*patch_bytes);
+            return ESP_FAIL;
+        }
+        *patch_bytes += read;
+        result = inflate_and_apply(session, session->buffer, read, read > 0, &inflate_done);
+        if (result < 0) {
+            ESP_LOGE(TAG, "Patch failed: %d", result);
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+        if (read == 0) {
+            break;
+        }
+    }
+    if (result != DELTA_PATCH_DONE || !inflate_done) {
+        ESP_LOGE(TAG, "Patch ended early after %u bytes", (unsigned)*patch_bytes);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    uint8_t digest[DELTA_PATCH_SHA256_LENGTH];
+    mbedtls_sha256_finish(&session->new_sha, digest);
+    if (memcmp(digest, session->patch.header.new_sha256, sizeof(digest)) != 0) {
+        ESP_LOGE(TAG, "New image SHA-256 does not match the patch");
+        return ESP_ERR_INVALID_CRC;
+    }
+    // Also validates the image format, and the signature with secure boot
+    session->ota_started = false;
+    esp_err_t err = esp_ota_end(session->handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "esp_ota_end failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    return esp_ota_set_boot_partition(session->update);
+}
+
+esp_err_t delta_ota_update(void) {
+    char name[OTA_NAME_HEX_DIGITS + 1];
+    char url[OTA_URL_SIZE];
+    esp_app_get_elf_sha256(name, sizeof(name));
+    snprintf(url, sizeof(url), "%s/%s.gdp", OTA_BASE_URL, name);
+
+    esp_http_client_config_t config = {
+        .url = url,
+        .cert_pem = (const char *)server_root_cert_pem_start,
+        .timeout_ms = OTA_HTTP_TIMEOUT_MS,
+    };
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+    esp_err_t err = esp_http_client_open(client, 0);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to reach the update server: %s", esp_err_to_name(err));
+        esp_http_client_cleanup(client);
+        return err;
+    }
+    esp_http_client_fetch_headers(client);
+    int status_code = esp_http_client_get_status_code(client);
+    if (status_code != 200) {
+        if (status_code == 404) {
+            ESP_LOGI(TAG, "No update for image %s", name);
+        } else {
+            ESP_LOGE(TAG, "Update server returned %d", status_code);
+        }
+        esp_http_client_cleanup(client);
+        return status_code == 404 ? ESP_ERR_NOT_FOUND : ESP_FAIL;
+    }
+
+    ota_session_t *session = calloc(1, sizeof(ota_session_t));
+    if (session == NULL) {
+        esp_http_client_cleanup(client);
+        return ESP_ERR_NO_MEM;
+    }
+    session->running = esp_ota_get_running_partition();
+    session->update = esp_ota_get_next_update_partition(NULL);
+    if (session->update == NULL) {
+        ESP_LOGE(TAG, "No OTA partition to update, check the partition table");
+        err = ESP_ERR_NOT_FOUND;
+    } else {
+        int64_t start_us = esp_timer_get_time();
+        size_t patch_bytes = 0;
+        err = download_and_apply(session, client, &patch_bytes);
+        if (err == ESP_OK) {
+            ESP_LOGI(TAG, "Update ready in %s: %u byte patch for a %" PRIu32 " byte image in %lld ms",
+                     session->update->label, (unsigned)patch_bytes, session->patch.header.new_size,
+                     (long long)((esp_timer_get_time() - start_us) / 1000));
+        }
+    }
+    if (session->ota_started) {
+        esp_ota_abort(session->handle);
+    }
+    mbedtls_sha256_free(&session->new_sha);
+    free(session);
+    esp_http_client_cleanup(client);
+    return err;
+}
+
+void delta_ota_confirm_running_image(void) {
+    static bool confirmed = false;
+    if (confirmed) {
+        return;
+    }
+    confirmed = true;
+    esp_ota_img_states_t state;
+    if (esp_ota_get_state_partition(esp_ota_get_running_partition(), &state) == ESP_OK && state == ESP_OTA_IMG_PENDING_VERIFY) {
+        esp_ota_mark_app_valid_cancel_rollback();
+        ESP_LOGI(TAG, "Updated image confirmed");
+    }
+}
+
+#else // CONFIG_GARAGE_OTA
+
+esp_err_t delta_ota_update(void) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void delta_ota_confirm_running_image(void) {
+}
+
+#endif // CONFIG_GARAGE_OTA
@@ -0,0 +1,195 @@
+#include "delta_patch.h"
+
+#include <string.h>
+
+typedef enum {
+    STATE_HEADER,
+    STATE_BLOCK_HEADER,
+    STATE_DIFF,
+    STATE_EXTRA,
+    STATE_DONE,
+} patch_state_t;
+
+static uint32_t read_u32(const uint8_t *bytes) {
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+void delta_patch_init(delta_patch_t *patch, const delta_patch_callbacks_t *callbacks) {
+    memset(patch, 0, sizeof(*patch));
+    patch->callbacks = *callbacks;
+    patch->state = STATE_HEADER;
+    patch->result = DELTA_PATCH_MORE;
+}
+
+static delta_patch_result_t fail(delta_patch_t *patch, delta_patch_result_t result) {
+    patch->result = result;
+    return result;
+}
+
+static bool flush_output(delta_patch_t *patch) {
+    if (patch->out_length == 0) {
+        return true;
+    }
+    bool ok = patch->callbacks.write_new(patch->out_chunk, patch->out_length, patch->callbacks.ctx);
+    patch->out_length = 0;
+    return ok;
+}
+
+// Collect a fixed-size field that may be split across feed calls. Returns true when complete.
+static bool collect_field(delta_patch_t *patch, size_t field_size, const uint8_t **data, size_t *length) {
+    size_t take = field_size - patch->field_length;
+    if (take > *length) {
+        take = *length;
+    }
+    memcpy(patch->field + patch->field_length, *data, take);
+    patch->field_length += take;
+    *data += take;
+    *length -= take;
+    if (patch->field_length < field_size) {
+        return false;
+    }
+    patch->field_length = 0;
+    return true;
+}
+
+// A block has been fully applied: move the old position, then finish or expect the next block
+static delta_patch_result_t end_block(delta_patch_t *patch) {
+    int64_t old_position = (int64_t)patch->old_position + patch->seek;
+    if (old_position < 0 || old_position > patch->header.old_size) {
+        return fail(patch, DELTA_PATCH_ERR_CORRUPT);
+    }
+    patch->old_position = (uint32_t)old_position;
+    if (patch->new_position == patch->header.new_size) {
+        if (!flush_output(patch)) {
+            return fail(patch, DELTA_PATCH_ERR_CALLBACK);
+        }
+        patch->state = STATE_DONE;
+        return DELTA_PATCH_DONE;
+    }
+    patch->state = STATE_BLOCK_HEADER;
+    return DELTA_PATCH_MORE;
+}
+
+static delta_patch_result_t parse_block_header(delta_patch_t *patch) {
+    uint32_t diff_length = read_u32(patch->field);
+    uint32_t extra_length = read_u32(patch->field + 4);
+    patch->seek = (int32_t)read_u32(patch->field + 8);
+    uint32_t new_remaining = patch->header.new_size - patch->new_position;
+    if (diff_length > new_remaining || extra_length > new_remaining - diff_length ||
+        diff_length > patch->header.old_size - patch->old_position) {
+        return fail(patch, DELTA_PATCH_ERR_CORRUPT);
+    }
+    patch->diff_remaining = diff_length;
+    patch->extra_remaining = extra_length;
+    patch->state = STATE_DIFF;
+    return DELTA_PATCH_MORE;
+}
+
+// Add diff bytes to the old image, one bounded chunk at a time
+static delta_patch_result_t apply_diff(delta_patch_t *patch, const uint8_t **data, size_t *length) {
+    size_t count = DELTA_PATCH_CHUNK_SIZE - patch->out_length;
+    if (count > patch->diff_remaining) {
+        count = patch->diff_remaining;
+    }
+    if (count > *length) {
+        count = *length;
+    }
+    if (!patch->callbacks.read_old(patch->old_position, patch->old_chunk, count, patch->callbacks.ctx)) {
+        return fail(patch, DELTA_PATCH_ERR_CALLBACK);
+    }
+    uint8_t *out = patch->out_chunk + patch->out_length;
+    for (size_t i = 0; i < count; i++) {
+        out[i] = (uint8_t)(patch->old_chunk[i] + (*data)[i]);
+    }
+    patch->out_length += count;
+    patch->old_position += count;
+    patch->new_position += count;
+    patch->diff_remaining -= count;
+    *data += count;
+    *length -= count;
+    return DELTA_PATCH_MORE;
+}
+
+static void copy_extra(delta_patch_t *patch, const uint8_t **data, size_t *length) {
+    size_t count = DELTA_PATCH_CHUNK_SIZE - patch->out_length;
+    if (count > patch->extra_remaining) {
+        count = patch->extra_remaining;
+    }
+    if (count > *length) {
+        count = *length;
+    }
+    memcpy(patch->out_chunk + patch->out_length, *data, count);
+    patch->out_length += count;
+    patch->new_position += count;
+    patch->extra_remaining -= count;
+    *data += count;
+    *length -= count;
+}
+
+delta_patch_result_t delta_patch_feed(delta_patch_t *patch, const uint8_t *data, size_t length) {
+    if (patch->result < 0) {
+        return patch->result;
+    }
+    while (length > 0 || patch->state == STATE_DIFF || patch->state == STATE_EXTRA) {
+        if (patch->out_length == DELTA_PATCH_CHUNK_SIZE && !flush_output(patch)) {
+            return fail(patch, DELTA_PATCH_ERR_CALLBACK);
+        }
+        switch (patch->state) {
+        case STATE_HEADER:
+            if (!collect_field(patch, DELTA_PATCH_HEADER_SIZE, &data, &length)) {
+                return DELTA_PATCH_MORE;
+            }
+            if (memcmp(patch->field, DELTA_PATCH_MAGIC, DELTA_PATCH_MAGIC_LENGTH) != 0) {
+                return fail(patch, DELTA_PATCH_ERR_MAGIC);
+            }
+            patch->header.old_size = read_u32(patch->field + 4);
+            patch->header.new_size = read_u32(patch->field + 8);
+            memcpy(patch->header.old_sha256, patch->field + 12, DELTA_PATCH_SHA256_LENGTH);
+            memcpy(patch->header.new_sha256, patch->field + 12 + DELTA_PATCH_SHA256_LENGTH, DELTA_PATCH_SHA256_LENGTH);
+            if (patch->callbacks.on_header != NULL && !patch->callbacks.on_header(&patch->header, patch->callbacks.ctx)) {
+                return fail(patch, DELTA_PATCH_ERR_CALLBACK);
+            }
+            if (patch->header.new_size == 0) {
+                patch->state = STATE_DONE;
+                return length > 0 ? fail(patch, DELTA_PATCH_ERR_TRAILING) : DELTA_PATCH_DONE;
+            }
+            patch->state = STATE_BLOCK_HEADER;
+            break;
+        case STATE_BLOCK_HEADER:
+            if (!collect_field(patch, DELTA_PATCH_BLOCK_HEADER_SIZE, &data, &length)) {
+                return DELTA_PATCH_MORE;
+            }
+            if (parse_block_header(patch) < 0) {
+                return patch->result;
+            }
+            break;
+        case STATE_DIFF:
+            if (patch->diff_remaining == 0) {
+                patch->state = STATE_EXTRA;
+                break;
+            }
+            if (length == 0) {
+                return DELTA_PATCH_MORE;
+            }
+            if (apply_diff(patch, &data, &length) < 0) {
+                return patch->result;
+            }
+            break;
+        case STATE_EXTRA:
+            if (patch->extra_remaining == 0) {
+                if (end_block(patch) < 0) {
+                    return patch->result;
+                }
+                break;
+            }
+            if (length == 0) {
+                return DELTA_PATCH_MORE;
+            }
+            copy_extra(patch, &data, &length);
+            break;
+        case STATE_DONE:
+            return length > 0 ? fail(patch, DELTA_PATCH_ERR_TRAILING) : DELTA_PATCH_DONE;
+        }
+    }
+    return patch->state == STATE_DONE ? DELTA_PATCH_DONE : DELTA_PATCH_MORE;
+}
@@ -0,0 +1,147 @@
+// Apply a raw (uncompressed) patch with src/delta_patch.c, feeding it in random chunk sizes.
+//   delta_patch_apply <old.bin> <patch> <new.bin> <seed> <rounds>   Rebuild new.bin, every round
+//   delta_patch_apply <old.bin> <patch> - <seed> <rounds>           Damaged patch: must not crash
+#include "delta_patch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    const uint8_t *old;
+    size_t old_size;
+    uint8_t *out;
+    size_t out_size;
+    size_t out_capacity;
+    bool header_seen;
+} apply_ctx_t;
+
+static uint8_t *read_file(const char *path, size_t *size) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        exit(2);
+    }
+    fseek(f, 0, SEEK_END);
+    long length = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    // One spare byte so an empty file still gets a buffer
+    uint8_t *data = malloc((size_t)length + 1);
+    if (data == NULL || fread(data, 1, (size_t)length, f) != (size_t)length) {
+        perror(path);
+        exit(2);
+    }
+    fclose(f);
+    *size = (size_t)length;
+    return data;
+}
+
+static bool on_header(const delta_patch_header_t *header, void *ctx) {
+    apply_ctx_t *apply = ctx;
+    if (apply->header_seen || header->old_size != apply->old_size) {
+        return false;
+    }
+    apply->header_seen = true;
+    return true;
+}
+
+// The applier must never ask for bytes outside the old image
+static bool read_old(uint32_t offset, uint8_t *buffer, size_t length, void *ctx) {
+    apply_ctx_t *apply = ctx;
+    if (length > DELTA_PATCH_CHUNK_SIZE || offset > apply->old_size || length > apply->old_size - offset) {
+        fprintf(stderr, "read_old(%u, %zu) outside the old image (%zu bytes)\n", offset, length, apply->old_size);
+        abort();
+    }
+    memcpy(buffer, apply->old + offset, length);
+    return true;
+}
+
+static bool write_new(const uint8_t *data, size_t length, void *ctx) {
+    apply_ctx_t *apply = ctx;
+    if (length == 0 || length > DELTA_PATCH_CHUNK_SIZE || length > apply->out_capacity - apply->out_size) {
+        fprintf(stderr, "write_new(%zu) past the new image\n", length);
+        abort();
+    }
+    memcpy(apply->out + apply->out_size, data, length);
+    apply->out_size += length;
+    return true;
+}
+
+// Mostly small chunks so fields split across feeds, sometimes one byte or a large run
+static size_t next_chunk(void) {
+    switch (rand() % 4) {
+    case 0:
+        return 1;
+    case 1:
+        return 1 + (size_t)(rand() % 16);
+    case 2:
+        return 1 + (size_t)(rand() % (2 * DELTA_PATCH_CHUNK_SIZE));
+    default:
+        return 1 + (size_t)(rand() % 8192);
+    }
+}
+
+static delta_patch_result_t apply(apply_ctx_t *ctx, const uint8_t *patch_data, size_t patch_size) {
+    delta_patch_callbacks_t callbacks = {
+        .on_header = on_header,
+        .read_old = read_old,
+        .write_new = write_new,
+        .ctx = ctx,
+    };
+    // On the heap so ASan sees overruns of the fixed buffers
+    delta_patch_t *patch = malloc(sizeof(*patch));
+    delta_patch_init(patch, &callbacks);
+    delta_patch_result_t result = DELTA_PATCH_MORE;
+    size_t position = 0;
+    while (position < patch_size && result >= 0) {
+        size_t chunk = next_chunk();
+        if (chunk > patch_size - position) {
+            chunk = patch_size - position;
+        }
+        // Copy each chunk into its own allocation so reads past it are caught
+        uint8_t *part = malloc(chunk);
+        memcpy(part, patch_data + position, chunk);
+        result = delta_patch_feed(patch, part, chunk);
+        free(part);
+        position += chunk;
+    }
+    free(patch);
+    return result;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 6) {
+        fprintf(stderr, "usage: %s <old.bin> <patch> <new.bin|-> <seed> <rounds>\n", argv[0]);
+        return 2;
+    }
+    size_t old_size, patch_size, expected_size = 0;
+    uint8_t *old = read_file(argv[1], &old_size);
+    uint8_t *patch_data = read_file(argv[2], &patch_size);
+    bool damaged = strcmp(argv[3], "-") == 0;
+    uint8_t *expected = damaged ? NULL : read_file(argv[3], &expected_size);
+    srand((unsigned)strtoul(argv[4], NULL, 10));
+    int rounds = atoi(argv[5]);
+
+    // Every new byte comes from one patch byte, so a damaged patch can't write more than that
+    size_t capacity = damaged ? patch_size : expected_size;
+    apply_ctx_t ctx = {.old = old, .old_size = old_size, .out = malloc(capacity + 1), .out_capacity = capacity};
+    for (int round = 0; round < rounds; round++) {
+        ctx.out_size = 0;
+        ctx.header_seen = false;
+        delta_patch_result_t result = apply(&ctx, patch_data, patch_size);
+        if (damaged) {
+            continue;
+        }
+        if (result != DELTA_PATCH_DONE || ctx.out_size != expected_size ||
+            memcmp(ctx.out, expected, expected_size) != 0) {
+            fprintf(stderr, "%s: round %d gave result %d and %zu of %zu bytes\n", argv[2], round, result,
+                    ctx.out_size, expected_size);
+            return 1;
+        }
+    }
+    free(ctx.out);
+    free(expected);
+    free(patch_data);
+    free(old);
+    return 0;
+}
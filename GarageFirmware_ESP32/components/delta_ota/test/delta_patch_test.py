@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""Make patches with tools/delta_patch.py and apply them with the host build of src/delta_patch.c.
+
+Usage: delta_patch_test.py <delta_patch_apply>
+
+Each case is applied ROUNDS times with different random chunkings of the patch, then a set of
+damaged copies of it (truncated, bit flips) are fed to check the applier fails safely.
+"""
+
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "tools"))
+import delta_patch  # noqa: E402
+
+SEED = 20261018
+ROUNDS = 20
+DAMAGED_COPIES = 8
+
+
+def firmware_like(rng, size):
+    """Repeating instruction-like words with some noise, so the matcher finds long runs."""
+    words = [rng.getrandbits(32).to_bytes(4, "little") for _ in range(64)]
+    out = bytearray()
+    while len(out) < size:
+        out += rng.choice(words) if rng.random() < 0.9 else bytes([rng.getrandbits(8)])
+    return bytes(out[:size])
+
+
+def edit(rng, image, edits):
+    """Insert, delete and change small runs, the way a rebuild shifts and patches code."""
+    new = bytearray(image)
+    for _ in range(edits):
+        at = rng.randrange(len(new) + 1)
+        kind = rng.randrange(3)
+        run = rng.randrange(1, 64)
+        if kind == 0:
+            new[at:at] = bytes(rng.getrandbits(8) for _ in range(run))
+        elif kind == 1:
+            del new[at:at + run]
+        else:
+            for k in range(at, min(at + run, len(new))):
+                new[k] = (new[k] + rng.randrange(1, 4)) & 0xFF
+    return bytes(new)
+
+
+def cases(rng):
+    base = firmware_like(rng, 48 * 1024)
+    yield "identical", base, base
+    yield "few edits", base, edit(rng, base, 5)
+    yield "many edits", base, edit(rng, base, 200)
+    yield "grown", base, base + firmware_like(rng, 4096)
+    yield "shrunk", base, base[:20000]
+    yield "unrelated", base, bytes(rng.getrandbits(8) for _ in range(8192))
+    yield "empty new", base, b""
+    yield "empty old", b"", base[:4096]
+    yield "tiny", b"abc", b"abcd"
+
+
+def damage(rng, patch):
+    if rng.random() < 0.3:
+        return patch[:rng.randrange(len(patch))]
+    damaged = bytearray(patch)
+    for _ in range(rng.randrange(1, 4)):
+        damaged[rng.randrange(len(damaged))] ^= 1 << rng.randrange(8)
+    return bytes(damaged)
+
+
+def run(applier, old_path, patch_path, new_path, seed):
+    return subprocess.run([applier, old_path, patch_path, new_path, str(seed), str(ROUNDS)]).returncode
+
+
+def main():
+    applier = sys.argv[1]
+    rng = random.Random(SEED)
+    failures = 0
+    with tempfile.TemporaryDirectory() as tmp:
+        old_path, new_path, patch_path = (os.path.join(tmp, name) for name in ("old.bin", "new.bin", "patch"))
+        for name, old, new in cases(rng):
+            patch = delta_patch.make_patch(old, new)
+            if delta_patch.apply_patch(old, patch) != new:
+                print(f"FAIL {name}: reference applier does not rebuild the new image")
+                failures += 1
+                continue
+            for path, data in ((old_path, old), (new_path, new), (patch_path, patch)):
+                with open(path, "wb") as f:
+                    f.write(data)
+            if run(applier, old_path, patch_path, new_path, rng.getrandbits(31)) != 0:
+                print(f"FAIL {name}: applier did not rebuild the new image")
+                failures += 1
+                continue
+            for _ in range(DAMAGED_COPIES):
+                with open(patch_path, "wb") as f:
+                    f.write(damage(rng, patch))
+                if run(applier, old_path, patch_path, "-", rng.getrandbits(31)) != 0:
+                    print(f"FAIL {name}: applier crashed on a damaged patch")
+                    failures += 1
+                    break
+            print(f"ok   {name}: {len(old)} -> {len(new)} bytes, patch {len(patch)} bytes")
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+"""Make and check delta OTA patches for the garage firmware.
+
+Usage:
+    delta_patch.py diff <old.bin> <new.bin> <out_dir>   Write <out_dir>/<name>.gdp
+    delta_patch.py apply <old.bin> <patch.gdp> <new.bin> Rebuild new.bin from a patch
+    delta_patch.py name <old.bin>                       Print the patch file name
+
+<old.bin> is the image running on the devices, from build/<project>.bin of that release.
+The device downloads CONFIG_GARAGE_OTA_BASE_URL/<name>.gdp, where <name> is the first 16
+hex digits of the running image's ELF SHA-256, so one patch per base image is enough.
+
+A .gdp file is a zlib stream of the patch format documented in include/delta_patch.h.
+"""
+
+import hashlib
+import os
+import struct
+import sys
+import zlib
+
+MAGIC = b"GDP1"
+HEADER = struct.Struct("<4sII32s32s")
+BLOCK = struct.Struct("<IIi")
+
+# Matching: index every STRIDE-th old position by its next KEY bytes
+KEY = 8
+STRIDE = 4
+MIN_MATCH = 16
+# Stop extending an approximate match after this many bytes without improvement
+EXTEND_SLACK = 64
+
+# esp_app_desc_t follows the 24-byte image header and the first 8-byte segment header
+APP_DESC_OFFSET = 32
+APP_DESC_MAGIC = 0xABCD5432
+APP_DESC_ELF_SHA256_OFFSET = 144
+NAME_HEX_DIGITS = 16
+
+
+def patch_name(image):
+    """Name the device asks for: the first hex digits of the app's ELF SHA-256."""
+    (magic,) = struct.unpack_from("<I", image, APP_DESC_OFFSET)
+    if magic != APP_DESC_MAGIC:
+        raise ValueError("not an ESP-IDF app image (no app description)")
+    start = APP_DESC_OFFSET + APP_DESC_ELF_SHA256_OFFSET
+    return image[start:start + NAME_HEX_DIGITS // 2].hex()
+
+
+def exact_length(old, o, new, n):
+    """Length of the exact match of old[o:] and new[n:], compared a slice at a time."""
+    length = 0
+    step = 256
+    limit = min(len(old) - o, len(new) - n)
+    while step > 0:
+        while length + step <= limit and old[o + length:o + length + step] == new[n + length:n + length + step]:
+            length += step
+        step //= 4
+    return length
+
+
+def approximate_length(old, o, new, n, start):
+    """Extend a match past small differences while at least half the bytes still match.
+
+    Same idea as bsdiff: a few changed bytes inside otherwise shifted code cost one
+    nonzero diff byte each instead of a new block.
+    """
+    limit = min(len(old) - o, len(new) - n)
+    best_length = start
+    best_score = 0
+    score = 0
+    i = start
+    while i < limit and i - best_length <= EXTEND_SLACK:
+        score += 1 if old[o + i] == new[n + i] else -1
+        i += 1
+        if score > best_score:
+            best_score = score
+            best_length = i
+    return best_length
+
+
+def find_blocks(old, new):
+    """Return [(new_start, old_start, length)] of matched regions, in new image order."""
+    index = {}
+    for o in range(0, len(old) - KEY + 1, STRIDE):
+        index.setdefault(old[o:o + KEY], o)
+    blocks = []
+    offset = 0  # old - new of the last match; code after an edit usually keeps it
+    n = 0
+    while n + KEY <= len(new):
+        best_length, best_old = 0, 0
+        for o in (n + offset, index.get(new[n:n + KEY])):
+            if o is None or o < 0 or o >= len(old):
+                continue
+            length = exact_length(old, o, new, n)
+            if length > best_length:
+                best_length, best_old = length, o
+        if best_length < MIN_MATCH:
+            n += 1
+            continue
+        length = approximate_length(old, best_old, new, n, best_length)
+        blocks.append((n, best_old, length))
+        offset = best_old - n
+        n += length
+    return blocks
+
+
+def make_patch(old, new):
+    blocks = find_blocks(old, new)
+    out = bytearray(HEADER.pack(MAGIC, len(old), len(new), hashlib.sha256(old).digest(), hashlib.sha256(new).digest()))
+    # An empty new image is the header alone, the appliers stop as soon as new_size is written
+    if new and (not blocks or blocks[0][0] > 0):
+        first_new = blocks[0][0] if blocks else len(new)
+        first_old = blocks[0][1] if blocks else 0
+        out += BLOCK.pack(0, first_new, first_old)
+        out += new[:first_new]
+    for i, (n, o, length) in enumerate(blocks):
+        if i + 1 < len(blocks):
+            next_new, next_old = blocks[i + 1][0], blocks[i + 1][1]
+        else:
+            next_new, next_old = len(new), o + length
+        out += BLOCK.pack(length, next_new - (n + length), next_old - (o + length))
+        out += bytes((new[n + k] - old[o + k]) & 0xFF for k in range(length))
+        out += new[n + length:next_new]
+    return bytes(out)
+
+
+def apply_patch(old, patch):
+    """Reference applier, the same steps as src/delta_patch.c."""
+    magic, old_size, new_size, old_sha, new_sha = HEADER.unpack_from(patch, 0)
+    if magic != MAGIC:
+        raise ValueError("not a delta patch")
+    if old_size != len(old) or hashlib.sha256(old).digest() != old_sha:
+        raise ValueError("patch is for a different old image")
+    new = bytearray()
+    position = HEADER.size
+    old_position = 0
+    while len(new) < new_size:
+        diff_length, extra_length, seek = BLOCK.unpack_from(patch, position)
+        position += BLOCK.size
+        diff = patch[position:position + diff_length]
+        position += diff_length
+        new += bytes((old[old_position + k] + diff[k]) & 0xFF for k in range(diff_length))
+        new += patch[position:position + extra_length]
+        position += extra_length
+        old_position += diff_length + seek
+    if position != len(patch) or hashlib.sha256(new).digest() != new_sha:
+        raise ValueError("patch did not rebuild the new image")
+    return bytes(new)
+
+
+def read(path):
+    with open(path, "rb") as f:
+        return f.read()
+
+
+def main():
+    if len(sys.argv) < 3:
+        print(__doc__)
+        sys.exit(1)
+    command = sys.argv[1]
+    if command == "name" and len(sys.argv) == 3:
+        print(patch_name(read(sys.argv[2])) + ".gdp")
+    elif command == "diff" and len(sys.argv) == 5:
+        old, new = read(sys.argv[2]), read(sys.argv[3])
+        compressed = zlib.compress(make_patch(old, new), 9)
+        if apply_patch(old, zlib.decompress(compressed)) != new:
+            raise SystemExit("patch check failed")
+        path = os.path.join(sys.argv[4], patch_name(old) + ".gdp")
+        with open(path, "wb") as f:
+            f.write(compressed)
+        full = len(zlib.compress(new, 9))
+        print(f"{path}: {len(compressed)} bytes, full image {len(new)} bytes ({full} compressed)")
+    elif command == "apply" and len(sys.argv) == 5:
+        new = apply_patch(read(sys.argv[2]), zlib.decompress(read(sys.argv[3])))
+        with open(sys.argv[4], "wb") as f:
+            f.write(new)
+        print(f"{sys.argv[4]}: {len(new)} bytes, SHA-256 verified")
+    else:
+        print(__doc__)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -4,6 +4,10 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef struct {
     bool has_value;
     int level;
@@ -19,4 +23,8 @@ typedef struct {
 
 extern sensor_debouncer_t sensor_debouncer;
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif // DOOR_SENSORS_H
@@ -0,0 +1,40 @@
+#include <stdio.h>
+
+#include "door_sensors.h"
+#include "garage_core/debouncer.h"
+#include "metrics.h"
+
+void debounce_init(sensor_state_t *sensor_state, uint32_t tick_debounce_threshold) {
+    sensor_state->tick_debounce_threshold = tick_debounce_threshold;
+    sensor_state->has_value = false;
+}
+
+/**
+ * The debounce rules live in the shared core. The DoorSensor sketch has its own bit-packed
+ * debouncer that also waits for the first value to settle, so its rules differ.
+ *   - Always return true for the first value
+ *   - Otherwise return true once a changed value has been stable for the debounce threshold
+ */
+bool debounce_sensor(sensor_state_t *sensor_state, int level, uint32_t tick_count) {
+    // A new level that went back before it settled was a bounce
+    if (sensor_state->has_value && sensor_state->pending_level != sensor_state->level && level == sensor_state->level) {
+        metrics_count(METRIC_DEBOUNCE_REJECTIONS);
+    }
+    garage_core::DebounceState<uint32_t> state = {
+        sensor_state->has_value,
+        sensor_state->level,
+        sensor_state->pending_level,
+        sensor_state->settled_tick,
+    };
+    bool changed = garage_core::debounce_step(state, level, tick_count, sensor_state->tick_debounce_threshold);
+    sensor_state->has_value = state.has_value;
+    sensor_state->level = state.level;
+    sensor_state->pending_level = state.pending_level;
+    sensor_state->settled_tick = state.settled_time;
+    return changed;
+}
+
+sensor_debouncer_t sensor_debouncer = {
+    .init = debounce_init,
+    .debounce = debounce_sensor,
+};
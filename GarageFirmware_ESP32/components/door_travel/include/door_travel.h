@@ -0,0 +1,59 @@
+#ifndef DOOR_TRAVEL_H
+#define DOOR_TRAVEL_H
+
+#include <stdint.h>
+
+/**
+ * Door travel times, measured from the debounced sensors.
+ *
+ * Opening runs from sensor A leaving closed until sensor B reaches open, and closing the
+ * other way around. Each kind of travel, and the delay from a button press until the door
+ * starts moving, is counted in a fixed-bucket histogram that is halved as it fills, so it
+ * follows the opener over months. The median of the last few travels is compared with the
+ * histogram's median, and a drift flag is raised when they differ by more than
+ * GARAGE_TRAVEL_DRIFT_PERCENT: the opener or springs are changing.
+ *
+ * Record from one task, read from any.
+ */
+
+#define DOOR_TRAVEL_BUCKETS 12
+
+typedef enum {
+    DOOR_TRAVEL_OPEN,        // Sensor A leaves closed until sensor B reaches open
+    DOOR_TRAVEL_CLOSE,       // Sensor B leaves open until sensor A reaches closed
+    DOOR_TRAVEL_PRESS_DELAY, // Button press until either sensor changes
+    DOOR_TRAVEL_KIND_COUNT,
+} door_travel_kind_t;
+
+// Bit in door_travel_report_t.drift_flags for one kind
+#define DOOR_TRAVEL_DRIFT(kind) (1u << (kind))
+
+typedef struct {
+    uint16_t counts[DOOR_TRAVEL_KIND_COUNT][DOOR_TRAVEL_BUCKETS];
+    uint32_t median_ms[DOOR_TRAVEL_KIND_COUNT]; // From the histogram, 0 while it is empty
+    uint32_t drift_flags;
+} door_travel_report_t;
+
+/**
+ * @brief Upper bounds of the buckets of one kind, in ms. The last bucket has no bound (UINT32_MAX).
+ */
+const uint32_t *door_travel_bucket_bounds(door_travel_kind_t kind);
+
+/**
+ * @brief Follow the debounced sensor levels, and record a travel when the door arrives.
+ *
+ * Call with every change. A travel that turns back, or takes longer than a minute, is not recorded.
+ */
+void door_travel_on_sensors(int a_level, int b_level, int64_t now_ms);
+
+/**
+ * @brief Record one duration, for the kinds the sensors cannot see by themselves.
+ */
+void door_travel_record(door_travel_kind_t kind, uint32_t duration_ms);
+
+/**
+ * @brief Copy the histograms, medians and drift flags.
+ */
+void door_travel_get_report(door_travel_report_t *report);
+
+#endif // DOOR_TRAVEL_H
@@ -0,0 +1,188 @@
+#include "door_travel.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "binary_log.h"
+#include "freertos/FreeRTOS.h"
+
+#define DRIFT_PERCENT CONFIG_GARAGE_TRAVEL_DRIFT_PERCENT
+#define RECENT_TRAVELS 8        // Compared with the histogram for drift
+#define MIN_BASELINE_TRAVELS 20 // Before the histogram's median means anything
+#define AGE_AT_COUNT 256        // Halve a histogram when it holds this many travels
+#define MAX_TRAVEL_MS 60000     // The server calls a door stuck after a minute
+
+// Upper bounds in ms. Finer where healthy doors land: 10-15 s of travel, under a second of delay.
+static const uint32_t TRAVEL_BOUNDS[DOOR_TRAVEL_BUCKETS] = {
+    5000, 7000, 8000, 9000, 10000, 11000, 12000, 13000, 14000, 16000, 20000, UINT32_MAX,
+};
+static const uint32_t PRESS_DELAY_BOUNDS[DOOR_TRAVEL_BUCKETS] = {
+    250, 500, 750, 1000, 1250, 1500, 2000, 2500, 3000, 4000, 5000, UINT32_MAX,
+};
+
+typedef struct {
+    uint16_t counts[DOOR_TRAVEL_BUCKETS];
+    uint32_t total;
+    uint32_t recent_ms[RECENT_TRAVELS]; // Ring of the latest travels
+    uint32_t recent_count;
+    uint32_t recent_next;
+} histogram_t;
+
+typedef enum {
+    POSITION_UNKNOWN,
+    POSITION_CLOSED,
+    POSITION_OPEN,
+} position_t;
+
+static struct {
+    histogram_t histograms[DOOR_TRAVEL_KIND_COUNT];
+    uint32_t drift_flags;
+    position_t last_end; // Where the door last stopped at a sensor
+    bool travelling;
+    int64_t left_ms;
+} travel;
+static portMUX_TYPE travel_lock = portMUX_INITIALIZER_UNLOCKED;
+
+const uint32_t *door_travel_bucket_bounds(door_travel_kind_t kind) {
+    return kind == DOOR_TRAVEL_PRESS_DELAY ? PRESS_DELAY_BOUNDS : TRAVEL_BOUNDS;
+}
+
+/**
+ * The median, spreading each bucket's travels evenly between its bounds.
+ * The open-ended last bucket reports its lower bound.
+ */
+static uint32_t histogram_median(const histogram_t *histogram, const uint32_t *bounds) {
+    if (histogram->total == 0) {
+        return 0;
+    }
+    uint32_t rank = (histogram->total + 1) / 2;
+    uint32_t below = 0;
+    for (int i = 0; i < DOOR_TRAVEL_BUCKETS; i++) {
+        uint32_t count = histogram->counts[i];
+        if (below + count >= rank) {
+            uint32_t lower = i == 0 ? 0 : bounds[i - 1];
+            if (bounds[i] == UINT32_MAX) {
+                return lower;
+            }
+            uint64_t offset = (uint64_t)(bounds[i] - lower) * (2 * (rank - below) - 1) / (2 * count);
+            return lower + (uint32_t)offset;
+        }
+        below += count;
+    }
+    return 0;
+}
+
+static uint32_t recent_median(const histogram_t *histogram) {
+    uint32_t sorted[RECENT_TRAVELS];
+    uint32_t n = histogram->recent_count;
+    memcpy(sorted, histogram->recent_ms, sizeof(sorted));
+    for (uint32_t i = 1; i < n; i++) {
+        uint32_t value = sorted[i];
+        uint32_t j = i;
+        for (; j > 0 && sorted[j - 1] > value; j--) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = value;
+    }
+    return n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+}
+
+static void add_travel(door_travel_kind_t kind, uint32_t duration_ms) {
+    histogram_t *histogram = &travel.histograms[kind];
+    const uint32_t *bounds = door_travel_bucket_bounds(kind);
+    int bucket = 0;
+    while (duration_ms > bounds[bucket]) {
+        bucket++;
+    }
+    if (histogram->total >= AGE_AT_COUNT) {
+        // Halve, rounding up, so old travels fade but a rare bucket is not lost
+        histogram->total = 0;
+        for (int i = 0; i < DOOR_TRAVEL_BUCKETS; i++) {
+            histogram->counts[i] = (histogram->counts[i] + 1) / 2;
+            histogram->total += histogram->counts[i];
+        }
+    }
+    histogram->counts[bucket]++;
+    histogram->total++;
+    histogram->recent_ms[histogram->recent_next] = duration_ms;
+    histogram->recent_next = (histogram->recent_next + 1) % RECENT_TRAVELS;
+    if (histogram->recent_count < RECENT_TRAVELS) {
+        histogram->recent_count++;
+    }
+}
+
+/**
+ * Compare the recent travels with the histogram. Returns true when the flag changed.
+ */
+static bool update_drift(door_travel_kind_t kind, uint32_t *recent_ms, uint32_t *baseline_ms) {
+    const histogram_t *histogram = &travel.histograms[kind];
+    if (histogram->recent_count < RECENT_TRAVELS || histogram->total < MIN_BASELINE_TRAVELS) {
+        return false;
+    }
+    *recent_ms = recent_median(histogram);
+    *baseline_ms = histogram_median(histogram, door_travel_bucket_bounds(kind));
+    uint32_t difference = *recent_ms > *baseline_ms ? *recent_ms - *baseline_ms : *baseline_ms - *recent_ms;
+    bool drifted = (uint64_t)difference * 100 > (uint64_t)*baseline_ms * DRIFT_PERCENT;
+    bool was_drifted = (travel.drift_flags & DOOR_TRAVEL_DRIFT(kind)) != 0;
+    if (drifted) {
+        travel.drift_flags |= DOOR_TRAVEL_DRIFT(kind);
+    } else {
+        travel.drift_flags &= ~DOOR_TRAVEL_DRIFT(kind);
+    }
+    return drifted != was_drifted;
+}
+
+void door_travel_record(door_travel_kind_t kind, uint32_t duration_ms) {
+    uint32_t recent_ms = 0;
+    uint32_t baseline_ms = 0;
+    portENTER_CRITICAL(&travel_lock);
+    add_travel(kind, duration_ms);
+    bool drift_changed = update_drift(kind, &recent_ms, &baseline_ms);
+    bool drifted = (travel.drift_flags & DOOR_TRAVEL_DRIFT(kind)) != 0;
+    portEXIT_CRITICAL(&travel_lock);
+    BLOG2(DOOR_TRAVEL_RECORDED, kind, (int32_t)duration_ms);
+    if (drift_changed) {
+        BLOG4(DOOR_TRAVEL_DRIFT_CHANGED, kind, drifted, (int32_t)recent_ms, (int32_t)baseline_ms);
+    }
+}
+
+static position_t position_of(int a_level, int b_level) {
+    if (a_level == 0 && b_level != 0) {
+        return POSITION_CLOSED;
+    }
+    if (a_level != 0 && b_level == 0) {
+        return POSITION_OPEN;
+    }
+    return POSITION_UNKNOWN;
+}
+
+void door_travel_on_sensors(int a_level, int b_level, int64_t now_ms) {
+    position_t position = position_of(a_level, b_level);
+    bool between = a_level != 0 && b_level != 0;
+    if (between) {
+        // Only a door that left a sensor is timed, not one found between them after boot
+        if (travel.last_end != POSITION_UNKNOWN && !travel.travelling) {
+            travel.travelling = true;
+            travel.left_ms = now_ms;
+        }
+        return;
+    }
+    int64_t duration_ms = now_ms - travel.left_ms;
+    bool arrived = travel.travelling && position != POSITION_UNKNOWN && position != travel.last_end;
+    travel.travelling = false;
+    travel.last_end = position;
+    if (arrived && duration_ms <= MAX_TRAVEL_MS) {
+        door_travel_record(position == POSITION_OPEN ? DOOR_TRAVEL_OPEN : DOOR_TRAVEL_CLOSE, (uint32_t)duration_ms);
+    }
+}
+
+void door_travel_get_report(door_travel_report_t *report) {
+    portENTER_CRITICAL(&travel_lock);
+    for (int kind = 0; kind < DOOR_TRAVEL_KIND_COUNT; kind++) {
+        const histogram_t *histogram = &travel.histograms[kind];
+        memcpy(report->counts[kind], histogram->counts, sizeof(report->counts[kind]));
+        report->median_ms[kind] = histogram_median(histogram, door_travel_bucket_bounds(kind));
+    }
+    report->drift_flags = travel.drift_flags;
+    portEXIT_CRITICAL(&travel_lock);
+}
@@ -0,0 +1,225 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/door_travel.c"
+
+// The last DOOR_TRAVEL_DRIFT_CHANGED record
+static struct {
+    int count;
+    int32_t kind;
+    int32_t drifted;
+    int32_t recent_ms;
+    int32_t baseline_ms;
+} drift_log;
+
+bool binary_log_write(binary_log_id_t id, uint8_t arg_count, int32_t a0, int32_t a1, int32_t a2, int32_t a3) {
+    (void)arg_count;
+    if (id == BLOG_DOOR_TRAVEL_DRIFT_CHANGED) {
+        drift_log.count++;
+        drift_log.kind = a0;
+        drift_log.drifted = a1;
+        drift_log.recent_ms = a2;
+        drift_log.baseline_ms = a3;
+    }
+    return true;
+}
+
+static void reset(void) {
+    memset(&travel, 0, sizeof(travel));
+    memset(&drift_log, 0, sizeof(drift_log));
+}
+
+static void record_many(door_travel_kind_t kind, uint32_t duration_ms, int count) {
+    for (int i = 0; i < count; i++) {
+        door_travel_record(kind, duration_ms);
+    }
+}
+
+static void test_buckets(void) {
+    reset();
+    door_travel_record(DOOR_TRAVEL_OPEN, 5000);  // Bounds are inclusive
+    door_travel_record(DOOR_TRAVEL_OPEN, 5001);
+    door_travel_record(DOOR_TRAVEL_OPEN, 60000); // Open-ended last bucket
+    door_travel_record(DOOR_TRAVEL_PRESS_DELAY, 600);
+    door_travel_report_t report;
+    door_travel_get_report(&report);
+    assert(report.counts[DOOR_TRAVEL_OPEN][0] == 1);
+    assert(report.counts[DOOR_TRAVEL_OPEN][1] == 1);
+    assert(report.counts[DOOR_TRAVEL_OPEN][DOOR_TRAVEL_BUCKETS - 1] == 1);
+    assert(report.counts[DOOR_TRAVEL_PRESS_DELAY][2] == 1);
+    assert(report.counts[DOOR_TRAVEL_CLOSE][0] == 0);
+}
+
+// At AGE_AT_COUNT the counts halve, rounding up, before the new travel is added
+static void test_histogram_halving(void) {
+    reset();
+    door_travel_record(DOOR_TRAVEL_CLOSE, 4000);                       // Bucket 0
+    record_many(DOOR_TRAVEL_CLOSE, 12000, AGE_AT_COUNT - 1);           // Bucket 6
+    const histogram_t *histogram = &travel.histograms[DOOR_TRAVEL_CLOSE];
+    assert(histogram->total == AGE_AT_COUNT);
+    assert(histogram->counts[6] == AGE_AT_COUNT - 1);
+
+    door_travel_record(DOOR_TRAVEL_CLOSE, 12000);
+    assert(histogram->counts[0] == 1); // A rare bucket is not lost
+    assert(histogram->counts[6] == AGE_AT_COUNT / 2 + 1);
+    assert(histogram->total == AGE_AT_COUNT / 2 + 2);
+
+    // It only halves again once it fills again
+    record_many(DOOR_TRAVEL_CLOSE, 12000, AGE_AT_COUNT / 2 - 2);
+    assert(histogram->total == AGE_AT_COUNT);
+    door_travel_record(DOOR_TRAVEL_CLOSE, 12000);
+    assert(histogram->counts[0] == 1);
+    assert(histogram->total == AGE_AT_COUNT / 2 + 2);
+    // The other kinds are untouched
+    assert(travel.histograms[DOOR_TRAVEL_OPEN].total == 0);
+}
+
+static void test_recent_ring(void) {
+    reset();
+    const histogram_t *histogram = &travel.histograms[DOOR_TRAVEL_OPEN];
+    for (uint32_t i = 1; i <= 3; i++) {
+        door_travel_record(DOOR_TRAVEL_OPEN, i * 1000);
+    }
+    assert(histogram->recent_count == 3);
+    assert(recent_median(histogram) == 2000);
+    door_travel_record(DOOR_TRAVEL_OPEN, 4000);
+    assert(recent_median(histogram) == 2500); // Even count: mean of the middle two
+
+    for (uint32_t i = 5; i <= RECENT_TRAVELS + 2; i++) {
+        door_travel_record(DOOR_TRAVEL_OPEN, i * 1000);
+    }
+    // Full, and the two oldest are overwritten
+    assert(histogram->recent_count == RECENT_TRAVELS);
+    assert(histogram->recent_next == 2);
+    assert(histogram->recent_ms[0] == (RECENT_TRAVELS + 1) * 1000);
+    assert(histogram->recent_ms[1] == (RECENT_TRAVELS + 2) * 1000);
+    assert(histogram->recent_ms[2] == 3000);
+    assert(recent_median(histogram) == 6500);
+    // Sorting a copy leaves the ring in order
+    assert(histogram->recent_ms[0] == (RECENT_TRAVELS + 1) * 1000);
+}
+
+static void test_histogram_median(void) {
+    histogram_t histogram;
+    memset(&histogram, 0, sizeof(histogram));
+    assert(histogram_median(&histogram, TRAVEL_BOUNDS) == 0);
+
+    // One travel sits in the middle of its bucket
+    histogram.counts[6] = 1;
+    histogram.total = 1;
+    assert(histogram_median(&histogram, TRAVEL_BOUNDS) == 11500);
+
+    // 20 travels spread evenly over 11000-12000: the 10th is at 11475
+    histogram.counts[6] = 20;
+    histogram.total = 20;
+    assert(histogram_median(&histogram, TRAVEL_BOUNDS) == 11475);
+
+    // Split across buckets
+    histogram.counts[6] = 3;
+    histogram.counts[8] = 3;
+    histogram.total = 6;
+    assert(histogram_median(&histogram, TRAVEL_BOUNDS) == 11833);
+
+    // The open-ended bucket reports its lower bound
+    memset(&histogram, 0, sizeof(histogram));
+    histogram.counts[DOOR_TRAVEL_BUCKETS - 1] = 5;
+    histogram.total = 5;
+    assert(histogram_median(&histogram, TRAVEL_BOUNDS) == 20000);
+    assert(histogram_median(&histogram, PRESS_DELAY_BOUNDS) == 5000);
+}
+
+static void test_drift_needs_a_baseline(void) {
+    reset();
+    record_many(DOOR_TRAVEL_OPEN, 12000, MIN_BASELINE_TRAVELS - RECENT_TRAVELS - 1);
+    record_many(DOOR_TRAVEL_OPEN, 19000, RECENT_TRAVELS);
+    assert(travel.histograms[DOOR_TRAVEL_OPEN].total == MIN_BASELINE_TRAVELS - 1);
+    assert(travel.drift_flags == 0);
+    assert(drift_log.count == 0);
+
+    door_travel_record(DOOR_TRAVEL_OPEN, 19000);
+    assert(travel.drift_flags == DOOR_TRAVEL_DRIFT(DOOR_TRAVEL_OPEN));
+    assert(drift_log.count == 1);
+}
+
+static void test_drift_raised_and_cleared(void) {
+    reset();
+    record_many(DOOR_TRAVEL_CLOSE, 12000, MIN_BASELINE_TRAVELS);
+    assert(travel.drift_flags == 0);
+
+    // The recent median moves to 14000 with four slow travels, 21% over the baseline
+    record_many(DOOR_TRAVEL_CLOSE, 16000, 4);
+    assert(travel.drift_flags == 0);
+    // and to 16000 with the fifth, 37% over
+    door_travel_record(DOOR_TRAVEL_CLOSE, 16000);
+    assert(travel.drift_flags == DOOR_TRAVEL_DRIFT(DOOR_TRAVEL_CLOSE));
+    assert(drift_log.count == 1);
+    assert(drift_log.kind == DOOR_TRAVEL_CLOSE);
+    assert(drift_log.drifted == 1);
+    assert(drift_log.recent_ms == 16000);
+    assert(drift_log.baseline_ms == 11625);
+
+    // Still drifted: the flag stays up and is logged once
+    door_travel_record(DOOR_TRAVEL_CLOSE, 16000);
+    assert(drift_log.count == 1);
+
+    door_travel_report_t report;
+    door_travel_get_report(&report);
+    assert(report.drift_flags == DOOR_TRAVEL_DRIFT(DOOR_TRAVEL_CLOSE));
+
+    // Back to normal travels: cleared once the slow ones are no longer the majority
+    record_many(DOOR_TRAVEL_CLOSE, 12000, 3);
+    assert(travel.drift_flags == DOOR_TRAVEL_DRIFT(DOOR_TRAVEL_CLOSE));
+    door_travel_record(DOOR_TRAVEL_CLOSE, 12000);
+    assert(travel.drift_flags == 0);
+    assert(drift_log.count == 2);
+    assert(drift_log.drifted == 0);
+}
+
+// Faster travels drift too, and each kind has its own flag
+static void test_drift_faster(void) {
+    reset();
+    record_many(DOOR_TRAVEL_PRESS_DELAY, 1100, MIN_BASELINE_TRAVELS);
+    record_many(DOOR_TRAVEL_OPEN, 12000, MIN_BASELINE_TRAVELS);
+    record_many(DOOR_TRAVEL_PRESS_DELAY, 300, RECENT_TRAVELS);
+    assert(travel.drift_flags == DOOR_TRAVEL_DRIFT(DOOR_TRAVEL_PRESS_DELAY));
+    assert(drift_log.kind == DOOR_TRAVEL_PRESS_DELAY);
+}
+
+static void test_travel_from_sensors(void) {
+    reset();
+    // Found between the sensors after boot: not timed
+    door_travel_on_sensors(1, 1, 0);
+    door_travel_on_sensors(1, 0, 10000);
+    assert(travel.histograms[DOOR_TRAVEL_OPEN].total == 0);
+
+    // Open, then closing
+    door_travel_on_sensors(1, 1, 20000);
+    door_travel_on_sensors(0, 1, 32000);
+    assert(travel.histograms[DOOR_TRAVEL_CLOSE].total == 1);
+    assert(travel.histograms[DOOR_TRAVEL_CLOSE].recent_ms[0] == 12000);
+
+    // Turned back: not recorded
+    door_travel_on_sensors(1, 1, 40000);
+    door_travel_on_sensors(0, 1, 45000);
+    assert(travel.histograms[DOOR_TRAVEL_CLOSE].total == 1);
+    assert(travel.histograms[DOOR_TRAVEL_OPEN].total == 0);
+
+    // Too slow: not recorded
+    door_travel_on_sensors(1, 1, 50000);
+    door_travel_on_sensors(1, 0, 50000 + MAX_TRAVEL_MS + 1);
+    assert(travel.histograms[DOOR_TRAVEL_OPEN].total == 0);
+}
+
+int main(void) {
+    test_buckets();
+    test_histogram_halving();
+    test_recent_ring();
+    test_histogram_median();
+    test_drift_needs_a_baseline();
+    test_drift_raised_and_cleared();
+    test_drift_faster();
+    test_travel_from_sensors();
+    printf("door_travel tests passed\n");
+    return 0;
+}
@@ -0,0 +1,10 @@
+// Host stand-in for the one FreeRTOS type door_travel.c uses. The tests run on one thread.
+#ifndef DOOR_TRAVEL_TEST_FREERTOS_H
+#define DOOR_TRAVEL_TEST_FREERTOS_H
+
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+
+#endif // DOOR_TRAVEL_TEST_FREERTOS_H
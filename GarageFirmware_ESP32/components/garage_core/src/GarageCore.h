@@ -0,0 +1,14 @@
+#ifndef GARAGE_CORE_H
+#define GARAGE_CORE_H
+
+#include "garage_core/button_token.h"
+#include "garage_core/debouncer.h"
+#include "garage_core/http_response_reader.h"
+#include "garage_core/index_sequence.h"
+#include "garage_core/ok_blinker.h"
+#include "garage_core/platform.h"
+#include "garage_core/url_encoder.h"
+#include "garage_core/retry_policy.h"
+#include "garage_core/wget.h"
+
+#endif // GARAGE_CORE_H
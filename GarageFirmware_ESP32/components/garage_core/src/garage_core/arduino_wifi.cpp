@@ -0,0 +1,170 @@
+#include "arduino_wifi.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+// Tested with Adafruit HUZZAH32 - ESP32 Feather
+// https://github.com/espressif/arduino-esp32/blob/master/docs/arduino-ide/boards_manager.md
+#include <WiFi.h>
+#include <WiFiMulti.h>
+#elif defined(ARDUINO_ARCH_SAMD)
+// Tested with Adafruit Metro M4 Express AirLift (WiFi) - Lite
+// https://www.adafruit.com/product/4000
+#include <WiFiNINA.h>
+#endif
+
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_SAMD)
+
+namespace garage_core {
+
+static const unsigned int WIFI_CONNECT_RETRY_MAX = 0;
+
+static bool gave_up(unsigned int retry_count) {
+    if (retry_count <= WIFI_CONNECT_RETRY_MAX) {
+        return false;
+    }
+    Serial.println();
+    Serial.print("Tried to connect to WiFi ");
+    Serial.print(retry_count);
+    Serial.println(" times.");
+    return true;
+}
+
+void print_wget_result(Print &out, const WiFiRequest &request) {
+    // Printed piece by piece: building a String here would allocate on every request
+    if (request.error() != NULL) {
+        out.print(request.error());
+        out.print(" after ");
+        out.print(request.elapsed());
+        out.println(" ms.");
+    }
+    if (request.status_code() != 0) {
+        out.print("HTTP ");
+        out.print(request.status_code());
+        out.print(" handled in ");
+        out.print(request.elapsed());
+        out.println(" ms.");
+    }
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+static const unsigned long WIFI_FAST_RECONNECT_TIMEOUT_MILLIS = 3000;
+
+static WiFiMulti wifi_multi;
+static WiFiClient client;
+
+// Survive deep sleep, so the next wakeup can skip the scan
+static RTC_DATA_ATTR int saved_channel = 0;
+static RTC_DATA_ATTR uint8_t saved_bssid[6];
+
+Client &WiFiTransport::connection() {
+    return client;
+}
+
+const char *WiFiTransport::http_version() {
+    return "HTTP/1.0";
+}
+
+bool wifi_setup(const char *ssid, const char *password) {
+    Serial.println("Using WiFiMulti");
+    wifi_multi.addAP(ssid, password);
+    unsigned int retry_count = 0;
+    Serial.print("Looking for WiFi SSID: ");
+    Serial.println(ssid);
+    while (wifi_multi.run() != WL_CONNECTED) {
+        if (gave_up(retry_count)) {
+            return false;
+        }
+        Serial.print(".");
+        delay(500);
+        retry_count++;
+    }
+    Serial.println("");
+    return true;
+}
+
+bool wifi_fast_reconnect(const char *ssid, const char *password) {
+    if (saved_channel > 0) {
+        Serial.print("Reconnecting to WiFi on channel ");
+        Serial.println(saved_channel);
+        unsigned long start = millis();
+        WiFi.mode(WIFI_STA);
+        WiFi.begin(ssid, password, saved_channel, saved_bssid);
+        while (millis() - start < WIFI_FAST_RECONNECT_TIMEOUT_MILLIS) {
+            if (WiFi.status() == WL_CONNECTED) {
+                Serial.print("Reconnected to WiFi in ");
+                Serial.print(millis() - start);
+                Serial.println(" ms.");
+                return true;
+            }
+            delay(10);
+        }
+        Serial.println("Fast reconnect failed, scanning.");
+        WiFi.disconnect();
+        saved_channel = 0;
+    }
+    bool success = wifi_setup(ssid, password);
+    if (success) {
+        saved_channel = WiFi.channel();
+        memcpy(saved_bssid, WiFi.BSSID(), sizeof(saved_bssid));
+    }
+    return success;
+}
+
+#else // ARDUINO_ARCH_SAMD
+
+static WiFiSSLClient client;
+static int status = WL_IDLE_STATUS;
+
+Client &WiFiTransport::connection() {
+    return client;
+}
+
+const char *WiFiTransport::http_version() {
+    return "HTTP/1.1";
+}
+
+bool wifi_setup(const char *ssid, const char *password) {
+    Serial.println("Using WiFiNINA");
+    // Check for WiFi module.
+    if (WiFi.status() == WL_NO_MODULE) {
+        Serial.println("Error: Communication with WiFi module failed!");
+        return false;
+    }
+    String fv = WiFi.firmwareVersion();
+    if (fv < WIFI_FIRMWARE_LATEST_VERSION) {
+        Serial.println("Warning: Please upgrade the firmware");
+    }
+    unsigned int retry_count = 0;
+    Serial.print("Attempting to connect to WiFi SSID: ");
+    Serial.println(ssid);
+    while (status != WL_CONNECTED) {
+        if (gave_up(retry_count)) {
+            return false;
+        }
+        // Connect to WPA/WPA2 network.
+        status = WiFi.begin(ssid, password);
+        Serial.print(".");
+        delay(500);
+        retry_count++;
+    }
+    Serial.println("");
+    Serial.print("Connected to SSID: ");
+    Serial.println(WiFi.SSID());
+    Serial.print("IP Address: ");
+    Serial.println(WiFi.localIP());
+    Serial.print("WiFi signal strength (RSSI):");
+    Serial.print(WiFi.RSSI());
+    Serial.println(" dBm");
+    return true;
+}
+
+// NINA has no RTC memory to keep the access point in
+bool wifi_fast_reconnect(const char *ssid, const char *password) {
+    return wifi_setup(ssid, password);
+}
+
+#endif
+
+} // namespace garage_core
+
+#endif
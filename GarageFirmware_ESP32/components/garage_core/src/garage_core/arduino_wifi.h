@@ -0,0 +1,45 @@
+#ifndef GARAGE_CORE_ARDUINO_WIFI_H
+#define GARAGE_CORE_ARDUINO_WIFI_H
+
+/**
+ * WiFi for the sketches: joining the network, and the transport WgetRequest sends over.
+ * GarageCore.h leaves it out, since it pulls in the board's WiFi library.
+ *
+ * The board's architecture picks the library, in arduino_wifi.cpp:
+ * - ESP32 (Adafruit HUZZAH32 - ESP32 Feather): WiFiMulti and a WiFiClient, HTTP/1.0
+ * - SAMD (Adafruit Metro M4 Express AirLift): WiFiNINA and a WiFiSSLClient, HTTP/1.1
+ */
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#include <Client.h>
+
+#include "platform.h"
+#include "wget.h"
+
+namespace garage_core {
+
+struct WiFiTransport {
+    typedef Client Connection;
+    static Connection &connection();
+    static const char *http_version();
+};
+
+typedef WgetRequest<ArduinoPlatform, WiFiTransport> WiFiRequest;
+typedef WiFiRequest::Reader WiFiResponseReader;
+
+// Join the access point. Gives up after one retry.
+bool wifi_setup(const char *ssid, const char *password);
+
+// Reconnect to the access point used before a deep sleep, skipping the scan. Falls back to
+// wifi_setup() if there is no saved access point, the reconnect fails, or the board can't.
+bool wifi_fast_reconnect(const char *ssid, const char *password);
+
+// Print how a finished request went: the status and time, or why it failed
+void print_wget_result(Print &out, const WiFiRequest &request);
+
+} // namespace garage_core
+
+#endif
+
+#endif // GARAGE_CORE_ARDUINO_WIFI_H
@@ -0,0 +1,18 @@
+#ifndef GARAGE_CORE_BUTTON_TOKEN_H
+#define GARAGE_CORE_BUTTON_TOKEN_H
+
+#include <string.h>
+
+namespace garage_core {
+
+/**
+ * The server changes the button token every time it wants the button pushed.
+ * A press is requested when the new token is not empty and differs from the current one.
+ */
+inline bool is_button_press_requested(const char *current_token, const char *new_token) {
+    return new_token[0] != '\0' && strcmp(current_token, new_token) != 0;
+}
+
+} // namespace garage_core
+
+#endif // GARAGE_CORE_BUTTON_TOKEN_H
@@ -0,0 +1,47 @@
+#ifndef GARAGE_CORE_DEBOUNCER_H
+#define GARAGE_CORE_DEBOUNCER_H
+
+namespace garage_core {
+
+/**
+ * State of one debounced input. Time is any unsigned type that wraps around.
+ */
+template <typename Time>
+struct DebounceState {
+    bool has_value;
+    int level;
+    int pending_level;
+    Time settled_time;
+};
+
+/**
+ * Feed one reading. Returns true when the debounced level changes:
+ *   - on the first reading, or
+ *   - when a new level has been stable for at least threshold.
+ */
+template <typename Time>
+inline bool debounce_step(DebounceState<Time> &state, int level, Time now, Time threshold) {
+    if (!state.has_value) {
+        state.has_value = true;
+        state.level = level;
+        state.pending_level = level;
+        state.settled_time = now;
+        return true;
+    }
+    if (state.level == level || state.pending_level != level) {
+        // Unchanged, or a new level that starts being tracked now
+        state.pending_level = level;
+        state.settled_time = now;
+        return false;
+    }
+    if ((Time)(now - state.settled_time) < threshold) {
+        return false;
+    }
+    state.level = level;
+    state.settled_time = now;
+    return true;
+}
+
+} // namespace garage_core
+
+#endif // GARAGE_CORE_DEBOUNCER_H
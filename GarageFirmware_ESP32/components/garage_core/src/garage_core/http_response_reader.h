@@ -0,0 +1,346 @@
+#ifndef GARAGE_CORE_HTTP_RESPONSE_READER_H
+#define GARAGE_CORE_HTTP_RESPONSE_READER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+namespace garage_core {
+
+/**
+ * Streaming HTTP/1.x response reader.
+ *
+ * Reads from the connection in bulk into a small fixed buffer, parses the status line and
+ * headers, and then gives out the body. The body ends at Content-Length, at the last chunk
+ * of a chunked response, or when the server closes the connection. Every wait is bounded
+ * by a deadline, so a stalled server cannot hang the caller.
+ *
+ * Source is the connection, such as an Arduino Client:
+ *
+ * struct Source {
+ *     int available();                      // Bytes that can be read without waiting
+ *     int read(uint8_t *buff, size_t size); // Bytes read, or <= 0
+ *     bool connected();
+ * };
+ *
+ * Platform also needs `static void delay_ms(Time ms)` for the waits.
+ *
+ * read() and readBytes() make the reader an ArduinoJson custom reader, so a response can
+ * be deserialized straight from the connection:
+ *
+ * HttpResponseReader<ArduinoPlatform, Client> reader(client);
+ * if (reader.read_headers()) {
+ *     deserializeJson(doc, reader);
+ * }
+ */
+template <class Platform, class Source, size_t BufferSize = 256, size_t LineSize = 128>
+class HttpResponseReader {
+  public:
+    typedef typename Platform::Time Time;
+
+    HttpResponseReader(Source &source, Time timeout = 10000)
+        : source_(source), start_(Platform::now()), timeout_(timeout), buffer_pos_(0), buffer_len_(0), peeked_(-1),
+          idle_(NULL), mode_(BODY_UNTIL_CLOSE), remaining_(0), first_chunk_(true), body_done_(false), status_code_(0),
+          timed_out_(false), overflowed_(false), truncated_(false) {}
+
+    // Called while waiting for data, so a scheduler can keep running short tasks
+    void set_idle_callback(void (*idle)(void)) {
+        idle_ = idle;
+    }
+
+    // Read the status line and headers. Returns false on timeout or a malformed response.
+    bool read_headers() {
+        char line[LineSize];
+        // Status line: "HTTP/1.1 200 OK"
+        if (!read_line(line, sizeof(line)) || strncmp(line, "HTTP/", 5) != 0) {
+            body_done_ = true;
+            return false;
+        }
+        const char *code = strchr(line, ' ');
+        status_code_ = code ? atoi(code + 1) : 0;
+        while (true) {
+            if (!read_line(line, sizeof(line))) {
+                body_done_ = true;
+                return false;
+            }
+            if (line[0] == '\0') {
+                return true; // Blank line ends the headers
+            }
+            char *value = strchr(line, ':');
+            if (value == NULL) {
+                continue;
+            }
+            *value++ = '\0';
+            while (*value == ' ') {
+                value++;
+            }
+            if (strcasecmp(line, "Content-Length") == 0 && mode_ != BODY_CHUNKED) {
+                mode_ = BODY_CONTENT_LENGTH;
+                remaining_ = strtoul(value, NULL, 10);
+            } else if (strcasecmp(line, "Transfer-Encoding") == 0 && strstr(value, "chunked") != NULL) {
+                // Chunked encoding wins over Content-Length (RFC 7230 3.3.3)
+                mode_ = BODY_CHUNKED;
+                remaining_ = 0;
+            }
+        }
+    }
+
+    // Copy the body into buff and terminate it with '\0'.
+    // Returns false if the body did not fit, the read timed out, or the body was cut short.
+    bool read_body(char *buff, size_t buff_size, size_t &length) {
+        length = 0;
+        if (buff_size == 0) {
+            return false;
+        }
+        if (peeked_ >= 0 && buff_size > 1) {
+            buff[length++] = (char)peeked_;
+            peeked_ = -1;
+        }
+        while (true) {
+            if (length >= buff_size - 1) {
+                // Full, which is an overflow only if the body goes on
+                overflowed_ = peeked_ >= 0 || ensure_body_bytes();
+                break;
+            }
+            size_t n = copy_body(buff + length, buff_size - 1 - length);
+            if (n == 0) {
+                break;
+            }
+            length += n;
+        }
+        buff[length] = '\0';
+        return !overflowed_ && !truncated_ && !timed_out_;
+    }
+
+    int status_code() const {
+        return status_code_;
+    }
+    bool timed_out() const {
+        return timed_out_;
+    }
+    bool overflowed() const {
+        return overflowed_;
+    }
+    Time elapsed() const {
+        return (Time)(Platform::now() - start_);
+    }
+
+    // Body bytes that can be read without waiting. Never counts chunk framing.
+    int available() {
+        if (peeked_ >= 0) {
+            return 1;
+        }
+        if (body_done_) {
+            return 0;
+        }
+        if (mode_ != BODY_UNTIL_CLOSE && remaining_ == 0) {
+            // Between chunks the next bytes are a chunk size line, not body
+            return 0;
+        }
+        size_t buffered = buffer_len_ - buffer_pos_;
+        if (buffered == 0) {
+            int waiting = source_.available();
+            buffered = waiting > 0 ? (size_t)waiting : 0;
+        }
+        if (mode_ != BODY_UNTIL_CLOSE && buffered > remaining_) {
+            buffered = remaining_;
+        }
+        return (int)buffered;
+    }
+
+    // One body byte, waiting for it until the deadline. -1 at the end of the body.
+    int read() {
+        if (peeked_ >= 0) {
+            int c = peeked_;
+            peeked_ = -1;
+            return c;
+        }
+        return next_body_byte();
+    }
+
+    int peek() {
+        if (peeked_ < 0) {
+            peeked_ = next_body_byte();
+        }
+        return peeked_;
+    }
+
+    // Arduino Stream name, for ArduinoJson. Returns fewer than length at the end of the body.
+    size_t readBytes(char *buff, size_t length) {
+        size_t count = 0;
+        if (length > 0 && peeked_ >= 0) {
+            buff[count++] = (char)peeked_;
+            peeked_ = -1;
+        }
+        while (count < length) {
+            size_t n = copy_body(buff + count, length - count);
+            if (n == 0) {
+                break;
+            }
+            count += n;
+        }
+        return count;
+    }
+
+  private:
+    enum BodyMode {
+        BODY_UNTIL_CLOSE,
+        BODY_CONTENT_LENGTH,
+        BODY_CHUNKED,
+    };
+
+    Source &source_;
+    Time start_;
+    Time timeout_;
+    uint8_t buffer_[BufferSize];
+    size_t buffer_pos_;
+    size_t buffer_len_;
+    int peeked_;
+    void (*idle_)(void);
+    BodyMode mode_;
+    unsigned long remaining_; // Bytes left in the body or the current chunk
+    bool first_chunk_;
+    bool body_done_;
+    int status_code_;
+    bool timed_out_;
+    bool overflowed_;
+    bool truncated_;
+
+    // Refill the buffer with one bulk read. Waits 1 ms at a time, running the idle callback between waits.
+    bool fill() {
+        buffer_pos_ = 0;
+        buffer_len_ = 0;
+        while (true) {
+            int available = source_.available();
+            if (available > 0) {
+                size_t want = (size_t)available < sizeof(buffer_) ? (size_t)available : sizeof(buffer_);
+                int got = source_.read(buffer_, want);
+                if (got > 0) {
+                    buffer_len_ = (size_t)got;
+                    return true;
+                }
+            } else if (!source_.connected()) {
+                return false;
+            }
+            if ((Time)(Platform::now() - start_) >= timeout_) {
+                timed_out_ = true;
+                return false;
+            }
+            if (idle_ != NULL) {
+                idle_();
+            }
+            Platform::delay_ms(1);
+        }
+    }
+
+    int next_raw_byte() {
+        if (buffer_pos_ >= buffer_len_ && !fill()) {
+            return -1;
+        }
+        return buffer_[buffer_pos_++];
+    }
+
+    // Read one line without the CRLF. Long lines are truncated to fit.
+    bool read_line(char *line, size_t size) {
+        size_t len = 0;
+        while (true) {
+            int c = next_raw_byte();
+            if (c < 0) {
+                line[len] = '\0';
+                return false;
+            }
+            if (c == '\n') {
+                break;
+            }
+            if (c != '\r' && len < size - 1) {
+                line[len++] = (char)c;
+            }
+        }
+        line[len] = '\0';
+        return true;
+    }
+
+    // Make sure the current chunk, or the Content-Length body, has bytes left. False at the end of the body.
+    bool ensure_body_bytes() {
+        if (body_done_) {
+            return false;
+        }
+        if (mode_ == BODY_UNTIL_CLOSE || remaining_ > 0) {
+            return true;
+        }
+        if (mode_ == BODY_CONTENT_LENGTH) {
+            body_done_ = true;
+            return false;
+        }
+        char line[LineSize];
+        if (!first_chunk_ && !read_line(line, sizeof(line))) { // CRLF after the previous chunk
+            end_body(true);
+            return false;
+        }
+        first_chunk_ = false;
+        if (!read_line(line, sizeof(line))) {
+            end_body(true);
+            return false;
+        }
+        remaining_ = strtoul(line, NULL, 16); // Ignores chunk extensions after ';'
+        if (remaining_ == 0) {
+            // Last chunk. Skip trailers up to the blank line.
+            while (read_line(line, sizeof(line)) && line[0] != '\0') {
+            }
+            body_done_ = true;
+            return false;
+        }
+        return true;
+    }
+
+    // The connection closing is how a BODY_UNTIL_CLOSE body ends. Any other end is a cut.
+    void end_body(bool cut) {
+        truncated_ = cut || timed_out_;
+        body_done_ = true;
+    }
+
+    int next_body_byte() {
+        if (!ensure_body_bytes()) {
+            return -1;
+        }
+        int c = next_raw_byte();
+        if (c < 0) {
+            end_body(mode_ != BODY_UNTIL_CLOSE);
+            return -1;
+        }
+        if (mode_ != BODY_UNTIL_CLOSE) {
+            remaining_--;
+        }
+        return c;
+    }
+
+    // Copy up to size body bytes at once: bounded by the buffer, the chunk and the caller. 0 at the end.
+    size_t copy_body(char *out, size_t size) {
+        if (size == 0 || !ensure_body_bytes()) {
+            return 0;
+        }
+        if (buffer_pos_ >= buffer_len_ && !fill()) {
+            end_body(mode_ != BODY_UNTIL_CLOSE);
+            return 0;
+        }
+        size_t n = buffer_len_ - buffer_pos_;
+        if (mode_ != BODY_UNTIL_CLOSE && n > remaining_) {
+            n = remaining_;
+        }
+        if (n > size) {
+            n = size;
+        }
+        memcpy(out, buffer_ + buffer_pos_, n);
+        buffer_pos_ += n;
+        if (mode_ != BODY_UNTIL_CLOSE) {
+            remaining_ -= n;
+        }
+        return n;
+    }
+};
+
+} // namespace garage_core
+
+#endif // GARAGE_CORE_HTTP_RESPONSE_READER_H
@@ -0,0 +1,17 @@
+#ifndef GARAGE_CORE_INDEX_SEQUENCE_H
+#define GARAGE_CORE_INDEX_SEQUENCE_H
+
+#include <stddef.h>
+
+namespace garage_core {
+
+// std::index_sequence for C++11, to expand a parameter pack alongside its indices
+template <size_t... I> struct IndexSequence {};
+template <size_t N, size_t... I> struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, I...> {};
+template <size_t... I> struct MakeIndexSequence<0, I...> {
+    typedef IndexSequence<I...> type;
+};
+
+} // namespace garage_core
+
+#endif // GARAGE_CORE_INDEX_SEQUENCE_H
@@ -0,0 +1,100 @@
+#ifndef GARAGE_CORE_OK_BLINKER_H
+#define GARAGE_CORE_OK_BLINKER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace garage_core {
+
+const uint16_t MORSE_CODE_DASH_MILLIS = 400;
+const uint16_t MORSE_CODE_DOT_MILLIS = 100;
+const uint16_t MORSE_CODE_CHAR_PAUSE_MILLIS = 200;
+const uint16_t MORSE_CODE_WORD_PAUSE_MILLIS = 500;
+
+struct BlinkStep {
+    bool on;
+    uint16_t millis;
+};
+
+// "OK" in Morse code: "O" is dash dash dash, "K" is dash dot dash. Every mark is followed
+// by a dash-long gap.
+inline const BlinkStep *ok_blink_steps(size_t &count) {
+    static const BlinkStep steps[] = {
+        {true, MORSE_CODE_DASH_MILLIS}, {false, MORSE_CODE_DASH_MILLIS},
+        {true, MORSE_CODE_DASH_MILLIS}, {false, MORSE_CODE_DASH_MILLIS},
+        {true, MORSE_CODE_DASH_MILLIS}, {false, MORSE_CODE_DASH_MILLIS},
+        {false, MORSE_CODE_CHAR_PAUSE_MILLIS},
+        {true, MORSE_CODE_DASH_MILLIS}, {false, MORSE_CODE_DASH_MILLIS},
+        {true, MORSE_CODE_DOT_MILLIS}, {false, MORSE_CODE_DASH_MILLIS},
+        {true, MORSE_CODE_DASH_MILLIS}, {false, MORSE_CODE_DASH_MILLIS},
+        {false, MORSE_CODE_WORD_PAUSE_MILLIS},
+    };
+    count = sizeof(steps) / sizeof(steps[0]);
+    return steps;
+}
+
+/**
+ * Blinks "OK" on an LED without blocking, for sketches that run a scheduler.
+ * Call update() often; it returns false once the blink is done.
+ *
+ * Platform needs `static void digital_write(int pin, bool high)`.
+ */
+template <class Platform>
+class OkBlinker {
+  public:
+    typedef typename Platform::Time Time;
+
+    OkBlinker() : pin_(-1), step_(-1), step_start_(0) {}
+
+    void start(int pin, Time now) {
+        pin_ = pin;
+        step_ = 0;
+        step_start_ = now;
+        size_t count;
+        Platform::digital_write(pin_, ok_blink_steps(count)[0].on);
+    }
+
+    bool update(Time now) {
+        if (step_ < 0) {
+            return false;
+        }
+        size_t count;
+        const BlinkStep *steps = ok_blink_steps(count);
+        while ((Time)(now - step_start_) >= steps[step_].millis) {
+            step_start_ += steps[step_].millis;
+            step_++;
+            if ((size_t)step_ >= count) {
+                step_ = -1;
+                Platform::digital_write(pin_, false);
+                return false;
+            }
+            Platform::digital_write(pin_, steps[step_].on);
+        }
+        return true;
+    }
+
+    bool running() const {
+        return step_ >= 0;
+    }
+
+  private:
+    int pin_;
+    int step_;
+    Time step_start_;
+};
+
+// The same blink, waiting it out with Platform::delay_ms()
+template <class Platform>
+void blink_ok(int pin) {
+    size_t count;
+    const BlinkStep *steps = ok_blink_steps(count);
+    for (size_t i = 0; i < count; i++) {
+        Platform::digital_write(pin, steps[i].on);
+        Platform::delay_ms(steps[i].millis);
+    }
+    Platform::digital_write(pin, false);
+}
+
+} // namespace garage_core
+
+#endif // GARAGE_CORE_OK_BLINKER_H
@@ -0,0 +1,47 @@
+#ifndef GARAGE_CORE_PLATFORM_H
+#define GARAGE_CORE_PLATFORM_H
+
+#include <stdint.h>
+
+/**
+ * A platform is a type with static functions. Core templates call them directly,
+ * so there is no virtual dispatch or function pointer, and each call inlines.
+ *
+ * struct Platform {
+ *     typedef uint32_t Time;          // Unsigned, wraps around
+ *     static Time now();              // Clock in milliseconds
+ *     static void delay_ms(Time ms);  // Only for HttpResponseReader and blink_ok, which wait
+ *     static void digital_write(int pin, bool high); // Only for OkBlinker and blink_ok
+ * };
+ *
+ * Connections stay outside the core: UrlWriter writes requests into caller buffers,
+ * HttpResponseReader reads responses from whatever connection the target passes in, and
+ * WgetRequest takes a transport type that hands out the connection.
+ *
+ * The ESP-IDF firmware passes tick counts to the core functions itself, so only the
+ * sketches need a platform here.
+ */
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+
+namespace garage_core {
+
+struct ArduinoPlatform {
+    typedef unsigned long Time;
+    static Time now() {
+        return millis();
+    }
+    static void delay_ms(Time ms) {
+        delay(ms);
+    }
+    static void digital_write(int pin, bool high) {
+        digitalWrite(pin, high ? HIGH : LOW);
+    }
+};
+
+} // namespace garage_core
+
+#endif
+
+#endif // GARAGE_CORE_PLATFORM_H
@@ -0,0 +1,63 @@
+#ifndef GARAGE_CORE_RETRY_POLICY_H
+#define GARAGE_CORE_RETRY_POLICY_H
+
+namespace garage_core {
+
+/**
+ * Exponential backoff between min_backoff and max_backoff, plus outage tracking.
+ * An outage starts at the first failure and ends at the next success.
+ */
+template <class Platform>
+class RetryPolicy {
+  public:
+    typedef typename Platform::Time Time;
+
+    RetryPolicy(Time min_backoff, Time max_backoff)
+        : min_backoff_(min_backoff), max_backoff_(max_backoff), backoff_(0), last_failure_(0), outage_start_(0), in_outage_(false) {}
+
+    // True when there is no backoff to wait for
+    bool ready() const {
+        return backoff_ == 0 || (Time)(Platform::now() - last_failure_) >= backoff_;
+    }
+    void on_success() {
+        backoff_ = 0;
+        in_outage_ = false;
+    }
+    void on_failure() {
+        Time now = Platform::now();
+        if (!in_outage_) {
+            in_outage_ = true;
+            outage_start_ = now;
+        }
+        backoff_ = backoff_ == 0 ? min_backoff_ : (backoff_ > max_backoff_ / 2 ? max_backoff_ : backoff_ * 2);
+        last_failure_ = now;
+    }
+    // Start an outage without a failed attempt, such as one carried over from before a reset
+    void begin_outage() {
+        if (!in_outage_) {
+            in_outage_ = true;
+            outage_start_ = Platform::now();
+        }
+    }
+    Time backoff() const {
+        return backoff_;
+    }
+    bool in_outage() const {
+        return in_outage_;
+    }
+    Time outage_duration() const {
+        return in_outage_ ? (Time)(Platform::now() - outage_start_) : 0;
+    }
+
+  private:
+    Time min_backoff_;
+    Time max_backoff_;
+    Time backoff_;
+    Time last_failure_;
+    Time outage_start_;
+    bool in_outage_;
+};
+
+} // namespace garage_core
+
+#endif // GARAGE_CORE_RETRY_POLICY_H
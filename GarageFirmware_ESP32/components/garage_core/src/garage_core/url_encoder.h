@@ -0,0 +1,150 @@
+#ifndef GARAGE_CORE_URL_ENCODER_H
+#define GARAGE_CORE_URL_ENCODER_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "index_sequence.h"
+
+namespace garage_core {
+
+/**
+ * Percent-encoding shared by compile-time constants and the runtime writer.
+ * Only RFC 3986 unreserved characters are left as they are.
+ */
+constexpr bool is_url_unreserved(char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '_' ||
+           c == '.' || c == '~';
+}
+
+constexpr char url_hex_digit(unsigned int value) {
+    return value < 10 ? (char)('0' + value) : (char)('A' + value - 10);
+}
+
+constexpr size_t url_encoded_length(const char *s) {
+    return *s == '\0' ? 0 : (is_url_unreserved(*s) ? 1 : 3) + url_encoded_length(s + 1);
+}
+
+// Character at index i of the encoded form of s. Single-expression for C++11 constexpr.
+constexpr char url_encoded_char_at(const char *s, size_t i) {
+    return is_url_unreserved(*s) ? (i == 0 ? *s : url_encoded_char_at(s + 1, i - 1))
+                                 : (i == 0   ? '%'
+                                    : i == 1 ? url_hex_digit(((unsigned char)*s) >> 4)
+                                    : i == 2 ? url_hex_digit(((unsigned char)*s) & 0x0F)
+                                             : url_encoded_char_at(s + 1, i - 3));
+}
+
+template <size_t N> struct UrlEncodedString {
+    char value[N + 1];
+};
+
+} // namespace garage_core
+
+/**
+ * Define a constant holding the percent-encoded form of a string literal, encoded by the compiler.
+ * The literal expands where the macro is used, so __TIMESTAMP__ describes the file that uses it.
+ *
+ * GARAGE_CORE_URL_ENCODED_CONSTANT(BUILD_TIMESTAMP_URL_ENCODED, __TIMESTAMP__);
+ * // "Wed Mar  3 00:28:41 2021" -> "Wed%20Mar%20%203%2000%3A28%3A41%202021"
+ */
+#define GARAGE_CORE_URL_ENCODED_CONSTANT(name, literal)                                                                \
+    template <size_t... I>                                                                                             \
+    constexpr garage_core::UrlEncodedString<sizeof...(I)> name##_encode(garage_core::IndexSequence<I...>) {            \
+        return {{garage_core::url_encoded_char_at(literal, I)..., '\0'}};                                             \
+    }                                                                                                                  \
+    static constexpr garage_core::UrlEncodedString<garage_core::url_encoded_length(literal)> name =                   \
+        name##_encode(garage_core::MakeIndexSequence<garage_core::url_encoded_length(literal)>::type())
+
+namespace garage_core {
+
+/**
+ * Writes a URL into a caller-owned buffer without allocating.
+ * Once the buffer is full the URL is marked as overflowed and further appends are ignored.
+ *
+ * char url[256];
+ * UrlWriter writer(url, sizeof(url));
+ * writer.append(base_url).param("session", session).param("deviceTimestamp", now);
+ * if (!writer.overflowed()) { ... }
+ */
+class UrlWriter {
+  public:
+    UrlWriter(char *buff, size_t buff_size) : buff_(buff), buff_size_(buff_size), length_(0), has_query_(false), overflowed_(false) {
+        if (buff_size_ > 0) {
+            buff_[0] = '\0';
+        } else {
+            overflowed_ = true;
+        }
+    }
+
+    // Append without escaping, for the base URL and pre-encoded values
+    UrlWriter &append(const char *raw) {
+        while (*raw != '\0') {
+            put(*raw++);
+        }
+        return *this;
+    }
+
+    // Append "?key=value" or "&key=value" with the value percent-encoded
+    UrlWriter &param(const char *key, const char *value) {
+        begin_param(key);
+        while (*value != '\0') {
+            char c = *value++;
+            if (is_url_unreserved(c)) {
+                put(c);
+            } else {
+                put('%');
+                put(url_hex_digit(((unsigned char)c) >> 4));
+                put(url_hex_digit(((unsigned char)c) & 0x0F));
+            }
+        }
+        return *this;
+    }
+
+    UrlWriter &param(const char *key, long value) {
+        char digits[21]; // Any 64-bit long, for host builds
+        snprintf(digits, sizeof(digits), "%ld", value);
+        return param(key, digits);
+    }
+
+    // Append a value that is already percent-encoded, such as a UrlEncodedString
+    UrlWriter &encoded_param(const char *key, const char *encoded_value) {
+        begin_param(key);
+        return append(encoded_value);
+    }
+
+    bool overflowed() const {
+        return overflowed_;
+    }
+    size_t length() const {
+        return length_;
+    }
+
+  private:
+    char *buff_;
+    size_t buff_size_;
+    size_t length_;
+    bool has_query_;
+    bool overflowed_;
+
+    void begin_param(const char *key) {
+        put(has_query_ ? '&' : '?');
+        append(key);
+        put('=');
+    }
+
+    void put(char c) {
+        if (c == '?') {
+            has_query_ = true;
+        }
+        if (overflowed_ || length_ + 1 >= buff_size_) {
+            overflowed_ = true;
+            return;
+        }
+        buff_[length_++] = c;
+        buff_[length_] = '\0';
+    }
+};
+
+} // namespace garage_core
+
+#endif // GARAGE_CORE_URL_ENCODER_H
@@ -0,0 +1,190 @@
+#ifndef GARAGE_CORE_WGET_H
+#define GARAGE_CORE_WGET_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "http_response_reader.h"
+
+namespace garage_core {
+
+// Split "https://host/path?query" into "host" and "/path?query" without allocating
+inline bool parse_url(const char *url, char *host, size_t host_size, const char **path) {
+    const char *host_start = strstr(url, "//");
+    host_start = host_start ? host_start + 2 : url;
+    *path = strchr(host_start, '/');
+    size_t host_length = *path ? (size_t)(*path - host_start) : strlen(host_start);
+    if (*path == NULL) {
+        *path = "/";
+    }
+    if (host_length >= host_size) {
+        return false;
+    }
+    memcpy(host, host_start, host_length);
+    host[host_length] = '\0';
+    return true;
+}
+
+// Write a GET request into buff. Returns its length, or 0 if it does not fit.
+inline size_t format_get_request(char *buff, size_t size, const char *host, const char *path, const char *http_version) {
+    int length = snprintf(buff, size, "GET %s %s\r\nHost: %s\r\nConnection: close\r\n\r\n", path, http_version, host);
+    if (length < 0 || (size_t)length >= size) {
+        return 0;
+    }
+    return (size_t)length;
+}
+
+enum WgetState {
+    WGET_IDLE,
+    WGET_WAITING,
+    WGET_SUCCEEDED,
+    WGET_FAILED,
+};
+
+/**
+ * Resumable GET over a connection the target owns.
+ *
+ * begin() connects and sends the request. The connect still blocks, because the WiFi
+ * libraries have no asynchronous connect. poll() returns right away while the server is
+ * preparing the response, which is where most of the time goes, and reads the response
+ * once it starts to arrive. get() does both and waits.
+ *
+ * Transport hands out the connection, such as an Arduino Client:
+ *
+ * struct Transport {
+ *     typedef Client Connection;          // connect(host, port), write(buff, size), stop(),
+ *                                         // and what HttpResponseReader reads
+ *     static Connection &connection();    // Reused for every request
+ *     static const char *http_version();  // "HTTP/1.0" or "HTTP/1.1"
+ * };
+ *
+ * WgetRequest<ArduinoPlatform, WiFiTransport> request;
+ * request.begin(url, 443);
+ * // In a scheduled task:
+ * if (request.poll(handler, NULL) != WGET_WAITING) {
+ *     ...
+ * }
+ */
+template <class Platform, class Transport, size_t HostSize = 128, size_t RequestSize = 1024>
+class WgetRequest {
+  public:
+    typedef typename Platform::Time Time;
+    typedef typename Transport::Connection Connection;
+    typedef HttpResponseReader<Platform, Connection> Reader;
+    // Called with the response once the headers are read. Reads the body from the reader.
+    typedef bool (*BodyHandler)(Reader &response, void *context);
+
+    explicit WgetRequest(Time timeout = 10000)
+        : connection_(NULL), state_(WGET_IDLE), start_(0), timeout_(timeout), status_code_(0), error_(NULL),
+          idle_(NULL) {}
+
+    // Called while a response is being read, so sampling continues during network waits.
+    // The callback must not start another request.
+    void set_idle_callback(void (*idle)(void)) {
+        idle_ = idle;
+    }
+
+    bool begin(const char *url, int port) {
+        char host[HostSize];
+        const char *path;
+        start_ = Platform::now();
+        state_ = WGET_FAILED;
+        status_code_ = 0;
+        error_ = NULL;
+        if (!parse_url(url, host, sizeof(host), &path)) {
+            error_ = "Host name is too long";
+            return false;
+        }
+        connection_ = &Transport::connection();
+        connection_->stop();
+        if (!connection_->connect(host, port)) {
+            error_ = "Problem connecting";
+            return false;
+        }
+        // The whole request goes out with one write, so it fits in a single TLS record
+        char request[RequestSize];
+        size_t length = format_get_request(request, sizeof(request), host, path, Transport::http_version());
+        if (length == 0) {
+            error_ = "Request does not fit";
+            connection_->stop();
+            return false;
+        }
+        if (connection_->write((const uint8_t *)request, length) != length) {
+            error_ = "Problem sending the request";
+            connection_->stop();
+            return false;
+        }
+        state_ = WGET_WAITING;
+        return true;
+    }
+
+    WgetState poll(BodyHandler handler, void *context) {
+        if (state_ != WGET_WAITING) {
+            return state_;
+        }
+        if (connection_->available() > 0 || !connection_->connected()) {
+            // The response has started, so the rest follows quickly
+            finish(handler, context);
+        } else if (elapsed() >= timeout_) {
+            error_ = "Timed out waiting for the response";
+            connection_->stop();
+            state_ = WGET_FAILED;
+        }
+        return state_;
+    }
+
+    bool get(const char *url, int port, BodyHandler handler, void *context) {
+        if (!begin(url, port)) {
+            return false;
+        }
+        return finish(handler, context) == WGET_SUCCEEDED;
+    }
+
+    WgetState state() const {
+        return state_;
+    }
+    bool in_progress() const {
+        return state_ == WGET_WAITING;
+    }
+    Time elapsed() const {
+        return (Time)(Platform::now() - start_);
+    }
+    // 0 until the status line is read
+    int status_code() const {
+        return status_code_;
+    }
+    // Why the last request failed before the handler saw it, or NULL
+    const char *error() const {
+        return error_;
+    }
+
+  private:
+    Connection *connection_;
+    WgetState state_;
+    Time start_;
+    Time timeout_;
+    int status_code_;
+    const char *error_;
+    void (*idle_)(void);
+
+    // Read the response, pass the body to the handler, then close the connection
+    WgetState finish(BodyHandler handler, void *context) {
+        Time waited = elapsed();
+        Reader reader(*connection_, timeout_ > waited ? (Time)(timeout_ - waited) : 0);
+        reader.set_idle_callback(idle_);
+        bool success = reader.read_headers() && handler(reader, context);
+        connection_->stop();
+        status_code_ = reader.status_code();
+        if (reader.timed_out()) {
+            error_ = "Timed out waiting for the response";
+        }
+        state_ = success ? WGET_SUCCEEDED : WGET_FAILED;
+        return state_;
+    }
+};
+
+} // namespace garage_core
+
+#endif // GARAGE_CORE_WGET_H
@@ -0,0 +1,149 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+#include "GarageCore.h"
+
+// Host clock for the templates, set by the benchmark instead of read from a timer
+struct HostPlatform {
+    typedef uint32_t Time;
+    static Time current;
+    static Time now() {
+        return current;
+    }
+    static void digital_write(int, bool high) {
+        led = high;
+    }
+    static bool led;
+};
+HostPlatform::Time HostPlatform::current = 0;
+bool HostPlatform::led = false;
+
+GARAGE_CORE_URL_ENCODED_CONSTANT(BUILD_TIMESTAMP_URL_ENCODED, "Sun Oct 18 18:48:56 2026");
+
+// Keeps results alive so the optimizer can't drop the loops
+static volatile uint32_t sink;
+
+template <class Body>
+static void bench(const char *name, long iterations, Body body) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint32_t result = 0;
+    for (long i = 0; i < iterations; i++) {
+        result += body(i);
+    }
+    double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    sink = result;
+    printf("%-28s %8.2f ns/op\n", name, elapsed / iterations);
+}
+
+// A bouncing switch: 20 ms of noise around every level change, at 1 ms a sample
+static int bouncing_level(long sample) {
+    long phase = sample % 1000;
+    if (phase < 20) {
+        return (int)((sample * 2654435761u) >> 16) & 1;
+    }
+    return (int)(sample / 1000) & 1;
+}
+
+static void check_debounce() {
+    garage_core::DebounceState<uint32_t> state = garage_core::DebounceState<uint32_t>();
+    assert(garage_core::debounce_step(state, 0, 0u, 50u));
+    assert(!garage_core::debounce_step(state, 1, 10u, 50u));
+    assert(!garage_core::debounce_step(state, 1, 59u, 50u));
+    assert(garage_core::debounce_step(state, 1, 60u, 50u));
+    assert(state.level == 1);
+    // Clock wrap
+    assert(!garage_core::debounce_step(state, 0, UINT32_MAX - 10, 50u));
+    assert(garage_core::debounce_step(state, 0, 40u, 50u));
+    assert(state.level == 0);
+}
+
+static void check_url() {
+    char url[128];
+    garage_core::UrlWriter writer(url, sizeof(url));
+    writer.append("https://example.com/echo").param("session", "a b").param("sensorA", 1L)
+        .encoded_param("buildTimestamp", BUILD_TIMESTAMP_URL_ENCODED.value);
+    assert(!writer.overflowed());
+    assert(strcmp(url, "https://example.com/echo?session=a%20b&sensorA=1&buildTimestamp=Sun%20Oct%2018%2018%3A48%3A56%202026") == 0);
+    char small[8];
+    garage_core::UrlWriter overflow(small, sizeof(small));
+    overflow.append("https://example.com");
+    assert(overflow.overflowed() && strlen(small) == sizeof(small) - 1);
+}
+
+static void check_retry() {
+    HostPlatform::current = 1000;
+    garage_core::RetryPolicy<HostPlatform> policy(100, 1000);
+    assert(policy.ready());
+    policy.on_failure();
+    assert(!policy.ready() && policy.backoff() == 100);
+    HostPlatform::current += 100;
+    assert(policy.ready());
+    for (int i = 0; i < 10; i++) {
+        policy.on_failure();
+    }
+    assert(policy.backoff() == 1000 && policy.outage_duration() == 100);
+    HostPlatform::current += 500;
+    assert(policy.outage_duration() == 600);
+    policy.on_success();
+    assert(policy.ready() && !policy.in_outage());
+}
+
+int main(int argc, char **argv) {
+    long iterations = argc > 1 ? atol(argv[1]) : 10000000;
+    check_debounce();
+    check_url();
+    check_retry();
+    assert(garage_core::is_button_press_requested("token-1", "token-2"));
+    assert(!garage_core::is_button_press_requested("token-1", "token-1"));
+    assert(!garage_core::is_button_press_requested("token-1", ""));
+
+    garage_core::DebounceState<uint32_t> debounce = garage_core::DebounceState<uint32_t>();
+    bench("debounce_step", iterations, [&](long i) {
+        return (uint32_t)garage_core::debounce_step(debounce, bouncing_level(i), (uint32_t)i, 50u);
+    });
+    const char *tokens[] = {"2026-10-18T18:48:56.123Z-a", "2026-10-18T18:48:56.123Z-b", ""};
+    bench("is_button_press_requested", iterations, [&](long i) {
+        return (uint32_t)garage_core::is_button_press_requested(tokens[0], tokens[i % 3]);
+    });
+    char url[256];
+    bench("UrlWriter sensor request", iterations / 10, [&](long i) {
+        garage_core::UrlWriter writer(url, sizeof(url));
+        writer.append("https://us-central1-example.cloudfunctions.net/echo")
+            .param("session", "3f1c2a7e-5d64-4c2b-9a57-0d1b8e6f4a21")
+            .param("sensorA", (long)(i & 1))
+            .param("sensorB", (long)((i >> 1) & 1))
+            .param("deviceTimestamp", (long)i)
+            .encoded_param("buildTimestamp", BUILD_TIMESTAMP_URL_ENCODED.value);
+        return (uint32_t)writer.length();
+    });
+    char host[128];
+    char request[1024];
+    bench("parse_url + format_get_request", iterations / 10, [&](long) {
+        const char *path;
+        garage_core::parse_url(url, host, sizeof(host), &path);
+        return (uint32_t)garage_core::format_get_request(request, sizeof(request), host, path, "HTTP/1.0");
+    });
+    garage_core::OkBlinker<HostPlatform> blinker;
+    bench("OkBlinker update", iterations, [&](long i) {
+        if (!blinker.update((uint32_t)i)) {
+            blinker.start(13, (uint32_t)i);
+        }
+        return (uint32_t)HostPlatform::led;
+    });
+    garage_core::RetryPolicy<HostPlatform> policy(1000, 60000);
+    bench("RetryPolicy failure/success", iterations, [&](long i) {
+        HostPlatform::current = (uint32_t)i;
+        if (i % 8 == 7) {
+            policy.on_success();
+        } else {
+            policy.on_failure();
+        }
+        return (uint32_t)policy.ready();
+    });
+    return 0;
+}
@@ -0,0 +1,243 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "GarageCore.h"
+
+// Host clock that only moves when the reader waits
+struct HostPlatform {
+    typedef uint32_t Time;
+    static Time current;
+    static Time now() {
+        return current;
+    }
+    static void delay_ms(Time ms) {
+        current += ms;
+    }
+};
+HostPlatform::Time HostPlatform::current = 0;
+
+/**
+ * A connection that hands out a scripted response. Each part arrives at its time, and
+ * read() returns at most max_read bytes, like a socket that delivers in pieces.
+ */
+struct FakeSource {
+    struct Part {
+        const char *bytes;
+        uint32_t arrives_at;
+    };
+    const Part *parts;
+    size_t part_count;
+    size_t part;
+    size_t offset;
+    size_t max_read;
+    bool closes; // Close after the last part instead of going quiet
+
+    FakeSource(const Part *parts, size_t part_count, bool closes = true, size_t max_read = 7)
+        : parts(parts), part_count(part_count), part(0), offset(0), max_read(max_read), closes(closes) {}
+
+    int available() {
+        if (part >= part_count || HostPlatform::now() < parts[part].arrives_at) {
+            return 0;
+        }
+        return (int)(strlen(parts[part].bytes) - offset);
+    }
+    int read(uint8_t *buff, size_t size) {
+        size_t n = (size_t)available();
+        n = n < size ? n : size;
+        n = n < max_read ? n : max_read;
+        memcpy(buff, parts[part].bytes + offset, n);
+        offset += n;
+        if (offset == strlen(parts[part].bytes)) {
+            part++;
+            offset = 0;
+        }
+        return (int)n;
+    }
+    bool connected() {
+        return part < part_count || !closes;
+    }
+};
+
+typedef garage_core::HttpResponseReader<HostPlatform, FakeSource, 16, 64> Reader;
+
+static void test_content_length() {
+    HostPlatform::current = 0;
+    // Anything after Content-Length is not body
+    const FakeSource::Part parts[] = {
+        {"HTTP/1.1 200 OK\r\ncontent-length: 15\r\nConnection: keep-alive\r\n\r\n{\"session\":", 0},
+        {"\"a\"}extra", 5},
+    };
+    FakeSource source(parts, 2, false);
+    Reader reader(source);
+    assert(reader.read_headers());
+    assert(reader.status_code() == 200);
+    char body[64];
+    size_t length = 0;
+    assert(reader.read_body(body, sizeof(body), length));
+    assert(length == 15 && strcmp(body, "{\"session\":\"a\"}") == 0);
+    assert(reader.read() == -1);
+}
+
+static void test_chunked() {
+    HostPlatform::current = 0;
+    const FakeSource::Part parts[] = {
+        {"HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\nContent-Length: 99\r\n\r\n", 0},
+        {"5;ext=1\r\nhello\r\n", 1},
+        {"f\r\n, chunked world\r\n", 2},
+        {"0\r\nTrailer: x\r\n\r\n", 3},
+    };
+    FakeSource source(parts, 4);
+    Reader reader(source);
+    assert(reader.read_headers());
+    char body[64];
+    size_t length = 0;
+    assert(reader.read_body(body, sizeof(body), length));
+    assert(strcmp(body, "hello, chunked world") == 0);
+}
+
+// available() counts the body left in the current chunk, never the framing after it
+static void test_chunked_available() {
+    HostPlatform::current = 0;
+    const FakeSource::Part parts[] = {
+        {"HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n", 0},
+        {"3\r\nabc\r\n4\r\ndefg\r\n0\r\n\r\n", 0},
+    };
+    FakeSource source(parts, 2, true, 64);
+    Reader reader(source);
+    assert(reader.read_headers());
+    assert(reader.available() == 0); // No chunk started yet
+    assert(reader.read() == 'a');
+    assert(reader.available() == 2);
+    char bytes[8] = {0};
+    assert(reader.readBytes(bytes, 2) == 2 && strcmp(bytes, "bc") == 0);
+    assert(reader.available() == 0); // Raw bytes are buffered, but they are framing
+    assert(reader.peek() == 'd');
+    assert(reader.available() == 1);
+    assert(reader.readBytes(bytes, sizeof(bytes)) == 4 && strncmp(bytes, "defg", 4) == 0);
+    assert(reader.available() == 0 && reader.read() == -1);
+}
+
+static void test_until_close() {
+    HostPlatform::current = 0;
+    const FakeSource::Part parts[] = {
+        {"HTTP/1.0 404 Not Found\r\n\r\n", 0},
+        {"not found", 1},
+    };
+    FakeSource source(parts, 2);
+    Reader reader(source);
+    assert(reader.read_headers());
+    assert(reader.status_code() == 404);
+    char body[64];
+    size_t length = 0;
+    assert(reader.read_body(body, sizeof(body), length));
+    assert(strcmp(body, "not found") == 0);
+}
+
+static int idle_calls = 0;
+static void count_idle() {
+    idle_calls++;
+}
+
+static void test_timeout() {
+    HostPlatform::current = 0;
+    const FakeSource::Part parts[] = {
+        {"HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\nabc", 0},
+        {"defghij", 500},
+    };
+    FakeSource source(parts, 2);
+    Reader reader(source, 100);
+    reader.set_idle_callback(count_idle);
+    idle_calls = 0;
+    assert(reader.read_headers());
+    char body[64];
+    size_t length = 0;
+    assert(!reader.read_body(body, sizeof(body), length));
+    assert(reader.timed_out());
+    assert(strcmp(body, "abc") == 0);
+    assert(reader.elapsed() == 100);
+    assert(idle_calls == 100);
+}
+
+static void test_headers_timeout() {
+    HostPlatform::current = 0;
+    const FakeSource::Part parts[] = {
+        {"HTTP/1.1 200 OK\r\nContent-", 0},
+    };
+    FakeSource source(parts, 1, false);
+    Reader reader(source, 50);
+    assert(!reader.read_headers());
+    assert(reader.timed_out());
+    assert(reader.read() == -1);
+}
+
+static void test_overflow() {
+    HostPlatform::current = 0;
+    const FakeSource::Part parts[] = {
+        {"HTTP/1.1 200 OK\r\nContent-Length: 12\r\n\r\n0123456789ab", 0},
+    };
+    FakeSource source(parts, 1);
+    Reader reader(source);
+    assert(reader.read_headers());
+    char body[8];
+    size_t length = 0;
+    assert(!reader.read_body(body, sizeof(body), length));
+    assert(reader.overflowed());
+    assert(length == sizeof(body) - 1 && strcmp(body, "0123456") == 0);
+}
+
+// A body that exactly fills the buffer is not an overflow
+static void test_exact_fit() {
+    HostPlatform::current = 0;
+    const FakeSource::Part parts[] = {
+        {"HTTP/1.1 200 OK\r\nContent-Length: 7\r\n\r\n0123456", 0},
+    };
+    FakeSource source(parts, 1, false);
+    Reader reader(source);
+    assert(reader.read_headers());
+    char body[8];
+    size_t length = 0;
+    assert(reader.read_body(body, sizeof(body), length));
+    assert(!reader.overflowed() && length == 7);
+}
+
+static void test_cut_short() {
+    HostPlatform::current = 0;
+    const FakeSource::Part parts[] = {
+        {"HTTP/1.1 200 OK\r\nContent-Length: 20\r\n\r\nshort", 0},
+    };
+    FakeSource source(parts, 1);
+    Reader reader(source);
+    assert(reader.read_headers());
+    char body[64];
+    size_t length = 0;
+    assert(!reader.read_body(body, sizeof(body), length));
+    assert(!reader.timed_out() && !reader.overflowed());
+    assert(strcmp(body, "short") == 0);
+}
+
+static void test_malformed() {
+    HostPlatform::current = 0;
+    const FakeSource::Part parts[] = {
+        {"garbage\r\n\r\n", 0},
+    };
+    FakeSource source(parts, 1);
+    Reader reader(source);
+    assert(!reader.read_headers());
+}
+
+int main() {
+    test_content_length();
+    test_chunked();
+    test_chunked_available();
+    test_until_close();
+    test_timeout();
+    test_headers_timeout();
+    test_overflow();
+    test_exact_fit();
+    test_cut_short();
+    test_malformed();
+    printf("HttpResponseReader tests passed\n");
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "GarageCore.h"
+
+// Host clock and one LED, which records every level change with its time
+struct HostPlatform {
+    typedef uint32_t Time;
+    static Time current;
+    static bool led;
+    static int changes;
+    static Time on_time;
+    static Time now() {
+        return current;
+    }
+    static void delay_ms(Time ms) {
+        if (led) {
+            on_time += ms;
+        }
+        current += ms;
+    }
+    static void digital_write(int pin, bool high) {
+        assert(pin == 13);
+        if (high != led) {
+            changes++;
+        }
+        led = high;
+    }
+};
+HostPlatform::Time HostPlatform::current = 0;
+bool HostPlatform::led = false;
+int HostPlatform::changes = 0;
+HostPlatform::Time HostPlatform::on_time = 0;
+
+static void reset() {
+    HostPlatform::current = 0;
+    HostPlatform::led = false;
+    HostPlatform::changes = 0;
+    HostPlatform::on_time = 0;
+}
+
+// "OK": five dashes and one dot, each followed by a dash-long gap, plus the two pauses
+static const uint32_t OK_ON_MILLIS = 5 * 400 + 100;
+static const uint32_t OK_TOTAL_MILLIS = OK_ON_MILLIS + 6 * 400 + 200 + 500;
+
+static void test_blink_ok() {
+    reset();
+    garage_core::blink_ok<HostPlatform>(13);
+    assert(HostPlatform::current == OK_TOTAL_MILLIS);
+    assert(HostPlatform::on_time == OK_ON_MILLIS);
+    assert(HostPlatform::changes == 12 && !HostPlatform::led);
+}
+
+static void test_blinker_matches_blink_ok() {
+    reset();
+    garage_core::OkBlinker<HostPlatform> blinker;
+    assert(!blinker.running() && !blinker.update(0));
+    blinker.start(13, 0);
+    assert(blinker.running() && HostPlatform::led);
+    // Stepped once a millisecond, as a scheduler would
+    uint32_t on_time = 0;
+    uint32_t now = 0;
+    while (blinker.update(now)) {
+        if (HostPlatform::led) {
+            on_time++;
+        }
+        now++;
+    }
+    assert(now == OK_TOTAL_MILLIS && on_time == OK_ON_MILLIS);
+    assert(HostPlatform::changes == 12 && !HostPlatform::led && !blinker.running());
+}
+
+static void test_blinker_catches_up() {
+    reset();
+    garage_core::OkBlinker<HostPlatform> blinker;
+    // Starts near the clock wrap, then misses most of the blink
+    blinker.start(13, UINT32_MAX - 100);
+    assert(blinker.update(UINT32_MAX));
+    assert(blinker.update(1000) && HostPlatform::led);
+    assert(!blinker.update(OK_TOTAL_MILLIS) && !HostPlatform::led);
+}
+
+int main() {
+    test_blink_ok();
+    test_blinker_matches_blink_ok();
+    test_blinker_catches_up();
+    printf("OkBlinker tests passed\n");
+    return 0;
+}
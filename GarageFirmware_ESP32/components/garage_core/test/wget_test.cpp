@@ -0,0 +1,203 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+
+#include "GarageCore.h"
+
+// Host clock that only moves when a test or the reader waits
+struct HostPlatform {
+    typedef uint32_t Time;
+    static Time current;
+    static Time now() {
+        return current;
+    }
+    static void delay_ms(Time ms) {
+        current += ms;
+    }
+};
+HostPlatform::Time HostPlatform::current = 0;
+
+/**
+ * A connection that records the request and hands out a response once the clock reaches
+ * responds_at. Arrives whole, since the reader's own tests cover responses in pieces.
+ */
+struct FakeConnection {
+    bool refuse;
+    std::string host;
+    int port;
+    std::string sent;
+    const char *response;
+    uint32_t responds_at;
+    size_t offset;
+    bool open;
+    int stops;
+
+    FakeConnection() : refuse(false), port(0), response(""), responds_at(0), offset(0), open(false), stops(0) {}
+
+    bool connect(const char *to_host, int to_port) {
+        host = to_host;
+        port = to_port;
+        open = !refuse;
+        return open;
+    }
+    size_t write(const uint8_t *buff, size_t size) {
+        sent.append((const char *)buff, size);
+        return size;
+    }
+    void stop() {
+        open = false;
+        stops++;
+    }
+    int available() {
+        if (!open || HostPlatform::now() < responds_at) {
+            return 0;
+        }
+        return (int)(strlen(response) - offset);
+    }
+    int read(uint8_t *buff, size_t size) {
+        size_t n = (size_t)available();
+        n = n < size ? n : size;
+        memcpy(buff, response + offset, n);
+        offset += n;
+        return (int)n;
+    }
+    bool connected() {
+        // The server closes once the whole response is out
+        return open && (HostPlatform::now() < responds_at || offset < strlen(response));
+    }
+};
+
+struct FakeTransport {
+    typedef FakeConnection Connection;
+    static FakeConnection fake;
+    static Connection &connection() {
+        return fake;
+    }
+    static const char *http_version() {
+        return "HTTP/1.0";
+    }
+};
+FakeConnection FakeTransport::fake;
+
+typedef garage_core::WgetRequest<HostPlatform, FakeTransport, 16, 128> Request;
+
+static void reset(const char *response, uint32_t responds_at) {
+    HostPlatform::current = 0;
+    FakeTransport::fake = FakeConnection();
+    FakeTransport::fake.response = response;
+    FakeTransport::fake.responds_at = responds_at;
+}
+
+static bool copy_body(Request::Reader &response, void *context) {
+    char *body = (char *)context;
+    size_t length = 0;
+    return response.read_body(body, 32, length);
+}
+
+static void test_parse_url() {
+    char host[16];
+    const char *path;
+    assert(garage_core::parse_url("https://example.com/echo?a=1", host, sizeof(host), &path));
+    assert(strcmp(host, "example.com") == 0 && strcmp(path, "/echo?a=1") == 0);
+    assert(garage_core::parse_url("example.com", host, sizeof(host), &path));
+    assert(strcmp(host, "example.com") == 0 && strcmp(path, "/") == 0);
+    assert(!garage_core::parse_url("https://a-very-long-host.example.com/", host, sizeof(host), &path));
+}
+
+static void test_format_get_request() {
+    char request[64];
+    size_t length = garage_core::format_get_request(request, sizeof(request), "example.com", "/echo", "HTTP/1.1");
+    assert(length == strlen(request));
+    assert(strcmp(request, "GET /echo HTTP/1.1\r\nHost: example.com\r\nConnection: close\r\n\r\n") == 0);
+    std::string path = "/" + std::string(100, 'a');
+    assert(garage_core::format_get_request(request, sizeof(request), "example.com", path.c_str(), "HTTP/1.1") == 0);
+}
+
+static void test_poll() {
+    reset("HTTP/1.0 200 OK\r\nContent-Length: 4\r\n\r\nbody", 300);
+    Request request;
+    assert(request.begin("https://example.com/echo?a=1", 443));
+    assert(FakeTransport::fake.host == "example.com" && FakeTransport::fake.port == 443);
+    assert(FakeTransport::fake.sent == "GET /echo?a=1 HTTP/1.0\r\nHost: example.com\r\nConnection: close\r\n\r\n");
+    char body[32];
+    // Returns right away while the server is preparing the response
+    assert(request.poll(copy_body, body) == garage_core::WGET_WAITING && request.in_progress());
+    HostPlatform::current = 299;
+    assert(request.poll(copy_body, body) == garage_core::WGET_WAITING);
+    HostPlatform::current = 300;
+    assert(request.poll(copy_body, body) == garage_core::WGET_SUCCEEDED);
+    assert(strcmp(body, "body") == 0);
+    assert(request.status_code() == 200 && request.error() == NULL && request.elapsed() == 300);
+    assert(!FakeTransport::fake.open);
+    // Finished requests stay finished
+    assert(request.poll(copy_body, body) == garage_core::WGET_SUCCEEDED);
+}
+
+static void test_poll_timeout() {
+    reset("HTTP/1.0 200 OK\r\n\r\n", 20000);
+    Request request(1000);
+    assert(request.begin("https://example.com/", 443));
+    char body[32];
+    HostPlatform::current = 999;
+    assert(request.poll(copy_body, body) == garage_core::WGET_WAITING);
+    HostPlatform::current = 1000;
+    assert(request.poll(copy_body, body) == garage_core::WGET_FAILED);
+    assert(request.error() != NULL && request.status_code() == 0 && !FakeTransport::fake.open);
+}
+
+static void test_get() {
+    reset("HTTP/1.0 404 Not Found\r\nContent-Length: 2\r\n\r\nno", 50);
+    Request request;
+    char body[32];
+    // Waits for the response through Platform::delay_ms()
+    assert(request.get("https://example.com/missing", 80, copy_body, body));
+    assert(request.status_code() == 404 && strcmp(body, "no") == 0);
+    assert(HostPlatform::current >= 50 && !request.in_progress());
+}
+
+static void test_get_timeout() {
+    // The reader gets what is left of the request's deadline
+    reset("HTTP/1.0 200 OK\r\n\r\n", 20000);
+    Request request(1000);
+    char body[32];
+    assert(!request.get("https://example.com/", 443, copy_body, body));
+    assert(request.state() == garage_core::WGET_FAILED && request.error() != NULL);
+    assert(HostPlatform::current == 1000);
+}
+
+static void test_connect_failure() {
+    reset("", 0);
+    FakeTransport::fake.refuse = true;
+    Request request;
+    assert(!request.begin("https://example.com/", 443));
+    assert(request.state() == garage_core::WGET_FAILED && request.error() != NULL);
+    assert(FakeTransport::fake.sent.empty());
+}
+
+static void test_request_too_long() {
+    reset("", 0);
+    Request request;
+    char url[256];
+    snprintf(url, sizeof(url), "https://example.com/%0200d", 0);
+    assert(!request.begin(url, 443));
+    assert(request.error() != NULL && FakeTransport::fake.sent.empty() && !FakeTransport::fake.open);
+    reset("", 0);
+    assert(!request.begin("https://a-very-long-host.example.com/", 443));
+    assert(FakeTransport::fake.host.empty());
+}
+
+int main() {
+    test_parse_url();
+    test_format_get_request();
+    test_poll();
+    test_poll_timeout();
+    test_get();
+    test_get_timeout();
+    test_connect_failure();
+    test_request_too_long();
+    printf("WgetRequest tests passed\n");
+    return 0;
+}
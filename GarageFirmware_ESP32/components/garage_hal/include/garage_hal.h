@@ -1,19 +1,49 @@
 #ifndef MY_HAL_H
 #define MY_HAL_H
 
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "garage_config.h"
+
 typedef enum {
     G_HAL_SENSOR_A,
     G_HAL_SENSOR_B,
 } garage_input_t;
 
+/**
+ * Called once a button pulse has ended and the button is released.
+ * Runs in the esp_timer task, so it must not block.
+ *
+ * actual_duration_us: measured time between press and release.
+ */
+typedef void (*garage_pulse_done_cb_t)(uint32_t actual_duration_us, void *arg);
+
 typedef struct {
     void (*init)(void);
     // Input
     int (*read_sensor)(garage_input_t gpio);
     // Output
     void (*set_button)(int level);
+    // Press the button now and release it after duration_us without blocking the caller.
+    // Returns ESP_ERR_INVALID_STATE if a pulse is already in progress.
+    esp_err_t (*pulse_button)(uint32_t duration_us, garage_pulse_done_cb_t on_done, void *arg);
 } garage_hal_t;
 
 extern garage_hal_t garage_hal;
 
+#ifdef CONFIG_USE_FAKE_GARAGE_HAL
+#define FAKE_GARAGE_HAL_MAX_PULSES 8
+
+// Timing of a pulse recorded by the fake HAL
+typedef struct {
+    int64_t start_us;
+    uint32_t requested_us;
+    uint32_t actual_us;
+} fake_garage_hal_pulse_t;
+
+// Copy up to max_pulses of the most recent pulses, oldest first. Returns the number copied.
+int fake_garage_hal_get_pulses(fake_garage_hal_pulse_t *pulses, int max_pulses);
+#endif // CONFIG_USE_FAKE_GARAGE_HAL
+
 #endif // MY_HAL_H
@@ -2,7 +2,9 @@
 #ifdef CONFIG_USE_FAKE_GARAGE_HAL
 
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdio.h>
 
@@ -14,9 +16,27 @@
 
 const char *TAG = "fake_garage_hal";
 
+// Recorded pulses, kept in a ring of the most recent FAKE_GARAGE_HAL_MAX_PULSES
+static fake_garage_hal_pulse_t pulses[FAKE_GARAGE_HAL_MAX_PULSES];
+static int pulse_count = 0;
+static portMUX_TYPE pulse_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t pulse_timer;
+static bool pulse_active = false;
+static garage_pulse_done_cb_t pulse_on_done;
+static void *pulse_arg;
+
+static void garage_hal_pulse_end(void *arg);
+
 // Initialize the hardware abstraction layer
 static void garage_hal_init(void) {
     ESP_LOGI(TAG, "Initialize garage HAL");
+    const esp_timer_create_args_t pulse_timer_args = {
+        .callback = garage_hal_pulse_end,
+        .name = "fake_button_pulse",
+    };
+    if (esp_timer_create(&pulse_timer_args, &pulse_timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create button pulse timer");
+    }
 }
 
 static int garage_hal_read_sensor(garage_input_t gpio) {
@@ -41,10 +61,66 @@ static void garage_hal_set_button(int level) {
     ESP_LOGI(TAG, "Set button level: %d", level);
 }
 
+static void garage_hal_pulse_end(void *arg) {
+    portENTER_CRITICAL(&pulse_lock);
+    fake_garage_hal_pulse_t *pulse = &pulses[(pulse_count - 1) % FAKE_GARAGE_HAL_MAX_PULSES];
+    pulse->actual_us = (uint32_t)(esp_timer_get_time() - pulse->start_us);
+    uint32_t actual_us = pulse->actual_us;
+    pulse_active = false;
+    portEXIT_CRITICAL(&pulse_lock);
+    ESP_LOGI(TAG, "Button pulse done: requested %" PRIu32 " us, actual %" PRIu32 " us", pulse->requested_us, actual_us);
+    if (pulse_on_done != NULL) {
+        pulse_on_done(actual_us, pulse_arg);
+    }
+}
+
+// Record the pulse timing instead of driving a relay
+static esp_err_t garage_hal_pulse_button(uint32_t duration_us, garage_pulse_done_cb_t on_done, void *arg) {
+    if (pulse_timer == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    portENTER_CRITICAL(&pulse_lock);
+    if (pulse_active) {
+        portEXIT_CRITICAL(&pulse_lock);
+        ESP_LOGW(TAG, "Rejected overlapping button pulse");
+        return ESP_ERR_INVALID_STATE;
+    }
+    pulse_active = true;
+    fake_garage_hal_pulse_t *pulse = &pulses[pulse_count % FAKE_GARAGE_HAL_MAX_PULSES];
+    pulse->start_us = esp_timer_get_time();
+    pulse->requested_us = duration_us;
+    pulse->actual_us = 0;
+    pulse_count++;
+    portEXIT_CRITICAL(&pulse_lock);
+    pulse_on_done = on_done;
+    pulse_arg = arg;
+    esp_err_t err = esp_timer_start_once(pulse_timer, duration_us);
+    if (err != ESP_OK) {
+        // Like the real HAL, a pulse that never started does not block the next one or get recorded
+        portENTER_CRITICAL(&pulse_lock);
+        pulse_count--;
+        pulse_active = false;
+        portEXIT_CRITICAL(&pulse_lock);
+    }
+    return err;
+}
+
+int fake_garage_hal_get_pulses(fake_garage_hal_pulse_t *out, int max_pulses) {
+    portENTER_CRITICAL(&pulse_lock);
+    int available = pulse_count < FAKE_GARAGE_HAL_MAX_PULSES ? pulse_count : FAKE_GARAGE_HAL_MAX_PULSES;
+    int count = available < max_pulses ? available : max_pulses;
+    for (int i = 0; i < count; i++) {
+        out[i] = pulses[(pulse_count - count + i) % FAKE_GARAGE_HAL_MAX_PULSES];
+    }
+    portEXIT_CRITICAL(&pulse_lock);
+    return count;
+}
+
 garage_hal_t garage_hal = {
     .init = garage_hal_init,
     .read_sensor = garage_hal_read_sensor,
     .set_button = garage_hal_set_button,
+    .pulse_button = garage_hal_pulse_button,
 };
 
 #endif // CONFIG_USE_FAKE_GARAGE_HAL
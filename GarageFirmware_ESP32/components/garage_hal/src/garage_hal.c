@@ -2,6 +2,8 @@
 #ifndef CONFIG_USE_FAKE_GARAGE_HAL
 
 #include "driver/gpio.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
 #include <stdbool.h>
 #include <stdio.h>
 
@@ -11,6 +13,16 @@
 #define SENSOR_B_GPIO GPIO_NUM_26
 #define BUTTON_GPIO GPIO_NUM_27
 
+// Button pulse state, shared between the caller and the esp_timer task
+static esp_timer_handle_t pulse_timer;
+static portMUX_TYPE pulse_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool pulse_active = false;
+static int64_t pulse_start_us;
+static garage_pulse_done_cb_t pulse_on_done;
+static void *pulse_arg;
+
+static void garage_hal_pulse_end(void *arg);
+
 // Initialize the hardware abstraction layer
 static void garage_hal_init(void) {
     gpio_config_t io_conf;
@@ -37,6 +49,15 @@ static void garage_hal_init(void) {
         return;
     }
     gpio_set_level(BUTTON_GPIO, 0); // Default to 0.
+
+    const esp_timer_create_args_t pulse_timer_args = {
+        .callback = garage_hal_pulse_end,
+        .name = "button_pulse",
+    };
+    if (esp_timer_create(&pulse_timer_args, &pulse_timer) != ESP_OK) {
+        printf("Failed to create button pulse timer\n");
+        return;
+    }
 }
 
 // Read the sensor value
@@ -56,10 +77,53 @@ static void garage_hal_set_button(int level) {
     gpio_set_level(BUTTON_GPIO, level);
 }
 
+// Release the button at the end of a pulse (esp_timer task)
+static void garage_hal_pulse_end(void *arg) {
+    gpio_set_level(BUTTON_GPIO, 0);
+    uint32_t actual_us = (uint32_t)(esp_timer_get_time() - pulse_start_us);
+    garage_pulse_done_cb_t on_done = pulse_on_done;
+    void *on_done_arg = pulse_arg;
+    portENTER_CRITICAL(&pulse_lock);
+    pulse_active = false;
+    portEXIT_CRITICAL(&pulse_lock);
+    if (on_done != NULL) {
+        on_done(actual_us, on_done_arg);
+    }
+}
+
+// Press the button and arm a one-shot esp_timer (1 us resolution) to release it
+static esp_err_t garage_hal_pulse_button(uint32_t duration_us, garage_pulse_done_cb_t on_done, void *arg) {
+    if (pulse_timer == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    portENTER_CRITICAL(&pulse_lock);
+    if (pulse_active) {
+        portEXIT_CRITICAL(&pulse_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    pulse_active = true;
+    portEXIT_CRITICAL(&pulse_lock);
+
+    pulse_on_done = on_done;
+    pulse_arg = arg;
+    pulse_start_us = esp_timer_get_time();
+    gpio_set_level(BUTTON_GPIO, 1);
+    esp_err_t err = esp_timer_start_once(pulse_timer, duration_us);
+    if (err != ESP_OK) {
+        // Never leave the relay closed
+        gpio_set_level(BUTTON_GPIO, 0);
+        portENTER_CRITICAL(&pulse_lock);
+        pulse_active = false;
+        portEXIT_CRITICAL(&pulse_lock);
+    }
+    return err;
+}
+
 garage_hal_t garage_hal = {
     .init = garage_hal_init,
     .read_sensor = garage_hal_read_sensor,
     .set_button = garage_hal_set_button,
+    .pulse_button = garage_hal_pulse_button,
 };
 
 #endif // CONFIG_USE_FAKE_GARAGE_HAL
@@ -0,0 +1,11 @@
+// Host stand-ins for the ESP-IDF pieces fake_garage_hal.c uses. fake_garage_hal_test.c defines the functions.
+#ifndef GARAGE_HAL_TEST_ESP_ERR_H
+#define GARAGE_HAL_TEST_ESP_ERR_H
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_INVALID_STATE 0x103
+
+#endif // GARAGE_HAL_TEST_ESP_ERR_H
@@ -0,0 +1,21 @@
+#ifndef GARAGE_HAL_TEST_ESP_TIMER_H
+#define GARAGE_HAL_TEST_ESP_TIMER_H
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef struct esp_timer *esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void *arg);
+
+typedef struct {
+    esp_timer_cb_t callback;
+    void *arg;
+    const char *name;
+} esp_timer_create_args_t;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle);
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us);
+int64_t esp_timer_get_time(void);
+
+#endif // GARAGE_HAL_TEST_ESP_TIMER_H
@@ -0,0 +1,155 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/fake_garage_hal.c"
+
+// The one esp_timer the fake HAL creates, fired by hand
+static struct {
+    esp_timer_create_args_t args;
+    bool created;
+    bool started;
+    uint64_t timeout_us;
+    esp_err_t start_result;
+} timer;
+static int64_t now_us;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle) {
+    timer.args = *create_args;
+    timer.created = true;
+    *out_handle = (esp_timer_handle_t)&timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t handle, uint64_t timeout_us) {
+    assert(handle == (esp_timer_handle_t)&timer);
+    if (timer.start_result == ESP_OK) {
+        timer.started = true;
+        timer.timeout_us = timeout_us;
+    }
+    return timer.start_result;
+}
+
+int64_t esp_timer_get_time(void) {
+    return now_us;
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(now_us / 1000);
+}
+
+// Advance the clock past the pulse and run the timer callback
+static void fire_timer(uint32_t late_us) {
+    assert(timer.started);
+    timer.started = false;
+    now_us += timer.timeout_us + late_us;
+    timer.args.callback(timer.args.arg);
+}
+
+static struct {
+    int count;
+    uint32_t actual_us;
+    void *arg;
+} done;
+
+static void on_done(uint32_t actual_duration_us, void *arg) {
+    done.count++;
+    done.actual_us = actual_duration_us;
+    done.arg = arg;
+}
+
+static void test_pulse_before_init(void) {
+    assert(garage_hal.pulse_button(1000, on_done, NULL) == ESP_ERR_INVALID_STATE);
+    fake_garage_hal_pulse_t out[FAKE_GARAGE_HAL_MAX_PULSES];
+    assert(fake_garage_hal_get_pulses(out, FAKE_GARAGE_HAL_MAX_PULSES) == 0);
+}
+
+static void test_pulse_recorded(void) {
+    garage_hal.init();
+    assert(timer.created);
+    now_us = 1000000;
+    int arg;
+    assert(garage_hal.pulse_button(500000, on_done, &arg) == ESP_OK);
+    assert(timer.timeout_us == 500000);
+    assert(done.count == 0);
+
+    fire_timer(1200);
+    assert(done.count == 1);
+    assert(done.actual_us == 501200);
+    assert(done.arg == &arg);
+
+    fake_garage_hal_pulse_t out[FAKE_GARAGE_HAL_MAX_PULSES];
+    assert(fake_garage_hal_get_pulses(out, FAKE_GARAGE_HAL_MAX_PULSES) == 1);
+    assert(out[0].start_us == 1000000);
+    assert(out[0].requested_us == 500000);
+    assert(out[0].actual_us == 501200);
+}
+
+static void test_overlapping_pulse_rejected(void) {
+    assert(garage_hal.pulse_button(400000, NULL, NULL) == ESP_OK);
+    assert(garage_hal.pulse_button(400000, on_done, NULL) == ESP_ERR_INVALID_STATE);
+    fake_garage_hal_pulse_t out[FAKE_GARAGE_HAL_MAX_PULSES];
+    assert(fake_garage_hal_get_pulses(out, FAKE_GARAGE_HAL_MAX_PULSES) == 2);
+    // The rejected pulse did not replace the callback of the one in progress
+    int count = done.count;
+    fire_timer(0);
+    assert(done.count == count);
+    assert(fake_garage_hal_get_pulses(out, FAKE_GARAGE_HAL_MAX_PULSES) == 2);
+    assert(out[1].actual_us == 400000);
+}
+
+// A pulse whose timer does not start is not recorded and does not block the next one
+static void test_timer_start_fails(void) {
+    fake_garage_hal_pulse_t before[FAKE_GARAGE_HAL_MAX_PULSES];
+    int count = fake_garage_hal_get_pulses(before, FAKE_GARAGE_HAL_MAX_PULSES);
+
+    timer.start_result = ESP_FAIL;
+    assert(garage_hal.pulse_button(300000, on_done, NULL) == ESP_FAIL);
+    assert(!timer.started);
+    fake_garage_hal_pulse_t out[FAKE_GARAGE_HAL_MAX_PULSES];
+    assert(fake_garage_hal_get_pulses(out, FAKE_GARAGE_HAL_MAX_PULSES) == count);
+    assert(memcmp(out, before, sizeof(out[0]) * count) == 0);
+
+    timer.start_result = ESP_OK;
+    assert(garage_hal.pulse_button(300000, on_done, NULL) == ESP_OK);
+    fire_timer(0);
+    assert(fake_garage_hal_get_pulses(out, FAKE_GARAGE_HAL_MAX_PULSES) == count + 1);
+    assert(out[count].requested_us == 300000);
+    assert(out[count].actual_us == 300000);
+}
+
+// Only the latest FAKE_GARAGE_HAL_MAX_PULSES are kept, oldest first
+static void test_pulse_ring(void) {
+    for (uint32_t i = 1; i <= FAKE_GARAGE_HAL_MAX_PULSES + 3; i++) {
+        assert(garage_hal.pulse_button(i * 1000, on_done, NULL) == ESP_OK);
+        fire_timer(i);
+    }
+    fake_garage_hal_pulse_t out[FAKE_GARAGE_HAL_MAX_PULSES + 1];
+    assert(fake_garage_hal_get_pulses(out, FAKE_GARAGE_HAL_MAX_PULSES + 1) == FAKE_GARAGE_HAL_MAX_PULSES);
+    for (int i = 0; i < FAKE_GARAGE_HAL_MAX_PULSES; i++) {
+        uint32_t n = (uint32_t)i + 4;
+        assert(out[i].requested_us == n * 1000);
+        assert(out[i].actual_us == n * 1000 + n);
+    }
+    // Fewer than the ring holds: the most recent ones
+    assert(fake_garage_hal_get_pulses(out, 2) == 2);
+    assert(out[0].requested_us == (FAKE_GARAGE_HAL_MAX_PULSES + 2) * 1000);
+    assert(out[1].requested_us == (FAKE_GARAGE_HAL_MAX_PULSES + 3) * 1000);
+
+    // A failed start after the ring wrapped leaves it as it was
+    timer.start_result = ESP_FAIL;
+    assert(garage_hal.pulse_button(99000, on_done, NULL) == ESP_FAIL);
+    timer.start_result = ESP_OK;
+    assert(fake_garage_hal_get_pulses(out, 1) == 1);
+    assert(out[0].requested_us == (FAKE_GARAGE_HAL_MAX_PULSES + 3) * 1000);
+}
+
+int main(void) {
+    test_pulse_before_init();
+    test_pulse_recorded();
+    test_overlapping_pulse_rejected();
+    test_timer_start_fails();
+    test_pulse_ring();
+    printf("fake_garage_hal tests passed\n");
+    return 0;
+}
@@ -0,0 +1,16 @@
+// The tests run on one thread, so the critical sections do nothing
+#ifndef GARAGE_HAL_TEST_FREERTOS_H
+#define GARAGE_HAL_TEST_FREERTOS_H
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+TickType_t xTaskGetTickCount(void);
+
+#endif // GARAGE_HAL_TEST_FREERTOS_H
@@ -1,13 +1,20 @@
 #ifndef GARAGE_HTTP_CLIENT_H
 #define GARAGE_HTTP_CLIENT_H
 
+#include "door_travel.h"
 #include "garage_config.h"
 #include "http_receive_buffer.h"
+#include "metrics.h"
+#include <stdint.h>
 
 typedef struct {
     char device_id[MAX_DEVICE_ID_LENGTH + 1];
     int sensor_a;
     int sensor_b;
+    int64_t event_age_ms;   // Time between capturing the sensor values and sending them
+    int64_t event_epoch_ms; // Unix time of the capture, 0 if the clock is not synced yet
+    const door_travel_report_t *travel; // Sent with heartbeats, NULL otherwise
+    const metrics_snapshot_t *metrics;  // Sent with heartbeats, NULL otherwise
 } sensor_request_t;
 
 typedef struct {
@@ -16,9 +23,24 @@ typedef struct {
     int sensor_b;
 } sensor_response_t;
 
+// Whether the door moved after a button press, as watched by the sensors
+typedef enum {
+    ACTUATION_NONE = 0,      // Nothing to report
+    ACTUATION_MOTION = 1,    // The door started moving after latency_ms
+    ACTUATION_NO_MOTION = 2, // The door did not move within latency_ms
+} actuation_result_t;
+
+typedef struct {
+    actuation_result_t result;
+    int latency_ms;
+    int attempts; // Presses made, 2 when the first one was retried
+} actuation_report_t;
+
 typedef struct {
     char device_id[MAX_DEVICE_ID_LENGTH + 1];
     char button_token[MAX_BUTTON_TOKEN_LENGTH + 1];
+    int local_press_count; // Button presses accepted by the LAN API since the last poll
+    actuation_report_t actuation;
 } button_request_t;
 
 typedef struct {
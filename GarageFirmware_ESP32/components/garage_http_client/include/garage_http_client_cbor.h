@@ -0,0 +1,40 @@
+#ifndef GARAGE_HTTP_CLIENT_CBOR_H
+#define GARAGE_HTTP_CLIENT_CBOR_H
+
+#include "garage_http_client.h"
+
+/**
+ * The garage server requests in CBOR instead of JSON and query parameters.
+ * garage_server uses these when GARAGE_WIRE_CBOR is enabled in idf.py menuconfig.
+ */
+
+#define WIRE_CBOR_CONTENT_TYPE "application/cbor"
+
+// Map keys, shared with FirebaseServer/src/controller/DeviceWire.ts.
+// Pinned by the cbor_* fixtures in wire-contracts/echo and wire-contracts/remoteButton.
+typedef enum {
+    WIRE_KEY_BUILD_TIMESTAMP = 1,
+    WIRE_KEY_SENSOR_A = 2,
+    WIRE_KEY_SENSOR_B = 3,
+    WIRE_KEY_EVENT_AGE_MILLIS = 4,
+    WIRE_KEY_EVENT_TIMESTAMP_MILLIS = 5,
+    WIRE_KEY_BUTTON_ACK_TOKEN = 6,
+    WIRE_KEY_CONDITIONAL = 7,
+    WIRE_KEY_LOCAL_PRESS_COUNT = 8,
+    WIRE_KEY_ACTUATION_RESULT = 9,
+    WIRE_KEY_ACTUATION_LATENCY_MILLIS = 10,
+    WIRE_KEY_ACTUATION_ATTEMPTS = 11,
+    WIRE_KEY_TRAVEL_OPEN = 12,
+    WIRE_KEY_TRAVEL_CLOSE = 13,
+    WIRE_KEY_PRESS_DELAY = 14,
+    WIRE_KEY_TRAVEL_MEDIAN_MILLIS = 15,
+    WIRE_KEY_TRAVEL_DRIFT = 16,
+    WIRE_KEY_METRICS_COUNTERS = 17,
+    WIRE_KEY_METRICS_GAUGES = 18,
+    WIRE_KEY_METRICS_HISTOGRAMS = 19,
+} wire_key_t;
+
+void cbor_garage_server_send_sensor_values(sensor_request_t *sensor_request, sensor_response_t *sensor_response, http_receive_buffer_t *recv_buffer);
+void cbor_garage_server_send_button_token(button_request_t *button_request, button_response_t *button_response, http_receive_buffer_t *recv_buffer);
+
+#endif // GARAGE_HTTP_CLIENT_CBOR_H
@@ -8,6 +8,7 @@ typedef struct {
     size_t buffer_len;
     size_t data_received_len;
     int status_code;
+    int next_poll_seconds; // X-Next-Poll-Seconds response header, 0 if the server sent none
 } http_receive_buffer_t;
 
 void reset_http_buffer(http_receive_buffer_t *buffer);
@@ -3,6 +3,13 @@
 
 #include "http_receive_buffer.h"
 
+esp_err_t https_send_post_request(const char *url, const char *content_type, const char *post_data, int post_data_len, http_receive_buffer_t *recv_buffer);
 esp_err_t https_send_json_post_request(const char *url, const char *post_data, int post_data_len, http_receive_buffer_t *recv_buffer);
 
+/**
+ * @brief Close the connection GARAGE_HTTP_KEEP_ALIVE keeps open, so the next request opens a
+ *        new one. The TLS session is kept and resumed. Does nothing without keep-alive.
+ */
+void https_close_connection(void);
+
 #endif // HTTPS_POST_REQUEST_H
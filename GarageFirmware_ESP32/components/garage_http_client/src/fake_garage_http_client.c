@@ -15,10 +15,12 @@ void fake_garage_server_init(void) {
 
 void fake_garage_server_send_sensor_values(sensor_request_t *sensor_request, sensor_response_t *sensor_response, http_receive_buffer_t *recv_buffer) {
     ESP_LOGI(TAG,
-             "Send sensor values to server: device_id: %s, sensor_a: %d, sensor_b: %d",
+             "Send sensor values to server: device_id: %s, sensor_a: %d, sensor_b: %d, event_age_ms: %lld, event_epoch_ms: %lld",
              sensor_request->device_id,
              sensor_request->sensor_a,
-             sensor_request->sensor_b);
+             sensor_request->sensor_b,
+             (long long)sensor_request->event_age_ms,
+             (long long)sensor_request->event_epoch_ms);
     vTaskDelay(1000 / portTICK_PERIOD_MS); // Simulate network delay
     snprintf(sensor_response->device_id, MAX_DEVICE_ID_LENGTH + 1, "%s", sensor_request->device_id);
     sensor_response->sensor_a = sensor_request->sensor_a;
@@ -31,9 +33,12 @@ void fake_garage_server_send_button_token(button_request_t *button_request, butt
     static uint64_t counter = 0;
     button_token = (counter++/2); // Increments every 2 calls
     ESP_LOGI(TAG,
-             "Send button token to server: device_id: %s, button_token: %s",
+             "Send button token to server: device_id: %s, button_token: %s, local_press_count: %d, actuation: %d after %d ms",
              button_request->device_id,
-             button_request->button_token);
+             button_request->button_token,
+             button_request->local_press_count,
+             button_request->actuation.result,
+             button_request->actuation.latency_ms);
     vTaskDelay(1000 / portTICK_PERIOD_MS); // Simulate network delay
     snprintf(button_response->device_id, MAX_DEVICE_ID_LENGTH + 1, "%s", button_request->device_id);
     snprintf(button_response->button_token,
@@ -8,7 +8,9 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "binary_log.h"
 #include "garage_http_client.h"
+#include "garage_http_client_cbor.h"
 #include "https_post_request.h"
 #include "root_ca.h"
 
@@ -20,17 +22,58 @@ static const char *TAG = "garage_server";
 #define BUTTON_TOKEN_ENDPOINT CONFIG_BUTTON_TOKEN_ENDPOINT   // "/button_token"
 #define SENSOR_VALUES_URL GARAGE_SERVER_BASE_URL SENSOR_VALUES_ENDPOINT
 #define BUTTON_TOKEN_URL GARAGE_SERVER_BASE_URL BUTTON_TOKEN_ENDPOINT
+#define HTTP_STATUS_NOT_MODIFIED 304
 
 void real_garage_server_init(void) {
     ESP_LOGI(TAG, "Initialize garage server");
     ESP_LOGI(TAG, "Server root certificate: %s", server_root_cert_pem_start);
 }
 
+/**
+ * Door travel histograms for the heartbeat: bucket counts per kind, the medians and the drift flags.
+ * The bucket bounds are in door_travel.c.
+ */
+static void add_travel_report(cJSON *root, const door_travel_report_t *travel) {
+    static const char *const COUNT_NAMES[DOOR_TRAVEL_KIND_COUNT] = {"travel_open", "travel_close", "press_delay"};
+    int values[DOOR_TRAVEL_BUCKETS];
+    for (int kind = 0; kind < DOOR_TRAVEL_KIND_COUNT; kind++) {
+        for (int i = 0; i < DOOR_TRAVEL_BUCKETS; i++) {
+            values[i] = travel->counts[kind][i];
+        }
+        cJSON_AddItemToObject(root, COUNT_NAMES[kind], cJSON_CreateIntArray(values, DOOR_TRAVEL_BUCKETS));
+    }
+    for (int kind = 0; kind < DOOR_TRAVEL_KIND_COUNT; kind++) {
+        values[kind] = (int)travel->median_ms[kind];
+    }
+    cJSON_AddItemToObject(root, "travel_median_ms", cJSON_CreateIntArray(values, DOOR_TRAVEL_KIND_COUNT));
+    cJSON_AddNumberToObject(root, "travel_drift", travel->drift_flags);
+}
+
+static cJSON *create_uint_array(const uint32_t *values, size_t count) {
+    cJSON *array = cJSON_CreateArray();
+    for (size_t i = 0; i < count; i++) {
+        cJSON_AddItemToArray(array, cJSON_CreateNumber(values[i]));
+    }
+    return array;
+}
+
+/**
+ * Metrics for the heartbeat, in metrics.def order. Histograms are flattened by
+ * metrics_encode_histograms().
+ */
+static void add_metrics(cJSON *root, const metrics_snapshot_t *metrics) {
+    static uint32_t histograms[METRICS_ENCODED_HISTOGRAMS_MAX];
+    size_t histograms_length = metrics_encode_histograms(metrics, histograms);
+    int gauges[METRIC_GAUGE_COUNT];
+    for (int i = 0; i < METRIC_GAUGE_COUNT; i++) {
+        gauges[i] = metrics->gauges[i];
+    }
+    cJSON_AddItemToObject(root, "metrics_counters", create_uint_array(metrics->counters, METRIC_COUNTER_COUNT));
+    cJSON_AddItemToObject(root, "metrics_gauges", cJSON_CreateIntArray(gauges, METRIC_GAUGE_COUNT));
+    cJSON_AddItemToObject(root, "metrics_histograms", create_uint_array(histograms, histograms_length));
+}
+
 void real_garage_server_send_sensor_values(sensor_request_t *sensor_request, sensor_response_t *sensor_response, http_receive_buffer_t *recv_buffer) {
-    ESP_LOGI(TAG, "Send sensor values to server: device_id: %s, sensor_a: %d, sensor_b: %d",
-             sensor_request->device_id,
-             sensor_request->sensor_a,
-             sensor_request->sensor_b);
     // sensorA: 0 (door closed), 1 (door not closed)
     // sensorB: 0 (door open), 1 (door not open)
 
@@ -39,6 +82,16 @@ void real_garage_server_send_sensor_values(sensor_request_t *sensor_request, sen
     cJSON_AddStringToObject(root, "device_id", sensor_request->device_id);
     cJSON_AddNumberToObject(root, "sensor_a", sensor_request->sensor_a);
     cJSON_AddNumberToObject(root, "sensor_b", sensor_request->sensor_b);
+    cJSON_AddNumberToObject(root, "event_age_ms", (double)sensor_request->event_age_ms);
+    if (sensor_request->event_epoch_ms > 0) {
+        cJSON_AddNumberToObject(root, "event_epoch_ms", (double)sensor_request->event_epoch_ms);
+    }
+    if (sensor_request->travel != NULL) {
+        add_travel_report(root, sensor_request->travel);
+    }
+    if (sensor_request->metrics != NULL) {
+        add_metrics(root, sensor_request->metrics);
+    }
 
     char *json_payload = cJSON_Print(root);
     cJSON_Delete(root);
@@ -52,12 +105,19 @@ void real_garage_server_send_sensor_values(sensor_request_t *sensor_request, sen
     char url_with_params[512];
     // This is a legacy URL pattern for an old version of the server.
     // The legacy URL path is /echo (a generic endpoint), which needs to be updated in idf.py menuconfig
-    // URL query parameters: ?buildTimestamp=${device_id}&sensorA=${sensor_a}&sensorB=${sensor_b}
-    snprintf(url_with_params, sizeof(url_with_params),
-             "%s?buildTimestamp=%s&sensorA=%d&sensorB=%d",
-             SENSOR_VALUES_URL, sensor_request->device_id, sensor_request->sensor_a, sensor_request->sensor_b);
+    // URL query parameters: ?buildTimestamp=${device_id}&sensorA=${sensor_a}&sensorB=${sensor_b}&eventAgeMillis=${event_age_ms}
+    //     [&eventTimestampMillis=${event_epoch_ms}]
+    // The server stamps the event with the capture time instead of the arrival time.
+    int url_len = snprintf(url_with_params, sizeof(url_with_params),
+                           "%s?buildTimestamp=%s&sensorA=%d&sensorB=%d&eventAgeMillis=%lld",
+                           SENSOR_VALUES_URL, sensor_request->device_id, sensor_request->sensor_a, sensor_request->sensor_b,
+                           (long long)sensor_request->event_age_ms);
+    if (sensor_request->event_epoch_ms > 0 && url_len > 0 && url_len < (int)sizeof(url_with_params)) {
+        snprintf(url_with_params + url_len, sizeof(url_with_params) - url_len,
+                 "&eventTimestampMillis=%lld", (long long)sensor_request->event_epoch_ms);
+    }
 
-    ESP_LOGI(TAG, "URL with parameters: %s", url_with_params);
+    BLOG3(HTTP_SEND_SENSOR_VALUES, sensor_request->sensor_a, sensor_request->sensor_b, (int32_t)strlen(url_with_params));
     // 3. Send HTTPS POST Request:
     esp_err_t err = https_send_json_post_request(url_with_params, json_payload, strlen(json_payload), recv_buffer);
 
@@ -68,12 +128,10 @@ void real_garage_server_send_sensor_values(sensor_request_t *sensor_request, sen
             if (root == NULL) {
                 ESP_LOGE(TAG, "Failed to parse JSON");
             } else {
-                if (recv_buffer->status_code == 200) {
-                    ESP_LOGI(TAG, "Button token sent successfully (200)");
-                } else {
+                if (recv_buffer->status_code != 200) {
                     ESP_LOGE(TAG, "Button token sent successfully, but server returned status code %d", recv_buffer->status_code);
                 }
-                ESP_LOGI(TAG, "Parsed JSON: %s", cJSON_Print(root));
+                BLOG2(HTTP_RESPONSE_PARSED, recv_buffer->status_code, (int32_t)recv_buffer->data_received_len);
 
                 // Extract sensor values from the "body" object
                 cJSON *body = cJSON_GetObjectItemCaseSensitive(root, "queryParams");
@@ -104,7 +162,7 @@ void real_garage_server_send_sensor_values(sensor_request_t *sensor_request, sen
     }
 
     // 5. Free memory allocated for JSON payload:
-    free(json_payload);
+    cJSON_free(json_payload);
 }
 
 void real_garage_server_send_button_token(button_request_t *button_request, button_response_t *button_response, http_receive_buffer_t *recv_buffer) {
@@ -120,6 +178,16 @@ void real_garage_server_send_button_token(button_request_t *button_request, butt
     cJSON *root = cJSON_CreateObject();
     cJSON_AddStringToObject(root, "device_id", button_request->device_id);
     cJSON_AddStringToObject(root, "button_token", button_request->button_token);
+    if (button_request->local_press_count > 0) {
+        // The server stores the request body, so this records presses made over the LAN
+        cJSON_AddNumberToObject(root, "local_press_count", button_request->local_press_count);
+    }
+    if (button_request->actuation.result != ACTUATION_NONE) {
+        // Whether the door moved after the last press
+        cJSON_AddNumberToObject(root, "actuation_result", button_request->actuation.result);
+        cJSON_AddNumberToObject(root, "actuation_latency_ms", button_request->actuation.latency_ms);
+        cJSON_AddNumberToObject(root, "actuation_attempts", button_request->actuation.attempts);
+    }
 
     char *json_payload = cJSON_Print(root);
     cJSON_Delete(root);
@@ -132,29 +200,33 @@ void real_garage_server_send_button_token(button_request_t *button_request, butt
     // 2. Construct URL with Parameters:
     char url_with_params[2048];
 
-    // URL query parameters: ?buildTimestamp=${device_id}&buttonAckToken=${button_token}
+    // URL query parameters: ?buildTimestamp=${device_id}&buttonAckToken=${button_token}&conditional=true
+    // With conditional=true the server answers 304 with no body when our token is already current.
     snprintf(url_with_params, sizeof(url_with_params),
-             "%s?buildTimestamp=%s&buttonAckToken=%s",
+             "%s?buildTimestamp=%s&buttonAckToken=%s&conditional=true",
              BUTTON_TOKEN_URL, button_request->device_id, button_request->button_token);
 
-    ESP_LOGI(TAG, "URL with parameters: %s", url_with_params);
+    // The URL carries the button token, so only log its length.
+    BLOG1(HTTP_SEND_BUTTON_TOKEN, (int32_t)strlen(url_with_params));
 
     // 3. Send HTTPS POST Request:
     esp_err_t err = https_send_json_post_request(url_with_params, json_payload, strlen(json_payload), recv_buffer);
 
     // 4. Handle Response:
-    if (err == ESP_OK) {
+    if (err == ESP_OK && recv_buffer->status_code == HTTP_STATUS_NOT_MODIFIED) {
+        // Nearly every poll: nothing to parse, the token we sent is still current
+        snprintf(button_response->button_token, MAX_BUTTON_TOKEN_LENGTH + 1, "%s", button_request->button_token);
+        BLOG0(HTTP_BUTTON_TOKEN_NOT_MODIFIED);
+    } else if (err == ESP_OK) {
         if (recv_buffer->data_received_len > 0) {
             cJSON *root = cJSON_ParseWithLength(recv_buffer->buffer, recv_buffer->data_received_len);
             if (root == NULL) {
                 ESP_LOGE(TAG, "Failed to parse JSON");
             } else {
-                if (recv_buffer->status_code == 200) {
-                    ESP_LOGI(TAG, "Button token sent successfully (200)");
-                } else {
+                if (recv_buffer->status_code != 200) {
                     ESP_LOGE(TAG, "Button token sent successfully, but server returned status code %d", recv_buffer->status_code);
                 }
-                ESP_LOGI(TAG, "Parsed JSON: %s", cJSON_Print(root));
+                BLOG2(HTTP_RESPONSE_PARSED, recv_buffer->status_code, (int32_t)recv_buffer->data_received_len);
 
                 // Extract sensor values from the "body" object
                 cJSON *button_ack_token = cJSON_GetObjectItemCaseSensitive(root, "buttonAckToken");
@@ -171,13 +243,18 @@ void real_garage_server_send_button_token(button_request_t *button_request, butt
     }
 
     // 5. Free memory allocated for JSON payload:
-    free(json_payload);
+    cJSON_free(json_payload);
 }
 
 garage_server_t garage_server = {
     .init = real_garage_server_init,
+#ifdef CONFIG_GARAGE_WIRE_CBOR
+    .send_sensor_values = cbor_garage_server_send_sensor_values,
+    .send_button_token = cbor_garage_server_send_button_token,
+#else
     .send_sensor_values = real_garage_server_send_sensor_values,
     .send_button_token = real_garage_server_send_button_token,
+#endif
 };
 
 #endif // CONFIG_USE_FAKE_GARAGE_SERVER
@@ -0,0 +1,243 @@
+#include "garage_config.h"
+#include "garage_http_client_cbor.h"
+#if !defined(CONFIG_USE_FAKE_GARAGE_SERVER) && defined(CONFIG_GARAGE_WIRE_CBOR)
+
+#include "esp_log.h"
+#include <stdio.h>
+#include <string.h>
+
+#include "binary_log.h"
+#include "https_post_request.h"
+#include "wire_cbor.h"
+
+static const char *TAG = "garage_server_cbor";
+
+// Set the server URLs with: idf.py menuconfig
+#define SENSOR_VALUES_URL CONFIG_GARAGE_SERVER_BASE_URL CONFIG_SENSOR_VALUES_ENDPOINT
+#define BUTTON_TOKEN_URL CONFIG_GARAGE_SERVER_BASE_URL CONFIG_BUTTON_TOKEN_ENDPOINT
+#define HTTP_STATUS_OK 200
+#define HTTP_STATUS_NOT_MODIFIED 304
+
+// Fixed fields plus the longest strings each message can carry
+#define TRAVEL_REPORT_SIZE 160 // Three arrays of 16-bit counts, the medians and the flags
+// Up to 5 bytes per metric integer, plus the keys and array heads
+#define METRICS_REPORT_SIZE (5 * (METRIC_COUNTER_COUNT + METRIC_GAUGE_COUNT + METRICS_ENCODED_HISTOGRAMS_MAX) + 16)
+#define SENSOR_REQUEST_SIZE (MAX_DEVICE_ID_LENGTH + 64 + TRAVEL_REPORT_SIZE + METRICS_REPORT_SIZE)
+#define BUTTON_REQUEST_SIZE (MAX_DEVICE_ID_LENGTH + MAX_BUTTON_TOKEN_LENGTH + 64)
+
+static void copy_text(char *destination, size_t max_length, const char *text, size_t length) {
+    if (length > max_length) {
+        length = max_length;
+    }
+    memcpy(destination, text, length);
+    destination[length] = '\0';
+}
+
+/**
+ * Check the status and open the response map. Returns false if there is nothing to read.
+ */
+static bool open_response(http_receive_buffer_t *recv_buffer, cbor_reader_t *reader, size_t *pairs) {
+    if (recv_buffer->status_code != HTTP_STATUS_OK) {
+        ESP_LOGE(TAG, "Server returned status code %d", recv_buffer->status_code);
+        return false;
+    }
+    cbor_reader_init(reader, (const uint8_t *)recv_buffer->buffer, recv_buffer->data_received_len);
+    if (!cbor_read_map(reader, pairs)) {
+        ESP_LOGE(TAG, "Response is not a CBOR map");
+        return false;
+    }
+    return true;
+}
+
+static void write_counts(cbor_writer_t *writer, wire_key_t key, const uint16_t *counts) {
+    cbor_write_uint(writer, key);
+    cbor_write_array(writer, DOOR_TRAVEL_BUCKETS);
+    for (int i = 0; i < DOOR_TRAVEL_BUCKETS; i++) {
+        cbor_write_uint(writer, counts[i]);
+    }
+}
+
+// Five pairs, the same fields as the JSON heartbeat
+static void write_travel_report(cbor_writer_t *writer, const door_travel_report_t *travel) {
+    write_counts(writer, WIRE_KEY_TRAVEL_OPEN, travel->counts[DOOR_TRAVEL_OPEN]);
+    write_counts(writer, WIRE_KEY_TRAVEL_CLOSE, travel->counts[DOOR_TRAVEL_CLOSE]);
+    write_counts(writer, WIRE_KEY_PRESS_DELAY, travel->counts[DOOR_TRAVEL_PRESS_DELAY]);
+    cbor_write_uint(writer, WIRE_KEY_TRAVEL_MEDIAN_MILLIS);
+    cbor_write_array(writer, DOOR_TRAVEL_KIND_COUNT);
+    for (int kind = 0; kind < DOOR_TRAVEL_KIND_COUNT; kind++) {
+        cbor_write_uint(writer, travel->median_ms[kind]);
+    }
+    cbor_write_uint(writer, WIRE_KEY_TRAVEL_DRIFT);
+    cbor_write_uint(writer, travel->drift_flags);
+}
+
+static void write_uint_array(cbor_writer_t *writer, wire_key_t key, const uint32_t *values, size_t count) {
+    cbor_write_uint(writer, key);
+    cbor_write_array(writer, count);
+    for (size_t i = 0; i < count; i++) {
+        cbor_write_uint(writer, values[i]);
+    }
+}
+
+// Three pairs, the same fields as the JSON heartbeat
+static void write_metrics(cbor_writer_t *writer, const metrics_snapshot_t *metrics) {
+    static uint32_t histograms[METRICS_ENCODED_HISTOGRAMS_MAX];
+    size_t histograms_length = metrics_encode_histograms(metrics, histograms);
+    write_uint_array(writer, WIRE_KEY_METRICS_COUNTERS, metrics->counters, METRIC_COUNTER_COUNT);
+    cbor_write_uint(writer, WIRE_KEY_METRICS_GAUGES);
+    cbor_write_array(writer, METRIC_GAUGE_COUNT);
+    for (int i = 0; i < METRIC_GAUGE_COUNT; i++) {
+        cbor_write_int(writer, metrics->gauges[i]);
+    }
+    write_uint_array(writer, WIRE_KEY_METRICS_HISTOGRAMS, histograms, histograms_length);
+}
+
+void cbor_garage_server_send_sensor_values(sensor_request_t *sensor_request, sensor_response_t *sensor_response, http_receive_buffer_t *recv_buffer) {
+    static uint8_t request[SENSOR_REQUEST_SIZE];
+    bool has_epoch = sensor_request->event_epoch_ms > 0;
+    cbor_writer_t writer;
+    cbor_writer_init(&writer, request, sizeof(request));
+    cbor_write_map(&writer, 4 + (has_epoch ? 1 : 0) + (sensor_request->travel != NULL ? 5 : 0) +
+                                (sensor_request->metrics != NULL ? 3 : 0));
+    cbor_write_uint(&writer, WIRE_KEY_BUILD_TIMESTAMP);
+    cbor_write_text(&writer, sensor_request->device_id);
+    cbor_write_uint(&writer, WIRE_KEY_SENSOR_A);
+    cbor_write_int(&writer, sensor_request->sensor_a);
+    cbor_write_uint(&writer, WIRE_KEY_SENSOR_B);
+    cbor_write_int(&writer, sensor_request->sensor_b);
+    cbor_write_uint(&writer, WIRE_KEY_EVENT_AGE_MILLIS);
+    cbor_write_int(&writer, sensor_request->event_age_ms);
+    if (has_epoch) {
+        cbor_write_uint(&writer, WIRE_KEY_EVENT_TIMESTAMP_MILLIS);
+        cbor_write_int(&writer, sensor_request->event_epoch_ms);
+    }
+    if (sensor_request->travel != NULL) {
+        write_travel_report(&writer, sensor_request->travel);
+    }
+    if (sensor_request->metrics != NULL) {
+        write_metrics(&writer, sensor_request->metrics);
+    }
+    if (writer.overflow) {
+        ESP_LOGE(TAG, "Sensor request does not fit in %d bytes", (int)sizeof(request));
+        return;
+    }
+
+    BLOG3(HTTP_SEND_SENSOR_VALUES_CBOR, sensor_request->sensor_a, sensor_request->sensor_b, (int32_t)writer.length);
+    esp_err_t err = https_send_post_request(SENSOR_VALUES_URL, WIRE_CBOR_CONTENT_TYPE, (const char *)request, writer.length, recv_buffer);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to send sensor values");
+        return;
+    }
+
+    cbor_reader_t reader;
+    size_t pairs;
+    if (!open_response(recv_buffer, &reader, &pairs)) {
+        return;
+    }
+    for (size_t i = 0; i < pairs && !reader.error; i++) {
+        uint64_t key;
+        const char *text;
+        size_t length;
+        int64_t value;
+        if (!cbor_read_uint(&reader, &key)) {
+            break;
+        }
+        switch (key) {
+        case WIRE_KEY_BUILD_TIMESTAMP:
+            if (cbor_read_text(&reader, &text, &length)) {
+                copy_text(sensor_response->device_id, MAX_DEVICE_ID_LENGTH, text, length);
+            }
+            break;
+        case WIRE_KEY_SENSOR_A:
+            if (cbor_read_int(&reader, &value)) {
+                sensor_response->sensor_a = (int)value;
+            }
+            break;
+        case WIRE_KEY_SENSOR_B:
+            if (cbor_read_int(&reader, &value)) {
+                sensor_response->sensor_b = (int)value;
+            }
+            break;
+        default:
+            cbor_skip(&reader);
+            break;
+        }
+    }
+    if (reader.error) {
+        ESP_LOGE(TAG, "Failed to decode sensor response");
+        return;
+    }
+    BLOG2(HTTP_RESPONSE_DECODED, recv_buffer->status_code, (int32_t)recv_buffer->data_received_len);
+}
+
+void cbor_garage_server_send_button_token(button_request_t *button_request, button_response_t *button_response, http_receive_buffer_t *recv_buffer) {
+    static uint8_t request[BUTTON_REQUEST_SIZE];
+    bool has_local_presses = button_request->local_press_count > 0;
+    bool has_actuation = button_request->actuation.result != ACTUATION_NONE;
+    cbor_writer_t writer;
+    cbor_writer_init(&writer, request, sizeof(request));
+    cbor_write_map(&writer, 3 + (has_local_presses ? 1 : 0) + (has_actuation ? 3 : 0));
+    cbor_write_uint(&writer, WIRE_KEY_BUILD_TIMESTAMP);
+    cbor_write_text(&writer, button_request->device_id);
+    cbor_write_uint(&writer, WIRE_KEY_BUTTON_ACK_TOKEN);
+    cbor_write_text(&writer, button_request->button_token);
+    // Answer 304 with no body when our token is already current
+    cbor_write_uint(&writer, WIRE_KEY_CONDITIONAL);
+    cbor_write_bool(&writer, true);
+    if (has_local_presses) {
+        cbor_write_uint(&writer, WIRE_KEY_LOCAL_PRESS_COUNT);
+        cbor_write_int(&writer, button_request->local_press_count);
+    }
+    if (has_actuation) {
+        cbor_write_uint(&writer, WIRE_KEY_ACTUATION_RESULT);
+        cbor_write_int(&writer, button_request->actuation.result);
+        cbor_write_uint(&writer, WIRE_KEY_ACTUATION_LATENCY_MILLIS);
+        cbor_write_int(&writer, button_request->actuation.latency_ms);
+        cbor_write_uint(&writer, WIRE_KEY_ACTUATION_ATTEMPTS);
+        cbor_write_int(&writer, button_request->actuation.attempts);
+    }
+    if (writer.overflow) {
+        ESP_LOGE(TAG, "Button request does not fit in %d bytes", (int)sizeof(request));
+        return;
+    }
+
+    BLOG1(HTTP_SEND_BUTTON_TOKEN_CBOR, (int32_t)writer.length);
+    esp_err_t err = https_send_post_request(BUTTON_TOKEN_URL, WIRE_CBOR_CONTENT_TYPE, (const char *)request, writer.length, recv_buffer);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to send button token");
+        return;
+    }
+    if (recv_buffer->status_code == HTTP_STATUS_NOT_MODIFIED) {
+        snprintf(button_response->button_token, MAX_BUTTON_TOKEN_LENGTH + 1, "%s", button_request->button_token);
+        BLOG0(HTTP_BUTTON_TOKEN_NOT_MODIFIED);
+        return;
+    }
+
+    cbor_reader_t reader;
+    size_t pairs;
+    if (!open_response(recv_buffer, &reader, &pairs)) {
+        return;
+    }
+    for (size_t i = 0; i < pairs && !reader.error; i++) {
+        uint64_t key;
+        const char *text;
+        size_t length;
+        if (!cbor_read_uint(&reader, &key)) {
+            break;
+        }
+        if (key == WIRE_KEY_BUTTON_ACK_TOKEN) {
+            if (cbor_read_text(&reader, &text, &length)) {
+                copy_text(button_response->button_token, MAX_BUTTON_TOKEN_LENGTH, text, length);
+            }
+        } else {
+            cbor_skip(&reader);
+        }
+    }
+    if (reader.error) {
+        ESP_LOGE(TAG, "Failed to decode button response");
+        return;
+    }
+    BLOG2(HTTP_RESPONSE_DECODED, recv_buffer->status_code, (int32_t)recv_buffer->data_received_len);
+}
+
+#endif // !CONFIG_USE_FAKE_GARAGE_SERVER && CONFIG_GARAGE_WIRE_CBOR
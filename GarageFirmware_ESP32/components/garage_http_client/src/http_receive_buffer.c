@@ -6,5 +6,6 @@ void reset_http_buffer(http_receive_buffer_t *buffer) {
         memset(buffer->buffer, 0, buffer->buffer_len);
         buffer->data_received_len = 0;
         buffer->status_code = 0;
+        buffer->next_poll_seconds = 0;
     }
 }
@@ -2,14 +2,30 @@
 
 #include "esp_http_client.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 
+#include "binary_log.h"
 #include "http_receive_buffer.h"
 #include "https_post_request.h"
+#include "metrics.h"
 #include "root_ca.h"
 
 static const char *TAG = "http_button_request";
 
+// The server's hint for when to poll the button again
+#define NEXT_POLL_HEADER "X-Next-Poll-Seconds"
+
+// Whether the client has a connection open, tracked from its events
+static bool connection_open = false;
+
+#ifdef CONFIG_GARAGE_HTTP_KEEP_ALIVE
+// One client for every request, so its connection and TLS session outlive each request
+static esp_http_client_handle_t persistent_client = NULL;
+#endif
+
 /**
  * This function is the event handler for the HTTP client.
  * It is called when the HTTP client receives data from the server.
@@ -39,7 +55,9 @@ static esp_err_t _http_event_handler(esp_http_client_event_t *evt) {
         break;
 
     case HTTP_EVENT_ON_CONNECTED:
-        ESP_LOGI(TAG, "HTTP_EVENT_ON_CONNECTED");
+        BLOG0(HTTP_EVENT_CONNECTED);
+        connection_open = true;
+        metrics_count(METRIC_HTTP_CONNECTIONS_OPENED);
         if (recv_buffer->buffer == NULL) {
             ESP_LOGE(TAG, "HTTP_EVENT_ON_CONNECTED: buffer is NULL");
             return ESP_FAIL;
@@ -53,6 +71,9 @@ static esp_err_t _http_event_handler(esp_http_client_event_t *evt) {
         // and other sensitive material. Log at DEBUG so they only appear in
         // builds that raise the log level above INFO. Security audit ref: C2.
         ESP_LOGD(TAG, "HTTP_EVENT_ON_HEADER, key=%s, value=%s", evt->header_key, evt->header_value);
+        if (strcasecmp(evt->header_key, NEXT_POLL_HEADER) == 0) {
+            recv_buffer->next_poll_seconds = atoi(evt->header_value);
+        }
         break;
 
     case HTTP_EVENT_ON_DATA:
@@ -61,6 +82,7 @@ static esp_err_t _http_event_handler(esp_http_client_event_t *evt) {
         // Check for buffer overflow
         if (recv_buffer->data_received_len + evt->data_len > recv_buffer->buffer_len) {
             ESP_LOGE(TAG, "HTTP receive buffer overflow");
+            metrics_count(METRIC_HTTP_RESPONSE_OVERFLOWS);
             return ESP_FAIL;
         }
 
@@ -72,11 +94,12 @@ static esp_err_t _http_event_handler(esp_http_client_event_t *evt) {
         break;
 
     case HTTP_EVENT_ON_FINISH:
-        ESP_LOGI(TAG, "HTTP_EVENT_ON_FINISH received: %d bytes", recv_buffer->data_received_len);
+        BLOG1(HTTP_EVENT_FINISH, (int32_t)recv_buffer->data_received_len);
         break;
 
     case HTTP_EVENT_DISCONNECTED:
-        ESP_LOGI(TAG, "HTTP_EVENT_DISCONNECTED");
+        BLOG0(HTTP_EVENT_DISCONNECTED);
+        connection_open = false;
         break;
 
     default:
@@ -85,37 +108,136 @@ static esp_err_t _http_event_handler(esp_http_client_event_t *evt) {
     return ESP_OK;
 }
 
+static void count_status(int status_code) {
+    switch (status_code / 100) {
+    case 2:
+        metrics_count(METRIC_HTTP_STATUS_2XX);
+        break;
+    case 3:
+        metrics_count(METRIC_HTTP_STATUS_3XX);
+        break;
+    case 4:
+        metrics_count(METRIC_HTTP_STATUS_4XX);
+        break;
+    case 5:
+        metrics_count(METRIC_HTTP_STATUS_5XX);
+        break;
+    default:
+        break;
+    }
+}
+
+static esp_http_client_handle_t create_client(const char *url, http_receive_buffer_t *recv_buffer) {
+    esp_http_client_config_t config = {
+        .url = url,
+        .event_handler = _http_event_handler,
+        .cert_pem = (const char *)server_root_cert_pem_start,
+        .user_data = recv_buffer,
+#if defined(CONFIG_GARAGE_HTTP_KEEP_ALIVE) && defined(CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS)
+        // Resume the TLS session on the next connection instead of a full handshake. Only the
+        // persistent client saves it: a per-request client would take it from the request pool
+        // and keep the pool from ever being reset.
+        .save_client_session = true,
+#endif
+    };
+    return esp_http_client_init(&config);
+}
+
+#ifdef CONFIG_GARAGE_HTTP_KEEP_ALIVE
+
+static esp_http_client_handle_t take_client(const char *url, http_receive_buffer_t *recv_buffer) {
+    if (persistent_client == NULL) {
+        persistent_client = create_client(url, recv_buffer);
+    } else {
+        // A new host closes the connection, the same host keeps it
+        esp_http_client_set_url(persistent_client, url);
+        esp_http_client_set_user_data(persistent_client, recv_buffer);
+    }
+    return persistent_client;
+}
+
+static void release_client(esp_http_client_handle_t client, esp_err_t err) {
+    if (err != ESP_OK) {
+        // Never reuse a connection in an unknown state
+        esp_http_client_close(client);
+    }
+}
+
 /**
- * Send a POST request to the given URL with the given data.
- * The data is sent as JSON.
+ * An idle connection the server or the network dropped fails when the request is written,
+ * or more often when the response headers are read, since the write only fills the socket
+ * buffer. Both are retried once on a new connection. Repeating a request that did reach the
+ * server is harmless: a sensor upload with the same state only checks in, a button poll
+ * echoes the same ack token, and an actuation report replaces the device's one record.
+ */
+static bool is_stale_connection_error(esp_err_t err) {
+    return err == ESP_ERR_HTTP_WRITE_DATA || err == ESP_ERR_HTTP_FETCH_HEADER;
+}
+
+void https_close_connection(void) {
+    if (persistent_client != NULL) {
+        esp_http_client_close(persistent_client);
+    }
+}
+
+#else // CONFIG_GARAGE_HTTP_KEEP_ALIVE
+
+static esp_http_client_handle_t take_client(const char *url, http_receive_buffer_t *recv_buffer) {
+    return create_client(url, recv_buffer);
+}
+
+static void release_client(esp_http_client_handle_t client, esp_err_t err) {
+    esp_http_client_cleanup(client);
+}
+
+static bool is_stale_connection_error(esp_err_t err) {
+    return false;
+}
+
+void https_close_connection(void) {
+}
+
+#endif // CONFIG_GARAGE_HTTP_KEEP_ALIVE
+
+/**
+ * Send a POST request to the given URL with the given data and Content-Type.
  * The response is received in the recv_buffer.
  * The status code is returned in recv_buffer->status_code.
  * The data received is returned in recv_buffer->buffer.
  * The length of the data received is returned in recv_buffer->data_received_len.
  *
+ * With GARAGE_HTTP_KEEP_ALIVE, the request goes through the connection the last one left
+ * open, and one that went stale while idle is retried once on a new connection.
+ *
  * Returns ESP_OK if the request is successful, otherwise returns ESP_FAIL.
  */
-esp_err_t https_send_json_post_request(const char *url, const char *post_data, int post_data_len, http_receive_buffer_t *recv_buffer) {
-    esp_http_client_config_t config = {
-        .url = url,
-        .event_handler = _http_event_handler,
-        .cert_pem = (const char *)server_root_cert_pem_start,
-        .user_data = recv_buffer,
-    };
-    esp_http_client_handle_t client = esp_http_client_init(&config);
+esp_err_t https_send_post_request(const char *url, const char *content_type, const char *post_data, int post_data_len, http_receive_buffer_t *recv_buffer) {
+    // Nothing from the previous request survives a failed connection
+    reset_http_buffer(recv_buffer);
+    esp_http_client_handle_t client = take_client(url, recv_buffer);
+    bool reused = connection_open;
 
     esp_http_client_set_method(client, HTTP_METHOD_POST);
-    esp_http_client_set_header(client, "Content-Type", "application/json");
+    esp_http_client_set_header(client, "Content-Type", content_type);
     esp_http_client_set_post_field(client, post_data, post_data_len);
 
+    metrics_count(METRIC_HTTP_REQUESTS);
+    int64_t started_us = esp_timer_get_time();
     esp_err_t err = esp_http_client_perform(client);
+    if (reused && is_stale_connection_error(err)) {
+        BLOG1(HTTP_STALE_CONNECTION, err);
+        metrics_count(METRIC_HTTP_STALE_CONNECTIONS);
+        esp_http_client_close(client);
+        reset_http_buffer(recv_buffer);
+        err = esp_http_client_perform(client);
+    }
+    metrics_observe(METRIC_HTTP_REQUEST_TIME, (uint32_t)((esp_timer_get_time() - started_us) / 1000));
     if (err == ESP_OK) {
         int status_code = esp_http_client_get_status_code(client);
         recv_buffer->status_code = status_code;
+        count_status(status_code);
         int64_t content_length = esp_http_client_get_content_length(client);
-        ESP_LOGI(TAG, "HTTPS POST Status = %d, content_length = %" PRId64,
-                 status_code,
-                 content_length);
+        BLOG2(HTTP_POST_STATUS, status_code, (int32_t)content_length);
 
         if (content_length != recv_buffer->data_received_len) {
             ESP_LOGW(TAG, "HTTPS POST request received %d bytes, but expected %" PRId64,
@@ -124,8 +246,13 @@ esp_err_t https_send_json_post_request(const char *url, const char *post_data, i
         }
     } else {
         ESP_LOGE(TAG, "HTTPS POST request failed: %s", esp_err_to_name(err));
+        metrics_count(METRIC_HTTP_FAILURES);
     }
 
-    esp_http_client_cleanup(client);
+    release_client(client, err);
     return err;
 }
+
+esp_err_t https_send_json_post_request(const char *url, const char *post_data, int post_data_len, http_receive_buffer_t *recv_buffer) {
+    return https_send_post_request(url, "application/json", post_data, post_data_len, recv_buffer);
+}
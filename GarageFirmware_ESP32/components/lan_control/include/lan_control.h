@@ -0,0 +1,40 @@
+#ifndef LAN_CONTROL_H
+#define LAN_CONTROL_H
+
+#include <stdbool.h>
+
+#include "esp_err.h"
+
+/**
+ * Optional local network API, so the door works when the internet does not.
+ * Enable with GARAGE_LAN_CONTROL in idf.py menuconfig. Advertised over mDNS as
+ * _garage._tcp on <CONFIG_ESP_WIFI_HOSTNAME>.local.
+ *
+ * GET /state
+ *   {"sensorA":0,"sensorB":1,"nonce":"<32 hex chars>"}
+ *   Debounced sensor levels and a fresh nonce for one button request from the same client
+ *   address. A client holds one nonce at a time, and the device up to 4 for 30 seconds.
+ *   "nonce" is null while 4 other clients hold one.
+ *
+ * POST /button
+ *   X-Garage-Nonce: <nonce from GET /state>
+ *   X-Garage-Signature: <hex HMAC-SHA256(CONFIG_GARAGE_LAN_CONTROL_KEY, "button:" + nonce)>
+ *   204 if the button press was requested, 401 if the signature is wrong, 403 if the
+ *   nonce is unknown, expired, already used or was issued to another address. A nonce is only accepted once, so a
+ *   captured request cannot be replayed.
+ */
+typedef struct {
+    // Read the debounced sensor levels
+    void (*get_door_state)(int *sensor_a, int *sensor_b);
+    // Request a button press. Must not block. Returns false if the request was dropped.
+    bool (*request_button_press)(void);
+} lan_control_callbacks_t;
+
+/**
+ * @brief Start the HTTP server and mDNS advertisement. Call after Wi-Fi is connected.
+ *
+ * @return ESP_OK on success, ESP_ERR_NOT_SUPPORTED if GARAGE_LAN_CONTROL is disabled.
+ */
+esp_err_t lan_control_start(const lan_control_callbacks_t *callbacks);
+
+#endif // LAN_CONTROL_H
@@ -0,0 +1,238 @@
+#include "lan_control.h"
+
+#ifdef CONFIG_GARAGE_LAN_CONTROL
+
+#include "esp_http_server.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "lwip/sockets.h"
+#include "mbedtls/md.h"
+#include "mdns.h"
+#include <stdio.h>
+#include <string.h>
+
+// Set the LAN control configuration with: idf.py menuconfig
+#define LAN_CONTROL_PORT CONFIG_GARAGE_LAN_CONTROL_PORT
+#define LAN_CONTROL_KEY CONFIG_GARAGE_LAN_CONTROL_KEY
+#define LAN_CONTROL_HOSTNAME CONFIG_ESP_WIFI_HOSTNAME
+
+#define NONCE_BYTES 16
+#define NONCE_HEX_LENGTH (NONCE_BYTES * 2)
+#define NONCE_SLOTS 4
+#define NONCE_LIFETIME_US (30 * 1000 * 1000) // 30 seconds
+#define SIGNATURE_HEX_LENGTH 64              // SHA-256
+#define CLIENT_ADDRESS_BYTES 16              // IPv6, or IPv4 in the first 4 bytes
+
+static const char *TAG = "lan_control";
+
+// Outstanding nonces, at most one per client address. The HTTP server runs handlers one at
+// a time, so no lock is needed.
+typedef struct {
+    char value[NONCE_HEX_LENGTH + 1];
+    int64_t issued_us;
+    uint8_t client[CLIENT_ADDRESS_BYTES];
+} nonce_slot_t;
+static nonce_slot_t nonces[NONCE_SLOTS];
+
+static lan_control_callbacks_t lan_callbacks;
+static httpd_handle_t server;
+
+static void to_hex(const uint8_t *bytes, size_t len, char *out) {
+    static const char HEX[] = "0123456789abcdef";
+    for (size_t i = 0; i < len; i++) {
+        out[2 * i] = HEX[bytes[i] >> 4];
+        out[2 * i + 1] = HEX[bytes[i] & 0x0f];
+    }
+    out[2 * len] = '\0';
+}
+
+// Address of the peer that sent the request, so a nonce only works for the client it was issued to
+static bool client_address(httpd_req_t *req, uint8_t address[CLIENT_ADDRESS_BYTES]) {
+    struct sockaddr_storage peer;
+    socklen_t peer_length = sizeof(peer);
+    if (getpeername(httpd_req_to_sockfd(req), (struct sockaddr *)&peer, &peer_length) != 0) {
+        return false;
+    }
+    memset(address, 0, CLIENT_ADDRESS_BYTES);
+    if (peer.ss_family == AF_INET) {
+        memcpy(address, &((struct sockaddr_in *)&peer)->sin_addr, 4);
+        return true;
+    }
+#ifdef CONFIG_LWIP_IPV6
+    if (peer.ss_family == AF_INET6) {
+        memcpy(address, &((struct sockaddr_in6 *)&peer)->sin6_addr, CLIENT_ADDRESS_BYTES);
+        return true;
+    }
+#endif
+    return false;
+}
+
+/**
+ * Issue a new nonce to a client. It replaces the client's previous nonce, otherwise it takes
+ * a free or expired slot. Returns NULL while every slot holds a live nonce of another client,
+ * so a flood of GET /state can only replace the flooding client's own nonce.
+ */
+static const char *issue_nonce(const uint8_t client[CLIENT_ADDRESS_BYTES]) {
+    int64_t now_us = esp_timer_get_time();
+    nonce_slot_t *slot = NULL;
+    for (int i = 0; i < NONCE_SLOTS; i++) {
+        nonce_slot_t *candidate = &nonces[i];
+        if (candidate->value[0] != '\0' && memcmp(candidate->client, client, CLIENT_ADDRESS_BYTES) == 0) {
+            slot = candidate;
+            break;
+        }
+        if (slot == NULL && (candidate->value[0] == '\0' || now_us - candidate->issued_us >= NONCE_LIFETIME_US)) {
+            slot = candidate;
+        }
+    }
+    if (slot == NULL) {
+        return NULL;
+    }
+    uint8_t random_bytes[NONCE_BYTES];
+    esp_fill_random(random_bytes, sizeof(random_bytes));
+    to_hex(random_bytes, sizeof(random_bytes), slot->value);
+    slot->issued_us = now_us;
+    memcpy(slot->client, client, CLIENT_ADDRESS_BYTES);
+    return slot->value;
+}
+
+// Accept a nonce once. Returns false if it is unknown, expired, already used or for another client.
+static bool consume_nonce(const char *nonce, const uint8_t client[CLIENT_ADDRESS_BYTES]) {
+    int64_t now_us = esp_timer_get_time();
+    for (int i = 0; i < NONCE_SLOTS; i++) {
+        nonce_slot_t *slot = &nonces[i];
+        if (slot->value[0] == '\0' || strcmp(slot->value, nonce) != 0 ||
+            memcmp(slot->client, client, CLIENT_ADDRESS_BYTES) != 0) {
+            continue;
+        }
+        bool fresh = (now_us - slot->issued_us) < NONCE_LIFETIME_US;
+        slot->value[0] = '\0';
+        return fresh;
+    }
+    return false;
+}
+
+static bool signature_matches(const char *nonce, const char *signature) {
+    char message[sizeof("button:") + NONCE_HEX_LENGTH];
+    snprintf(message, sizeof(message), "button:%s", nonce);
+    uint8_t mac[32];
+    if (mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256),
+                        (const unsigned char *)LAN_CONTROL_KEY, strlen(LAN_CONTROL_KEY),
+                        (const unsigned char *)message, strlen(message),
+                        mac) != 0) {
+        return false;
+    }
+    char expected[SIGNATURE_HEX_LENGTH + 1];
+    to_hex(mac, sizeof(mac), expected);
+    // Constant-time compare
+    uint8_t diff = 0;
+    for (int i = 0; i < SIGNATURE_HEX_LENGTH; i++) {
+        diff |= (uint8_t)(expected[i] ^ signature[i]);
+    }
+    return diff == 0;
+}
+
+static esp_err_t state_get_handler(httpd_req_t *req) {
+    int sensor_a = -1;
+    int sensor_b = -1;
+    lan_callbacks.get_door_state(&sensor_a, &sensor_b);
+    uint8_t client[CLIENT_ADDRESS_BYTES];
+    const char *nonce = client_address(req, client) ? issue_nonce(client) : NULL;
+    char body[96];
+    if (nonce != NULL) {
+        snprintf(body, sizeof(body), "{\"sensorA\":%d,\"sensorB\":%d,\"nonce\":\"%s\"}", sensor_a, sensor_b, nonce);
+    } else {
+        snprintf(body, sizeof(body), "{\"sensorA\":%d,\"sensorB\":%d,\"nonce\":null}", sensor_a, sensor_b);
+    }
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    return httpd_resp_sendstr(req, body);
+}
+
+static esp_err_t button_post_handler(httpd_req_t *req) {
+    char nonce[NONCE_HEX_LENGTH + 1];
+    char signature[SIGNATURE_HEX_LENGTH + 1];
+    if (httpd_req_get_hdr_value_str(req, "X-Garage-Nonce", nonce, sizeof(nonce)) != ESP_OK ||
+        httpd_req_get_hdr_value_str(req, "X-Garage-Signature", signature, sizeof(signature)) != ESP_OK ||
+        strlen(signature) != SIGNATURE_HEX_LENGTH) {
+        httpd_resp_set_status(req, "401 Unauthorized");
+        return httpd_resp_sendstr(req, "Missing nonce or signature");
+    }
+    if (!signature_matches(nonce, signature)) {
+        ESP_LOGW(TAG, "Rejected button request with a bad signature");
+        httpd_resp_set_status(req, "401 Unauthorized");
+        return httpd_resp_sendstr(req, "Bad signature");
+    }
+    uint8_t client[CLIENT_ADDRESS_BYTES];
+    if (!client_address(req, client) || !consume_nonce(nonce, client)) {
+        ESP_LOGW(TAG, "Rejected button request with an unknown, expired or reused nonce");
+        httpd_resp_set_status(req, "403 Forbidden");
+        return httpd_resp_sendstr(req, "Stale nonce");
+    }
+    if (!lan_callbacks.request_button_press()) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        return httpd_resp_sendstr(req, "Busy");
+    }
+    ESP_LOGI(TAG, "Local button press accepted");
+    httpd_resp_set_status(req, "204 No Content");
+    return httpd_resp_send(req, NULL, 0);
+}
+
+static esp_err_t start_mdns(void) {
+    esp_err_t err = mdns_init();
+    if (err != ESP_OK) {
+        return err;
+    }
+    mdns_hostname_set(LAN_CONTROL_HOSTNAME);
+    mdns_instance_name_set("Smart Garage Door");
+    return mdns_service_add(NULL, "_garage", "_tcp", LAN_CONTROL_PORT, NULL, 0);
+}
+
+esp_err_t lan_control_start(const lan_control_callbacks_t *callbacks) {
+    if (callbacks == NULL || callbacks->get_door_state == NULL || callbacks->request_button_press == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (strlen(LAN_CONTROL_KEY) == 0) {
+        ESP_LOGE(TAG, "GARAGE_LAN_CONTROL_KEY is empty, not starting the LAN API");
+        return ESP_ERR_INVALID_STATE;
+    }
+    lan_callbacks = *callbacks;
+
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = LAN_CONTROL_PORT;
+    config.max_open_sockets = 3;
+    esp_err_t err = httpd_start(&server, &config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start HTTP server: %s", esp_err_to_name(err));
+        return err;
+    }
+    const httpd_uri_t state_uri = {
+        .uri = "/state",
+        .method = HTTP_GET,
+        .handler = state_get_handler,
+    };
+    const httpd_uri_t button_uri = {
+        .uri = "/button",
+        .method = HTTP_POST,
+        .handler = button_post_handler,
+    };
+    httpd_register_uri_handler(server, &state_uri);
+    httpd_register_uri_handler(server, &button_uri);
+
+    err = start_mdns();
+    if (err != ESP_OK) {
+        // The API still works by IP address
+        ESP_LOGW(TAG, "Failed to advertise over mDNS: %s", esp_err_to_name(err));
+    }
+    ESP_LOGI(TAG, "LAN API on %s.local:%d", LAN_CONTROL_HOSTNAME, LAN_CONTROL_PORT);
+    return ESP_OK;
+}
+
+#else // CONFIG_GARAGE_LAN_CONTROL
+
+esp_err_t lan_control_start(const lan_control_callbacks_t *callbacks) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif // CONFIG_GARAGE_LAN_CONTROL
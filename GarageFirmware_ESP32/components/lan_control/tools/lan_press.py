@@ -0,0 +1,37 @@
+#!/usr/bin/env python3
+"""Push the garage button through the LAN control API.
+
+Usage: lan_press.py <host> <key> [--state-only]
+"""
+import hashlib
+import hmac
+import json
+import sys
+import urllib.request
+
+
+def main():
+    if len(sys.argv) < 3:
+        print(__doc__)
+        sys.exit(1)
+    host, key = sys.argv[1], sys.argv[2]
+    with urllib.request.urlopen(f"http://{host}/state", timeout=5) as response:
+        state = json.load(response)
+    print(f"sensorA: {state['sensorA']}, sensorB: {state['sensorB']}")
+    if "--state-only" in sys.argv:
+        return
+    nonce = state["nonce"]
+    if nonce is None:
+        sys.exit("No nonce available, other clients hold them all. Try again in 30 seconds.")
+    signature = hmac.new(key.encode(), f"button:{nonce}".encode(), hashlib.sha256).hexdigest()
+    request = urllib.request.Request(
+        f"http://{host}/button",
+        method="POST",
+        headers={"X-Garage-Nonce": nonce, "X-Garage-Signature": signature},
+    )
+    with urllib.request.urlopen(request, timeout=5) as response:
+        print(f"Button: HTTP {response.status}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,106 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Counters, gauges and histograms for the numbers that tune the fleet.
+ *
+ * Every update is one relaxed 32-bit atomic operation on a static slot, so any task or ISR
+ * can update any metric without a lock. A snapshot reads each value atomically, but not all
+ * of them at one instant. Metrics are declared in metrics.def. Heartbeats carry a snapshot,
+ * and metrics_dump() prints one on the serial console.
+ *
+ * Histograms have 4 linear buckets per power of two: exact below 4, then within 25% up to
+ * 65535 of their unit, and one bucket above that.
+ */
+
+#define METRICS_HISTOGRAM_BUCKETS 61
+
+#define METRIC_COUNTER(name) METRIC_##name,
+#define METRIC_GAUGE(name)
+#define METRIC_HISTOGRAM(name, unit)
+typedef enum {
+#include "metrics.def"
+    METRIC_COUNTER_COUNT,
+} metric_counter_t;
+#undef METRIC_COUNTER
+#undef METRIC_GAUGE
+#undef METRIC_HISTOGRAM
+
+#define METRIC_COUNTER(name)
+#define METRIC_GAUGE(name) METRIC_##name,
+#define METRIC_HISTOGRAM(name, unit)
+typedef enum {
+#include "metrics.def"
+    METRIC_GAUGE_COUNT,
+} metric_gauge_t;
+#undef METRIC_COUNTER
+#undef METRIC_GAUGE
+#undef METRIC_HISTOGRAM
+
+#define METRIC_COUNTER(name)
+#define METRIC_GAUGE(name)
+#define METRIC_HISTOGRAM(name, unit) METRIC_##name,
+typedef enum {
+#include "metrics.def"
+    METRIC_HISTOGRAM_COUNT,
+} metric_histogram_t;
+#undef METRIC_COUNTER
+#undef METRIC_GAUGE
+#undef METRIC_HISTOGRAM
+
+typedef struct {
+    uint32_t count;
+    uint32_t sum; // Wraps, like a counter
+    uint32_t buckets[METRICS_HISTOGRAM_BUCKETS];
+} metrics_histogram_snapshot_t;
+
+typedef struct {
+    uint32_t counters[METRIC_COUNTER_COUNT];
+    int32_t gauges[METRIC_GAUGE_COUNT];
+    metrics_histogram_snapshot_t histograms[METRIC_HISTOGRAM_COUNT];
+} metrics_snapshot_t;
+
+// The most integers metrics_encode_histograms() writes
+#define METRICS_ENCODED_HISTOGRAMS_MAX (METRIC_HISTOGRAM_COUNT * (3 + 2 * METRICS_HISTOGRAM_BUCKETS))
+
+void metrics_add(metric_counter_t counter, uint32_t amount);
+void metrics_set(metric_gauge_t gauge, int32_t value);
+void metrics_observe(metric_histogram_t histogram, uint32_t value);
+
+#define metrics_count(counter) metrics_add((counter), 1)
+
+/**
+ * @brief Smallest value that lands in a histogram bucket.
+ */
+uint32_t metrics_bucket_lower_bound(unsigned bucket);
+
+void metrics_snapshot(metrics_snapshot_t *snapshot);
+
+/**
+ * @brief Flatten the histograms for the heartbeat.
+ *
+ * Per histogram: its count, its sum and the number of buckets in use, then a bucket index
+ * and count for each of them. Empty buckets cost nothing, so a quiet histogram is 3 integers.
+ *
+ * @return The number of integers written to out, at most METRICS_ENCODED_HISTOGRAMS_MAX.
+ */
+size_t metrics_encode_histograms(const metrics_snapshot_t *snapshot, uint32_t *out);
+
+/**
+ * @brief Print every metric on the console, one per line, with the median and 99th percentile
+ *        of each histogram.
+ */
+void metrics_dump(const metrics_snapshot_t *snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // METRICS_H
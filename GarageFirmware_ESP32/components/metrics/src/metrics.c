@@ -0,0 +1,164 @@
+#include "metrics.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+
+#define LINEAR_BUCKETS 4      // Values below this get a bucket each
+#define BUCKETS_PER_OCTAVE 4  // Sub-buckets per power of two above that
+#define MAX_OCTAVE 16         // Values from 2^16 share the last bucket
+
+typedef struct {
+    atomic_uint_least32_t count;
+    atomic_uint_least32_t sum;
+    atomic_uint_least32_t buckets[METRICS_HISTOGRAM_BUCKETS];
+} histogram_t;
+
+static atomic_uint_least32_t counters[METRIC_COUNTER_COUNT];
+static atomic_int_least32_t gauges[METRIC_GAUGE_COUNT];
+static histogram_t histograms[METRIC_HISTOGRAM_COUNT];
+
+#define METRIC_COUNTER(name) #name,
+#define METRIC_GAUGE(name)
+#define METRIC_HISTOGRAM(name, unit)
+static const char *const COUNTER_NAMES[] = {
+#include "metrics.def"
+};
+#undef METRIC_COUNTER
+#undef METRIC_GAUGE
+#undef METRIC_HISTOGRAM
+
+#define METRIC_COUNTER(name)
+#define METRIC_GAUGE(name) #name,
+#define METRIC_HISTOGRAM(name, unit)
+static const char *const GAUGE_NAMES[] = {
+#include "metrics.def"
+};
+#undef METRIC_COUNTER
+#undef METRIC_GAUGE
+#undef METRIC_HISTOGRAM
+
+#define METRIC_COUNTER(name)
+#define METRIC_GAUGE(name)
+#define METRIC_HISTOGRAM(name, unit) {#name, unit},
+static const struct {
+    const char *name;
+    const char *unit;
+} HISTOGRAM_INFO[] = {
+#include "metrics.def"
+};
+#undef METRIC_COUNTER
+#undef METRIC_GAUGE
+#undef METRIC_HISTOGRAM
+
+static unsigned bucket_of(uint32_t value) {
+    if (value < LINEAR_BUCKETS) {
+        return value;
+    }
+    unsigned octave = 31 - __builtin_clz(value); // 2 for 4..7
+    if (octave >= MAX_OCTAVE) {
+        return METRICS_HISTOGRAM_BUCKETS - 1;
+    }
+    unsigned sub_bucket = (value >> (octave - 2)) & (BUCKETS_PER_OCTAVE - 1);
+    return (octave - 1) * BUCKETS_PER_OCTAVE + sub_bucket;
+}
+
+uint32_t metrics_bucket_lower_bound(unsigned bucket) {
+    if (bucket < LINEAR_BUCKETS) {
+        return bucket;
+    }
+    unsigned octave = bucket / BUCKETS_PER_OCTAVE + 1;
+    unsigned sub_bucket = bucket % BUCKETS_PER_OCTAVE;
+    return (uint32_t)(BUCKETS_PER_OCTAVE + sub_bucket) << (octave - 2);
+}
+
+void metrics_add(metric_counter_t counter, uint32_t amount) {
+    atomic_fetch_add_explicit(&counters[counter], amount, memory_order_relaxed);
+}
+
+void metrics_set(metric_gauge_t gauge, int32_t value) {
+    atomic_store_explicit(&gauges[gauge], value, memory_order_relaxed);
+}
+
+void metrics_observe(metric_histogram_t histogram, uint32_t value) {
+    histogram_t *h = &histograms[histogram];
+    atomic_fetch_add_explicit(&h->buckets[bucket_of(value)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum, value, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->count, 1, memory_order_relaxed);
+}
+
+void metrics_snapshot(metrics_snapshot_t *snapshot) {
+    for (int i = 0; i < METRIC_COUNTER_COUNT; i++) {
+        snapshot->counters[i] = atomic_load_explicit(&counters[i], memory_order_relaxed);
+    }
+    for (int i = 0; i < METRIC_GAUGE_COUNT; i++) {
+        snapshot->gauges[i] = atomic_load_explicit(&gauges[i], memory_order_relaxed);
+    }
+    for (int i = 0; i < METRIC_HISTOGRAM_COUNT; i++) {
+        histogram_t *h = &histograms[i];
+        metrics_histogram_snapshot_t *out = &snapshot->histograms[i];
+        out->count = atomic_load_explicit(&h->count, memory_order_relaxed);
+        out->sum = atomic_load_explicit(&h->sum, memory_order_relaxed);
+        for (int bucket = 0; bucket < METRICS_HISTOGRAM_BUCKETS; bucket++) {
+            out->buckets[bucket] = atomic_load_explicit(&h->buckets[bucket], memory_order_relaxed);
+        }
+    }
+}
+
+size_t metrics_encode_histograms(const metrics_snapshot_t *snapshot, uint32_t *out) {
+    size_t n = 0;
+    for (int i = 0; i < METRIC_HISTOGRAM_COUNT; i++) {
+        const metrics_histogram_snapshot_t *h = &snapshot->histograms[i];
+        out[n++] = h->count;
+        out[n++] = h->sum;
+        size_t used_at = n++;
+        uint32_t used = 0;
+        for (unsigned bucket = 0; bucket < METRICS_HISTOGRAM_BUCKETS; bucket++) {
+            if (h->buckets[bucket] != 0) {
+                out[n++] = bucket;
+                out[n++] = h->buckets[bucket];
+                used++;
+            }
+        }
+        out[used_at] = used;
+    }
+    return n;
+}
+
+/**
+ * Lower bound of the bucket holding the value at percent. Buckets are read one by one while
+ * other tasks update them, so the total is summed here instead of taken from count.
+ */
+static uint32_t percentile(const metrics_histogram_snapshot_t *h, uint32_t percent) {
+    uint64_t total = 0;
+    for (int bucket = 0; bucket < METRICS_HISTOGRAM_BUCKETS; bucket++) {
+        total += h->buckets[bucket];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = (total * percent + 99) / 100;
+    uint64_t below = 0;
+    for (unsigned bucket = 0; bucket < METRICS_HISTOGRAM_BUCKETS; bucket++) {
+        below += h->buckets[bucket];
+        if (below >= rank) {
+            return metrics_bucket_lower_bound(bucket);
+        }
+    }
+    return 0;
+}
+
+void metrics_dump(const metrics_snapshot_t *snapshot) {
+    for (int i = 0; i < METRIC_COUNTER_COUNT; i++) {
+        printf("METRIC %s %lu\n", COUNTER_NAMES[i], (unsigned long)snapshot->counters[i]);
+    }
+    for (int i = 0; i < METRIC_GAUGE_COUNT; i++) {
+        printf("METRIC %s %ld\n", GAUGE_NAMES[i], (long)snapshot->gauges[i]);
+    }
+    for (int i = 0; i < METRIC_HISTOGRAM_COUNT; i++) {
+        const metrics_histogram_snapshot_t *h = &snapshot->histograms[i];
+        printf("METRIC %s count=%lu sum=%lu%s p50=%lu%s p99=%lu%s\n", HISTOGRAM_INFO[i].name,
+               (unsigned long)h->count, (unsigned long)h->sum, HISTOGRAM_INFO[i].unit,
+               (unsigned long)percentile(h, 50), HISTOGRAM_INFO[i].unit,
+               (unsigned long)percentile(h, 99), HISTOGRAM_INFO[i].unit);
+    }
+}
@@ -0,0 +1,133 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/metrics.c"
+
+static void test_linear_buckets(void) {
+    for (uint32_t value = 0; value < LINEAR_BUCKETS; value++) {
+        assert(bucket_of(value) == value);
+        assert(metrics_bucket_lower_bound(value) == value);
+    }
+}
+
+static void test_bucket_edges(void) {
+    assert(bucket_of(4) == 4);
+    assert(bucket_of(7) == 7);
+    assert(bucket_of(8) == 8);
+    assert(bucket_of(9) == 8);
+    assert(bucket_of(10) == 9);
+    assert(bucket_of(65535) == METRICS_HISTOGRAM_BUCKETS - 2);
+    assert(bucket_of(65536) == METRICS_HISTOGRAM_BUCKETS - 1);
+    assert(bucket_of(UINT32_MAX) == METRICS_HISTOGRAM_BUCKETS - 1);
+    assert(metrics_bucket_lower_bound(METRICS_HISTOGRAM_BUCKETS - 1) == 65536);
+}
+
+// Every bucket starts where the one before it ends, so each lower bound maps back to its bucket
+static void test_lower_bounds_round_trip(void) {
+    for (unsigned bucket = 1; bucket < METRICS_HISTOGRAM_BUCKETS; bucket++) {
+        uint32_t lower = metrics_bucket_lower_bound(bucket);
+        assert(lower > metrics_bucket_lower_bound(bucket - 1));
+        assert(bucket_of(lower) == bucket);
+        assert(bucket_of(lower - 1) == bucket - 1);
+    }
+}
+
+// Buckets below 2^16 are within 25% of their values
+static void test_bucket_width(void) {
+    for (unsigned bucket = LINEAR_BUCKETS; bucket < METRICS_HISTOGRAM_BUCKETS - 1; bucket++) {
+        uint32_t lower = metrics_bucket_lower_bound(bucket);
+        uint32_t width = metrics_bucket_lower_bound(bucket + 1) - lower;
+        assert(width * 4 <= lower);
+    }
+}
+
+static void test_counters_and_gauges(void) {
+    metrics_snapshot_t before, after;
+    metrics_snapshot(&before);
+    metrics_count(METRIC_HTTP_REQUESTS);
+    metrics_count(METRIC_HTTP_REQUESTS);
+    metrics_add(METRIC_HTTP_FAILURES, 5);
+    metrics_set(METRIC_MIN_FREE_HEAP, -7);
+    metrics_snapshot(&after);
+    assert(after.counters[METRIC_HTTP_REQUESTS] - before.counters[METRIC_HTTP_REQUESTS] == 2);
+    assert(after.counters[METRIC_HTTP_FAILURES] - before.counters[METRIC_HTTP_FAILURES] == 5);
+    assert(after.counters[METRIC_HTTP_STATUS_2XX] == before.counters[METRIC_HTTP_STATUS_2XX]);
+    assert(after.gauges[METRIC_MIN_FREE_HEAP] == -7);
+}
+
+static void test_counter_wraps(void) {
+    metrics_snapshot_t snapshot;
+    metrics_add(METRIC_DEBOUNCE_REJECTIONS, UINT32_MAX);
+    metrics_add(METRIC_DEBOUNCE_REJECTIONS, 2);
+    metrics_snapshot(&snapshot);
+    assert(snapshot.counters[METRIC_DEBOUNCE_REJECTIONS] == 1);
+}
+
+static void test_histogram(void) {
+    metrics_observe(METRIC_HTTP_REQUEST_TIME, 0);
+    metrics_observe(METRIC_HTTP_REQUEST_TIME, 300);
+    metrics_observe(METRIC_HTTP_REQUEST_TIME, 310);
+    metrics_observe(METRIC_HTTP_REQUEST_TIME, 100000);
+    metrics_snapshot_t snapshot;
+    metrics_snapshot(&snapshot);
+    const metrics_histogram_snapshot_t *h = &snapshot.histograms[METRIC_HTTP_REQUEST_TIME];
+    assert(h->count == 4);
+    assert(h->sum == 100610);
+    assert(h->buckets[0] == 1);
+    assert(h->buckets[bucket_of(300)] == 2);
+    assert(h->buckets[METRICS_HISTOGRAM_BUCKETS - 1] == 1);
+    assert(percentile(h, 50) == metrics_bucket_lower_bound(bucket_of(300)));
+    assert(percentile(h, 99) == 65536);
+    assert(snapshot.histograms[METRIC_SENSOR_UPLOAD_DELAY].count == 0);
+    assert(percentile(&snapshot.histograms[METRIC_SENSOR_UPLOAD_DELAY], 50) == 0);
+
+    uint32_t encoded[METRICS_ENCODED_HISTOGRAMS_MAX];
+    size_t n = metrics_encode_histograms(&snapshot, encoded);
+    // SENSOR_UPLOAD_DELAY is empty, HTTP_REQUEST_TIME uses three buckets
+    assert(n == 3 * METRIC_HISTOGRAM_COUNT + 2 * 3);
+    const uint32_t *request_time = encoded + 3 * METRIC_HTTP_REQUEST_TIME;
+    assert(request_time[0] == 4 && request_time[1] == 100610 && request_time[2] == 3);
+    assert(request_time[3] == 0 && request_time[4] == 1);
+    assert(request_time[5] == bucket_of(300) && request_time[6] == 2);
+    assert(request_time[7] == METRICS_HISTOGRAM_BUCKETS - 1 && request_time[8] == 1);
+}
+
+// Each entry of metrics.def gets an enum value and a name at the same position
+#define METRIC_COUNTER(id) assert(strcmp(COUNTER_NAMES[METRIC_##id], #id) == 0); counters_seen++;
+#define METRIC_GAUGE(id) assert(strcmp(GAUGE_NAMES[METRIC_##id], #id) == 0); gauges_seen++;
+#define METRIC_HISTOGRAM(id, id_unit)                                                                      \
+    assert(strcmp(HISTOGRAM_INFO[METRIC_##id].name, #id) == 0);                                            \
+    assert(strcmp(HISTOGRAM_INFO[METRIC_##id].unit, id_unit) == 0);                                        \
+    histograms_seen++;
+static void test_registration(void) {
+    int counters_seen = 0, gauges_seen = 0, histograms_seen = 0;
+#include "metrics.def"
+    assert(counters_seen == METRIC_COUNTER_COUNT);
+    assert(gauges_seen == METRIC_GAUGE_COUNT);
+    assert(histograms_seen == METRIC_HISTOGRAM_COUNT);
+    assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) == METRIC_COUNTER_COUNT);
+    assert(sizeof(GAUGE_NAMES) / sizeof(GAUGE_NAMES[0]) == METRIC_GAUGE_COUNT);
+    assert(sizeof(HISTOGRAM_INFO) / sizeof(HISTOGRAM_INFO[0]) == METRIC_HISTOGRAM_COUNT);
+    // Position among its kind is the heartbeat index, so these must never move
+    assert(METRIC_SENSOR_EVENTS_DROPPED == 0);
+    assert(METRIC_NETWORK_QUEUE_WAITING == 0);
+    assert(METRIC_SENSOR_UPLOAD_DELAY == 0);
+    assert(METRIC_HTTP_REQUEST_TIME == 1);
+}
+#undef METRIC_COUNTER
+#undef METRIC_GAUGE
+#undef METRIC_HISTOGRAM
+
+int main(void) {
+    test_linear_buckets();
+    test_bucket_edges();
+    test_lower_bounds_round_trip();
+    test_bucket_width();
+    test_counters_and_gauges();
+    test_counter_wraps();
+    test_histogram();
+    test_registration();
+    printf("metrics tests passed\n");
+    return 0;
+}
@@ -0,0 +1,54 @@
+#ifndef REQUEST_POOL_H
+#define REQUEST_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/**
+ * A static, size-classed pool for the short-lived allocations of one HTTPS request.
+ *
+ * Every request allocates and frees the same burst of mbedTLS record buffers, handshake
+ * state and cJSON nodes. From the heap, weeks of that fragments memory and the largest free
+ * block shrinks. Between request_pool_begin() and request_pool_end(), mbedTLS and cJSON
+ * allocations made by the calling task come from the pool instead. A freed block goes back
+ * to the free list of its size class, and the pool is reset once the request ends with
+ * nothing left allocated, so every request starts from the same empty pool.
+ *
+ * Other tasks, allocations outside a request and anything the pool cannot hold keep using
+ * the heap, so running out of pool costs fragmentation, never a failed request.
+ */
+
+typedef struct {
+    size_t capacity;                // Bytes in the pool
+    size_t high_water;              // Most bytes carved from the pool by one request, since boot
+    size_t request_peak;            // Most bytes allocated at once during the last request
+    uint32_t fallbacks;             // Allocations in the last request that went to the heap
+    uint32_t leaked_blocks;         // Blocks still allocated when the last request ended
+    size_t largest_free_heap_block; // Measured when the last request ended
+} request_pool_stats_t;
+
+/**
+ * @brief Route mbedTLS and cJSON allocations through the pool. Call once, before the first request.
+ *
+ * @return ESP_ERR_NOT_SUPPORTED if GARAGE_REQUEST_POOL is disabled in idf.py menuconfig.
+ */
+esp_err_t request_pool_init(void);
+
+/**
+ * @brief Serve allocations from the calling task out of the pool until request_pool_end().
+ */
+void request_pool_begin(void);
+
+/**
+ * @brief Stop using the pool, reset it if everything was freed, and log its usage.
+ */
+void request_pool_end(void);
+
+/**
+ * @brief Usage as of the last request_pool_end(). All zeros when the pool is disabled.
+ */
+void request_pool_get_stats(request_pool_stats_t *stats);
+
+#endif // REQUEST_POOL_H
@@ -0,0 +1,224 @@
+#include "request_pool.h"
+
+#include <string.h>
+
+#ifdef CONFIG_GARAGE_REQUEST_POOL
+
+#include "cJSON.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "mbedtls/platform.h"
+#include <inttypes.h>
+#include <stdlib.h>
+
+#include "binary_log.h"
+
+// Set the pool size with: idf.py menuconfig
+#define POOL_SIZE CONFIG_GARAGE_REQUEST_POOL_SIZE
+
+static const char *TAG = "request_pool";
+
+// Payload sizes. The two largest fit the mbedTLS output and input record buffers
+// (4 KB and 16 KB of content plus record overhead) without rounding up to a power of two.
+static const uint32_t SIZE_CLASSES[] = {16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 5120, 8192, 17408};
+#define SIZE_CLASS_COUNT (sizeof(SIZE_CLASSES) / sizeof(SIZE_CLASSES[0]))
+
+// Precedes every block. 8 bytes keeps payloads 8-byte aligned, as malloc does.
+typedef struct {
+    uint32_t size_class;
+    uint32_t reserved;
+} block_header_t;
+
+// A free block keeps its header and stores the link in its payload
+typedef struct free_block {
+    struct free_block *next;
+} free_block_t;
+
+static uint8_t pool[POOL_SIZE] __attribute__((aligned(8)));
+
+// Allocations can come from any task and free can come from any task, so the pool state
+// takes the lock. Each operation is a few pointer moves.
+static portMUX_TYPE pool_lock = portMUX_INITIALIZER_UNLOCKED;
+static size_t carved;              // Bytes handed out from the front of the pool, headers included
+static free_block_t *free_lists[SIZE_CLASS_COUNT];
+static uint32_t live_blocks;
+static size_t live_bytes;
+static size_t request_peak;
+static uint32_t request_fallbacks;
+static request_pool_stats_t last_stats;
+
+// Written only by the task that owns the request, so other tasks never see themselves as owner
+static TaskHandle_t owner;
+
+static bool in_request(void) {
+    return owner != NULL && xTaskGetCurrentTaskHandle() == owner;
+}
+
+static int size_class_for(size_t size) {
+    for (size_t i = 0; i < SIZE_CLASS_COUNT; i++) {
+        if (size <= SIZE_CLASSES[i]) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Take a block from the free list of its class, or carve a new one. NULL if it does not fit.
+ */
+static void *pool_alloc(size_t size) {
+    int size_class = size_class_for(size);
+    if (size_class < 0) {
+        portENTER_CRITICAL(&pool_lock);
+        request_fallbacks++;
+        portEXIT_CRITICAL(&pool_lock);
+        return NULL;
+    }
+    size_t block_size = sizeof(block_header_t) + SIZE_CLASSES[size_class];
+    void *payload = NULL;
+    portENTER_CRITICAL(&pool_lock);
+    if (free_lists[size_class] != NULL) {
+        payload = free_lists[size_class];
+        free_lists[size_class] = free_lists[size_class]->next;
+    } else if (POOL_SIZE - carved >= block_size) {
+        block_header_t *header = (block_header_t *)&pool[carved];
+        header->size_class = size_class;
+        payload = header + 1;
+        carved += block_size;
+    }
+    if (payload != NULL) {
+        live_blocks++;
+        live_bytes += block_size;
+        if (live_bytes > request_peak) {
+            request_peak = live_bytes;
+        }
+    } else {
+        request_fallbacks++;
+    }
+    portEXIT_CRITICAL(&pool_lock);
+    return payload;
+}
+
+/**
+ * Return a block to its free list. False if the pointer did not come from the pool.
+ */
+static bool pool_free(void *ptr) {
+    uint8_t *bytes = ptr;
+    if (bytes < pool || bytes >= pool + POOL_SIZE) {
+        return false;
+    }
+    block_header_t *header = (block_header_t *)ptr - 1;
+    free_block_t *block = ptr;
+    portENTER_CRITICAL(&pool_lock);
+    block->next = free_lists[header->size_class];
+    free_lists[header->size_class] = block;
+    live_blocks--;
+    live_bytes -= sizeof(block_header_t) + SIZE_CLASSES[header->size_class];
+    portEXIT_CRITICAL(&pool_lock);
+    return true;
+}
+
+static void *pool_calloc(size_t n, size_t size) {
+    if (size != 0 && n > SIZE_MAX / size) {
+        return NULL;
+    }
+    void *ptr = in_request() ? pool_alloc(n * size) : NULL;
+    if (ptr != NULL) {
+        memset(ptr, 0, n * size);
+        return ptr;
+    }
+    // The allocator mbedTLS uses by default
+    return heap_caps_calloc(n, size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+}
+
+static void *pool_malloc(size_t size) {
+    void *ptr = in_request() ? pool_alloc(size) : NULL;
+    return ptr != NULL ? ptr : malloc(size);
+}
+
+static void pool_release(void *ptr) {
+    if (ptr != NULL && !pool_free(ptr)) {
+        free(ptr);
+    }
+}
+
+esp_err_t request_pool_init(void) {
+    if (mbedtls_platform_set_calloc_free(pool_calloc, pool_release) != 0) {
+        ESP_LOGE(TAG, "Failed to set the mbedTLS allocator");
+        return ESP_FAIL;
+    }
+    cJSON_Hooks hooks = {
+        .malloc_fn = pool_malloc,
+        .free_fn = pool_release,
+    };
+    cJSON_InitHooks(&hooks);
+    last_stats.capacity = POOL_SIZE;
+    ESP_LOGI(TAG, "Serving request allocations from a %d byte pool", POOL_SIZE);
+    return ESP_OK;
+}
+
+void request_pool_begin(void) {
+    portENTER_CRITICAL(&pool_lock);
+    request_peak = live_bytes;
+    request_fallbacks = 0;
+    portEXIT_CRITICAL(&pool_lock);
+    owner = xTaskGetCurrentTaskHandle();
+}
+
+void request_pool_end(void) {
+    owner = NULL;
+    request_pool_stats_t stats = {
+        .capacity = POOL_SIZE,
+        .high_water = last_stats.high_water,
+    };
+    portENTER_CRITICAL(&pool_lock);
+    if (carved > stats.high_water) {
+        stats.high_water = carved;
+    }
+    stats.request_peak = request_peak;
+    stats.fallbacks = request_fallbacks;
+    stats.leaked_blocks = live_blocks;
+    // Start the next request from an empty pool. A block that outlived its request is
+    // never reclaimed, so the pool keeps its layout until that block is freed.
+    if (live_blocks == 0) {
+        carved = 0;
+        memset(free_lists, 0, sizeof(free_lists));
+    }
+    portEXIT_CRITICAL(&pool_lock);
+    stats.largest_free_heap_block = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    portENTER_CRITICAL(&pool_lock);
+    last_stats = stats;
+    portEXIT_CRITICAL(&pool_lock);
+
+    BLOG4(REQUEST_POOL_USAGE, (int32_t)stats.request_peak, (int32_t)stats.high_water, (int32_t)stats.fallbacks,
+          (int32_t)stats.largest_free_heap_block);
+    if (stats.leaked_blocks > 0) {
+        ESP_LOGW(TAG, "%" PRIu32 " blocks outlived the request, the pool is not reset", stats.leaked_blocks);
+    }
+}
+
+void request_pool_get_stats(request_pool_stats_t *stats) {
+    portENTER_CRITICAL(&pool_lock);
+    *stats = last_stats;
+    portEXIT_CRITICAL(&pool_lock);
+}
+
+#else // CONFIG_GARAGE_REQUEST_POOL
+
+esp_err_t request_pool_init(void) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void request_pool_begin(void) {
+}
+
+void request_pool_end(void) {
+}
+
+void request_pool_get_stats(request_pool_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif // CONFIG_GARAGE_REQUEST_POOL
@@ -0,0 +1,13 @@
+#ifndef REQUEST_POOL_TEST_CJSON_H
+#define REQUEST_POOL_TEST_CJSON_H
+
+#include <stddef.h>
+
+typedef struct cJSON_Hooks {
+    void *(*malloc_fn)(size_t sz);
+    void (*free_fn)(void *ptr);
+} cJSON_Hooks;
+
+void cJSON_InitHooks(cJSON_Hooks *hooks);
+
+#endif // REQUEST_POOL_TEST_CJSON_H
@@ -0,0 +1,12 @@
+// Host stand-ins for the ESP-IDF, mbedTLS and cJSON pieces request_pool.c uses.
+// request_pool_test.c defines the functions.
+#ifndef REQUEST_POOL_TEST_ESP_ERR_H
+#define REQUEST_POOL_TEST_ESP_ERR_H
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_NOT_SUPPORTED 0x106
+
+#endif // REQUEST_POOL_TEST_ESP_ERR_H
@@ -0,0 +1,10 @@
+// The tests run on one thread, so the critical sections do nothing
+#ifndef REQUEST_POOL_TEST_FREERTOS_H
+#define REQUEST_POOL_TEST_FREERTOS_H
+
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+
+#endif // REQUEST_POOL_TEST_FREERTOS_H
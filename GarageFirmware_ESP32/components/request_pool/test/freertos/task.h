@@ -0,0 +1,8 @@
+#ifndef REQUEST_POOL_TEST_FREERTOS_TASK_H
+#define REQUEST_POOL_TEST_FREERTOS_TASK_H
+
+typedef void *TaskHandle_t;
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+#endif // REQUEST_POOL_TEST_FREERTOS_TASK_H
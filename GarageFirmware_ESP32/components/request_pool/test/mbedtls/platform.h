@@ -0,0 +1,8 @@
+#ifndef REQUEST_POOL_TEST_MBEDTLS_PLATFORM_H
+#define REQUEST_POOL_TEST_MBEDTLS_PLATFORM_H
+
+#include <stddef.h>
+
+int mbedtls_platform_set_calloc_free(void *(*calloc_func)(size_t, size_t), void (*free_func)(void *));
+
+#endif // REQUEST_POOL_TEST_MBEDTLS_PLATFORM_H
@@ -0,0 +1,251 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/request_pool.c"
+
+// What request_pool_init() installed
+static void *(*tls_calloc)(size_t, size_t);
+static void (*tls_free)(void *);
+static cJSON_Hooks json_hooks;
+
+static int heap_callocs;
+static int network_worker;
+static int other_task;
+static TaskHandle_t current_task = &network_worker;
+
+int mbedtls_platform_set_calloc_free(void *(*calloc_func)(size_t, size_t), void (*free_func)(void *)) {
+    tls_calloc = calloc_func;
+    tls_free = free_func;
+    return 0;
+}
+
+void cJSON_InitHooks(cJSON_Hooks *hooks) {
+    json_hooks = *hooks;
+}
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps) {
+    assert(caps == (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+    heap_callocs++;
+    return calloc(n, size);
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+    (void)caps;
+    return 12345;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return current_task;
+}
+
+bool binary_log_write(binary_log_id_t id, uint8_t arg_count, int32_t a0, int32_t a1, int32_t a2, int32_t a3) {
+    (void)id;
+    (void)arg_count;
+    (void)a0;
+    (void)a1;
+    (void)a2;
+    (void)a3;
+    return true;
+}
+
+static bool from_pool(const void *ptr) {
+    return (const uint8_t *)ptr >= pool && (const uint8_t *)ptr < pool + POOL_SIZE;
+}
+
+static void test_size_classes(void) {
+    assert(size_class_for(0) == 0);
+    assert(size_class_for(16) == 0);
+    assert(size_class_for(17) == 1);
+    assert(size_class_for(4096) == 8);
+    assert(size_class_for(4097) == 9);  // mbedTLS output record buffer
+    assert(size_class_for(5120) == 9);
+    assert(size_class_for(16709) == 11); // mbedTLS input record buffer
+    assert(size_class_for(17408) == 11);
+    assert(size_class_for(17409) == -1);
+    for (size_t i = 1; i < SIZE_CLASS_COUNT; i++) {
+        assert(SIZE_CLASSES[i] > SIZE_CLASSES[i - 1]);
+        assert(SIZE_CLASSES[i] % 8 == 0); // Keeps the next header and payload aligned
+    }
+    assert(sizeof(block_header_t) == 8);
+}
+
+static void test_init(void) {
+    assert(request_pool_init() == ESP_OK);
+    assert(tls_calloc == pool_calloc);
+    assert(tls_free == pool_release);
+    assert(json_hooks.malloc_fn == pool_malloc);
+    assert(json_hooks.free_fn == pool_release);
+    request_pool_stats_t stats;
+    request_pool_get_stats(&stats);
+    assert(stats.capacity == POOL_SIZE);
+}
+
+// Only the task that began the request allocates from the pool
+static void test_owner_gate(void) {
+    current_task = &network_worker;
+    void *before = tls_calloc(1, 100);
+    assert(!from_pool(before));
+    assert(heap_callocs == 1);
+
+    request_pool_begin();
+    void *owned = tls_calloc(1, 100);
+    assert(from_pool(owned));
+    current_task = &other_task;
+    void *other = tls_calloc(1, 100);
+    void *other_json = json_hooks.malloc_fn(100);
+    assert(!from_pool(other));
+    assert(!from_pool(other_json));
+    assert(heap_callocs == 2);
+    // Any task can free a pool block
+    tls_free(owned);
+    current_task = &network_worker;
+    request_pool_end();
+
+    void *after = json_hooks.malloc_fn(100);
+    assert(!from_pool(after));
+    tls_free(before);
+    tls_free(other);
+    json_hooks.free_fn(other_json);
+    json_hooks.free_fn(after);
+    tls_free(NULL);
+}
+
+static void test_blocks_and_free_lists(void) {
+    request_pool_begin();
+    uint8_t *a = tls_calloc(10, 10); // 100 bytes: the 128 class
+    uint8_t *b = json_hooks.malloc_fn(16);
+    assert(from_pool(a) && from_pool(b));
+    assert(a == pool + sizeof(block_header_t));
+    assert(b == a + 128 + sizeof(block_header_t));
+    assert((uintptr_t)a % 8 == 0 && (uintptr_t)b % 8 == 0);
+    assert(live_blocks == 2);
+
+    // A freed block is reused by its own class, and calloc clears it
+    memset(a, 0xAA, 100);
+    tls_free(a);
+    assert(live_blocks == 1);
+    uint8_t *c = json_hooks.malloc_fn(64); // Another class carves a new block
+    assert(c == b + 16 + sizeof(block_header_t));
+    uint8_t *d = tls_calloc(1, 120);
+    assert(d == a);
+    for (int i = 0; i < 120; i++) {
+        assert(d[i] == 0);
+    }
+    tls_free(b);
+    tls_free(c);
+    tls_free(d);
+    request_pool_end();
+
+    request_pool_stats_t stats;
+    request_pool_get_stats(&stats);
+    assert(stats.leaked_blocks == 0);
+    assert(stats.fallbacks == 0);
+    assert(stats.request_peak == 3 * sizeof(block_header_t) + 128 + 16 + 64);
+    assert(stats.high_water == stats.request_peak);
+    assert(stats.largest_free_heap_block == 12345);
+}
+
+// With nothing left allocated, the next request starts from an empty pool
+static void test_reset_when_empty(void) {
+    assert(carved == 0);
+    for (size_t i = 0; i < SIZE_CLASS_COUNT; i++) {
+        assert(free_lists[i] == NULL);
+    }
+    request_pool_begin();
+    void *first = tls_calloc(1, 1000);
+    assert(first == pool + sizeof(block_header_t));
+    tls_free(first);
+    request_pool_end();
+    assert(carved == 0);
+}
+
+// A block that outlives its request keeps the pool from being reset until it is freed
+static void test_no_reset_while_blocks_live(void) {
+    request_pool_begin();
+    void *kept = tls_calloc(1, 1000);
+    void *freed = tls_calloc(1, 1000);
+    tls_free(freed);
+    request_pool_end();
+
+    request_pool_stats_t stats;
+    request_pool_get_stats(&stats);
+    assert(stats.leaked_blocks == 1);
+    assert(carved == 2 * (sizeof(block_header_t) + 1024));
+    assert(free_lists[size_class_for(1000)] == freed);
+
+    // The next request carves past the live block and reuses the free one
+    request_pool_begin();
+    void *next = tls_calloc(1, 1000);
+    assert(next == freed);
+    tls_free(next);
+    tls_free(kept); // Freed outside a request, still returns to the pool
+    assert(live_blocks == 0);
+    request_pool_end();
+    request_pool_get_stats(&stats);
+    assert(stats.leaked_blocks == 0);
+    assert(carved == 0);
+}
+
+// What the pool cannot hold comes from the heap and is counted
+static void test_heap_fallback(void) {
+    request_pool_begin();
+    int callocs = heap_callocs;
+    void *too_big = tls_calloc(1, 17409);
+    assert(!from_pool(too_big));
+    assert(heap_callocs == callocs + 1);
+    void *json_too_big = json_hooks.malloc_fn(20000);
+    assert(!from_pool(json_too_big));
+
+    // The pool holds two of the largest class
+    void *records[3];
+    for (int i = 0; i < 3; i++) {
+        records[i] = tls_calloc(1, 17408);
+    }
+    assert(from_pool(records[0]) && from_pool(records[1]));
+    assert(!from_pool(records[2]));
+    assert(heap_callocs == callocs + 2);
+    // A smaller class still fits in what is left
+    void *small = tls_calloc(1, 4096);
+    assert(from_pool(small));
+
+    // n * size overflow is refused outright
+    assert(tls_calloc(SIZE_MAX / 2, 4) == NULL);
+
+    for (int i = 0; i < 3; i++) {
+        tls_free(records[i]);
+    }
+    tls_free(small);
+    tls_free(too_big);
+    json_hooks.free_fn(json_too_big);
+    request_pool_end();
+
+    request_pool_stats_t stats;
+    request_pool_get_stats(&stats);
+    assert(stats.fallbacks == 3);
+    assert(stats.leaked_blocks == 0);
+    assert(stats.high_water == 2 * (sizeof(block_header_t) + 17408) + sizeof(block_header_t) + 4096);
+    assert(carved == 0);
+
+    // The counts are per request, the high water mark is since boot
+    request_pool_begin();
+    tls_free(tls_calloc(1, 16));
+    request_pool_end();
+    request_pool_stats_t next;
+    request_pool_get_stats(&next);
+    assert(next.fallbacks == 0);
+    assert(next.request_peak == sizeof(block_header_t) + 16);
+    assert(next.high_water == stats.high_water);
+}
+
+int main(void) {
+    test_size_classes();
+    test_init();
+    test_owner_gate();
+    test_blocks_and_free_lists();
+    test_reset_when_empty();
+    test_no_reset_while_blocks_live();
+    test_heap_fallback();
+    printf("request_pool tests passed\n");
+    return 0;
+}
@@ -0,0 +1,30 @@
+#ifndef TIME_SYNC_H
+#define TIME_SYNC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+/**
+ * Wall clock time from SNTP, mapped onto the monotonic esp_timer clock.
+ *
+ * Events are stamped with esp_timer_get_time() when they are captured, which works before
+ * the first sync and is never stepped. The stamp is converted to Unix time when it is sent,
+ * with the offset from the latest sync, so an event captured while offline still gets the
+ * right wall clock time once the device syncs.
+ */
+
+/**
+ * @brief Start SNTP with CONFIG_GARAGE_SNTP_SERVER. Call after the network interface exists.
+ */
+esp_err_t time_sync_start(void);
+
+/**
+ * @brief Convert an esp_timer_get_time() stamp to Unix time in milliseconds.
+ *
+ * @return false if the clock has not been synced yet.
+ */
+bool time_sync_to_epoch_ms(int64_t monotonic_us, int64_t *epoch_ms);
+
+#endif // TIME_SYNC_H
@@ -0,0 +1,53 @@
+#include "time_sync.h"
+
+#include "esp_log.h"
+#include "esp_netif_sntp.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include <sys/time.h>
+
+// Set the SNTP server with: idf.py menuconfig
+#define SNTP_SERVER CONFIG_GARAGE_SNTP_SERVER
+
+static const char *TAG = "time_sync";
+
+// Unix time minus esp_timer time, both in microseconds. Written by the SNTP callback
+// in the lwIP task and read by the network worker, so 64-bit access takes the lock.
+static portMUX_TYPE offset_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t epoch_offset_us;
+static bool synced = false;
+
+static void on_time_sync(struct timeval *tv) {
+    int64_t epoch_us = (int64_t)tv->tv_sec * 1000000 + tv->tv_usec;
+    int64_t offset_us = epoch_us - esp_timer_get_time();
+    portENTER_CRITICAL(&offset_lock);
+    int64_t drift_us = synced ? offset_us - epoch_offset_us : 0;
+    epoch_offset_us = offset_us;
+    synced = true;
+    portEXIT_CRITICAL(&offset_lock);
+    ESP_LOGI(TAG, "Time synced to %lld, drift since last sync %lld us", (long long)tv->tv_sec, (long long)drift_us);
+}
+
+esp_err_t time_sync_start(void) {
+    esp_sntp_config_t config = ESP_NETIF_SNTP_DEFAULT_CONFIG(SNTP_SERVER);
+    config.sync_cb = on_time_sync;
+    // Keep events flowing while waiting: stamps are converted whenever the first sync lands
+    config.wait_for_sync = false;
+    esp_err_t err = esp_netif_sntp_init(&config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start SNTP: %s", esp_err_to_name(err));
+    }
+    return err;
+}
+
+bool time_sync_to_epoch_ms(int64_t monotonic_us, int64_t *epoch_ms) {
+    portENTER_CRITICAL(&offset_lock);
+    bool is_synced = synced;
+    int64_t offset_us = epoch_offset_us;
+    portEXIT_CRITICAL(&offset_lock);
+    if (!is_synced) {
+        return false;
+    }
+    *epoch_ms = (monotonic_us + offset_us) / 1000;
+    return true;
+}
@@ -0,0 +1,50 @@
+#ifndef WIRE_CBOR_H
+#define WIRE_CBOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Minimal CBOR (RFC 8949) for the device messages: unsigned and negative integers,
+ * text strings, booleans, definite-length arrays and maps. Other items can be skipped.
+ *
+ * Both sides work on caller-owned buffers and never allocate. Errors are sticky:
+ * after the first overflow or malformed item every call fails, so a message can be
+ * written or read straight through and checked once at the end.
+ */
+
+typedef struct {
+    uint8_t *buffer;
+    size_t capacity;
+    size_t length;
+    bool overflow;
+} cbor_writer_t;
+
+void cbor_writer_init(cbor_writer_t *writer, uint8_t *buffer, size_t capacity);
+void cbor_write_uint(cbor_writer_t *writer, uint64_t value);
+void cbor_write_int(cbor_writer_t *writer, int64_t value);
+void cbor_write_text(cbor_writer_t *writer, const char *text);
+void cbor_write_bool(cbor_writer_t *writer, bool value);
+// Start a map of the given number of key/value pairs. Write the pairs next.
+void cbor_write_map(cbor_writer_t *writer, size_t pairs);
+// Start an array of the given number of items. Write the items next.
+void cbor_write_array(cbor_writer_t *writer, size_t items);
+
+typedef struct {
+    const uint8_t *next;
+    const uint8_t *end;
+    bool error;
+} cbor_reader_t;
+
+void cbor_reader_init(cbor_reader_t *reader, const uint8_t *data, size_t length);
+bool cbor_read_map(cbor_reader_t *reader, size_t *pairs);
+bool cbor_read_uint(cbor_reader_t *reader, uint64_t *value);
+bool cbor_read_int(cbor_reader_t *reader, int64_t *value);
+// Points into the input, which is not NUL-terminated.
+bool cbor_read_text(cbor_reader_t *reader, const char **text, size_t *length);
+bool cbor_read_bool(cbor_reader_t *reader, bool *value);
+// Skip one item, including everything nested in it.
+bool cbor_skip(cbor_reader_t *reader);
+
+#endif // WIRE_CBOR_H
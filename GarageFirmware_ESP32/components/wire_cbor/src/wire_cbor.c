@@ -0,0 +1,226 @@
+#include "wire_cbor.h"
+
+#include <string.h>
+
+#define CBOR_MAJOR_UINT 0
+#define CBOR_MAJOR_NEGATIVE_INT 1
+#define CBOR_MAJOR_BYTES 2
+#define CBOR_MAJOR_TEXT 3
+#define CBOR_MAJOR_ARRAY 4
+#define CBOR_MAJOR_MAP 5
+#define CBOR_MAJOR_TAG 6
+#define CBOR_MAJOR_SIMPLE 7
+
+#define CBOR_FALSE 20
+#define CBOR_TRUE 21
+
+// Additional info values that say how many argument bytes follow the initial byte
+#define CBOR_ARGUMENT_1_BYTE 24
+#define CBOR_ARGUMENT_8_BYTES 27
+
+void cbor_writer_init(cbor_writer_t *writer, uint8_t *buffer, size_t capacity) {
+    writer->buffer = buffer;
+    writer->capacity = capacity;
+    writer->length = 0;
+    writer->overflow = false;
+}
+
+static void write_bytes(cbor_writer_t *writer, const void *data, size_t length) {
+    if (writer->overflow || length > writer->capacity - writer->length) {
+        writer->overflow = true;
+        return;
+    }
+    memcpy(writer->buffer + writer->length, data, length);
+    writer->length += length;
+}
+
+// Initial byte plus the shortest argument encoding, as CBOR's preferred serialization asks
+static void write_head(cbor_writer_t *writer, uint8_t major, uint64_t argument) {
+    uint8_t head[9];
+    size_t length;
+    if (argument < CBOR_ARGUMENT_1_BYTE) {
+        head[0] = (uint8_t)((major << 5) | argument);
+        length = 1;
+    } else {
+        size_t argument_bytes = argument <= UINT8_MAX ? 1 : argument <= UINT16_MAX ? 2 : argument <= UINT32_MAX ? 4 : 8;
+        uint8_t info = CBOR_ARGUMENT_1_BYTE + (argument_bytes == 1 ? 0 : argument_bytes == 2 ? 1 : argument_bytes == 4 ? 2 : 3);
+        head[0] = (uint8_t)((major << 5) | info);
+        for (size_t i = 0; i < argument_bytes; i++) {
+            head[argument_bytes - i] = (uint8_t)(argument >> (8 * i));
+        }
+        length = 1 + argument_bytes;
+    }
+    write_bytes(writer, head, length);
+}
+
+void cbor_write_uint(cbor_writer_t *writer, uint64_t value) {
+    write_head(writer, CBOR_MAJOR_UINT, value);
+}
+
+void cbor_write_int(cbor_writer_t *writer, int64_t value) {
+    if (value >= 0) {
+        write_head(writer, CBOR_MAJOR_UINT, (uint64_t)value);
+    } else {
+        // -1 - value, without overflowing on INT64_MIN
+        write_head(writer, CBOR_MAJOR_NEGATIVE_INT, ~(uint64_t)value);
+    }
+}
+
+void cbor_write_text(cbor_writer_t *writer, const char *text) {
+    size_t length = strlen(text);
+    write_head(writer, CBOR_MAJOR_TEXT, length);
+    write_bytes(writer, text, length);
+}
+
+void cbor_write_bool(cbor_writer_t *writer, bool value) {
+    write_head(writer, CBOR_MAJOR_SIMPLE, value ? CBOR_TRUE : CBOR_FALSE);
+}
+
+void cbor_write_map(cbor_writer_t *writer, size_t pairs) {
+    write_head(writer, CBOR_MAJOR_MAP, pairs);
+}
+
+void cbor_write_array(cbor_writer_t *writer, size_t items) {
+    write_head(writer, CBOR_MAJOR_ARRAY, items);
+}
+
+void cbor_reader_init(cbor_reader_t *reader, const uint8_t *data, size_t length) {
+    reader->next = data;
+    reader->end = data + length;
+    reader->error = false;
+}
+
+static bool fail(cbor_reader_t *reader) {
+    reader->error = true;
+    return false;
+}
+
+// Read an initial byte and its argument. Indefinite lengths and reserved values are errors.
+static bool read_head(cbor_reader_t *reader, uint8_t *major, uint64_t *argument) {
+    if (reader->error || reader->next >= reader->end) {
+        return fail(reader);
+    }
+    uint8_t initial = *reader->next++;
+    uint8_t info = initial & 0x1f;
+    *major = initial >> 5;
+    if (info < CBOR_ARGUMENT_1_BYTE) {
+        *argument = info;
+        return true;
+    }
+    if (info > CBOR_ARGUMENT_8_BYTES) {
+        return fail(reader);
+    }
+    size_t argument_bytes = (size_t)1 << (info - CBOR_ARGUMENT_1_BYTE);
+    if ((size_t)(reader->end - reader->next) < argument_bytes) {
+        return fail(reader);
+    }
+    *argument = 0;
+    for (size_t i = 0; i < argument_bytes; i++) {
+        *argument = (*argument << 8) | *reader->next++;
+    }
+    return true;
+}
+
+static bool read_expected(cbor_reader_t *reader, uint8_t expected_major, uint64_t *argument) {
+    uint8_t major;
+    if (!read_head(reader, &major, argument)) {
+        return false;
+    }
+    return major == expected_major || fail(reader);
+}
+
+bool cbor_read_map(cbor_reader_t *reader, size_t *pairs) {
+    uint64_t argument;
+    if (!read_expected(reader, CBOR_MAJOR_MAP, &argument)) {
+        return false;
+    }
+    // Every pair takes at least two bytes, so a larger count is malformed
+    if (argument > (uint64_t)(reader->end - reader->next) / 2) {
+        return fail(reader);
+    }
+    *pairs = (size_t)argument;
+    return true;
+}
+
+bool cbor_read_uint(cbor_reader_t *reader, uint64_t *value) {
+    return read_expected(reader, CBOR_MAJOR_UINT, value);
+}
+
+bool cbor_read_int(cbor_reader_t *reader, int64_t *value) {
+    uint8_t major;
+    uint64_t argument;
+    if (!read_head(reader, &major, &argument)) {
+        return false;
+    }
+    if ((major != CBOR_MAJOR_UINT && major != CBOR_MAJOR_NEGATIVE_INT) || argument > INT64_MAX) {
+        return fail(reader);
+    }
+    *value = major == CBOR_MAJOR_UINT ? (int64_t)argument : -1 - (int64_t)argument;
+    return true;
+}
+
+bool cbor_read_text(cbor_reader_t *reader, const char **text, size_t *length) {
+    uint64_t argument;
+    if (!read_expected(reader, CBOR_MAJOR_TEXT, &argument)) {
+        return false;
+    }
+    if (argument > (uint64_t)(reader->end - reader->next)) {
+        return fail(reader);
+    }
+    *text = (const char *)reader->next;
+    *length = (size_t)argument;
+    reader->next += argument;
+    return true;
+}
+
+bool cbor_read_bool(cbor_reader_t *reader, bool *value) {
+    uint64_t argument;
+    if (!read_expected(reader, CBOR_MAJOR_SIMPLE, &argument)) {
+        return false;
+    }
+    if (argument != CBOR_FALSE && argument != CBOR_TRUE) {
+        return fail(reader);
+    }
+    *value = argument == CBOR_TRUE;
+    return true;
+}
+
+bool cbor_skip(cbor_reader_t *reader) {
+    // Items still to skip. Containers add their children instead of recursing.
+    uint64_t remaining = 1;
+    while (remaining > 0) {
+        uint8_t major;
+        uint64_t argument;
+        if (!read_head(reader, &major, &argument)) {
+            return false;
+        }
+        remaining--;
+        uint64_t available = (uint64_t)(reader->end - reader->next);
+        switch (major) {
+        case CBOR_MAJOR_BYTES:
+        case CBOR_MAJOR_TEXT:
+            if (argument > available) {
+                return fail(reader);
+            }
+            reader->next += argument;
+            break;
+        case CBOR_MAJOR_ARRAY:
+        case CBOR_MAJOR_MAP: {
+            // Each child takes at least one byte
+            uint64_t children = major == CBOR_MAJOR_MAP ? argument * 2 : argument;
+            if (argument > available || children > available) {
+                return fail(reader);
+            }
+            remaining += children;
+            break;
+        }
+        case CBOR_MAJOR_TAG:
+            remaining++;
+            break;
+        default:
+            // Integers and simple values are complete after the head
+            break;
+        }
+    }
+    return true;
+}
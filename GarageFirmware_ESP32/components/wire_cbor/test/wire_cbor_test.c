@@ -0,0 +1,277 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "wire_cbor.h"
+
+/**
+ * Each message is written the way garage_http_client_cbor.c writes it, with the values in
+ * its fixture, and must match the fixture's cborHex byte for byte. Keys are the wire_key_t
+ * values in garage_http_client_cbor.h.
+ */
+
+#define BUILD_TIMESTAMP "Sat Mar 13 14:45:00 2021"
+#define MESSAGE_SIZE 512
+
+typedef struct {
+    uint8_t bytes[MESSAGE_SIZE];
+    size_t length;
+} message_t;
+
+static message_t load_fixture(const char *name) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", WIRE_CONTRACTS_DIR, name);
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Missing fixture %s\n", path);
+        abort();
+    }
+    static char json[4096];
+    size_t json_length = fread(json, 1, sizeof(json) - 1, file);
+    fclose(file);
+    json[json_length] = '\0';
+    const char *hex = strstr(json, "\"cborHex\": \"");
+    assert(hex != NULL);
+    hex += strlen("\"cborHex\": \"");
+    message_t message = {.length = 0};
+    while (*hex != '"') {
+        unsigned byte;
+        assert(message.length < MESSAGE_SIZE && sscanf(hex, "%2x", &byte) == 1);
+        message.bytes[message.length++] = (uint8_t)byte;
+        hex += 2;
+    }
+    return message;
+}
+
+static void assert_matches_fixture(const cbor_writer_t *writer, const char *name) {
+    message_t fixture = load_fixture(name);
+    assert(!writer->overflow);
+    if (writer->length != fixture.length || memcmp(writer->buffer, fixture.bytes, fixture.length) != 0) {
+        fprintf(stderr, "%s: encoded ", name);
+        for (size_t i = 0; i < writer->length; i++) {
+            fprintf(stderr, "%02x", writer->buffer[i]);
+        }
+        fprintf(stderr, "\n");
+        abort();
+    }
+}
+
+static void write_uint_array(cbor_writer_t *writer, uint64_t key, const uint32_t *values, size_t count) {
+    cbor_write_uint(writer, key);
+    cbor_write_array(writer, count);
+    for (size_t i = 0; i < count; i++) {
+        cbor_write_uint(writer, values[i]);
+    }
+}
+
+static void write_sensor_fields(cbor_writer_t *writer, int sensor_a, int sensor_b, int64_t event_age_ms) {
+    cbor_write_uint(writer, 1); // buildTimestamp
+    cbor_write_text(writer, BUILD_TIMESTAMP);
+    cbor_write_uint(writer, 2); // sensorA
+    cbor_write_int(writer, sensor_a);
+    cbor_write_uint(writer, 3); // sensorB
+    cbor_write_int(writer, sensor_b);
+    cbor_write_uint(writer, 4); // eventAgeMillis
+    cbor_write_int(writer, event_age_ms);
+}
+
+static void test_sensor_request(void) {
+    uint8_t buffer[MESSAGE_SIZE];
+    cbor_writer_t writer;
+    cbor_writer_init(&writer, buffer, sizeof(buffer));
+    cbor_write_map(&writer, 5);
+    write_sensor_fields(&writer, 0, 1, 1500);
+    cbor_write_uint(&writer, 5); // eventTimestampMillis
+    cbor_write_int(&writer, 1760000000123LL);
+    assert_matches_fixture(&writer, "echo/cbor_request_sensor.json");
+}
+
+// Before SNTP syncs there is no event timestamp
+static void test_sensor_request_unsynced(void) {
+    uint8_t buffer[MESSAGE_SIZE];
+    cbor_writer_t writer;
+    cbor_writer_init(&writer, buffer, sizeof(buffer));
+    cbor_write_map(&writer, 4);
+    write_sensor_fields(&writer, 1, 0, 0);
+    assert_matches_fixture(&writer, "echo/cbor_request_sensor_unsynced.json");
+}
+
+// The heartbeat adds the door travel report and the metrics snapshot
+static void test_sensor_request_heartbeat(void) {
+    static const uint32_t travel_open[] = {0, 0, 0, 0, 1, 3, 5, 2, 0, 0, 0, 0};
+    static const uint32_t travel_close[] = {0, 0, 0, 1, 4, 5, 1, 0, 0, 0, 0, 0};
+    static const uint32_t press_delay[] = {0, 2, 6, 3, 0, 0, 0, 0, 0, 0, 0, 0};
+    static const uint32_t median_ms[] = {11300, 10500, 600};
+    static const uint32_t counters[] = {0, 3, 0, 7, 150, 2, 147, 0, 1, 0, 0};
+    static const int64_t gauges[] = {0, 182340};
+    static const uint32_t histograms[] = {3, 827, 3, 10, 1, 11, 1, 34, 1, 148, 60760, 2, 28, 100, 32, 48};
+    uint8_t buffer[MESSAGE_SIZE];
+    cbor_writer_t writer;
+    cbor_writer_init(&writer, buffer, sizeof(buffer));
+    cbor_write_map(&writer, 5 + 5 + 3);
+    write_sensor_fields(&writer, 0, 1, 12);
+    cbor_write_uint(&writer, 5); // eventTimestampMillis
+    cbor_write_int(&writer, 1760000000123LL);
+    write_uint_array(&writer, 12, travel_open, 12);
+    write_uint_array(&writer, 13, travel_close, 12);
+    write_uint_array(&writer, 14, press_delay, 12);
+    write_uint_array(&writer, 15, median_ms, 3);
+    cbor_write_uint(&writer, 16); // travel_drift
+    cbor_write_uint(&writer, 1);
+    write_uint_array(&writer, 17, counters, 11);
+    cbor_write_uint(&writer, 18); // metrics_gauges, signed
+    cbor_write_array(&writer, 2);
+    for (int i = 0; i < 2; i++) {
+        cbor_write_int(&writer, gauges[i]);
+    }
+    write_uint_array(&writer, 19, histograms, 16);
+    assert_matches_fixture(&writer, "echo/cbor_request_sensor_heartbeat.json");
+}
+
+static void write_poll_fields(cbor_writer_t *writer, const char *button_ack_token) {
+    cbor_write_uint(writer, 1); // buildTimestamp
+    cbor_write_text(writer, BUILD_TIMESTAMP);
+    cbor_write_uint(writer, 6); // buttonAckToken
+    cbor_write_text(writer, button_ack_token);
+    cbor_write_uint(writer, 7); // conditional
+    cbor_write_bool(writer, true);
+}
+
+static void test_button_poll(void) {
+    uint8_t buffer[MESSAGE_SIZE];
+    cbor_writer_t writer;
+    cbor_writer_init(&writer, buffer, sizeof(buffer));
+    cbor_write_map(&writer, 3);
+    write_poll_fields(&writer, "ack-token-1");
+    assert_matches_fixture(&writer, "remoteButton/cbor_request_poll.json");
+}
+
+static void test_button_poll_local_press(void) {
+    uint8_t buffer[MESSAGE_SIZE];
+    cbor_writer_t writer;
+    cbor_writer_init(&writer, buffer, sizeof(buffer));
+    cbor_write_map(&writer, 4);
+    write_poll_fields(&writer, "");
+    cbor_write_uint(&writer, 8); // local_press_count
+    cbor_write_int(&writer, 2);
+    assert_matches_fixture(&writer, "remoteButton/cbor_request_poll_local_press.json");
+}
+
+static void test_button_poll_actuation(void) {
+    uint8_t buffer[MESSAGE_SIZE];
+    cbor_writer_t writer;
+    cbor_writer_init(&writer, buffer, sizeof(buffer));
+    cbor_write_map(&writer, 6);
+    write_poll_fields(&writer, "");
+    cbor_write_uint(&writer, 9); // actuation_result
+    cbor_write_int(&writer, 1);
+    cbor_write_uint(&writer, 10); // actuation_latency_ms
+    cbor_write_int(&writer, 740);
+    cbor_write_uint(&writer, 11); // actuation_attempts
+    cbor_write_int(&writer, 1);
+    assert_matches_fixture(&writer, "remoteButton/cbor_request_poll_actuation.json");
+}
+
+/**
+ * The server encodes the responses. Writing them here pins the same bytes, and reading
+ * them back checks the firmware's side: it reads text and integers and skips the rest.
+ */
+static void test_sensor_response(void) {
+    uint8_t buffer[MESSAGE_SIZE];
+    cbor_writer_t writer;
+    cbor_writer_init(&writer, buffer, sizeof(buffer));
+    cbor_write_map(&writer, 3);
+    cbor_write_uint(&writer, 1); // buildTimestamp
+    cbor_write_text(&writer, BUILD_TIMESTAMP);
+    cbor_write_uint(&writer, 2); // sensorA
+    cbor_write_int(&writer, 0);
+    cbor_write_uint(&writer, 3); // sensorB
+    cbor_write_int(&writer, 1);
+    assert_matches_fixture(&writer, "echo/cbor_response_sensor.json");
+
+    message_t fixture = load_fixture("echo/cbor_response_sensor.json");
+    cbor_reader_t reader;
+    cbor_reader_init(&reader, fixture.bytes, fixture.length);
+    size_t pairs;
+    uint64_t key;
+    const char *text;
+    size_t length;
+    int64_t value;
+    assert(cbor_read_map(&reader, &pairs) && pairs == 3);
+    assert(cbor_read_uint(&reader, &key) && key == 1);
+    assert(cbor_read_text(&reader, &text, &length));
+    assert(length == strlen(BUILD_TIMESTAMP) && memcmp(text, BUILD_TIMESTAMP, length) == 0);
+    assert(cbor_read_uint(&reader, &key) && key == 2);
+    assert(cbor_read_int(&reader, &value) && value == 0);
+    assert(cbor_read_uint(&reader, &key) && key == 3);
+    assert(cbor_read_int(&reader, &value) && value == 1);
+    assert(reader.next == reader.end && !reader.error);
+}
+
+static void test_button_responses(void) {
+    uint8_t buffer[MESSAGE_SIZE];
+    cbor_writer_t writer;
+    cbor_writer_init(&writer, buffer, sizeof(buffer));
+    cbor_write_map(&writer, 1);
+    cbor_write_uint(&writer, 6); // buttonAckToken
+    cbor_write_text(&writer, "ack-token-2");
+    assert_matches_fixture(&writer, "remoteButton/cbor_response_command.json");
+
+    cbor_writer_init(&writer, buffer, sizeof(buffer));
+    cbor_write_map(&writer, 0);
+    assert_matches_fixture(&writer, "remoteButton/cbor_response_no_command.json");
+
+    message_t fixture = load_fixture("remoteButton/cbor_response_command.json");
+    cbor_reader_t reader;
+    cbor_reader_init(&reader, fixture.bytes, fixture.length);
+    size_t pairs;
+    uint64_t key;
+    const char *text;
+    size_t length;
+    assert(cbor_read_map(&reader, &pairs) && pairs == 1);
+    assert(cbor_read_uint(&reader, &key) && key == 6);
+    assert(cbor_read_text(&reader, &text, &length) && length == 11 && memcmp(text, "ack-token-2", 11) == 0);
+}
+
+// Newer servers may add keys of any type, which the firmware skips
+static void test_skip_heartbeat_body(void) {
+    message_t fixture = load_fixture("echo/cbor_request_sensor_heartbeat.json");
+    cbor_reader_t reader;
+    cbor_reader_init(&reader, fixture.bytes, fixture.length);
+    size_t pairs;
+    assert(cbor_read_map(&reader, &pairs) && pairs == 13);
+    for (size_t i = 0; i < pairs; i++) {
+        uint64_t key;
+        assert(cbor_read_uint(&reader, &key) && key == (i < 5 ? i + 1 : i + 7));
+        assert(cbor_skip(&reader));
+    }
+    assert(reader.next == reader.end && !reader.error);
+}
+
+static void test_overflow_is_sticky(void) {
+    uint8_t buffer[8];
+    cbor_writer_t writer;
+    cbor_writer_init(&writer, buffer, sizeof(buffer));
+    cbor_write_map(&writer, 1);
+    cbor_write_uint(&writer, 1);
+    cbor_write_text(&writer, BUILD_TIMESTAMP);
+    assert(writer.overflow);
+    cbor_write_uint(&writer, 2);
+    assert(writer.overflow && writer.length <= sizeof(buffer));
+}
+
+int main(void) {
+    test_sensor_request();
+    test_sensor_request_unsynced();
+    test_sensor_request_heartbeat();
+    test_button_poll();
+    test_button_poll_local_press();
+    test_button_poll_actuation();
+    test_sensor_response();
+    test_button_responses();
+    test_skip_heartbeat_body();
+    test_overflow_is_sticky();
+    printf("wire_cbor tests passed\n");
+    return 0;
+}
@@ -1,208 +1,636 @@
+#include "esp_event.h"
 #include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_system.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
 #include "freertos/task.h"
+#include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
 
+#include "binary_log.h"
 #include "button_token.h"
+#include "delta_ota.h"
 #include "door_sensors.h"
+#include "door_travel.h"
 #include "garage_hal.h"
 #include "garage_http_client.h"
+#include "https_post_request.h"
+#include "lan_control.h"
+#include "metrics.h"
+#include "request_pool.h"
+#include "time_sync.h"
 #include "wifi_connector.h"
 
 #define DEVICE_ID CONFIG_PROJECT_DEVICE_ID
+// The largest response is the sensor echo: the query params with a full-length device ID.
+// The server leaves the body out, since a heartbeat's metrics would not fit (HttpEchoTest).
 #define HTTP_RECEIVE_BUFFER_SIZE 1024
 
+#define SENSOR_SAMPLE_PERIOD_MS 10
+#define BUTTON_POLL_PERIOD_MS 5000      // Until the server sends a hint, or when it sends none
+#define BUTTON_POLL_MIN_PERIOD_MS 1000  // Bounds on the server's hint
+#define BUTTON_POLL_MAX_PERIOD_MS 30000 // Two polls must fit in the server's 60 s ONLINE threshold
+#define BUTTON_PUSH_DURATION_MS 1000
+#define ACTUATION_TIMEOUT_MS (CONFIG_GARAGE_ACTUATION_TIMEOUT_SECONDS * 1000)
+#define LOG_HELLO_PERIOD_MS 10000
+#define NETWORK_QUEUE_LENGTH 4
+
+// Set the task topology with: idf.py menuconfig
+#ifdef CONFIG_GARAGE_NETWORK_TASK_CORE
+#define NETWORK_TASK_CORE CONFIG_GARAGE_NETWORK_TASK_CORE
+#else
+#define NETWORK_TASK_CORE tskNO_AFFINITY
+#endif
+#define NETWORK_TASK_PRIORITY CONFIG_GARAGE_NETWORK_TASK_PRIORITY
+
 static const char *TAG = "main";
-// Queue to communicate between tasks that read sensor values and tasks that upload them to the server
-static QueueHandle_t xSensorQueue;
-// Data to pass to the xSensorQueue
+
+// Events posted to the default event loop by the timers and the network worker
+ESP_EVENT_DEFINE_BASE(GARAGE_EVENT);
+enum {
+    GARAGE_EVENT_SENSOR_UPDATE,      // event_data is a sensor_collection_t
+    GARAGE_EVENT_BUTTON_PRESS,       // no event_data
+    GARAGE_EVENT_LOCAL_BUTTON_PRESS, // no event_data, accepted by the LAN API
+    GARAGE_EVENT_ACTUATION_RESULT,   // event_data is an actuation_report_t
+    GARAGE_EVENT_ACTUATION_RETRY,    // no event_data, the door did not move after the first press
+};
+
+// Data to pass with GARAGE_EVENT_SENSOR_UPDATE
 typedef struct {
     int a_level;
     int b_level;
+    int64_t captured_us; // esp_timer_get_time() when the values were read
+    bool heartbeat;      // Also send the door travel report
 } sensor_collection_t;
 // Sensor state
 static sensor_state_t sensor_a;
 static sensor_state_t sensor_b;
 
-// Queue to communicate between tasks that download button commands and tasks that push the button
-static QueueHandle_t xButtonQueue;
-// Data to pass to the xButtonQueue
-static void *void_pointer;
+// Work for the network worker, which is the only task that blocks on the network
+typedef enum {
+    NETWORK_JOB_UPLOAD_SENSORS,
+    NETWORK_JOB_POLL_BUTTON,
+    NETWORK_JOB_CHECK_OTA,
+    NETWORK_JOB_WARM_UP,
+} network_job_type_t;
+typedef struct {
+    network_job_type_t type;
+    sensor_collection_t sensors;  // Only used by NETWORK_JOB_UPLOAD_SENSORS
+    int local_press_count;        // Only used by NETWORK_JOB_POLL_BUTTON
+    actuation_report_t actuation; // Only used by NETWORK_JOB_POLL_BUTTON
+} network_job_t;
+static QueueHandle_t xNetworkQueue;
+
 // Button token state
 static button_token_t current_button_token;
 
+// Watches the debounced sensors after a press to confirm that the door moved.
+// Armed from the event loop, checked by read_sensors and on_actuation_timeout in the esp_timer task.
+static struct {
+    bool armed;
+    int64_t pushed_us;
+    int attempts;
+} actuation_check;
+static portMUX_TYPE actuation_check_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t actuation_timer;
+
+// Timers that replace the fixed-delay task loops
+static esp_timer_handle_t sensor_timer;
+static esp_timer_handle_t button_poll_timer;
+static esp_timer_handle_t log_hello_timer;
+#ifdef CONFIG_GARAGE_OTA
+static esp_timer_handle_t ota_check_timer;
+#endif
+
+#ifdef CONFIG_GARAGE_SENSOR_JITTER_STATS
+// How late read_sensors runs compared to SENSOR_SAMPLE_PERIOD_MS.
+// Only touched from esp_timer callbacks, which all run in the esp_timer task.
+static struct {
+    int64_t last_us;
+    uint32_t samples;
+    int64_t total_us;
+    int64_t max_us;
+} sensor_jitter;
+
+static void record_sensor_jitter(void) {
+    int64_t now_us = esp_timer_get_time();
+    if (sensor_jitter.last_us != 0) {
+        int64_t jitter_us = (now_us - sensor_jitter.last_us) - SENSOR_SAMPLE_PERIOD_MS * 1000;
+        if (jitter_us < 0) {
+            jitter_us = -jitter_us;
+        }
+        sensor_jitter.samples++;
+        sensor_jitter.total_us += jitter_us;
+        if (jitter_us > sensor_jitter.max_us) {
+            sensor_jitter.max_us = jitter_us;
+        }
+    }
+    sensor_jitter.last_us = now_us;
+}
+
+static void log_sensor_jitter(void) {
+    if (sensor_jitter.samples == 0) {
+        return;
+    }
+    char network_core[12] = "unpinned";
+    if (NETWORK_TASK_CORE != tskNO_AFFINITY) {
+        snprintf(network_core, sizeof(network_core), "core %d", (int)NETWORK_TASK_CORE);
+    }
+    ESP_LOGI(TAG, "read_sensors jitter over %" PRIu32 " samples: mean %" PRId64 " us, max %" PRId64 " us (network worker %s)",
+             sensor_jitter.samples,
+             sensor_jitter.total_us / sensor_jitter.samples,
+             sensor_jitter.max_us,
+             network_core);
+    sensor_jitter.samples = 0;
+    sensor_jitter.total_us = 0;
+    sensor_jitter.max_us = 0;
+}
+#endif // CONFIG_GARAGE_SENSOR_JITTER_STATS
+
+static void post_actuation_result(actuation_result_t result, int latency_ms, int attempts) {
+    const actuation_report_t report = {
+        .result = result,
+        .latency_ms = latency_ms,
+        .attempts = attempts,
+    };
+    esp_err_t err = esp_event_post(GARAGE_EVENT, GARAGE_EVENT_ACTUATION_RESULT, &report, sizeof(report), 0);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to post actuation result %d (%s)", result, esp_err_to_name(err));
+    }
+}
+
+/**
+ * The door moved while a press was being checked. Runs in read_sensors.
+ */
+static void on_door_moved(int64_t captured_us) {
+    portENTER_CRITICAL(&actuation_check_lock);
+    bool armed = actuation_check.armed;
+    int latency_ms = (int)((captured_us - actuation_check.pushed_us) / 1000);
+    int attempts = actuation_check.attempts;
+    actuation_check.armed = false;
+    portEXIT_CRITICAL(&actuation_check_lock);
+    if (!armed) {
+        return;
+    }
+    esp_timer_stop(actuation_timer);
+    BLOG2(ACTUATION_MOTION, latency_ms, attempts);
+    door_travel_record(DOOR_TRAVEL_PRESS_DELAY, (uint32_t)latency_ms);
+    post_actuation_result(ACTUATION_MOTION, latency_ms, attempts);
+}
+
 /**
- * Read sensor values and signal the xSensorQueue when they have changed.
- * Also send a regular heartbeat if the values do not change.
+ * The door did not move within ACTUATION_TIMEOUT_MS of a press. One-shot esp_timer callback.
  */
-void read_sensors(void *pvParameters) {
-    static TickType_t tick_count;
+static void on_actuation_timeout(void *arg) {
+    portENTER_CRITICAL(&actuation_check_lock);
+    // Not armed by a press that landed while this callback was already due
+    bool armed = actuation_check.armed && esp_timer_get_time() - actuation_check.pushed_us >= ACTUATION_TIMEOUT_MS * 1000LL;
+    int attempts = actuation_check.attempts;
+    if (armed) {
+        actuation_check.armed = false;
+    }
+    portEXIT_CRITICAL(&actuation_check_lock);
+    if (!armed) {
+        return;
+    }
+#ifdef CONFIG_GARAGE_ACTUATION_RETRY
+    if (attempts == 1 && esp_event_post(GARAGE_EVENT, GARAGE_EVENT_ACTUATION_RETRY, NULL, 0, 0) == ESP_OK) {
+        BLOG0(ACTUATION_RETRY);
+        return;
+    }
+#endif
+    BLOG2(ACTUATION_NO_MOTION, ACTUATION_TIMEOUT_MS, attempts);
+    post_actuation_result(ACTUATION_NO_MOTION, ACTUATION_TIMEOUT_MS, attempts);
+}
+
+static void post_sensor_event(const sensor_collection_t *collection, binary_log_id_t posted_log_id) {
+    esp_err_t err = esp_event_post(GARAGE_EVENT, GARAGE_EVENT_SENSOR_UPDATE, collection, sizeof(*collection), 0);
+    if (err == ESP_OK) {
+        binary_log_write(posted_log_id, 2, collection->a_level, collection->b_level, 0, 0);
+    } else {
+        ESP_LOGE(TAG, "Failed to post sensor values a: %d, b: %d (%s)", collection->a_level, collection->b_level, esp_err_to_name(err));
+        metrics_count(METRIC_SENSOR_EVENTS_DROPPED);
+    }
+}
+
+/**
+ * Read sensor values and post a sensor event when they have changed.
+ * Also post a regular heartbeat if the values do not change.
+ *
+ * Runs every SENSOR_SAMPLE_PERIOD_MS in the esp_timer task, so it must never block.
+ */
+static void read_sensors(void *arg) {
     static uint32_t tick_count_of_last_update = 0;
     const static uint32_t HEARTBEAT_TICKS = pdMS_TO_TICKS(600000); // 10 minutes
-    static int new_sensor_a;
-    static int new_sensor_b;
-    static bool a_changed;
-    static bool b_changed;
     static sensor_collection_t send_collection;
-    static BaseType_t xStatus;
-    memset(&send_collection, 0, sizeof(send_collection));
-    while (1) {
-        tick_count = xTaskGetTickCount();
-        // Read sensor values
-        new_sensor_a = garage_hal.read_sensor(G_HAL_SENSOR_A);
-        new_sensor_b = garage_hal.read_sensor(G_HAL_SENSOR_B);
-        // Debounce sensor values and check if they have changed
-        a_changed = sensor_debouncer.debounce(&sensor_a, new_sensor_a, (uint32_t)tick_count);
-        b_changed = sensor_debouncer.debounce(&sensor_b, new_sensor_b, (uint32_t)tick_count);
-        if (a_changed) {
-            send_collection.a_level = new_sensor_a;
-        }
-        if (b_changed) {
-            send_collection.b_level = new_sensor_b;
-        }
-        if (a_changed || b_changed) {
-            // If sensor values have changed, send them to the server
-            xStatus = xQueueSend(xSensorQueue, &send_collection, 0);
-            if (xStatus == pdPASS) {
-                ESP_LOGI(TAG, "Change: Send sensor values a: %d, b: %d to xSensorQueue", send_collection.a_level, send_collection.b_level);
-            } else {
-                ESP_LOGE(TAG, "Failed to send sensor values a: %d, b: %d to xSensorQueue", send_collection.a_level, send_collection.b_level);
-            }
-            tick_count_of_last_update = tick_count;
-        } else if (tick_count_of_last_update == 0) {
-            // Make sure we send something after booting
-            xStatus = xQueueSend(xSensorQueue, &send_collection, 0);
-            if (xStatus == pdPASS) {
-                ESP_LOGI(TAG, "First Heartbeat: Send sensor values a: %d, b: %d to xSensorQueue", send_collection.a_level, send_collection.b_level);
-            } else {
-                ESP_LOGE(TAG, "Failed to send sensor values a: %d, b: %d to xSensorQueue", send_collection.a_level, send_collection.b_level);
-            }
-            tick_count_of_last_update = 1; // Ensure we don't send a heartbeat immediately again
-        } else if ((tick_count - tick_count_of_last_update) > HEARTBEAT_TICKS) {
-            // If it is time to send a heartbeat, send the sensor values to the server
-            xStatus = xQueueSend(xSensorQueue, &send_collection, 0);
-            if (xStatus == pdPASS) {
-                ESP_LOGI(TAG, "Heartbeat: Send sensor values a: %d, b: %d to xSensorQueue", send_collection.a_level, send_collection.b_level);
-            } else {
-                ESP_LOGE(TAG, "Failed to send sensor values a: %d, b: %d to xSensorQueue", send_collection.a_level, send_collection.b_level);
-            }
-            tick_count_of_last_update = tick_count;
-        }
-        vTaskDelay(10 / portTICK_PERIOD_MS); // 10 ms
+#ifdef CONFIG_GARAGE_SENSOR_JITTER_STATS
+    record_sensor_jitter();
+#endif
+    TickType_t tick_count = xTaskGetTickCount();
+    // Read sensor values
+    int new_sensor_a = garage_hal.read_sensor(G_HAL_SENSOR_A);
+    int new_sensor_b = garage_hal.read_sensor(G_HAL_SENSOR_B);
+    send_collection.captured_us = esp_timer_get_time();
+    // Debounce sensor values and check if they have changed
+    bool a_changed = sensor_debouncer.debounce(&sensor_a, new_sensor_a, (uint32_t)tick_count);
+    bool b_changed = sensor_debouncer.debounce(&sensor_b, new_sensor_b, (uint32_t)tick_count);
+    if (a_changed) {
+        send_collection.a_level = new_sensor_a;
+    }
+    if (b_changed) {
+        send_collection.b_level = new_sensor_b;
+    }
+    if (a_changed || b_changed) {
+        // If sensor values have changed, send them to the server
+        send_collection.heartbeat = false;
+        post_sensor_event(&send_collection, BLOG_SENSOR_CHANGE_POSTED);
+        on_door_moved(send_collection.captured_us);
+        door_travel_on_sensors(send_collection.a_level, send_collection.b_level, send_collection.captured_us / 1000);
+        tick_count_of_last_update = tick_count;
+    } else if (tick_count_of_last_update == 0) {
+        // Make sure we send something after booting
+        send_collection.heartbeat = true;
+        post_sensor_event(&send_collection, BLOG_SENSOR_FIRST_HEARTBEAT_POSTED);
+        tick_count_of_last_update = 1; // Ensure we don't send a heartbeat immediately again
+    } else if ((tick_count - tick_count_of_last_update) > HEARTBEAT_TICKS) {
+        // If it is time to send a heartbeat, send the sensor values to the server
+        send_collection.heartbeat = true;
+        post_sensor_event(&send_collection, BLOG_SENSOR_HEARTBEAT_POSTED);
+        tick_count_of_last_update = tick_count;
     }
 }
 
 /**
  * Upload sensor values to the server.
  */
-void upload_sensors(void *pvParameters) {
-    static sensor_collection_t receive_collection;
+static void upload_sensors(const sensor_collection_t *collection, http_receive_buffer_t *recv_buffer) {
     static sensor_request_t sensor_request;
     static sensor_response_t sensor_response;
-    memset(&receive_collection, 0, sizeof(receive_collection));
-    memset(&sensor_request, 0, sizeof(sensor_request));
-    memset(&sensor_response, 0, sizeof(sensor_response));
-    static http_receive_buffer_t recv_buffer;
-    static char recv_buffer_data[HTTP_RECEIVE_BUFFER_SIZE];
-    recv_buffer.buffer = recv_buffer_data;
-    recv_buffer.buffer_len = sizeof(recv_buffer_data);
-    recv_buffer.data_received_len = 0;
-    while (1) {
-        if (xQueueReceive(xSensorQueue, &receive_collection, portMAX_DELAY)) {
-            ESP_LOGI(TAG,
-                     "Upload sensor values a: %d, b: %d",
-                     receive_collection.a_level,
-                     receive_collection.b_level);
-            snprintf(sensor_request.device_id, MAX_DEVICE_ID_LENGTH, "%s", DEVICE_ID);
-            sensor_request.sensor_a = receive_collection.a_level;
-            sensor_request.sensor_b = receive_collection.b_level;
-            // Send sensor values to the server
-            garage_server.send_sensor_values(&sensor_request, &sensor_response, &recv_buffer);
-            ESP_LOGI(TAG,
-                     "Received sensor values a: %d, b: %d",
-                     sensor_response.sensor_a,
-                     sensor_response.sensor_b);
-        } else {
-            ESP_LOGE(TAG, "Failed to receive sensor value");
-        }
+    static door_travel_report_t travel_report;
+    static metrics_snapshot_t metrics;
+    BLOG2(SENSOR_UPLOAD, collection->a_level, collection->b_level);
+    snprintf(sensor_request.device_id, MAX_DEVICE_ID_LENGTH, "%s", DEVICE_ID);
+    sensor_request.sensor_a = collection->a_level;
+    sensor_request.sensor_b = collection->b_level;
+    // Stamp the event with when it was captured, not when the queue got to it
+    sensor_request.event_age_ms = (esp_timer_get_time() - collection->captured_us) / 1000;
+    metrics_observe(METRIC_SENSOR_UPLOAD_DELAY, (uint32_t)sensor_request.event_age_ms);
+    if (!time_sync_to_epoch_ms(collection->captured_us, &sensor_request.event_epoch_ms)) {
+        sensor_request.event_epoch_ms = 0;
+    }
+    // Heartbeats carry the travel histograms and the metrics, so they cost no extra request
+    sensor_request.travel = NULL;
+    sensor_request.metrics = NULL;
+    if (collection->heartbeat) {
+        door_travel_get_report(&travel_report);
+        sensor_request.travel = &travel_report;
+        metrics_set(METRIC_MIN_FREE_HEAP, (int32_t)esp_get_minimum_free_heap_size());
+        metrics_snapshot(&metrics);
+        metrics_dump(&metrics);
+        sensor_request.metrics = &metrics;
+    }
+    // Send sensor values to the server
+    garage_server.send_sensor_values(&sensor_request, &sensor_response, recv_buffer);
+    BLOG2(SENSOR_UPLOAD_RESPONSE, sensor_response.sensor_a, sensor_response.sensor_b);
+}
+
+/**
+ * Poll as often as the server asks, within bounds. The server asks for fast polls while someone
+ * is using the app or just sent a command, and slow ones when nobody is.
+ */
+static void follow_poll_hint(int next_poll_seconds) {
+    static uint32_t period_ms = BUTTON_POLL_PERIOD_MS;
+    uint32_t hint_ms = next_poll_seconds > 0 ? (uint32_t)next_poll_seconds * 1000 : BUTTON_POLL_PERIOD_MS;
+    if (hint_ms < BUTTON_POLL_MIN_PERIOD_MS) {
+        hint_ms = BUTTON_POLL_MIN_PERIOD_MS;
+    } else if (hint_ms > BUTTON_POLL_MAX_PERIOD_MS) {
+        hint_ms = BUTTON_POLL_MAX_PERIOD_MS;
+    }
+    if (hint_ms == period_ms) {
+        return;
+    }
+    esp_err_t err = esp_timer_restart(button_poll_timer, (uint64_t)hint_ms * 1000);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to change the button poll period: %s", esp_err_to_name(err));
+        return;
     }
+    BLOG2(BUTTON_POLL_PERIOD_CHANGED, (int32_t)period_ms, (int32_t)hint_ms);
+    period_ms = hint_ms;
 }
 
 /**
- * Fetch button command from server and signal the xButtonQueue to push the button.
+ * Fetch button command from server and post a button press event when it changes.
  */
-void download_button_commands(void *pvParameters) {
+static void download_button_commands(int local_press_count, const actuation_report_t *actuation, http_receive_buffer_t *recv_buffer) {
     static button_request_t button_request;
     static button_response_t button_response;
-    static BaseType_t xStatus;
-    memset(&button_request, 0, sizeof(button_request));
-    memset(&button_response, 0, sizeof(button_response));
+    BLOG0(BUTTON_POLL);
+
+    snprintf(button_request.device_id, MAX_DEVICE_ID_LENGTH, "%s", DEVICE_ID);
+    snprintf(button_request.button_token, MAX_BUTTON_TOKEN_LENGTH + 1, "%s", current_button_token);
+    button_request.local_press_count = local_press_count;
+    button_request.actuation = *actuation;
+
+    garage_server.send_button_token(&button_request, &button_response, recv_buffer);
+    follow_poll_hint(recv_buffer->next_poll_seconds);
+
+    if (token_manager.is_button_press_requested(&current_button_token, button_response.button_token)) {
+        esp_err_t err = esp_event_post(GARAGE_EVENT, GARAGE_EVENT_BUTTON_PRESS, NULL, 0, 0); // Signal the button to be pushed
+        if (err == ESP_OK) {
+            BLOG0(BUTTON_PRESS_POSTED);
+        } else {
+            ESP_LOGE(TAG, "Failed to post button push event: %s", esp_err_to_name(err));
+        }
+    }
+    token_manager.consume_button_token(&current_button_token, button_response.button_token);
+}
+
+/**
+ * Download and apply a firmware update if one exists for this image, then reboot into it.
+ */
+static void check_for_update(void) {
+    esp_err_t err = delta_ota_update();
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "Firmware updated, restarting");
+        esp_restart();
+    } else if (err != ESP_ERR_NOT_FOUND && err != ESP_ERR_NOT_SUPPORTED) {
+        ESP_LOGE(TAG, "Firmware update failed: %s", esp_err_to_name(err));
+    }
+}
+
+/**
+ * The only task left: run network jobs one at a time, blocking on HTTPS as long as needed.
+ */
+static void network_worker(void *pvParameters) {
+    static network_job_t job;
     static http_receive_buffer_t recv_buffer;
     static char recv_buffer_data[HTTP_RECEIVE_BUFFER_SIZE];
     recv_buffer.buffer = recv_buffer_data;
     recv_buffer.buffer_len = sizeof(recv_buffer_data);
     recv_buffer.data_received_len = 0;
     while (1) {
-        ESP_LOGI(TAG, "Fetch button token from server with %s", current_button_token);
+        if (xQueueReceive(xNetworkQueue, &job, portMAX_DELAY)) {
+            metrics_set(METRIC_NETWORK_QUEUE_WAITING, (int32_t)uxQueueMessagesWaiting(xNetworkQueue));
+            // Each job's TLS session and JSON come from the request pool, when enabled
+            request_pool_begin();
+            switch (job.type) {
+            case NETWORK_JOB_UPLOAD_SENSORS:
+                upload_sensors(&job.sensors, &recv_buffer);
+                break;
+            case NETWORK_JOB_POLL_BUTTON:
+                download_button_commands(job.local_press_count, &job.actuation, &recv_buffer);
+                break;
+            case NETWORK_JOB_CHECK_OTA:
+                check_for_update();
+                break;
+            case NETWORK_JOB_WARM_UP:
+                // The old connection died with the Wi-Fi. Open a new one with a poll, which
+                // also picks up commands sent while offline, before a sensor change needs it.
+                https_close_connection();
+                download_button_commands(0, &job.actuation, &recv_buffer);
+                break;
+            default:
+                ESP_LOGE(TAG, "Unknown network job %d", job.type);
+                break;
+            }
+            request_pool_end();
+            // Reaching the server means a freshly updated image works, so stop a rollback
+            if (recv_buffer.status_code == 200) {
+                delta_ota_confirm_running_image();
+            }
+        }
+    }
+}
 
-        snprintf(button_request.device_id, MAX_DEVICE_ID_LENGTH, "%s", DEVICE_ID);
-        snprintf(button_request.button_token, MAX_BUTTON_TOKEN_LENGTH + 1, "%s", current_button_token);
+/**
+ * Queue a button poll every BUTTON_POLL_PERIOD_MS, or as often as the server's last hint asks.
+ * One slot is always left free so a sensor change is never dropped behind polls.
+ */
+static void poll_button(void *arg) {
+    static const network_job_t job = {.type = NETWORK_JOB_POLL_BUTTON};
+    if (uxQueueSpacesAvailable(xNetworkQueue) <= 1) {
+        ESP_LOGW(TAG, "Network worker is busy, skip button poll");
+        metrics_count(METRIC_BUTTON_POLLS_SKIPPED);
+        return;
+    }
+    xQueueSend(xNetworkQueue, &job, 0);
+}
+
+#ifdef CONFIG_GARAGE_OTA
+/**
+ * Queue an update check every GARAGE_OTA_CHECK_INTERVAL_MINUTES, with the same free slot rule.
+ */
+static void queue_update_check(void *arg) {
+    static const network_job_t job = {.type = NETWORK_JOB_CHECK_OTA};
+    if (uxQueueSpacesAvailable(xNetworkQueue) <= 1) {
+        ESP_LOGW(TAG, "Network worker is busy, skip update check");
+        return;
+    }
+    xQueueSend(xNetworkQueue, &job, 0);
+}
+#endif
 
-        garage_server.send_button_token(&button_request, &button_response, &recv_buffer);
+/**
+ * Queue a warm-up when Wi-Fi reconnects, with the same free slot rule. Runs on the default
+ * event loop, registered after the first connection, which the first button poll warms up.
+ */
+static void on_wifi_connected(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data) {
+    static const network_job_t job = {.type = NETWORK_JOB_WARM_UP};
+    if (uxQueueSpacesAvailable(xNetworkQueue) <= 1) {
+        ESP_LOGW(TAG, "Network worker is busy, skip warm-up");
+        return;
+    }
+    BLOG0(NETWORK_WARM_UP);
+    xQueueSend(xNetworkQueue, &job, 0);
+}
 
-        if (token_manager.is_button_press_requested(&current_button_token, button_response.button_token)) {
-            xStatus = xQueueSend(xButtonQueue, &void_pointer, 0); // Signal the button to be pushed
-            if (xStatus == pdPASS) {
-                ESP_LOGI(TAG, "Sent button push signal to xButtonQueue");
-            } else {
-                ESP_LOGE(TAG, "Failed to send button push signal to xButtonQueue");
-            }
-        }
-        token_manager.consume_button_token(&current_button_token, button_response.button_token);
+static void on_button_released(uint32_t actual_duration_us, void *arg) {
+    BLOG1(BUTTON_RELEASED, (int32_t)actual_duration_us);
+}
 
-        vTaskDelay(5000 / portTICK_PERIOD_MS); // 5 seconds
+/**
+ * Start watching the sensors for the door to move after a press. Only a door that is
+ * closed or open can be checked: one stopped between the sensors moves without either
+ * sensor changing until it arrives.
+ */
+static void arm_actuation_check(int attempts) {
+    if (sensor_a.level == sensor_b.level) {
+        BLOG2(ACTUATION_CHECK_SKIPPED, sensor_a.level, sensor_b.level);
+        return;
     }
+    esp_timer_stop(actuation_timer); // A new press replaces the check of the last one
+    portENTER_CRITICAL(&actuation_check_lock);
+    actuation_check.armed = true;
+    actuation_check.pushed_us = esp_timer_get_time();
+    actuation_check.attempts = attempts;
+    portEXIT_CRITICAL(&actuation_check_lock);
+    esp_err_t err = esp_timer_start_once(actuation_timer, ACTUATION_TIMEOUT_MS * 1000ULL);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start the actuation check: %s", esp_err_to_name(err));
+        return;
+    }
+    BLOG1(ACTUATION_CHECK_ARMED, attempts);
 }
 
 /**
- * Push the button when a message is received in the xButtonQueue.
+ * Push the button and check that the door moves. The HAL releases it from a one-shot
+ * timer, so nothing blocks.
  */
-void push_button(void *pvParameters) {
-    while (1) {
-        if (xQueueReceive(xButtonQueue, &void_pointer, portMAX_DELAY)) {
-            ESP_LOGI(TAG, "Push the button");
-            garage_hal.set_button(1); // Push the button
-            ESP_LOGI(TAG, "Button pushed");
-            vTaskDelay(1000 / portTICK_PERIOD_MS); // 1000 ms
-            garage_hal.set_button(0);              // Release the button
-            ESP_LOGI(TAG, "Button released");
-        }
+static void push_button(int attempts) {
+    esp_err_t err = garage_hal.pulse_button(BUTTON_PUSH_DURATION_MS * 1000, on_button_released, NULL);
+    if (err == ESP_OK) {
+        BLOG0(BUTTON_PUSHED);
+        arm_actuation_check(attempts);
+    } else if (err == ESP_ERR_INVALID_STATE) {
+        ESP_LOGW(TAG, "Button is already pushed");
+    } else {
+        ESP_LOGE(TAG, "Failed to push the button: %s", esp_err_to_name(err));
     }
 }
 
-void log_hello(void *pvParameters) {
-    while (1) {
-        ESP_LOGI(TAG, "Hello, world!");
-        vTaskDelay(10000 / portTICK_PERIOD_MS); // 10 seconds
+/**
+ * Handle GARAGE_EVENT on the default event loop. Handlers must not block.
+ */
+static void garage_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data) {
+    switch (event_id) {
+    case GARAGE_EVENT_SENSOR_UPDATE: {
+        network_job_t job = {
+            .type = NETWORK_JOB_UPLOAD_SENSORS,
+            .sensors = *(sensor_collection_t *)event_data,
+        };
+        // Keep FIFO order so the server never sees an older sensor state last
+        if (xQueueSend(xNetworkQueue, &job, 0) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to queue sensor values a: %d, b: %d", job.sensors.a_level, job.sensors.b_level);
+            metrics_count(METRIC_SENSOR_EVENTS_DROPPED);
+        }
+        break;
+    }
+    case GARAGE_EVENT_BUTTON_PRESS:
+        push_button(1);
+        break;
+    case GARAGE_EVENT_ACTUATION_RETRY:
+        push_button(2);
+        break;
+    case GARAGE_EVENT_LOCAL_BUTTON_PRESS: {
+        push_button(1);
+        // Tell the cloud afterwards with an immediate button poll
+        const network_job_t job = {
+            .type = NETWORK_JOB_POLL_BUTTON,
+            .local_press_count = 1,
+        };
+        if (uxQueueSpacesAvailable(xNetworkQueue) <= 1 || xQueueSend(xNetworkQueue, &job, 0) != pdPASS) {
+            ESP_LOGW(TAG, "Network worker is busy, local button press not reported");
+        }
+        break;
+    }
+    case GARAGE_EVENT_ACTUATION_RESULT: {
+        // Report right away instead of waiting for the next poll, so the app hears in about a second
+        const network_job_t job = {
+            .type = NETWORK_JOB_POLL_BUTTON,
+            .actuation = *(actuation_report_t *)event_data,
+        };
+        if (uxQueueSpacesAvailable(xNetworkQueue) <= 1 || xQueueSend(xNetworkQueue, &job, 0) != pdPASS) {
+            ESP_LOGW(TAG, "Network worker is busy, actuation result %d not reported", job.actuation.result);
+            metrics_count(METRIC_ACTUATION_REPORTS_DROPPED);
+        }
+        break;
+    }
+    default:
+        break;
     }
 }
 
+static void get_door_state(int *a_level, int *b_level) {
+    *a_level = sensor_a.level;
+    *b_level = sensor_b.level;
+}
+
+/**
+ * Called by the LAN API after a request is authenticated. Goes through the event loop
+ * like a cloud button press, so the button is only ever pushed from one place.
+ */
+static bool request_local_button_press(void) {
+    return esp_event_post(GARAGE_EVENT, GARAGE_EVENT_LOCAL_BUTTON_PRESS, NULL, 0, 0) == ESP_OK;
+}
+
+static const lan_control_callbacks_t LAN_CONTROL_CALLBACKS = {
+    .get_door_state = get_door_state,
+    .request_button_press = request_local_button_press,
+};
+
+static void log_hello(void *arg) {
+    ESP_LOGI(TAG, "Hello, world!");
+#ifdef CONFIG_GARAGE_SENSOR_JITTER_STATS
+    log_sensor_jitter();
+#endif
+}
+
+// Tasks created by app_main. Timer callbacks run in the esp_timer task instead.
+typedef struct {
+    TaskFunction_t function;
+    const char *name;
+    uint32_t stack_size;
+    UBaseType_t priority;
+    BaseType_t core;
+} task_topology_t;
+
+static const task_topology_t TASK_TOPOLOGY[] = {
+    {network_worker, "network_worker", 8192, NETWORK_TASK_PRIORITY, NETWORK_TASK_CORE},
+    {binary_log_drain, "binary_log", 2048, 1, tskNO_AFFINITY},
+};
+
+static void start_periodic_timer(esp_timer_handle_t *timer, esp_timer_cb_t callback, const char *name, uint64_t period_ms) {
+    const esp_timer_create_args_t args = {
+        .callback = callback,
+        .name = name,
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&args, timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(*timer, period_ms * 1000));
+}
+
 void app_main(void) {
-    // Initialize WIFI
+    binary_log_init();
+    esp_err_t pool_err = request_pool_init();
+    if (pool_err != ESP_OK && pool_err != ESP_ERR_NOT_SUPPORTED) {
+        ESP_LOGE(TAG, "Failed to start the request pool: %s", esp_err_to_name(pool_err));
+    }
+    // Initialize WIFI (also creates the default event loop)
     if (wifi_connector_init() != ESP_OK) {
         ESP_LOGE(TAG, "Failed to connect to WiFi");
     }
+    time_sync_start();
     garage_hal.init();
     garage_server.init();
     sensor_debouncer.init(&sensor_a, pdMS_TO_TICKS(50));
     sensor_debouncer.init(&sensor_b, pdMS_TO_TICKS(50));
     token_manager.init(&current_button_token);
-    xSensorQueue = xQueueCreate(1, sizeof(sensor_collection_t));
-    xButtonQueue = xQueueCreate(1, sizeof(void *));
-    xTaskCreate(log_hello, "log_hello", 2048, NULL, 5, NULL);
-    xTaskCreate(read_sensors, "read_sensors", 2048, NULL, 5, NULL);
-    xTaskCreate(upload_sensors, "upload_sensors", 4096, NULL, 5, NULL);
-    xTaskCreate(download_button_commands, "download_button", 8192, NULL, 5, NULL);
-    xTaskCreate(push_button, "push_button", 2048, NULL, 5, NULL);
+    xNetworkQueue = xQueueCreate(NETWORK_QUEUE_LENGTH, sizeof(network_job_t));
+    const esp_timer_create_args_t actuation_timer_args = {
+        .callback = on_actuation_timeout,
+        .name = "actuation_check",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&actuation_timer_args, &actuation_timer));
+    ESP_ERROR_CHECK(esp_event_handler_register(GARAGE_EVENT, ESP_EVENT_ANY_ID, garage_event_handler, NULL));
+    ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, on_wifi_connected, NULL));
+
+    for (size_t i = 0; i < sizeof(TASK_TOPOLOGY) / sizeof(TASK_TOPOLOGY[0]); i++) {
+        const task_topology_t *task = &TASK_TOPOLOGY[i];
+        xTaskCreatePinnedToCore(task->function, task->name, task->stack_size, NULL, task->priority, NULL, task->core);
+    }
+    esp_err_t lan_err = lan_control_start(&LAN_CONTROL_CALLBACKS);
+    if (lan_err != ESP_OK && lan_err != ESP_ERR_NOT_SUPPORTED) {
+        ESP_LOGE(TAG, "Failed to start LAN control: %s", esp_err_to_name(lan_err));
+    }
+    start_periodic_timer(&log_hello_timer, log_hello, "log_hello", LOG_HELLO_PERIOD_MS);
+    start_periodic_timer(&sensor_timer, read_sensors, "read_sensors", SENSOR_SAMPLE_PERIOD_MS);
+    start_periodic_timer(&button_poll_timer, poll_button, "button_poll", BUTTON_POLL_PERIOD_MS);
+    // Poll once right away instead of waiting for the first period. After the timer exists,
+    // because the response can change its period.
+    poll_button(NULL);
+#ifdef CONFIG_GARAGE_OTA
+    start_periodic_timer(&ota_check_timer, queue_update_check, "ota_check", CONFIG_GARAGE_OTA_CHECK_INTERVAL_MINUTES * 60 * 1000ULL);
+#endif
 }